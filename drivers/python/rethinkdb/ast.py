@@ -1202,6 +1202,9 @@ class Table(RqlQuery):
     def sync(self, *args):
         return Sync(self, *args)
 
+    def backup(self, *args, **kwargs):
+        return Backup(self, *args, **kwargs)
+
     def grant(self, *args, **kwargs):
         return Grant(self, *args, **kwargs)
 
@@ -1522,6 +1525,11 @@ class Sync(RqlMethodQuery):
     st = 'sync'
 
 
+class Backup(RqlMethodQuery):
+    tt = pTerm.BACKUP
+    st = 'backup'
+
+
 class Grant(RqlMethodQuery):
     tt = pTerm.GRANT
     st = 'grant'
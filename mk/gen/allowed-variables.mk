@@ -0,0 +1 @@
+allowed-variables := CONFIG DEFAULT_GOAL IGNORE_MAKEFILE_CHANGES ALLOW_WARNINGS SHOW_COUNTDOWN VERBOSE STATIC VANILLA_PACKAGE_NAME SERVER_EXEC_NAME SYMBOLS SPLIT_SYMBOLS JSON_SHORTCUTS DEBUG UNIT_TESTS VALGRIND LINTIAN BUILD_DIR DESTDIR TIMINGS MAKE_VARIABLE_CHECK STRICT_MAKE_VARIABLE_CHECK COVERAGE STRIP_ON_INSTALL PVERSION PVERSION NAMEVERSIONED UBUNTU_RELEASE DEB_RELEASE TEST RUN_TEST_ARGS SHOW_BUILD_REASON RQL_ERROR_BT FULL_PERFMON CORO_PROFILING SIGN_PACKAGE PACKAGE_BUILD_NUMBER THREADED_COROUTINES REQUIRE_SIGNED OSX_SIGNATURE_NAME DIST_CONFIGURE_DEFAULT UGLIFY NO_OMIT_FRAME_POINTER VERIFY_FETCH_HASH STATIC_LIBGCC DISABLE_BREAKPOINTS BUILD_PORTABLE LEGACY_LINUX LEGACY_GCC RT_FORCE_NATIVE RT_COPY_NATIVE RT_REDUCE_NATIVE KEEP_INLINE NO_EVENTFD NO_EPOLL UNIT_TEST_FILTER PACKAGE_FOR_SUSE_10 NO_COMPILE_JS
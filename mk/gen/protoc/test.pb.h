@@ -0,0 +1,262 @@
+// Generated by the protocol buffer compiler.  DO NOT EDIT!
+// source: mk/gen/protoc/test.proto
+
+#ifndef GOOGLE_PROTOBUF_INCLUDED_mk_2fgen_2fprotoc_2ftest_2eproto
+#define GOOGLE_PROTOBUF_INCLUDED_mk_2fgen_2fprotoc_2ftest_2eproto
+
+#include <limits>
+#include <string>
+
+#include <google/protobuf/port_def.inc>
+#if PROTOBUF_VERSION < 3021000
+#error This file was generated by a newer version of protoc which is
+#error incompatible with your Protocol Buffer headers. Please update
+#error your headers.
+#endif
+#if 3021012 < PROTOBUF_MIN_PROTOC_VERSION
+#error This file was generated by an older version of protoc which is
+#error incompatible with your Protocol Buffer headers. Please
+#error regenerate this file with a newer version of protoc.
+#endif
+
+#include <google/protobuf/port_undef.inc>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/arena.h>
+#include <google/protobuf/arenastring.h>
+#include <google/protobuf/generated_message_bases.h>
+#include <google/protobuf/generated_message_util.h>
+#include <google/protobuf/metadata_lite.h>
+#include <google/protobuf/generated_message_reflection.h>
+#include <google/protobuf/message.h>
+#include <google/protobuf/repeated_field.h>  // IWYU pragma: export
+#include <google/protobuf/extension_set.h>  // IWYU pragma: export
+#include <google/protobuf/generated_enum_reflection.h>
+#include <google/protobuf/unknown_field_set.h>
+// @@protoc_insertion_point(includes)
+#include <google/protobuf/port_def.inc>
+#define PROTOBUF_INTERNAL_EXPORT_mk_2fgen_2fprotoc_2ftest_2eproto
+PROTOBUF_NAMESPACE_OPEN
+namespace internal {
+class AnyMetadata;
+}  // namespace internal
+PROTOBUF_NAMESPACE_CLOSE
+
+// Internal implementation detail -- do not use these members.
+struct TableStruct_mk_2fgen_2fprotoc_2ftest_2eproto {
+  static const uint32_t offsets[];
+};
+extern const ::PROTOBUF_NAMESPACE_ID::internal::DescriptorTable descriptor_table_mk_2fgen_2fprotoc_2ftest_2eproto;
+class Foo;
+struct FooDefaultTypeInternal;
+extern FooDefaultTypeInternal _Foo_default_instance_;
+PROTOBUF_NAMESPACE_OPEN
+template<> ::Foo* Arena::CreateMaybeMessage<::Foo>(Arena*);
+PROTOBUF_NAMESPACE_CLOSE
+
+enum Foo_Bar : int {
+  Foo_Bar_Baz = 1
+};
+bool Foo_Bar_IsValid(int value);
+constexpr Foo_Bar Foo_Bar_Bar_MIN = Foo_Bar_Baz;
+constexpr Foo_Bar Foo_Bar_Bar_MAX = Foo_Bar_Baz;
+constexpr int Foo_Bar_Bar_ARRAYSIZE = Foo_Bar_Bar_MAX + 1;
+
+const ::PROTOBUF_NAMESPACE_ID::EnumDescriptor* Foo_Bar_descriptor();
+template<typename T>
+inline const std::string& Foo_Bar_Name(T enum_t_value) {
+  static_assert(::std::is_same<T, Foo_Bar>::value ||
+    ::std::is_integral<T>::value,
+    "Incorrect type passed to function Foo_Bar_Name.");
+  return ::PROTOBUF_NAMESPACE_ID::internal::NameOfEnum(
+    Foo_Bar_descriptor(), enum_t_value);
+}
+inline bool Foo_Bar_Parse(
+    ::PROTOBUF_NAMESPACE_ID::ConstStringParam name, Foo_Bar* value) {
+  return ::PROTOBUF_NAMESPACE_ID::internal::ParseNamedEnum<Foo_Bar>(
+    Foo_Bar_descriptor(), name, value);
+}
+// ===================================================================
+
+class Foo final :
+    public ::PROTOBUF_NAMESPACE_ID::internal::ZeroFieldsBase /* @@protoc_insertion_point(class_definition:Foo) */ {
+ public:
+  inline Foo() : Foo(nullptr) {}
+  explicit PROTOBUF_CONSTEXPR Foo(::PROTOBUF_NAMESPACE_ID::internal::ConstantInitialized);
+
+  Foo(const Foo& from);
+  Foo(Foo&& from) noexcept
+    : Foo() {
+    *this = ::std::move(from);
+  }
+
+  inline Foo& operator=(const Foo& from) {
+    CopyFrom(from);
+    return *this;
+  }
+  inline Foo& operator=(Foo&& from) noexcept {
+    if (this == &from) return *this;
+    if (GetOwningArena() == from.GetOwningArena()
+  #ifdef PROTOBUF_FORCE_COPY_IN_MOVE
+        && GetOwningArena() != nullptr
+  #endif  // !PROTOBUF_FORCE_COPY_IN_MOVE
+    ) {
+      InternalSwap(&from);
+    } else {
+      CopyFrom(from);
+    }
+    return *this;
+  }
+
+  inline const ::PROTOBUF_NAMESPACE_ID::UnknownFieldSet& unknown_fields() const {
+    return _internal_metadata_.unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>(::PROTOBUF_NAMESPACE_ID::UnknownFieldSet::default_instance);
+  }
+  inline ::PROTOBUF_NAMESPACE_ID::UnknownFieldSet* mutable_unknown_fields() {
+    return _internal_metadata_.mutable_unknown_fields<::PROTOBUF_NAMESPACE_ID::UnknownFieldSet>();
+  }
+
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* descriptor() {
+    return GetDescriptor();
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Descriptor* GetDescriptor() {
+    return default_instance().GetMetadata().descriptor;
+  }
+  static const ::PROTOBUF_NAMESPACE_ID::Reflection* GetReflection() {
+    return default_instance().GetMetadata().reflection;
+  }
+  static const Foo& default_instance() {
+    return *internal_default_instance();
+  }
+  static inline const Foo* internal_default_instance() {
+    return reinterpret_cast<const Foo*>(
+               &_Foo_default_instance_);
+  }
+  static constexpr int kIndexInFileMessages =
+    0;
+
+  friend void swap(Foo& a, Foo& b) {
+    a.Swap(&b);
+  }
+  inline void Swap(Foo* other) {
+    if (other == this) return;
+  #ifdef PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() != nullptr &&
+        GetOwningArena() == other->GetOwningArena()) {
+   #else  // PROTOBUF_FORCE_COPY_IN_SWAP
+    if (GetOwningArena() == other->GetOwningArena()) {
+  #endif  // !PROTOBUF_FORCE_COPY_IN_SWAP
+      InternalSwap(other);
+    } else {
+      ::PROTOBUF_NAMESPACE_ID::internal::GenericSwap(this, other);
+    }
+  }
+  void UnsafeArenaSwap(Foo* other) {
+    if (other == this) return;
+    GOOGLE_DCHECK(GetOwningArena() == other->GetOwningArena());
+    InternalSwap(other);
+  }
+
+  // implements Message ----------------------------------------------
+
+  Foo* New(::PROTOBUF_NAMESPACE_ID::Arena* arena = nullptr) const final {
+    return CreateMaybeMessage<Foo>(arena);
+  }
+  using ::PROTOBUF_NAMESPACE_ID::internal::ZeroFieldsBase::CopyFrom;
+  inline void CopyFrom(const Foo& from) {
+    ::PROTOBUF_NAMESPACE_ID::internal::ZeroFieldsBase::CopyImpl(*this, from);
+  }
+  using ::PROTOBUF_NAMESPACE_ID::internal::ZeroFieldsBase::MergeFrom;
+  void MergeFrom(const Foo& from) {
+    ::PROTOBUF_NAMESPACE_ID::internal::ZeroFieldsBase::MergeImpl(*this, from);
+  }
+  public:
+
+  private:
+  friend class ::PROTOBUF_NAMESPACE_ID::internal::AnyMetadata;
+  static ::PROTOBUF_NAMESPACE_ID::StringPiece FullMessageName() {
+    return "Foo";
+  }
+  protected:
+  explicit Foo(::PROTOBUF_NAMESPACE_ID::Arena* arena,
+                       bool is_message_owned = false);
+  public:
+
+  static const ClassData _class_data_;
+  const ::PROTOBUF_NAMESPACE_ID::Message::ClassData*GetClassData() const final;
+
+  ::PROTOBUF_NAMESPACE_ID::Metadata GetMetadata() const final;
+
+  // nested types ----------------------------------------------------
+
+  typedef Foo_Bar Bar;
+  static constexpr Bar Baz =
+    Foo_Bar_Baz;
+  static inline bool Bar_IsValid(int value) {
+    return Foo_Bar_IsValid(value);
+  }
+  static constexpr Bar Bar_MIN =
+    Foo_Bar_Bar_MIN;
+  static constexpr Bar Bar_MAX =
+    Foo_Bar_Bar_MAX;
+  static constexpr int Bar_ARRAYSIZE =
+    Foo_Bar_Bar_ARRAYSIZE;
+  static inline const ::PROTOBUF_NAMESPACE_ID::EnumDescriptor*
+  Bar_descriptor() {
+    return Foo_Bar_descriptor();
+  }
+  template<typename T>
+  static inline const std::string& Bar_Name(T enum_t_value) {
+    static_assert(::std::is_same<T, Bar>::value ||
+      ::std::is_integral<T>::value,
+      "Incorrect type passed to function Bar_Name.");
+    return Foo_Bar_Name(enum_t_value);
+  }
+  static inline bool Bar_Parse(::PROTOBUF_NAMESPACE_ID::ConstStringParam name,
+      Bar* value) {
+    return Foo_Bar_Parse(name, value);
+  }
+
+  // accessors -------------------------------------------------------
+
+  // @@protoc_insertion_point(class_scope:Foo)
+ private:
+  class _Internal;
+
+  template <typename T> friend class ::PROTOBUF_NAMESPACE_ID::Arena::InternalHelper;
+  typedef void InternalArenaConstructable_;
+  typedef void DestructorSkippable_;
+  struct Impl_ {
+  };
+  friend struct ::TableStruct_mk_2fgen_2fprotoc_2ftest_2eproto;
+};
+// ===================================================================
+
+
+// ===================================================================
+
+#ifdef __GNUC__
+  #pragma GCC diagnostic push
+  #pragma GCC diagnostic ignored "-Wstrict-aliasing"
+#endif  // __GNUC__
+// Foo
+
+#ifdef __GNUC__
+  #pragma GCC diagnostic pop
+#endif  // __GNUC__
+
+// @@protoc_insertion_point(namespace_scope)
+
+
+PROTOBUF_NAMESPACE_OPEN
+
+template <> struct is_proto_enum< ::Foo_Bar> : ::std::true_type {};
+template <>
+inline const EnumDescriptor* GetEnumDescriptor< ::Foo_Bar>() {
+  return ::Foo_Bar_descriptor();
+}
+
+PROTOBUF_NAMESPACE_CLOSE
+
+// @@protoc_insertion_point(global_scope)
+
+#include <google/protobuf/port_undef.inc>
+#endif  // GOOGLE_PROTOBUF_INCLUDED_GOOGLE_PROTOBUF_INCLUDED_mk_2fgen_2fprotoc_2ftest_2eproto
@@ -53,7 +53,7 @@ public:
                          perfmon_collection_t *stats) :
         stack_stats(stats, "stack"),
         conflict_resolver(stats),
-        accounter(batch_factor),
+        accounter(batch_factor, max_concurrent_io_requests, stats),
         backend_stats(stats, "backend", accounter.producer),
         backend(queue, backend_stats.producer, max_concurrent_io_requests),
         outstanding_txn(0)
@@ -81,8 +81,9 @@ public:
                 outstanding_txn);
     }
 
-    void *create_account(int pri, int outstanding_requests_limit) {
-        return new accounting_diskmgr_t::account_t(&accounter, pri, outstanding_requests_limit);
+    void *create_account(io_class_t io_class, int outstanding_requests_limit) {
+        return new accounting_diskmgr_t::account_t(&accounter, io_class,
+                                                   outstanding_requests_limit);
     }
 
     void destroy_account(void *account) {
@@ -222,7 +223,10 @@ linux_file_t::linux_file_t(scoped_fd_t &&_fd, int64_t _file_size, linux_disk_man
     // file_account_t outside of the thread pool?  But they're associated with the diskmgr,
     // aren't they?)
     if (linux_thread_pool_t::get_thread()) {
-        default_account.init(new file_account_t(this, 1, UNLIMITED_OUTSTANDING_REQUESTS));
+        // The default account serves metablock and static header writes, which
+        // are part of every flush.
+        default_account.init(new file_account_t(this, io_class_t::flush,
+                                                UNLIMITED_OUTSTANDING_REQUESTS));
     }
 }
 
@@ -362,9 +366,9 @@ bool linux_file_t::coop_lock_and_check() {
 #endif
 }
 
-void *linux_file_t::create_account(int priority, int outstanding_requests_limit) {
+void *linux_file_t::create_account(io_class_t io_class, int outstanding_requests_limit) {
     assert_thread();
-    return diskmgr->create_account(priority, outstanding_requests_limit);
+    return diskmgr->create_account(io_class, outstanding_requests_limit);
 }
 
 void linux_file_t::destroy_account(void *account) {
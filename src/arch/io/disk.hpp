@@ -83,7 +83,7 @@ public:
 
     bool coop_lock_and_check();
 
-    void *create_account(int priority, int outstanding_requests_limit);
+    void *create_account(io_class_t io_class, int outstanding_requests_limit);
     void destroy_account(void *account);
 
     ~linux_file_t();
@@ -1,19 +1,21 @@
 #include "arch/io/disk/accounting.hpp"
 
+#include <algorithm>
+#include <string>
+
+#include "config/args.hpp"
 #include "containers/printf_buffer.hpp"
 
-/* Each account on the `accounting_diskmgr_t` has its own
-   `unlimited_fifo_queue_t` associated with it. Operations for that account
-   queue up on that queue while they wait for the `accounting_queue_t` on the
-   `accounting_diskmgr_t` to draw from that account. */
+/* Each account on the `accounting_diskmgr_t` holds back the operations that would
+   exceed its limit of outstanding requests.  Once an operation may go ahead, it is
+   queued up on the `accounting_diskmgr_t` by its I/O class. */
 struct accounting_diskmgr_eager_account_t : public semaphore_available_callback_t {
     typedef accounting_diskmgr_action_t action_t;
 
-    accounting_diskmgr_eager_account_t(accounting_diskmgr_t *par,
-                                       int pri,
+    accounting_diskmgr_eager_account_t(accounting_diskmgr_t *_par,
                                        int outstanding_requests_limit) :
+        par(_par),
         outstanding_requests_limiter(outstanding_requests_limit == UNLIMITED_OUTSTANDING_REQUESTS ? SEMAPHORE_NO_LIMIT : outstanding_requests_limit),
-        account(&par->queue, &queue, pri),
         accounter_lock(par->get_auto_drainer()) {
         rassert(outstanding_requests_limit == UNLIMITED_OUTSTANDING_REQUESTS || outstanding_requests_limit > 0);
     }
@@ -25,32 +27,32 @@ struct accounting_diskmgr_eager_account_t : public semaphore_available_callback_
     void on_semaphore_available() {
         action_t *action = throttled_queue.head();
         throttled_queue.pop_front();
-        queue.push(action);
+        par->enqueue(action);
     }
     co_semaphore_t *get_outstanding_requests_limiter() {
         return &outstanding_requests_limiter;
     }
 
 private:
+    accounting_diskmgr_t *par;
     // It would be nice if we could just use a limited_fifo_queue to
     // implement the limitation of outstanding requests.
     // However this part of the code must not rely on coroutines, therefore
     // we have to implement that functionality manually.
-    // throttled_queue contains requests which can not be put on queue right now,
-    // because the number of outstanding requests has been exceeded
+    // throttled_queue contains requests which can not be queued up on the
+    // `accounting_diskmgr_t` right now, because the number of outstanding requests
+    // has been exceeded
     intrusive_list_t<action_t> throttled_queue;
-    unlimited_fifo_queue_t<action_t *, intrusive_list_t<action_t> > queue;
     static_semaphore_t outstanding_requests_limiter;
-    accounting_queue_t<action_t *>::account_t account;
     auto_drainer_t::lock_t accounter_lock;
 
     DISABLE_COPYING(accounting_diskmgr_eager_account_t);
 };
 
 accounting_diskmgr_account_t::accounting_diskmgr_account_t(accounting_diskmgr_t *_par,
-                                                           int _pri,
+                                                           io_class_t _io_class,
                                                            int _outstanding_requests_limit)
-        : par(_par), pri(_pri),
+        : par(_par), io_class(_io_class),
           outstanding_requests_limit(_outstanding_requests_limit) { }
 
 accounting_diskmgr_account_t::~accounting_diskmgr_account_t() {
@@ -83,7 +85,7 @@ co_semaphore_t *accounting_diskmgr_account_t::get_outstanding_requests_limiter()
 void accounting_diskmgr_account_t::maybe_init(){
     if (!eager_account.has()) {
         par->assert_thread();
-        eager_account.init(new eager_account_t(par, pri, outstanding_requests_limit));
+        eager_account.init(new eager_account_t(par, outstanding_requests_limit));
     }
 }
 
@@ -99,8 +101,95 @@ void debug_print(printf_buffer_t *buf,
 }
 
 
+// Each window of latencies that the floor isn't lowered by lets it rise by this
+// factor.
+static const double LATENCY_FLOOR_DRIFT = 1.02;
+
+static int64_t io_class_latency_target_us(io_class_t io_class) {
+    switch (io_class) {
+    case io_class_t::foreground_read: return FOREGROUND_READ_IO_LATENCY_TARGET_US;
+    case io_class_t::flush: return FLUSH_IO_LATENCY_TARGET_US;
+    case io_class_t::backfill: return BACKFILL_IO_LATENCY_TARGET_US;
+    case io_class_t::gc: return GC_IO_LATENCY_TARGET_US;
+    case io_class_t::sindex_build: return SINDEX_BUILD_IO_LATENCY_TARGET_US;
+    case io_class_t::prefetch: return PREFETCH_IO_LATENCY_TARGET_US;
+    default: unreachable();
+    }
+}
+
+static int64_t io_class_bandwidth_cap(io_class_t io_class) {
+    switch (io_class) {
+    case io_class_t::foreground_read: return FOREGROUND_READ_IO_BANDWIDTH_CAP;
+    case io_class_t::flush: return FLUSH_IO_BANDWIDTH_CAP;
+    case io_class_t::backfill: return BACKFILL_IO_BANDWIDTH_CAP;
+    case io_class_t::gc: return GC_IO_BANDWIDTH_CAP;
+    case io_class_t::sindex_build: return SINDEX_BUILD_IO_BANDWIDTH_CAP;
+    case io_class_t::prefetch: return PREFETCH_IO_BANDWIDTH_CAP;
+    default: unreachable();
+    }
+}
+
+static const char *io_class_name(io_class_t io_class) {
+    switch (io_class) {
+    case io_class_t::foreground_read: return "foreground_read";
+    case io_class_t::flush: return "flush";
+    case io_class_t::backfill: return "backfill";
+    case io_class_t::gc: return "gc";
+    case io_class_t::sindex_build: return "sindex_build";
+    case io_class_t::prefetch: return "prefetch";
+    default: unreachable();
+    }
+}
+
+accounting_diskmgr_t::class_queue_t::class_queue_t(io_class_t io_class,
+                                                   perfmon_collection_t *stats)
+    : latency_target(io_class_latency_target_us(io_class) * THOUSAND),
+      bandwidth_cap(io_class_bandwidth_cap(io_class)),
+      max_tokens(static_cast<double>(bandwidth_cap) * IO_BANDWIDTH_BURST_MS / THOUSAND),
+      tokens(max_tokens),
+      queue_time(secs_to_ticks(1), false),
+      queue_time_membership(stats, &queue_time,
+                            std::string("queue_") + io_class_name(io_class)) { }
+
+bool accounting_diskmgr_t::class_queue_t::is_eligible() const {
+    // We let a request through as long as there are any tokens left, even if it
+    // costs more than that.  Otherwise requests that are larger than the burst
+    // size could never go through.
+    return !actions.empty() && (bandwidth_cap == 0 || tokens > 0);
+}
+
+accounting_diskmgr_t::accounting_diskmgr_t(int _batch_factor,
+                                           int _max_outstanding_requests,
+                                           perfmon_collection_t *stats)
+    : passive_producer_t<accounting_payload_t *>(&available_control),
+      producer(this),
+      last_refill_time(get_ticks()),
+      refill_timer(nullptr),
+      batch_factor(_batch_factor),
+      batch_class(nullptr),
+      batch_remaining(0),
+      min_outstanding_requests(std::min(DISK_MIN_OUTSTANDING_REQUESTS,
+                                        _max_outstanding_requests)),
+      max_outstanding_requests(_max_outstanding_requests),
+      depth_limit(_max_outstanding_requests),
+      outstanding_requests(0),
+      window_completions(0),
+      window_saturated(false),
+      depth_limit_membership(stats, &depth_limit_counter, "outstanding_requests_limit"),
+      auto_drainer(new auto_drainer_t()) {
+    rassert(batch_factor > 0);
+    rassert(max_outstanding_requests > 0);
+    for (size_t i = 0; i < NUM_IO_CLASSES; ++i) {
+        classes[i].init(new class_queue_t(static_cast<io_class_t>(i), stats));
+    }
+    depth_limit_counter += depth_limit;
+}
+
 accounting_diskmgr_t::~accounting_diskmgr_t() {
     auto_drainer.reset();  // Make absolutely sure this happens first.
+    if (refill_timer != nullptr) {
+        cancel_timer(refill_timer);
+    }
 }
 
 void accounting_diskmgr_t::submit(action_t *a) {
@@ -110,8 +199,149 @@ void accounting_diskmgr_t::submit(action_t *a) {
 void accounting_diskmgr_t::done(accounting_payload_t *p) {
     // p really is an action_t...
     action_t *a = static_cast<action_t *>(p);
+    --outstanding_requests;
+    record_latency(a, get_ticks());
+    update_availability();
     a->account->get_outstanding_requests_limiter()->unlock(1);
     a->account_acq.reset();
     done_fun(static_cast<action_t *>(p));
 }
 
+void accounting_diskmgr_t::enqueue(action_t *a) {
+    assert_thread();
+    a->enqueue_time = get_ticks();
+    classes[static_cast<size_t>(a->account->get_io_class())]->actions.push_back(a);
+    update_availability();
+}
+
+accounting_payload_t *accounting_diskmgr_t::produce_next_value() {
+    assert_thread();
+    const ticks_t now = get_ticks();
+    refill_tokens(now);
+    class_queue_t *c = choose_class();
+    rassert(c != nullptr);
+    if (c != batch_class) {
+        batch_class = c;
+        batch_remaining = batch_factor;
+    }
+    --batch_remaining;
+
+    action_t *a = c->actions.head();
+    c->actions.pop_front();
+    c->queue_time.record(ticks_to_secs(now - a->enqueue_time));
+    if (c->bandwidth_cap != 0) {
+        c->tokens -= a->get_count();
+    }
+
+    a->dispatch_time = now;
+    ++outstanding_requests;
+    if (outstanding_requests >= depth_limit) {
+        window_saturated = true;
+    }
+    update_availability();
+    return a;
+}
+
+void accounting_diskmgr_t::on_timer() {
+    refill_timer = nullptr;
+    update_availability();
+}
+
+void accounting_diskmgr_t::refill_tokens(ticks_t now) {
+    const double elapsed_secs = ticks_to_secs(now - last_refill_time);
+    last_refill_time = now;
+    for (size_t i = 0; i < NUM_IO_CLASSES; ++i) {
+        class_queue_t *c = classes[i].get();
+        if (c->bandwidth_cap != 0) {
+            c->tokens = std::min(c->max_tokens,
+                                 c->tokens + c->bandwidth_cap * elapsed_secs);
+        }
+    }
+}
+
+accounting_diskmgr_t::class_queue_t *accounting_diskmgr_t::choose_class() {
+    class_queue_t *earliest = nullptr;
+    ticks_t earliest_deadline = 0;
+    for (size_t i = 0; i < NUM_IO_CLASSES; ++i) {
+        class_queue_t *c = classes[i].get();
+        if (!c->is_eligible()) {
+            continue;
+        }
+        const ticks_t deadline = c->actions.head()->enqueue_time + c->latency_target;
+        if (earliest == nullptr || deadline < earliest_deadline) {
+            earliest = c;
+            earliest_deadline = deadline;
+        }
+    }
+    // Stick with the class we took the last request from for up to `batch_factor`
+    // requests, because its requests tend to be close to each other on disk.  But
+    // only while its next request is due no later than every other class's.
+    if (batch_class != nullptr && batch_remaining > 0 && batch_class->is_eligible()
+        && batch_class->actions.head()->enqueue_time + batch_class->latency_target
+           <= earliest_deadline) {
+        return batch_class;
+    }
+    return earliest;
+}
+
+void accounting_diskmgr_t::update_availability() {
+    refill_tokens(get_ticks());
+    bool any_eligible = false;
+    int64_t refill_ms = -1;
+    for (size_t i = 0; i < NUM_IO_CLASSES; ++i) {
+        class_queue_t *c = classes[i].get();
+        if (c->is_eligible()) {
+            any_eligible = true;
+        } else if (!c->actions.empty()) {
+            // The class is out of tokens.  Find out when it will have some again.
+            int64_t ms = static_cast<int64_t>(-c->tokens * THOUSAND / c->bandwidth_cap) + 1;
+            refill_ms = refill_ms == -1 ? ms : std::min(refill_ms, ms);
+        }
+    }
+    // We set the timer before changing the availability, because that can
+    // re-enter `produce_next_value()`.
+    if (refill_ms != -1 && refill_timer == nullptr) {
+        refill_timer = fire_timer_once(refill_ms, this);
+    }
+    available_control.set_available(any_eligible && outstanding_requests < depth_limit);
+}
+
+void accounting_diskmgr_t::record_latency(action_t *a, ticks_t now) {
+    latency_window_t *window = a->get_is_read() ? &read_latency : &write_latency;
+    window->sum += ticks_to_secs(now - a->dispatch_time);
+    ++window->count;
+    ++window_completions;
+    if (window_completions >= std::max(depth_limit, min_outstanding_requests)) {
+        adjust_outstanding_requests_limit();
+    }
+}
+
+void accounting_diskmgr_t::adjust_outstanding_requests_limit() {
+    bool congested = false;
+    for (latency_window_t *window : { &read_latency, &write_latency }) {
+        if (window->count == 0) {
+            continue;
+        }
+        const double mean = window->sum / window->count;
+        if (window->floor == 0 || mean < window->floor) {
+            window->floor = mean;
+        } else {
+            congested = congested || mean > window->floor * DISK_LATENCY_TOLERANCE;
+            window->floor *= LATENCY_FLOOR_DRIFT;
+        }
+        window->sum = 0;
+        window->count = 0;
+    }
+
+    const int old_depth_limit = depth_limit;
+    if (congested) {
+        // The device is queueing up requests internally.  Back off quickly.
+        depth_limit = std::max(min_outstanding_requests, depth_limit * 3 / 4);
+    } else if (window_saturated) {
+        // We could have used more requests, and the device kept up.  Probe upwards.
+        depth_limit = std::min(max_outstanding_requests, depth_limit + 1);
+    }
+    depth_limit_counter += depth_limit - old_depth_limit;
+    window_completions = 0;
+    window_saturated = false;
+}
@@ -7,32 +7,24 @@
 #include "containers/intrusive_list.hpp"
 #include "containers/scoped.hpp"
 #include "concurrency/auto_drainer.hpp"
-#include "concurrency/queue/accounting.hpp"
-#include "concurrency/queue/unlimited_fifo.hpp"
+#include "concurrency/queue/passive_producer.hpp"
 #include "concurrency/semaphore.hpp"
 #include "arch/io/disk.hpp"
 #include "arch/io/disk/stats_2.hpp"
+#include "arch/timer.hpp"
+#include "perfmon/perfmon.hpp"
 
-/* `casting_passive_producer_t` is useful when you have a
-`passive_producer_t<X>` but you need a `passive_producer_t<Y>`, where `X` can
-be cast to `Y`. */
+/* `accounting_diskmgr_t` schedules the I/O requests of a number of different
+"accounts".  Every account belongs to an I/O class (see `io_class_t`).  Once an
+account lets a request through, the request gets a deadline: the current time plus
+the latency target of its class.  The `accounting_diskmgr_t` always hands out the
+request with the earliest deadline next.  Background classes additionally have a
+bandwidth cap, which is enforced with a token bucket.
 
-template <class input_t, class output_t>
-struct casting_passive_producer_t : public passive_producer_t<output_t> {
-    explicit casting_passive_producer_t(passive_producer_t<input_t> *_source) :
-        passive_producer_t<output_t>(_source->available), source(_source) { }
-
-    output_t produce_next_value() {
-        /* Implicit cast from `input_t` to `output_t` in return */
-        return source->pop();
-    }
-
-private:
-    passive_producer_t<input_t> *source;
-};
-
-/* `accounting_diskmgr_t` shares disk throughput proportionally between a
-number of different "accounts". */
+The `accounting_diskmgr_t` also limits how many requests are outstanding on the
+device at once.  It lowers the limit when the device's latency climbs well above the
+lowest latency it has shown, so that requests wait in the scheduler, where reads can
+still pass ahead of background work, rather than inside the device. */
 
 typedef stats_diskmgr_2_t::action_t accounting_payload_t;
 
@@ -46,7 +38,7 @@ struct accounting_diskmgr_account_t {
     typedef accounting_diskmgr_action_t action_t;
 
     accounting_diskmgr_account_t(accounting_diskmgr_t *_par,
-                                 int _pri,
+                                 io_class_t _io_class,
                                  int _outstanding_requests_limit);
 
     ~accounting_diskmgr_account_t();
@@ -55,13 +47,15 @@ struct accounting_diskmgr_account_t {
     void on_semaphore_available();
     co_semaphore_t *get_outstanding_requests_limiter();
 
+    io_class_t get_io_class() const { return io_class; }
+
 private:
     typedef accounting_diskmgr_eager_account_t eager_account_t;
 
     void maybe_init();
 
     accounting_diskmgr_t *par;
-    int pri;
+    io_class_t io_class;
     int outstanding_requests_limit;
     scoped_ptr_t<eager_account_t> eager_account;
     // A scoped pointer because we create the drainer lazily on first use.
@@ -75,18 +69,23 @@ struct accounting_diskmgr_action_t
       public accounting_payload_t {
     accounting_diskmgr_account_t *account;
     auto_drainer_t::lock_t account_acq;
+    // When the action got queued up in the `accounting_diskmgr_t`, and when it was
+    // handed to the device.
+    ticks_t enqueue_time;
+    ticks_t dispatch_time;
 };
 
 void debug_print(printf_buffer_t *buf,
                  const accounting_diskmgr_action_t &action);
 
-class accounting_diskmgr_t : public home_thread_mixin_t {
+class accounting_diskmgr_t
+    : public home_thread_mixin_t,
+      private passive_producer_t<accounting_payload_t *>,
+      private timer_callback_t {
 public:
-    explicit accounting_diskmgr_t(int batch_factor)
-        : producer(&caster),
-          queue(batch_factor),
-          caster(&queue),
-          auto_drainer(new auto_drainer_t()) { }
+    accounting_diskmgr_t(int batch_factor,
+                         int max_outstanding_requests,
+                         perfmon_collection_t *stats);
 
     ~accounting_diskmgr_t();
 
@@ -105,11 +104,79 @@ public:
         return auto_drainer.get();
     }
 
+    // How many requests the `accounting_diskmgr_t` currently lets be outstanding on
+    // the device.
+    int get_outstanding_requests_limit() const { return depth_limit; }
+
 private:
     friend struct accounting_diskmgr_eager_account_t;
 
-    accounting_queue_t<action_t *> queue;
-    casting_passive_producer_t<action_t *, accounting_payload_t *> caster;
+    // The queued up requests of one I/O class, in the order of their deadlines.
+    // (All requests of a class have the same latency target.)
+    struct class_queue_t {
+        class_queue_t(io_class_t io_class, perfmon_collection_t *stats);
+
+        bool is_eligible() const;
+
+        const ticks_t latency_target;
+        const int64_t bandwidth_cap;
+        const double max_tokens;
+        double tokens;
+        intrusive_list_t<action_t> actions;
+
+        perfmon_sampler_t queue_time;
+        perfmon_membership_t queue_time_membership;
+
+        DISABLE_COPYING(class_queue_t);
+    };
+
+    // Device latencies, in seconds, of the requests that completed since the
+    // outstanding requests limit was last adjusted.  Reads and writes are tracked
+    // separately, because writes tend to be much larger.
+    struct latency_window_t {
+        latency_window_t() : floor(0), sum(0), count(0) { }
+        // The lowest mean latency of a window that we have seen, drifting upwards
+        // slowly so that it follows the device.  Zero until the first window ends.
+        double floor;
+        double sum;
+        int count;
+    };
+
+    // Called by the accounts when they let a request through.
+    void enqueue(action_t *a);
+
+    accounting_payload_t *produce_next_value();
+    void on_timer();
+
+    void refill_tokens(ticks_t now);
+    class_queue_t *choose_class();
+    void update_availability();
+
+    void record_latency(action_t *a, ticks_t now);
+    void adjust_outstanding_requests_limit();
+
+    availability_control_t available_control;
+
+    scoped_ptr_t<class_queue_t> classes[NUM_IO_CLASSES];
+    ticks_t last_refill_time;
+    // Pending while a capped class waits for its tokens to refill.
+    timer_token_t *refill_timer;
+
+    const int batch_factor;
+    class_queue_t *batch_class;
+    int batch_remaining;
+
+    const int min_outstanding_requests, max_outstanding_requests;
+    int depth_limit;
+    int outstanding_requests;
+    latency_window_t read_latency, write_latency;
+    int window_completions;
+    // Whether the limit was reached since it was last adjusted.
+    bool window_saturated;
+
+    perfmon_counter_t depth_limit_counter;
+    perfmon_membership_t depth_limit_membership;
+
     scoped_ptr_t<auto_drainer_t> auto_drainer;
 
     DISABLE_COPYING(accounting_diskmgr_t);
@@ -18,6 +18,7 @@
 #include <netinet/tcp.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #endif
 
 #include "utils.hpp"
@@ -213,6 +214,7 @@ linux_tcp_conn_t::linux_tcp_conn_t(const ip_address_t &peer,
         event_watcher(new event_watcher_t(sock.get(), this)),
         read_in_progress(false), write_in_progress(false),
         read_buffer(IO_BUFFER_SIZE),
+        read_chunk_size(IO_BUFFER_SIZE),
         write_handler(this),
         write_queue_limiter(WRITE_QUEUE_MAX_SIZE),
         write_coro_pool(1, &write_queue, &write_handler),
@@ -254,6 +256,7 @@ linux_tcp_conn_t::linux_tcp_conn_t(fd_t s) :
        event_watcher(new event_watcher_t(sock.get(), this)),
        read_in_progress(false), write_in_progress(false),
        read_buffer(IO_BUFFER_SIZE),
+       read_chunk_size(IO_BUFFER_SIZE),
        write_handler(this),
        write_queue_limiter(WRITE_QUEUE_MAX_SIZE),
        write_coro_pool(1, &write_queue, &write_handler),
@@ -346,8 +349,30 @@ size_t linux_tcp_conn_t::read_internal(void *buffer, size_t size) THROWS_ONLY(tc
         return op.nb_bytes;
     }
 #else
+    return linux_tcp_conn_t::read_internal_scatter(buffer, size, nullptr, 0);
+#endif
+}
+
+size_t linux_tcp_conn_t::read_internal_scatter(
+        void *buffer, size_t size, void *overflow, size_t overflow_size)
+        THROWS_ONLY(tcp_conn_read_closed_exc_t) {
+#ifdef _WIN32
+    (void) overflow;
+    (void) overflow_size;
+    return read_internal(buffer, size);
+#else
+    assert_thread();
+    rassert(!read_closed.is_pulsed());
+
+    struct iovec iov[2];
+    iov[0].iov_base = buffer;
+    iov[0].iov_len = size;
+    iov[1].iov_base = overflow;
+    iov[1].iov_len = overflow_size;
+    int iovcnt = overflow_size > 0 ? 2 : 1;
+
     while (true) {
-        ssize_t res = ::read(sock.get(), buffer, size);
+        ssize_t res = ::readv(sock.get(), iov, iovcnt);
 
         if (res == -1 && (get_errno() == EAGAIN || get_errno() == EWOULDBLOCK)) {
             /* There's no data available right now, so we must wait for a notification from the
@@ -390,15 +415,18 @@ size_t linux_tcp_conn_t::read_some(void *buf, size_t size, signal_t *closer) THR
     rassert(size > 0);
     read_op_wrapper_t sentry(this, closer);
 
-    if (read_buffer.size()) {
+    if (!read_buffer.empty()) {
         /* Return the data from the peek buffer */
         size_t read_buffer_bytes = std::min(read_buffer.size(), size);
         memcpy(buf, read_buffer.data(), read_buffer_bytes);
-        read_buffer.erase_front(read_buffer_bytes);
+        read_buffer.consume(read_buffer_bytes);
         return read_buffer_bytes;
     } else {
         /* Go to the kernel _once_. */
-        return read_internal(buf, size);
+        size_t delta = read_internal(buf, size);
+        ++read_stats.reads;
+        read_stats.bytes += delta;
+        return delta;
     }
 }
 
@@ -406,16 +434,25 @@ void linux_tcp_conn_t::read(void *buf, size_t size, signal_t *closer) THROWS_ONL
     read_op_wrapper_t sentry(this, closer);
 
     /* First, consume any data in the peek buffer */
-    int read_buffer_bytes = std::min(read_buffer.size(), size);
+    size_t read_buffer_bytes = std::min(read_buffer.size(), size);
     memcpy(buf, read_buffer.data(), read_buffer_bytes);
-    read_buffer.erase_front(read_buffer_bytes);
+    read_buffer.consume(read_buffer_bytes);
     buf = reinterpret_cast<void *>(reinterpret_cast<char *>(buf) + read_buffer_bytes);
     size -= read_buffer_bytes;
 
-    /* Now go to the kernel for any more data that we need */
+    /* Now go to the kernel for any more data that we need. Whatever arrives beyond
+    the end of `buf` lands in the (by now empty) read buffer in the same call, so that
+    the next small read doesn't need a system call of its own. */
     while (size > 0) {
-        size_t delta = read_internal(buf, size);
-        rassert(delta <= size);
+        size_t overflow_size = read_buffer.free_space();
+        char *overflow = read_buffer.prepare(overflow_size);
+        size_t delta = read_internal_scatter(buf, size, overflow, overflow_size);
+        ++read_stats.reads;
+        read_stats.bytes += delta;
+        if (delta > size) {
+            read_buffer.commit(delta - size);
+            delta = size;
+        }
         buf = reinterpret_cast<void *>(reinterpret_cast<char *>(buf) + delta);
         size -= delta;
     }
@@ -454,14 +491,28 @@ void linux_tcp_conn_t::read_buffered(void *buf, size_t size, signal_t *closer)
     }
 }
 
-void linux_tcp_conn_t::read_more_buffered(signal_t *closer) THROWS_ONLY(tcp_conn_read_closed_exc_t) {
-    read_op_wrapper_t sentry(this, closer);
+void linux_tcp_conn_t::fill_read_buffer(size_t min_size)
+        THROWS_ONLY(tcp_conn_read_closed_exc_t) {
+    char *dest = read_buffer.prepare(std::max(read_chunk_size, min_size));
+    // `prepare()` may have left more room than we asked for, and we might as well
+    // use it.
+    size_t chunk_size = read_buffer.free_space();
+    size_t delta = read_internal(dest, chunk_size);
+    rassert(delta <= chunk_size);
+    read_buffer.commit(delta);
+    ++read_stats.reads;
+    read_stats.bytes += delta;
 
-    size_t old_size = read_buffer.size();
-    read_buffer.resize(old_size + IO_BUFFER_SIZE);
-    size_t delta = read_internal(read_buffer.data() + old_size, IO_BUFFER_SIZE);
+    if (delta >= read_chunk_size) {
+        read_chunk_size = std::min<size_t>(2 * read_chunk_size, MAX_READ_CHUNK_SIZE);
+    } else if (delta < read_chunk_size / 4) {
+        read_chunk_size = std::max<size_t>(read_chunk_size / 2, IO_BUFFER_SIZE);
+    }
+}
 
-    read_buffer.resize(old_size + delta);
+void linux_tcp_conn_t::read_more_buffered(signal_t *closer) THROWS_ONLY(tcp_conn_read_closed_exc_t) {
+    read_op_wrapper_t sentry(this, closer);
+    fill_read_buffer(0);
 }
 
 const_charslice linux_tcp_conn_t::peek() const THROWS_ONLY(tcp_conn_read_closed_exc_t) {
@@ -475,8 +526,13 @@ const_charslice linux_tcp_conn_t::peek() const THROWS_ONLY(tcp_conn_read_closed_
 }
 
 const_charslice linux_tcp_conn_t::peek(size_t size, signal_t *closer) THROWS_ONLY(tcp_conn_read_closed_exc_t) {
-    while (read_buffer.size() < size) {
-        read_more_buffered(closer);
+    if (read_buffer.size() < size) {
+        read_op_wrapper_t sentry(this, closer);
+        while (read_buffer.size() < size) {
+            // We know how much more we need, so we ask for all of it at once.
+            fill_read_buffer(std::min<size_t>(size - read_buffer.size(),
+                                              MAX_READ_CHUNK_SIZE));
+        }
     }
     return const_charslice(read_buffer.data(), read_buffer.data() + size);
 }
@@ -489,7 +545,9 @@ void linux_tcp_conn_t::pop(size_t len, signal_t *closer) THROWS_ONLY(tcp_conn_re
     }
 
     peek(len, closer);
-    read_buffer.erase_front(len);
+    read_buffer.consume(len);
+    // Don't hold on to the memory of a large message once it has been consumed.
+    read_buffer.shrink_if_empty(read_chunk_size);
 }
 
 void linux_tcp_conn_t::shutdown_read() {
@@ -1047,6 +1105,12 @@ size_t linux_secure_tcp_conn_t::read_internal(void *buffer, size_t size)
     }
 }
 
+size_t linux_secure_tcp_conn_t::read_internal_scatter(
+        void *buffer, size_t size, UNUSED void *overflow, UNUSED size_t overflow_size)
+        THROWS_ONLY(tcp_conn_read_closed_exc_t) {
+    return read_internal(buffer, size);
+}
+
 void linux_secure_tcp_conn_t::perform_write(const void *buffer, size_t size) {
     assert_thread();
 
@@ -28,8 +28,8 @@
 #include "arch/compiler.hpp"
 #include "config/args.hpp"
 #include "concurrency/interruptor.hpp"
-#include "containers/lazy_erase_vector.hpp"
 #include "containers/scoped.hpp"
+#include "containers/sliding_buffer.hpp"
 #include "arch/address.hpp"
 #include "arch/io/event_watcher.hpp"
 #include "arch/io/io_utils.hpp"
@@ -163,6 +163,21 @@ public:
     transmitted over the network. */
     perfmon_rate_monitor_t *write_perfmon;
 
+    /* Counts the reads we have made on the socket, to tell how well the read path is
+    batching the traffic on this connection. */
+    struct read_stats_t {
+        read_stats_t() : reads(0), bytes(0) { }
+        uint64_t reads;
+        uint64_t bytes;
+        double reads_per_megabyte() const {
+            return bytes == 0 ? 0.0 : reads * static_cast<double>(MEGABYTE) / bytes;
+        }
+    };
+    const read_stats_t &get_read_stats() const {
+        assert_thread();
+        return read_stats;
+    }
+
     virtual ~linux_tcp_conn_t() THROWS_NOTHING;
 
     virtual void rethread(threadnum_t thread);
@@ -264,7 +279,21 @@ private:
     bool read_in_progress, write_in_progress;
 
     /* Holds data that we read from the socket but hasn't been consumed yet */
-    lazy_erase_vector_t<char> read_buffer;
+    sliding_buffer_t read_buffer;
+
+    /* How many bytes `read_more_buffered()` asks the kernel for. It doubles (up to
+    `MAX_READ_CHUNK_SIZE`) whenever a read fills it completely, since that means more
+    data was waiting, and halves (down to `IO_BUFFER_SIZE`) when reads come back mostly
+    empty. A large message thus takes a logarithmic number of small reads to ramp up,
+    rather than one read per `IO_BUFFER_SIZE` bytes. */
+    size_t read_chunk_size;
+    static const size_t MAX_READ_CHUNK_SIZE = 1 * MEGABYTE;
+
+    read_stats_t read_stats;
+
+    /* Reads at least one byte into `read_buffer`, asking the kernel for at least
+    `min_size` bytes. */
+    void fill_read_buffer(size_t min_size) THROWS_ONLY(tcp_conn_read_closed_exc_t);
 
     static const size_t WRITE_QUEUE_MAX_SIZE = 128 * KILOBYTE;
     static const size_t WRITE_CHUNK_SIZE = 8 * KILOBYTE;
@@ -342,6 +371,14 @@ private:
         void *buffer, size_t size
     ) THROWS_ONLY(tcp_conn_read_closed_exc_t);
 
+    /* Like `read_internal()`, but once `buffer` is full the same call goes on to fill
+    up to `overflow_size` bytes of `overflow`, using `readv()`. The return value
+    counts the bytes in both. Implementations that can't scatter may ignore
+    `overflow`. */
+    virtual size_t read_internal_scatter(
+        void *buffer, size_t size, void *overflow, size_t overflow_size
+    ) THROWS_ONLY(tcp_conn_read_closed_exc_t);
+
     /* Used to actually perform a write. If the write end of the connection is open, then
     writes `size` bytes from `buffer` to the socket. */
     virtual void perform_write(const void *buffer, size_t size);
@@ -405,6 +442,11 @@ private:
     virtual size_t read_internal(void *buffer, size_t size) THROWS_ONLY(
         tcp_conn_read_closed_exc_t);
 
+    /* `SSL_read()` has no scatter variant, so this only fills `buffer`. */
+    virtual size_t read_internal_scatter(
+        void *buffer, size_t size, void *overflow, size_t overflow_size
+    ) THROWS_ONLY(tcp_conn_read_closed_exc_t);
+
     /* Used to actually perform a write. If the write end of the connection is open, then
     writes `size` bytes from `buffer` to the socket. */
     virtual void perform_write(const void *buffer, size_t size);
@@ -105,6 +105,19 @@ enum class file_direct_io_mode_t {
     buffered_desired
 };
 
+// What the requests of an I/O account are for.  The disk scheduler gives each class
+// its own latency target and bandwidth cap (see `accounting_diskmgr_t`).
+enum class io_class_t {
+    foreground_read,
+    flush,
+    backfill,
+    gc,
+    sindex_build,
+    prefetch
+};
+
+static const size_t NUM_IO_CLASSES = static_cast<size_t>(io_class_t::prefetch) + 1;
+
 // A linux file.  It expects reads and writes and buffers to have an
 // alignment of DEVICE_BLOCK_SIZE.
 class file_t {
@@ -127,7 +140,7 @@ public:
     virtual void writev_async(int64_t offset, size_t length, scoped_array_t<iovec> &&bufs,
                               file_account_t *account, linux_iocallback_t *cb) = 0;
 
-    virtual void *create_account(int priority, int outstanding_requests_limit) = 0;
+    virtual void *create_account(io_class_t io_class, int outstanding_requests_limit) = 0;
     virtual void destroy_account(void *account) = 0;
 
     virtual bool coop_lock_and_check() = 0;
@@ -138,7 +151,8 @@ private:
 
 class file_account_t {
 public:
-    file_account_t(file_t *f, int p, int outstanding_requests_limit = UNLIMITED_OUTSTANDING_REQUESTS);
+    file_account_t(file_t *f, io_class_t io_class,
+                   int outstanding_requests_limit = UNLIMITED_OUTSTANDING_REQUESTS);
     ~file_account_t();
     void *get_account() { return account; }
 
@@ -110,6 +110,10 @@ public:
         return cb_->get_trace();
     }
 
+    virtual bool should_read_ahead() THROWS_NOTHING {
+        return cb_->should_read_ahead();
+    }
+
 private:
     friend class concurrent_traversal_fifo_enforcer_signal_t;
 
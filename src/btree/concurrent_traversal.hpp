@@ -56,6 +56,9 @@ public:
 
     virtual profile::trace_t *get_trace() THROWS_NOTHING { return nullptr; }
 
+    /* See `depth_first_traversal_callback_t::should_read_ahead()`. */
+    virtual bool should_read_ahead() THROWS_NOTHING { return false; }
+
 protected:
     virtual ~concurrent_traversal_callback_t() { }
 private:
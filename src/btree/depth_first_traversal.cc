@@ -1,6 +1,8 @@
 // Copyright 2010-2014 RethinkDB, all rights reserved.
 #include "btree/depth_first_traversal.hpp"
 
+#include <algorithm>
+
 #include "btree/internal_node.hpp"
 #include "btree/operations.hpp"
 #include "concurrency/interruptor.hpp"
@@ -35,8 +37,25 @@ void scoped_key_value_t::reset() {
 }
 
 
+/* The longest a traversal reads ahead among the children of an internal node. */
+static const int max_read_ahead_depth = 16;
+
+/* How far ahead a traversal loads the children of the internal nodes it visits. The
+depth grows by one with every leaf that the traversal has finished, so that short range
+reads don't load blocks they won't use, while long scans keep enough reads in flight
+to make use of the disk. */
+class read_ahead_state_t {
+public:
+    read_ahead_state_t() : depth(0), last_node_was_leaf(false) { }
+    int depth;
+    // Whether the last node that the traversal finished was a leaf, which tells an
+    // internal node whether its children are leaves.
+    bool last_node_was_leaf;
+};
+
 /* Returns `true` if we reached the end of the subtree or range, and `false` if
-`cb->handle_value()` returned `false`. */
+`cb->handle_value()` returned `false`. `read_ahead` is null if the traversal doesn't
+read ahead. */
 continue_bool_t btree_depth_first_traversal(
         counted_t<counted_buf_lock_and_read_t> block,
         const key_range_t &range,
@@ -45,6 +64,7 @@ continue_bool_t btree_depth_first_traversal(
         direction_t direction,
         const btree_key_t *left_excl_or_null,
         const btree_key_t *right_incl,
+        read_ahead_state_t *read_ahead,
         signal_t *interruptor);
 
 continue_bool_t btree_depth_first_traversal(
@@ -103,9 +123,12 @@ continue_bool_t btree_depth_first_traversal(
             wait_interruptible(root_block->lock.read_acq_signal(), interruptor);
         }
 
+        read_ahead_state_t read_ahead;
         return btree_depth_first_traversal(
             std::move(root_block), range, cb, access, direction,
-            left_excl_or_null, right_incl_buf.btree_key(), interruptor);
+            left_excl_or_null, right_incl_buf.btree_key(),
+            access == access_t::read && cb->should_read_ahead() ? &read_ahead : nullptr,
+            interruptor);
     }
 }
 
@@ -153,6 +176,7 @@ continue_bool_t btree_depth_first_traversal(
         direction_t direction,
         const btree_key_t *left_excl_or_null,
         const btree_key_t *right_incl,
+        read_ahead_state_t *read_ahead,
         signal_t *interruptor) {
     bool skip;
     if (continue_bool_t::ABORT == cb->filter_range_ts(
@@ -180,10 +204,33 @@ continue_bool_t btree_depth_first_traversal(
             r.decrement();
             end_index = internal_node::get_offset_index(inode, r.btree_key()) + 1;
         }
+        // We don't know if the children are leaves until we have visited one.
+        bool children_are_leaves = false;
+        // The children before `read_ahead_end` (counted from `start_index`, like `i`)
+        // have been read ahead or visited already.
+        int read_ahead_end = 0;
         for (int i = 0; i < end_index - start_index; ++i) {
             int true_index = (direction == FORWARD ? start_index + i : (end_index - 1) - i);
             const btree_internal_pair *pair = internal_node::get_pair_by_index(inode, true_index);
 
+            if (read_ahead != nullptr) {
+                // Internal nodes cover many leaves, so we don't read ahead more than
+                // one of them.
+                int depth = children_are_leaves
+                    ? read_ahead->depth
+                    : std::min(read_ahead->depth, 1);
+                int end = std::min(end_index - start_index, i + 1 + depth);
+                for (read_ahead_end = std::max(read_ahead_end, i + 1);
+                     read_ahead_end < end;
+                     ++read_ahead_end) {
+                    int ahead_index = (direction == FORWARD
+                                       ? start_index + read_ahead_end
+                                       : (end_index - 1) - read_ahead_end);
+                    block->lock.read_ahead_child(
+                        internal_node::get_pair_by_index(inode, ahead_index)->lnode);
+                }
+            }
+
             // Get the child key range
             const btree_key_t *child_left_excl_or_null;
             const btree_key_t *child_right_incl;
@@ -208,11 +255,18 @@ continue_bool_t btree_depth_first_traversal(
                 }
                 if (continue_bool_t::ABORT == btree_depth_first_traversal(
                         std::move(lock), range, cb, access, direction,
-                        child_left_excl_or_null, child_right_incl, interruptor)) {
+                        child_left_excl_or_null, child_right_incl, read_ahead,
+                        interruptor)) {
                     return continue_bool_t::ABORT;
                 }
+                if (read_ahead != nullptr) {
+                    children_are_leaves = read_ahead->last_node_was_leaf;
+                }
             }
         }
+        if (read_ahead != nullptr) {
+            read_ahead->last_node_was_leaf = false;
+        }
         return continue_bool_t::CONTINUE;
     } else {
         if (continue_bool_t::ABORT == cb->handle_pre_leaf(
@@ -267,6 +321,10 @@ continue_bool_t btree_depth_first_traversal(
                 }
             }
         }
+        if (read_ahead != nullptr) {
+            read_ahead->depth = std::min(read_ahead->depth + 1, max_read_ahead_depth);
+            read_ahead->last_node_was_leaf = true;
+        }
         return continue_bool_t::CONTINUE;
     }
 }
@@ -127,6 +127,13 @@ public:
     cover the full range of the traversal. */
 
     virtual profile::trace_t *get_trace() THROWS_NOTHING { return nullptr; }
+
+    /* If this returns `true`, a read traversal loads the next few children of an
+    internal node into the cache while it works on the current one. That only pays off
+    if the traversal is going to visit those children, so it's off by default and
+    should stay off for callbacks that skip most of the tree in `filter_range()` or
+    `filter_range_ts()`. */
+    virtual bool should_read_ahead() THROWS_NOTHING { return false; }
 protected:
     virtual ~depth_first_traversal_callback_t() { }
 };
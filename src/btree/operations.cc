@@ -552,6 +552,39 @@ void find_keyvalue_location_for_read(
     }
 }
 
+void warm_keyvalue_location(
+        superblock_t *superblock,
+        const btree_key_t *key) {
+    const block_id_t root_id = superblock->get_root_block_id();
+    rassert(root_id != SUPERBLOCK_ID);
+
+    if (root_id == NULL_BLOCK_ID) {
+        superblock->release();
+        return;
+    }
+
+    buf_lock_t buf(superblock->expose_buf(), root_id, access_t::read);
+    superblock->release();
+
+    for (;;) {
+        block_id_t node_id;
+        {
+            buf_read_t read(&buf);
+            const void *data = read.get_data_read();
+            if (!node::is_internal(static_cast<const node_t *>(data))) {
+                return;
+            }
+            node_id = internal_node::lookup(static_cast<const internal_node_t *>(data),
+                                            key);
+        }
+        rassert(node_id != NULL_BLOCK_ID && node_id != SUPERBLOCK_ID);
+
+        buf_lock_t tmp(&buf, node_id, access_t::read);
+        buf.reset_buf_lock();
+        buf = std::move(tmp);
+    }
+}
+
 void apply_keyvalue_change(
         value_sizer_t *sizer,
         keyvalue_location_t *kv_loc,
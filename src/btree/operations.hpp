@@ -213,6 +213,14 @@ void find_keyvalue_location_for_read(
         btree_stats_t *stats,
         profile::trace_t *trace);
 
+/* Loads the nodes on the path from the root to the leaf that would contain `key` into
+the cache, without looking at the leaf's contents. Releases `superblock`. Unlike
+`find_keyvalue_location_for_read()`, this doesn't count as a key read in the B-tree
+stats; it's used to warm up the cache. */
+void warm_keyvalue_location(
+        superblock_t *superblock,
+        const btree_key_t *key);
+
 /* `delete_mode_t` controls how `apply_keyvalue_change()` acts when `kv_loc->value` is
 empty. */
 enum class delete_mode_t {
@@ -111,8 +111,13 @@ cache_t::~cache_t() {
     guarantee(snapshot_nodes_by_block_id_.empty());
 }
 
-cache_account_t cache_t::create_cache_account(int priority) {
-    return page_cache_.create_cache_account(priority);
+cache_account_t cache_t::create_cache_account(io_class_t io_class, int priority) {
+    return page_cache_.create_cache_account(io_class, priority);
+}
+
+void cache_t::set_policy(const cache_policy_t &policy) {
+    assert_thread();
+    page_cache_.evicter().set_policy(policy);
 }
 
 alt_snapshot_node_t *
@@ -731,6 +736,34 @@ void buf_lock_t::detach_child(block_id_t child_id) {
             child_id);
 }
 
+void buf_lock_t::read_ahead_child(block_id_t child_id) {
+    ASSERT_FINITE_CORO_WAITING;
+    guarantee(!empty());
+    if (snapshot_node_ != nullptr
+        && snapshot_node_->children_.find(child_id) != snapshot_node_->children_.end()) {
+        // The snapshot keeps the version of the child that we'd acquire.
+        return;
+    }
+    cache()->page_cache_.read_ahead_block(child_id, txn_->account());
+}
+
+void buf_lock_t::read_ahead_children(const block_id_t *child_ids, size_t count) {
+    ASSERT_FINITE_CORO_WAITING;
+    guarantee(!empty());
+    std::vector<block_id_t> block_ids;
+    block_ids.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (snapshot_node_ != nullptr
+            && snapshot_node_->children_.find(child_ids[i])
+               != snapshot_node_->children_.end()) {
+            // The snapshot keeps the version of the child that we'd acquire.
+            continue;
+        }
+        block_ids.push_back(child_ids[i]);
+    }
+    cache()->page_cache_.read_ahead_blocks(block_ids, txn_->account());
+}
+
 repli_timestamp_t buf_lock_t::get_recency() const {
     guarantee(!empty());
     current_page_acq_t *cpa = current_page_acq();
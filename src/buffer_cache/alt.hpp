@@ -6,6 +6,7 @@
 #include <vector>
 #include <utility>
 
+#include "arch/types.hpp"
 #include "buffer_cache/page_cache.hpp"
 #include "buffer_cache/types.hpp"
 #include "containers/two_level_array.hpp"
@@ -53,7 +54,12 @@ public:
     // throttling systems.  TODO: Come up with a consistent priority scheme,
     // i.e. define a "default" priority etc.  TODO: As soon as we can support it, we
     // might consider supporting a mem_cap paremeter.
-    cache_account_t create_cache_account(int priority);
+    // The I/O class decides how the disk scheduler treats the account's reads; the
+    // priority limits how many of them can be outstanding at once.
+    cache_account_t create_cache_account(io_class_t io_class, int priority);
+
+    // Tells the cache balancer how to treat this cache.
+    void set_policy(const cache_policy_t &policy);
 
 private:
     friend class txn_t;
@@ -201,6 +207,13 @@ public:
 
     void detach_child(block_id_t child_id);
 
+    // Starts loading the child block into the cache without acquiring it, for a
+    // traversal that is going to acquire it soon.  The lock must be acquired for read.
+    void read_ahead_child(block_id_t child_id);
+    // Like read_ahead_child, for several children, which get read from disk together
+    // where they're close to each other on disk.
+    void read_ahead_children(const block_id_t *child_ids, size_t count);
+
     block_id_t block_id() const {
         guarantee(txn_ != nullptr);
         return current_page_acq()->block_id();
@@ -303,6 +316,14 @@ public:
         }
     }
 
+    // Starts loading the children into the cache, for a caller that is going to
+    // acquire them for read soon.  Does nothing if the parent is just a txn_t.
+    void read_ahead_children(const block_id_t *child_ids, size_t count) {
+        if (lock_or_null_ != nullptr) {
+            lock_or_null_->read_ahead_children(child_ids, count);
+        }
+    }
+
     bool empty() const {
         return txn_ == nullptr;
     }
@@ -420,6 +420,13 @@ make_tree_from_block_ids(buf_parent_t parent, access_t mode, int levels,
     compute_acquisition_offsets(parent.cache()->max_block_size(), levels, offset,
                                 size, &filler.lo, &filler.hi);
 
+    if (mode == access_t::read && levels == 1 && filler.hi - filler.lo > 1) {
+        // Only BLOB_TRAVERSAL_CONCURRENCY leaves get acquired at a time.  Loading all
+        // of them in one batch lets the serializer read leaves that were written next
+        // to each other (as the leaves of a value usually are) with one disk read.
+        parent.read_ahead_children(block_ids + filler.lo, filler.hi - filler.lo);
+    }
+
     filler.nodes = new temporary_acq_tree_node_t[filler.hi - filler.lo];
 
     throttled_pmap(filler.hi - filler.lo, filler, choose_concurrency(levels));
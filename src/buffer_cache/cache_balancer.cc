@@ -1,5 +1,6 @@
 #include "buffer_cache/cache_balancer.hpp"
 
+#include <algorithm>
 #include <limits>
 
 #include "buffer_cache/evicter.hpp"
@@ -12,16 +13,31 @@ const uint64_t alt_cache_balancer_t::rebalance_timeout_ms = 500;
 
 const double alt_cache_balancer_t::read_ahead_proportion = 0.9;
 
+const uint64_t alt_cache_balancer_t::compressed_min_lookups = 64;
+const double alt_cache_balancer_t::compressed_grow_hit_rate = 0.25;
+const double alt_cache_balancer_t::compressed_shrink_hit_rate = 0.05;
+const int alt_cache_balancer_t::compressed_fraction_steps = 8;
+
 alt_cache_balancer_t::cache_data_t::cache_data_t(alt::evicter_t *_evicter) :
     evicter(_evicter),
     new_size(0),
     old_size(evicter->memory_limit()),
     bytes_loaded(evicter->get_bytes_loaded()),
-    access_count(evicter->access_count()) { }
+    access_count(evicter->access_count()),
+    old_compressed_fraction(evicter->compressed_fraction()),
+    new_compressed_fraction(old_compressed_fraction),
+    compressed_hits(evicter->compressed_hits()),
+    compressed_misses(evicter->compressed_misses()),
+    policy(evicter->policy()),
+    in_memory_size(evicter->in_memory_size()),
+    floor(0),
+    keep_pinned_pages(false) { }
 
 alt_cache_balancer_t::alt_cache_balancer_t(
-        clone_ptr_t<watchable_t<uint64_t> > _total_cache_size_watchable) :
+        clone_ptr_t<watchable_t<uint64_t> > _total_cache_size_watchable,
+        double _max_compressed_fraction) :
     total_cache_size_watchable(_total_cache_size_watchable),
+    max_compressed_fraction(_max_compressed_fraction),
     rebalance_timer(make_scoped<repeating_timer_t>(rebalance_check_interval_ms, this)),
     rebalance_timer_state(rebalance_timer_state_t::normal),
     last_rebalance_time(0),
@@ -68,6 +84,34 @@ void alt_cache_balancer_t::wake_up_activity_happened() {
     }
 }
 
+void alt_cache_balancer_t::compute_compressed_fraction(cache_data_t *data) const {
+    const uint64_t lookups = data->compressed_hits + data->compressed_misses;
+    if (max_compressed_fraction == 0 || lookups < compressed_min_lookups) {
+        data->compressed_hits = 0;
+        data->compressed_misses = 0;
+        return;
+    }
+
+    // Pages only get into the pool when they're evicted, so a pool that rarely
+    // has the pages that get loaded is memory better spent on uncompressed pages.
+    const double step = max_compressed_fraction / compressed_fraction_steps;
+    const double hit_rate = static_cast<double>(data->compressed_hits) / lookups;
+    double fraction = data->old_compressed_fraction;
+    if (hit_rate > compressed_grow_hit_rate) {
+        fraction += step;
+    } else if (hit_rate < compressed_shrink_hit_rate) {
+        fraction -= step;
+    }
+    data->new_compressed_fraction
+        = std::min(max_compressed_fraction, std::max(step, fraction));
+}
+
+bool alt_cache_balancer_t::can_adjust_size(const cache_data_t &data,
+                                           int64_t extra_bytes) {
+    return !data.policy.pinned
+        && (extra_bytes > 0 || data.new_size > data.floor);
+}
+
 void alt_cache_balancer_t::add_evicter(alt::evicter_t *evicter) {
     evicter->assert_thread();
     auto res = per_thread_data[get_thread_id().threadnum].evicters.insert(evicter);
@@ -148,48 +192,120 @@ void alt_cache_balancer_t::rebalance_blocking(UNUSED signal_t *interruptor) {
 
     // Calculate new cache sizes
     if (total_evicters > 0) {
-        uint64_t total_new_sizes = 0;
-
+        // Reservations and the memory that pinned caches hold are guaranteed, but
+        // only up to the total cache size.  If they add up to more than that, each
+        // cache gets the same fraction of what it asked for, and pinned caches evict
+        // pages like any other cache until they fit.
+        uint64_t total_guaranteed = 0;
+        for (size_t i = 0; i < cache_data.size(); ++i) {
+            for (size_t j = 0; j < cache_data[i].size(); ++j) {
+                const cache_data_t &data = cache_data[i][j];
+                total_guaranteed += data.policy.pinned
+                    ? std::max(data.policy.reserved_bytes, data.in_memory_size)
+                    : data.policy.reserved_bytes;
+            }
+        }
+        const bool guarantees_fit = total_guaranteed <= total_cache_size;
         for (size_t i = 0; i < cache_data.size(); ++i) {
             for (size_t j = 0; j < cache_data[i].size(); ++j) {
                 cache_data_t *data = &cache_data[i][j];
+                data->floor = data->policy.pinned
+                    ? std::max(data->policy.reserved_bytes, data->in_memory_size)
+                    : data->policy.reserved_bytes;
+                if (!guarantees_fit) {
+                    data->floor = static_cast<uint64_t>(
+                        static_cast<double>(data->floor)
+                        * static_cast<double>(total_cache_size)
+                        / static_cast<double>(total_guaranteed));
+                }
+                data->keep_pinned_pages = data->policy.pinned && guarantees_fit;
+            }
+        }
 
-                if (total_cache_size > 0) {
-                    double temp = data->old_size;
-                    temp /= static_cast<double>(total_cache_size);
-                    temp *= static_cast<double>(total_bytes_loaded);
+        // Caches grow by their priority-weighted demand, and pay for it in
+        // proportion to their size divided by their priority.  With equal
+        // priorities, caches give up memory in proportion to their size.
+        double weighted_demand = 0;
+        double weighted_size = 0;
+        for (size_t i = 0; i < cache_data.size(); ++i) {
+            for (size_t j = 0; j < cache_data[i].size(); ++j) {
+                const cache_data_t &data = cache_data[i][j];
+                if (!data.policy.pinned) {
+                    weighted_demand += data.policy.priority
+                        * static_cast<double>(std::max<int64_t>(0, data.bytes_loaded));
+                    weighted_size += data.old_size / data.policy.priority;
+                }
+            }
+        }
 
-                    int64_t new_size = std::max<int64_t>(0, data->bytes_loaded);
+        uint64_t total_new_sizes = 0;
+        for (size_t i = 0; i < cache_data.size(); ++i) {
+            for (size_t j = 0; j < cache_data[i].size(); ++j) {
+                cache_data_t *data = &cache_data[i][j];
+                compute_compressed_fraction(data);
+
+                if (data->policy.pinned) {
+                    // Pinned caches get what they're using, as far as that fits.
+                    data->new_size = data->floor;
+                } else if (total_cache_size > 0) {
+                    double temp = 0;
+                    if (weighted_size > 0) {
+                        temp = data->old_size / data->policy.priority;
+                        temp /= weighted_size;
+                        temp *= weighted_demand;
+                    }
+
+                    int64_t new_size = static_cast<int64_t>(
+                        data->policy.priority
+                        * static_cast<double>(std::max<int64_t>(0, data->bytes_loaded)));
                     new_size -= static_cast<int64_t>(temp);
                     new_size += data->old_size;
                     new_size = std::max<int64_t>(new_size, 0);
 
                     data->new_size = new_size;
-                    total_new_sizes += new_size;
                 } else {
                     data->new_size = 0;
                 }
+                data->new_size = std::max(data->new_size, data->floor);
+                total_new_sizes += data->new_size;
             }
         }
 
-        // Distribute any rounding error across shards
+        // Distribute any rounding error, and the memory that went to pinned caches
+        // and reservations, across the shards that can take or give it
         int64_t extra_bytes = total_cache_size - total_new_sizes;
         while (extra_bytes != 0) {
-            int64_t delta = extra_bytes / static_cast<int64_t>(total_evicters);
+            int64_t adjustable = 0;
+            for (size_t i = 0; i < cache_data.size(); ++i) {
+                for (size_t j = 0; j < cache_data[i].size(); ++j) {
+                    adjustable += can_adjust_size(cache_data[i][j], extra_bytes) ? 1 : 0;
+                }
+            }
+            if (adjustable == 0) {
+                // Every cache is pinned or at its floor.  Since the floors fit into
+                // the total cache size, this only leaves memory unused.
+                break;
+            }
+
+            int64_t delta = extra_bytes / adjustable;
             if (delta == 0) {
                 delta = ((extra_bytes < 0) ? -1 : 1);
             }
             for (size_t i = 0; i < cache_data.size() && extra_bytes != 0; ++i) {
                 for (size_t j = 0; j < cache_data[i].size() && extra_bytes != 0; ++j) {
                     cache_data_t *data = &cache_data[i][j];
+                    if (!can_adjust_size(*data, extra_bytes)) {
+                        continue;
+                    }
 
-                    // Avoid underflow
-                    if (static_cast<int64_t>(data->new_size) + delta >= 0) {
+                    // Avoid going below the reservation
+                    const int64_t floor = data->floor;
+                    if (static_cast<int64_t>(data->new_size) + delta >= floor) {
                         data->new_size += delta;
                         extra_bytes -= delta;
                     } else {
-                        extra_bytes += data->new_size;
-                        data->new_size = 0;
+                        extra_bytes += data->new_size - floor;
+                        data->new_size = floor;
                     }
                 }
             }
@@ -251,6 +367,10 @@ void alt_cache_balancer_t::apply_rebalance_to_thread(int index,
             it->evicter->update_memory_limit(it->new_size,
                                              it->bytes_loaded,
                                              it->access_count,
+                                             it->new_compressed_fraction,
+                                             it->compressed_hits,
+                                             it->compressed_misses,
+                                             it->keep_pinned_pages,
                                              new_read_ahead_ok);
         }
     }
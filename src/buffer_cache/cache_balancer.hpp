@@ -8,6 +8,8 @@
 #include "errors.hpp"
 #include "time.hpp"
 
+#include "buffer_cache/types.hpp"
+
 #include "threading.hpp"
 #include "arch/timing.hpp"
 #include "concurrency/pump_coro.hpp"
@@ -30,6 +32,9 @@ public:
     // Tells caches whether to start read ahead initially
     virtual bool read_ahead_ok_at_start() const = 0;
 
+    // The share of a cache's memory that initially goes to its compressed page pool
+    virtual double base_compressed_fraction() const = 0;
+
     // Returns a pointer to a boolean for the given thread number (which must be the
     // current thread) which, when set to true, means you should notify the balancer
     // that it should wake up.  Stuff outside the balancer should only set it from
@@ -52,11 +57,14 @@ protected:
     DISABLE_COPYING(cache_balancer_t);
 };
 
-// Dummy balancer that does nothing but provide the initial size of a cache
+// Dummy balancer that does nothing but provide the initial size of a cache, and
+// the share of it that goes to the compressed page pool
 class dummy_cache_balancer_t final : public cache_balancer_t {
 public:
-    explicit dummy_cache_balancer_t(uint64_t _base_mem_per_store)
+    explicit dummy_cache_balancer_t(uint64_t _base_mem_per_store,
+                                    double _compressed_fraction = 0)
         : base_mem_per_store_(_base_mem_per_store),
+          compressed_fraction_(_compressed_fraction),
           notify_activity_boolean_(false) { }
     ~dummy_cache_balancer_t() { }
 
@@ -68,6 +76,10 @@ public:
         return false;
     }
 
+    double base_compressed_fraction() const final {
+        return compressed_fraction_;
+    }
+
     bool *notify_activity_boolean(threadnum_t) final {
         return &notify_activity_boolean_;
     }
@@ -79,6 +91,7 @@ private:
     void remove_evicter(alt::evicter_t *) { }
 
     uint64_t base_mem_per_store_;
+    double compressed_fraction_;
 
     bool notify_activity_boolean_;
 
@@ -89,8 +102,11 @@ class alt_cache_balancer_t final :
     public cache_balancer_t,
     public repeating_timer_callback_t {
 public:
-    explicit alt_cache_balancer_t(
-        clone_ptr_t<watchable_t<uint64_t> > _total_cache_size_watchable);
+    // Up to `_max_compressed_fraction` of each cache's memory may be used to keep
+    // evicted pages compressed; zero disables the compressed page pools.
+    alt_cache_balancer_t(
+        clone_ptr_t<watchable_t<uint64_t> > _total_cache_size_watchable,
+        double _max_compressed_fraction);
     ~alt_cache_balancer_t();
 
     uint64_t base_mem_per_store() const final {
@@ -101,6 +117,10 @@ public:
         return true;
     }
 
+    double base_compressed_fraction() const final {
+        return max_compressed_fraction / 2;
+    }
+
     bool *notify_activity_boolean(threadnum_t thread) final;
 
     void wake_up_activity_happened() final;
@@ -120,6 +140,14 @@ private:
     static const uint64_t read_ahead_ratio_numerator;
     static const uint64_t read_ahead_ratio_denominator;
 
+    // Constants that control how the compressed page pools are resized: a pool grows
+    // while more than `compressed_grow_hit_rate` of the lookups in it hit, and
+    // shrinks while fewer than `compressed_shrink_hit_rate` do.
+    static const uint64_t compressed_min_lookups;
+    static const double compressed_grow_hit_rate;
+    static const double compressed_shrink_hit_rate;
+    static const int compressed_fraction_steps;
+
     // Called by the evicter on the evicter's thread
     void add_evicter(alt::evicter_t *evicter);
     void remove_evicter(alt::evicter_t *evicter);
@@ -142,8 +170,26 @@ private:
         uint64_t old_size;
         int64_t bytes_loaded;
         uint64_t access_count;
+        double old_compressed_fraction;
+        double new_compressed_fraction;
+        uint64_t compressed_hits;
+        uint64_t compressed_misses;
+        cache_policy_t policy;
+        uint64_t in_memory_size;
+        // The size the cache doesn't go below: its reservation, or what it holds if
+        // it's pinned, scaled down if all of them don't fit into the total size.
+        uint64_t floor;
+        bool keep_pinned_pages;
     };
 
+    // True if the balancer may move `extra_bytes` (or part of them) into or out of
+    // the cache
+    static bool can_adjust_size(const cache_data_t &data, int64_t extra_bytes);
+
+    // Sets the cache's new compressed fraction from its pool's hit rate.  Lookups
+    // that weren't enough to judge the hit rate are left for the next rebalance.
+    void compute_compressed_fraction(cache_data_t *data) const;
+
     // Helper function to collect stats from each thread so we don't need
     //  atomic variables slowing down normal operations
     void collect_stats_from_thread(int index,
@@ -155,6 +201,7 @@ private:
                                    bool new_read_ahead_ok);
 
     clone_ptr_t<watchable_t<uint64_t> > total_cache_size_watchable;
+    const double max_compressed_fraction;
     scoped_ptr_t<repeating_timer_t> rebalance_timer;
     enum class rebalance_timer_state_t {
         // Normal operating condition: there is a timer, and it'll ping soon.  Can
@@ -0,0 +1,118 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "buffer_cache/compressed_page_pool.hpp"
+
+#include <string.h>
+#include <zlib.h>
+
+namespace alt {
+
+// A block is only worth keeping compressed if it shrinks to this fraction of its
+// size or less.
+static const double MAX_COMPRESSED_PAGE_RATIO = 0.75;
+
+compressed_page_pool_t::compressed_page_pool_t()
+    : memory_limit_(0),
+      memory_usage_(0),
+      uncompressed_size_(0),
+      compressed_size_(0) { }
+
+compressed_page_pool_t::~compressed_page_pool_t() {
+    while (entry_t *entry = insertion_order_.head()) {
+        remove_entry(entry);
+    }
+}
+
+uint64_t compressed_page_pool_t::entry_memory_usage(const entry_t *entry) {
+    // The constant accounts for the hash table node.
+    return sizeof(entry_t) + 4 * sizeof(void *) + entry->data.size();
+}
+
+void compressed_page_pool_t::insert(block_id_t block_id,
+                                    const counted_t<standard_block_token_t> &token,
+                                    const buf_ptr_t &buf) {
+    remove(block_id);
+    if (memory_limit_ == 0) {
+        return;
+    }
+
+    const uint32_t size = buf.block_size().ser_value();
+    uLongf compressed_size = compressBound(size);
+    scoped_array_t<char> compressed(compressed_size);
+    int res = compress2(reinterpret_cast<Bytef *>(compressed.data()), &compressed_size,
+                        reinterpret_cast<const Bytef *>(buf.ser_buffer()), size,
+                        Z_BEST_SPEED);
+    guarantee(res == Z_OK, "compress2 failed: %d", res);
+    if (compressed_size > size * MAX_COMPRESSED_PAGE_RATIO) {
+        return;
+    }
+
+    scoped_array_t<char> data(compressed_size);
+    memcpy(data.data(), compressed.data(), compressed_size);
+    entry_t *entry = new entry_t(block_id, token, buf.block_size(), std::move(data));
+
+    entries_.insert(std::make_pair(block_id, entry));
+    insertion_order_.push_back(entry);
+    memory_usage_ += entry_memory_usage(entry);
+    uncompressed_size_ += size;
+    compressed_size_ += compressed_size;
+    evict_if_necessary();
+}
+
+bool compressed_page_pool_t::take(
+        block_id_t block_id,
+        const counted_t<standard_block_token_t> &expected_token,
+        counted_t<standard_block_token_t> *token_out,
+        buf_ptr_t *buf_out) {
+    auto it = entries_.find(block_id);
+    if (it == entries_.end()) {
+        return false;
+    }
+    entry_t *entry = it->second;
+    if (expected_token.has() && expected_token.get() != entry->token.get()) {
+        return false;
+    }
+
+    buf_ptr_t buf = buf_ptr_t::alloc_uninitialized(entry->block_size);
+    uLongf size = entry->block_size.ser_value();
+    int res = uncompress(reinterpret_cast<Bytef *>(buf.ser_buffer()), &size,
+                         reinterpret_cast<const Bytef *>(entry->data.data()),
+                         entry->data.size());
+    guarantee(res == Z_OK && size == entry->block_size.ser_value(),
+              "uncompress failed: %d", res);
+
+    *token_out = std::move(entry->token);
+    *buf_out = std::move(buf);
+    remove_entry(entry);
+    return true;
+}
+
+void compressed_page_pool_t::remove(block_id_t block_id) {
+    auto it = entries_.find(block_id);
+    if (it != entries_.end()) {
+        remove_entry(it->second);
+    }
+}
+
+void compressed_page_pool_t::set_memory_limit(uint64_t memory_limit) {
+    memory_limit_ = memory_limit;
+    evict_if_necessary();
+}
+
+void compressed_page_pool_t::remove_entry(entry_t *entry) {
+    memory_usage_ -= entry_memory_usage(entry);
+    uncompressed_size_ -= entry->block_size.ser_value();
+    compressed_size_ -= entry->data.size();
+    insertion_order_.remove(entry);
+    entries_.erase(entry->block_id);
+    delete entry;
+}
+
+void compressed_page_pool_t::evict_if_necessary() {
+    while (memory_usage_ > memory_limit_) {
+        entry_t *oldest = insertion_order_.head();
+        rassert(oldest != nullptr);
+        remove_entry(oldest);
+    }
+}
+
+}  // namespace alt
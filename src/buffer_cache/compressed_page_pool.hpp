@@ -0,0 +1,87 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef BUFFER_CACHE_COMPRESSED_PAGE_POOL_HPP_
+#define BUFFER_CACHE_COMPRESSED_PAGE_POOL_HPP_
+
+#include <stdint.h>
+
+#include <unordered_map>
+
+#include "containers/counted.hpp"
+#include "containers/intrusive_list.hpp"
+#include "containers/scoped.hpp"
+#include "serializer/buf_ptr.hpp"
+#include "serializer/types.hpp"
+
+namespace alt {
+
+// Holds compressed copies of clean pages that the evicter has evicted, so that
+// loading them again doesn't take a disk read.  The pool only ever holds the current
+// version of a block, along with its block token: the page cache removes a block
+// from the pool as soon as the block gets modified or deleted.  When the pool runs
+// out of memory, it drops the blocks that were put into it longest ago.
+class compressed_page_pool_t {
+public:
+    compressed_page_pool_t();
+    ~compressed_page_pool_t();
+
+    // Compresses and stores the block, replacing what the pool had for it.  Blocks
+    // that don't compress well enough to be worth the CPU time aren't stored.
+    void insert(block_id_t block_id,
+                const counted_t<standard_block_token_t> &token,
+                const buf_ptr_t &buf);
+
+    // Removes the block from the pool, returning its token and its uncompressed
+    // contents.  Returns false if the pool doesn't have the block, or if
+    // `expected_token` is non-empty and the pool has a different version of it.
+    bool take(block_id_t block_id,
+              const counted_t<standard_block_token_t> &expected_token,
+              counted_t<standard_block_token_t> *token_out,
+              buf_ptr_t *buf_out);
+
+    void remove(block_id_t block_id);
+
+    void set_memory_limit(uint64_t memory_limit);
+    uint64_t memory_limit() const { return memory_limit_; }
+
+    // The memory used by the stored blocks, including bookkeeping.
+    uint64_t memory_usage() const { return memory_usage_; }
+
+    // The sizes of the stored blocks before and after compression.
+    uint64_t uncompressed_size() const { return uncompressed_size_; }
+    uint64_t compressed_size() const { return compressed_size_; }
+
+private:
+    struct entry_t : public intrusive_list_node_t<entry_t> {
+        entry_t(block_id_t _block_id,
+                const counted_t<standard_block_token_t> &_token,
+                block_size_t _block_size,
+                scoped_array_t<char> &&_data)
+            : block_id(_block_id), token(_token), block_size(_block_size),
+              data(std::move(_data)) { }
+
+        block_id_t block_id;
+        counted_t<standard_block_token_t> token;
+        block_size_t block_size;
+        scoped_array_t<char> data;
+    };
+
+    static uint64_t entry_memory_usage(const entry_t *entry);
+
+    void remove_entry(entry_t *entry);
+    void evict_if_necessary();
+
+    uint64_t memory_limit_;
+    uint64_t memory_usage_;
+    uint64_t uncompressed_size_;
+    uint64_t compressed_size_;
+
+    std::unordered_map<block_id_t, entry_t *> entries_;
+    // Ordered from the least to the most recently inserted entry.
+    intrusive_list_t<entry_t> insertion_order_;
+
+    DISABLE_COPYING(compressed_page_pool_t);
+};
+
+}  // namespace alt
+
+#endif  // BUFFER_CACHE_COMPRESSED_PAGE_POOL_HPP_
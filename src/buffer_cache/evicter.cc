@@ -17,6 +17,12 @@ evicter_t::evicter_t()
       bytes_loaded_counter_(0),
       access_count_counter_(0),
       access_time_counter_(INITIAL_ACCESS_TIME),
+      keep_pinned_pages_(true),
+      compressed_fraction_(0),
+      compressed_hits_counter_(0),
+      compressed_misses_counter_(0),
+      total_compressed_hits_(0),
+      total_compressed_misses_(0),
       evict_if_necessary_active_(false) { }
 
 evicter_t::~evicter_t() {
@@ -36,22 +42,29 @@ void evicter_t::initialize(page_cache_t *page_cache,
     initialized_ = true;  // Can you really say this class is 'initialized_'?
     page_cache_ = page_cache;
     memory_limit_ = balancer->base_mem_per_store();
+    compressed_fraction_ = balancer->base_compressed_fraction();
+    compressed_pages_.set_memory_limit(memory_limit_ - page_memory_limit());
     page_cache_ = page_cache;
     throttler_ = throttler;
     balancer_ = balancer;
     balancer_notify_activity_boolean_
         = balancer_->notify_activity_boolean(get_thread_id());
     balancer_->add_evicter(this);
-    throttler_->inform_memory_limit_change(memory_limit_,
+    throttler_->inform_memory_limit_change(page_memory_limit(),
                                            page_cache_->max_block_size());
 }
 
 void evicter_t::update_memory_limit(uint64_t new_memory_limit,
                                     int64_t bytes_loaded_accounted_for,
                                     uint64_t access_count_accounted_for,
+                                    double compressed_fraction,
+                                    uint64_t compressed_hits_accounted_for,
+                                    uint64_t compressed_misses_accounted_for,
+                                    bool keep_pinned_pages,
                                     bool read_ahead_ok) {
     assert_thread();
     guarantee(initialized_);
+    guarantee(compressed_fraction >= 0 && compressed_fraction < 1);
 
     if (!read_ahead_ok) {
         page_cache_->have_read_ahead_cb_destroyed();
@@ -59,13 +72,90 @@ void evicter_t::update_memory_limit(uint64_t new_memory_limit,
 
     bytes_loaded_counter_ -= bytes_loaded_accounted_for;
     access_count_counter_ -= access_count_accounted_for;
+    compressed_hits_counter_ -= compressed_hits_accounted_for;
+    compressed_misses_counter_ -= compressed_misses_accounted_for;
     memory_limit_ = new_memory_limit;
+    keep_pinned_pages_ = keep_pinned_pages;
+    compressed_fraction_ = compressed_fraction;
+    compressed_pages_.set_memory_limit(memory_limit_ - page_memory_limit());
     evict_if_necessary();
 
-    throttler_->inform_memory_limit_change(memory_limit_,
+    throttler_->inform_memory_limit_change(page_memory_limit(),
                                            page_cache_->max_block_size());
 }
 
+const cache_policy_t &evicter_t::policy() const {
+    assert_thread();
+    guarantee(initialized_);
+    return policy_;
+}
+
+uint64_t evicter_t::page_memory_limit() const {
+    return memory_limit_
+        - static_cast<uint64_t>(static_cast<double>(memory_limit_)
+                                * compressed_fraction_);
+}
+
+bool evicter_t::take_compressed_page(
+        block_id_t block_id,
+        const counted_t<standard_block_token_t> &expected_token,
+        counted_t<standard_block_token_t> *token_out,
+        buf_ptr_t *buf_out) {
+    assert_thread();
+    guarantee(initialized_);
+    if (compressed_pages_.take(block_id, expected_token, token_out, buf_out)) {
+        ++compressed_hits_counter_;
+        ++total_compressed_hits_;
+        return true;
+    } else {
+        ++compressed_misses_counter_;
+        ++total_compressed_misses_;
+        return false;
+    }
+}
+
+void evicter_t::forget_compressed_page(block_id_t block_id) {
+    assert_thread();
+    guarantee(initialized_);
+    compressed_pages_.remove(block_id);
+}
+
+double evicter_t::compressed_fraction() const {
+    assert_thread();
+    guarantee(initialized_);
+    return compressed_fraction_;
+}
+
+const compressed_page_pool_t &evicter_t::compressed_pages() const {
+    assert_thread();
+    guarantee(initialized_);
+    return compressed_pages_;
+}
+
+uint64_t evicter_t::compressed_hits() const {
+    assert_thread();
+    guarantee(initialized_);
+    return compressed_hits_counter_;
+}
+
+uint64_t evicter_t::compressed_misses() const {
+    assert_thread();
+    guarantee(initialized_);
+    return compressed_misses_counter_;
+}
+
+uint64_t evicter_t::total_compressed_hits() const {
+    assert_thread();
+    guarantee(initialized_);
+    return total_compressed_hits_;
+}
+
+uint64_t evicter_t::total_compressed_misses() const {
+    assert_thread();
+    guarantee(initialized_);
+    return total_compressed_misses_;
+}
+
 int64_t evicter_t::get_bytes_loaded() const {
     assert_thread();
     guarantee(initialized_);
@@ -104,6 +194,17 @@ void evicter_t::notify_bytes_loading(int64_t in_memory_buf_change) {
     }
 }
 
+void evicter_t::set_policy(const cache_policy_t &policy) {
+    assert_thread();
+    guarantee(initialized_);
+    policy_ = policy;
+    evict_if_necessary();
+    // The balancer might be idle, but it should apply the policy now.
+    coro_t::spawn_sometime(std::bind(&wake_up_balancer,
+                                     balancer_,
+                                     drainer_.lock()));
+}
+
 void evicter_t::add_deferred_loaded(page_t *page) {
     assert_thread();
     guarantee(initialized_);
@@ -222,17 +323,28 @@ void evicter_t::evict_if_necessary() THROWS_NOTHING {
         // overflows.
         return;
     }
+    if (policy_.pinned && keep_pinned_pages_) {
+        return;
+    }
     // KSI: Implement eviction of unbacked evictables too.  When flushing, you
     // could use the page_t::eviction_index_ field to identify pages that are
     // currently in the process of being evicted, to avoid reflushing a page
     // currently being written for the purpose of eviction.
 
     evict_if_necessary_active_ = true;
+    const uint64_t limit = page_memory_limit();
     page_t *page;
-    while (in_memory_size() > memory_limit_
+    while (in_memory_size() > limit
            && evictable_disk_backed_.remove_oldish(&page, access_time_counter_,
                                                    page_cache_)) {
         evicted_.add(page, page->hypothetical_memory_usage(page_cache_));
+        // Snapshotted pages hold old versions of their blocks, which nobody is
+        // going to load again once the snapshots are gone.
+        if (compressed_pages_.memory_limit() > 0
+            && page_cache_->is_current_page(page)) {
+            compressed_pages_.insert(page->block_id(), page->block_token(),
+                                     page->loaded_buf());
+        }
         page->evict_self(page_cache_);
         page_cache_->consider_evicting_current_page(page->block_id());
     }
@@ -5,7 +5,9 @@
 
 #include <functional>
 
+#include "buffer_cache/compressed_page_pool.hpp"
 #include "buffer_cache/eviction_bag.hpp"
+#include "buffer_cache/types.hpp"
 #include "concurrency/auto_drainer.hpp"
 #include "concurrency/cache_line_padded.hpp"
 #include "concurrency/pubsub.hpp"
@@ -42,9 +44,16 @@ public:
     void initialize(page_cache_t *page_cache,
                     cache_balancer_t *balancer,
                     alt_txn_throttler_t *throttler);
+    // `compressed_fraction` is the share of the memory limit that goes to the
+    // compressed page pool.  `keep_pinned_pages` is false if the cache is pinned but
+    // the balancer couldn't give it all the memory it holds.
     void update_memory_limit(uint64_t new_memory_limit,
                              int64_t bytes_loaded_accounted_for,
                              uint64_t access_count_accounted_for,
+                             double compressed_fraction,
+                             uint64_t compressed_hits_accounted_for,
+                             uint64_t compressed_misses_accounted_for,
+                             bool keep_pinned_pages,
                              bool read_ahead_ok);
 
     uint64_t next_access_time() {
@@ -58,6 +67,29 @@ public:
 
     uint64_t in_memory_size() const;
 
+    // Loads the block from the compressed page pool, if the pool has it (and it's
+    // the version of `expected_token`, if that's non-empty).  Every call counts as
+    // a hit or a miss of the pool.
+    bool take_compressed_page(block_id_t block_id,
+                              const counted_t<standard_block_token_t> &expected_token,
+                              counted_t<standard_block_token_t> *token_out,
+                              buf_ptr_t *buf_out);
+    // Must be called when the block gets modified or deleted.
+    void forget_compressed_page(block_id_t block_id);
+
+    // The balancer reads the policy when it rebalances.
+    void set_policy(const cache_policy_t &policy);
+    const cache_policy_t &policy() const;
+
+    double compressed_fraction() const;
+    const compressed_page_pool_t &compressed_pages() const;
+    // Hits and misses since the balancer last accounted for them.
+    uint64_t compressed_hits() const;
+    uint64_t compressed_misses() const;
+    // Hits and misses since the evicter was created.
+    uint64_t total_compressed_hits() const;
+    uint64_t total_compressed_misses() const;
+
     // This is decremented past UINT64_MAX to force code to be aware of access time
     // rollovers.
     static const uint64_t INITIAL_ACCESS_TIME = UINT64_MAX - 100;
@@ -71,6 +103,9 @@ private:
     // Evicts any evictable pages until under the memory limit
     void evict_if_necessary() THROWS_NOTHING;
 
+    // The part of `memory_limit_` that isn't given to `compressed_pages_`.
+    uint64_t page_memory_limit() const;
+
     bool initialized_;
     page_cache_t *page_cache_;
     cache_balancer_t *balancer_;
@@ -89,6 +124,22 @@ private:
     // This gets incremented every time a page is accessed.
     uint64_t access_time_counter_;
 
+    // Clean pages that get evicted are kept here in compressed form, if the
+    // balancer gives the pool any memory.
+    compressed_page_pool_t compressed_pages_;
+
+    // A pinned evicter doesn't evict pages; the balancer sizes it to fit them.  If
+    // the pinned caches don't fit into the total cache size, the balancer clears
+    // `keep_pinned_pages_` and the evicter evicts down to its limit as usual.
+    cache_policy_t policy_;
+    bool keep_pinned_pages_;
+    double compressed_fraction_;
+    // Like `access_count_counter_`, these are cleared by the balancer.
+    uint64_t compressed_hits_counter_;
+    uint64_t compressed_misses_counter_;
+    uint64_t total_compressed_hits_;
+    uint64_t total_compressed_misses_;
+
     // This is set to true while `evict_if_necessary()` is active.
     // It avoids reentrant calls to that function.
     bool evict_if_necessary_active_;
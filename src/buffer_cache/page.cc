@@ -66,10 +66,12 @@ page_t::page_t(block_id_t _block_id, page_cache_t *page_cache)
 }
 
 page_t::page_t(block_id_t _block_id, page_cache_t *page_cache,
-               cache_account_t *account)
+               cache_account_t *account, page_load_t load)
     : block_id_(_block_id),
       loader_(nullptr),
-      access_time_(page_cache->evicter().next_access_time()),
+      access_time_(load == page_load_t::read_ahead
+                   ? READ_AHEAD_ACCESS_TIME
+                   : page_cache->evicter().next_access_time()),
       snapshot_refcount_(0) {
     page_cache->evicter().add_not_yet_loaded(this);
 
@@ -80,6 +82,17 @@ page_t::page_t(block_id_t _block_id, page_cache_t *page_cache,
                                             account));
 }
 
+page_t::page_t(block_id_t _block_id, page_cache_t *page_cache,
+               page_read_batch_t *batch)
+    : block_id_(_block_id),
+      loader_(nullptr),
+      access_time_(READ_AHEAD_ACCESS_TIME),
+      snapshot_refcount_(0) {
+    page_cache->evicter().add_not_yet_loaded(this);
+
+    batch->add(this, counted_t<standard_block_token_t>());
+}
+
 page_t::page_t(block_id_t _block_id, buf_ptr_t buf,
                page_cache_t *page_cache)
     : block_id_(_block_id),
@@ -349,7 +362,13 @@ void page_t::load_with_block_id(page_t *page, block_id_t block_id,
     buf_ptr_t buf;
     counted_t<standard_block_token_t> block_token;
 
-    {
+    // The compressed page pool only has current versions of blocks, so whatever
+    // version it has is the one the index would give us.
+    if (page_cache->evicter().take_compressed_page(
+            block_id, counted_t<standard_block_token_t>(), &block_token, &buf)) {
+        // We're still inside the page_t constructor.
+        coro_t::yield();
+    } else {
         serializer_t *const serializer = page_cache->serializer();
         on_thread_t th(serializer->home_thread());
         block_token = serializer->index_read(block_id);
@@ -429,6 +448,37 @@ void page_t::add_waiter(page_acq_t *acq, cache_account_t *account) {
     }
 }
 
+void page_t::read_ahead(page_cache_t *page_cache, cache_account_t *account) {
+    if (buf_.has() || loader_ != nullptr) {
+        // The page is in memory or on its way there already.
+        return;
+    }
+    rassert(block_token_.has());
+    access_time_ = READ_AHEAD_ACCESS_TIME;
+
+    // Like a waiter, the load makes the page unevictable until it's done.
+    eviction_bag_t *old_bag = page_cache->evicter().correct_eviction_category(this);
+    coro_t::spawn_now_dangerously(std::bind(&page_t::load_using_block_token,
+                                            this,
+                                            page_cache,
+                                            account));
+    page_cache->evicter().change_to_correct_eviction_bag(old_bag, this);
+}
+
+void page_t::read_ahead(page_cache_t *page_cache, page_read_batch_t *batch) {
+    if (buf_.has() || loader_ != nullptr) {
+        // The page is in memory or on its way there already.
+        return;
+    }
+    rassert(block_token_.has());
+    access_time_ = READ_AHEAD_ACCESS_TIME;
+
+    eviction_bag_t *old_bag = page_cache->evicter().correct_eviction_category(this);
+    batch->add(this, block_token_);
+    page_cache->evicter().reloading_page(this);
+    page_cache->evicter().change_to_correct_eviction_bag(old_bag, this);
+}
+
 // Unevicts page.
 void page_t::load_using_block_token(page_t *page, page_cache_t *page_cache,
                                     cache_account_t *account) {
@@ -446,7 +496,12 @@ void page_t::load_using_block_token(page_t *page, page_cache_t *page_cache,
     rassert(block_token.has());
 
     buf_ptr_t buf;
-    {
+    counted_t<standard_block_token_t> pool_token;
+    if (page_cache->evicter().take_compressed_page(
+            page->block_id_, block_token, &pool_token, &buf)) {
+        // Waiters don't expect to be pulsed before add_waiter returns.
+        coro_t::yield();
+    } else {
         serializer_t *const serializer = page_cache->serializer();
 
         on_thread_t th(serializer->home_thread());
@@ -471,6 +526,104 @@ void page_t::load_using_block_token(page_t *page, page_cache_t *page_cache,
     page->pulse_waiters_or_make_evictable(page_cache);
 }
 
+page_read_batch_t::page_read_batch_t(page_cache_t *page_cache)
+    : page_cache_(page_cache) { }
+
+page_read_batch_t::~page_read_batch_t() { }
+
+void page_read_batch_t::add(page_t *page,
+                            const counted_t<standard_block_token_t> &block_token) {
+    rassert(page->loader_ == nullptr);
+    entry_t entry;
+    entry.page = page;
+    entry.block_id = page->block_id();
+    entry.block_token = block_token;
+    entry.loader.init(new instant_page_loader_t);
+    page->loader_ = entry.loader.get();
+    entries_.push_back(std::move(entry));
+}
+
+void page_read_batch_t::start(scoped_ptr_t<page_read_batch_t> &&batch,
+                              cache_account_t *account) {
+    rassert(!batch->empty());
+    coro_t::spawn_now_dangerously(std::bind(&page_read_batch_t::load,
+                                            batch.release(),
+                                            account));
+}
+
+void page_read_batch_t::load(page_read_batch_t *batch_ptr,
+                             cache_account_t *account) {
+    // This is called using spawn_now_dangerously, so that we get the drainer lock
+    // before blocking.  The pages' loader_ fields were set when they joined the
+    // batch.
+    scoped_ptr_t<page_read_batch_t> batch(batch_ptr);
+    page_cache_t *const page_cache = batch->page_cache_;
+
+    auto_drainer_t::lock_t lock = page_cache->drainer_lock();
+
+    // Pages that the compressed page pool has don't need to be read.
+    std::vector<buf_ptr_t> bufs(batch->entries_.size());
+    std::vector<size_t> to_read;
+    for (size_t i = 0; i < batch->entries_.size(); ++i) {
+        entry_t *entry = &batch->entries_[i];
+        counted_t<standard_block_token_t> pool_token;
+        if (page_cache->evicter().take_compressed_page(
+                entry->block_id, entry->block_token, &pool_token, &bufs[i])) {
+            entry->block_token = std::move(pool_token);
+        } else {
+            to_read.push_back(i);
+        }
+    }
+
+    if (to_read.empty()) {
+        // Don't finish the loads before page_read_batch_t::start returns.
+        coro_t::yield();
+    } else {
+        serializer_t *const serializer = page_cache->serializer();
+        on_thread_t th(serializer->home_thread());
+        std::vector<counted_t<standard_block_token_t> > block_tokens;
+        block_tokens.reserve(to_read.size());
+        for (size_t i : to_read) {
+            entry_t *entry = &batch->entries_[i];
+            if (!entry->block_token.has()) {
+                entry->block_token = serializer->index_read(entry->block_id);
+                rassert(entry->block_token.has());
+            }
+            block_tokens.push_back(entry->block_token);
+        }
+        std::vector<buf_ptr_t> read_bufs
+            = serializer->block_reads(block_tokens, account->get());
+        for (size_t j = 0; j < to_read.size(); ++j) {
+            bufs[to_read[j]] = std::move(read_bufs[j]);
+        }
+    }
+
+    ASSERT_FINITE_CORO_WAITING;
+    for (size_t i = 0; i < batch->entries_.size(); ++i) {
+        entry_t *entry = &batch->entries_[i];
+        if (entry->loader->abandon_page()) {
+            continue;
+        }
+
+        page_t *page = entry->page;
+        if (page->block_token_.has()) {
+            // The page had been evicted.
+            rassert(page->block_token_.get() == entry->block_token.get());
+            rassert(!page->buf_.has());
+            {
+                usage_adjuster_t adjuster(page_cache, page);
+                page->buf_ = std::move(bufs[i]);
+                page->loader_ = nullptr;
+            }
+            page->pulse_waiters_or_make_evictable(page_cache);
+        } else {
+            page_t::finish_load_with_block_id(page, page_cache,
+                                              std::move(entry->block_token),
+                                              std::move(bufs[i]));
+        }
+    }
+}
+
 void page_t::set_page_buf_size(block_size_t block_size, page_cache_t *page_cache) {
     rassert(buf_.has(),
             "Called outside page_acq_t or without waiting for the buf_ready_signal_?");
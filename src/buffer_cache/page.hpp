@@ -1,9 +1,12 @@
 #ifndef BUFFER_CACHE_PAGE_HPP_
 #define BUFFER_CACHE_PAGE_HPP_
 
+#include <vector>
+
 #include "concurrency/cond_var.hpp"
 #include "containers/backindex_bag.hpp"
 #include "containers/half_intrusive_list.hpp"
+#include "containers/scoped.hpp"
 #include "repli_timestamp.hpp"
 #include "serializer/buf_ptr.hpp"
 #include "serializer/types.hpp"
@@ -18,6 +21,13 @@ class page_acq_t;
 class page_loader_t;
 class deferred_page_loader_t;
 class deferred_block_token_t;
+class page_read_batch_t;
+
+// Whether a page gets loaded because somebody is waiting for it, or ahead of time
+// because somebody is likely to acquire it soon.  Pages that get loaded ahead of time
+// are the first to be evicted until they get accessed, so that they don't displace
+// pages that are in use.
+enum class page_load_t { demand, read_ahead };
 
 // A page_t represents a page (a byte buffer of a specific size), having a definite
 // value known at the construction of the page_t (and possibly later modified
@@ -28,7 +38,10 @@ public:
     // token ASAP, so that we can't lose access to the current version of the block).
     page_t(block_id_t block_id, page_cache_t *page_cache);
     // Loads the block for the given block id.
-    page_t(block_id_t block_id, page_cache_t *page_cache, cache_account_t *account);
+    page_t(block_id_t block_id, page_cache_t *page_cache, cache_account_t *account,
+           page_load_t load = page_load_t::demand);
+    // Loads the block for the given block id ahead of time, as part of the batch.
+    page_t(block_id_t block_id, page_cache_t *page_cache, page_read_batch_t *batch);
 
     page_t(block_id_t block_id, buf_ptr_t buf, page_cache_t *page_cache);
     page_t(block_id_t block_id, buf_ptr_t buf,
@@ -42,6 +55,11 @@ public:
     void add_waiter(page_acq_t *acq, cache_account_t *account);
     void remove_waiter(page_acq_t *acq);
 
+    // Starts loading the page if it has been evicted, without waiting for it.
+    void read_ahead(page_cache_t *page_cache, cache_account_t *account);
+    // Like the above, but the page gets loaded as part of the batch.
+    void read_ahead(page_cache_t *page_cache, page_read_batch_t *batch);
+
     // These may not be called until the page_acq_t's buf_ready_signal is pulsed.
     void *get_page_buf(page_cache_t *page_cache);
     void reset_block_token(page_cache_t *page_cache);
@@ -77,12 +95,17 @@ public:
     }
 
     ser_buffer_t *get_loaded_ser_buffer();
+    const buf_ptr_t &loaded_buf() const {
+        rassert(buf_.has());
+        return buf_;
+    }
     void init_block_token(counted_t<standard_block_token_t> token,
                           page_cache_t *page_cache);
 
 private:
     friend class page_ptr_t;
     friend class deferred_page_loader_t;
+    friend class page_read_batch_t;
     static bool loader_is_loading(page_loader_t *loader);
     void add_snapshotter();
     void remove_snapshotter(page_cache_t *page_cache);
@@ -162,6 +185,44 @@ inline backindex_bag_index_t *access_backindex(page_t *page) {
     return &page->eviction_index_;
 }
 
+// Loads the blocks of several pages with a single `serializer_t::block_reads` call,
+// so that blocks that are close to each other on disk get read with one disk read.
+// Pages join the batch by being constructed with it or by `page_t::read_ahead`, and
+// get loaded once the batch is passed to `start()`, which must happen before the
+// coroutine that filled the batch yields.
+class page_read_batch_t {
+public:
+    explicit page_read_batch_t(page_cache_t *page_cache);
+    ~page_read_batch_t();
+
+    bool empty() const { return entries_.empty(); }
+
+    // Starts loading the pages in the batch, without waiting for them.
+    static void start(scoped_ptr_t<page_read_batch_t> &&batch,
+                      cache_account_t *account);
+
+private:
+    friend class page_t;
+
+    struct entry_t {
+        page_t *page;
+        block_id_t block_id;
+        // Empty for a new page, whose block token gets read on the serializer thread.
+        counted_t<standard_block_token_t> block_token;
+        scoped_ptr_t<page_loader_t> loader;
+    };
+
+    // Sets the page's loader_.
+    void add(page_t *page, const counted_t<standard_block_token_t> &block_token);
+
+    static void load(page_read_batch_t *batch, cache_account_t *account);
+
+    page_cache_t *page_cache_;
+    std::vector<entry_t> entries_;
+
+    DISABLE_COPYING(page_read_batch_t);
+};
+
 // A page_ptr_t holds a pointer to a page_t.
 class page_ptr_t {
 public:
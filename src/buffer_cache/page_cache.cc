@@ -15,6 +15,10 @@
 #include "serializer/serializer.hpp"
 #include "stl_utils.hpp"
 
+// The number of flushes that may be running at once.  With two, the blocks of one
+// flush are written while the previous flush's metablock is being synced.
+const size_t MAX_CONCURRENT_FLUSHES = 2;
+
 cache_conn_t::~cache_conn_t() {
     // The user could only be expected to make sure that txn_t objects don't have
     // their lifetime exceed the cache_conn_t's.  Soft durability makes it possible
@@ -206,6 +210,7 @@ page_cache_t::page_cache_t(serializer_t *_serializer,
                            alt_txn_throttler_t *throttler)
     : max_block_size_(_serializer->max_block_size()),
       serializer_(_serializer),
+      flushes_in_flight_(0),
       free_list_(_serializer),
       evicter_(),
       read_ahead_cb_(nullptr),
@@ -223,7 +228,8 @@ page_cache_t::page_cache_t(serializer_t *_serializer,
             local_read_ahead_cb = new page_read_ahead_cb_t(_serializer, this);
         }
         default_reads_account_.init(_serializer->home_thread(),
-                                    _serializer->make_io_account(CACHE_READS_IO_PRIORITY));
+                                    _serializer->make_io_account(
+                                        io_class_t::foreground_read));
         index_write_sink_.init(new page_cache_index_write_sink_t);
         recencies_ = _serializer->get_all_recencies();
     }
@@ -362,6 +368,45 @@ current_page_t *page_cache_t::page_for_block_id(block_id_t block_id) {
     return page_it->second;
 }
 
+void page_cache_t::read_ahead_block(block_id_t block_id, cache_account_t *account) {
+    assert_thread();
+
+    auto page_it = current_pages_.find(block_id);
+    if (page_it == current_pages_.end()) {
+        if (recency_for_block_id(block_id) == repli_timestamp_t::invalid) {
+            // The block has been deleted, or it's an aux block.
+            return;
+        }
+        page_it = current_pages_.insert(
+            page_it, std::make_pair(block_id, new current_page_t(block_id)));
+    }
+    page_it->second->read_ahead(current_page_help_t(block_id, this), account);
+}
+
+void page_cache_t::read_ahead_blocks(const std::vector<block_id_t> &block_ids,
+                                     cache_account_t *account) {
+    assert_thread();
+
+    scoped_ptr_t<page_read_batch_t> batch(new page_read_batch_t(this));
+    for (block_id_t block_id : block_ids) {
+        auto page_it = current_pages_.find(block_id);
+        if (page_it == current_pages_.end()) {
+            if (!is_aux_block_id(block_id)
+                && recency_for_block_id(block_id) == repli_timestamp_t::invalid) {
+                // The block has been deleted.
+                continue;
+            }
+            page_it = current_pages_.insert(
+                page_it, std::make_pair(block_id, new current_page_t(block_id)));
+        }
+        page_it->second->read_ahead(current_page_help_t(block_id, this), batch.get());
+    }
+
+    if (!batch->empty()) {
+        page_read_batch_t::start(std::move(batch), account);
+    }
+}
+
 current_page_t *page_cache_t::page_for_new_block_id(
         block_type_t block_type,
         block_id_t *block_id_out) {
@@ -397,6 +442,7 @@ current_page_t *page_cache_t::internal_page_for_new_chosen(block_id_t block_id)
     if (!is_aux_block_id(block_id)) {
         set_recency_for_block_id(block_id, repli_timestamp_t::distant_past);
     }
+    evicter_.forget_compressed_page(block_id);
 
     buf_ptr_t buf = buf_ptr_t::alloc_uninitialized(max_block_size_);
 
@@ -413,15 +459,15 @@ current_page_t *page_cache_t::internal_page_for_new_chosen(block_id_t block_id)
     return inserted_page.first->second;
 }
 
-cache_account_t page_cache_t::create_cache_account(int priority) {
-    // We assume that a priority of 100 means that the transaction should have the
-    // same priority as all the non-accounted transactions together. Not sure if this
-    // makes sense.
-
-    // Be aware of rounding errors... (what can be do against those? probably just
-    // setting the default io_priority_reads high enough)
-    int io_priority = std::max(1, CACHE_READS_IO_PRIORITY * priority / 100);
+bool page_cache_t::is_current_page(page_t *page) {
+    assert_thread();
+    auto it = current_pages_.find(page->block_id());
+    return it != current_pages_.end()
+        && it->second->page_.has()
+        && it->second->page_.get_page_for_read() == page;
+}
 
+cache_account_t page_cache_t::create_cache_account(io_class_t io_class, int priority) {
     // TODO: This is a heuristic. While it might not be evil, it's not really optimal
     // either.
     int outstanding_requests_limit = std::max(1, 16 * priority / 100);
@@ -431,7 +477,7 @@ cache_account_t page_cache_t::create_cache_account(int priority) {
         // Ideally we shouldn't have to switch to the serializer thread.  But that's
         // what the file account API is right now, deep in the I/O layer.
         on_thread_t thread_switcher(serializer_->home_thread());
-        io_account = serializer_->make_io_account(io_priority,
+        io_account = serializer_->make_io_account(io_class,
                                                   outstanding_requests_limit);
     }
 
@@ -913,6 +959,7 @@ void current_page_t::mark_deleted(current_page_help_t help) {
 
     help.page_cache->set_recency_for_block_id(help.block_id,
                                               repli_timestamp_t::invalid);
+    help.page_cache->evicter().forget_compressed_page(help.block_id);
     page_.reset_page_ptr(help.page_cache);
     // It's the caller's responsibility to call consider_evicting_current_page after
     // we return, if that would make sense (it wouldn't though).
@@ -933,6 +980,31 @@ void current_page_t::convert_from_serializer_if_necessary(current_page_help_t he
     }
 }
 
+void current_page_t::read_ahead(current_page_help_t help,
+                                cache_account_t *account) {
+    if (is_deleted_) {
+        return;
+    }
+    if (!page_.has()) {
+        page_.init(new page_t(help.block_id, help.page_cache, account,
+                              page_load_t::read_ahead));
+    } else {
+        page_.get_page_for_read()->read_ahead(help.page_cache, account);
+    }
+}
+
+void current_page_t::read_ahead(current_page_help_t help,
+                                page_read_batch_t *batch) {
+    if (is_deleted_) {
+        return;
+    }
+    if (!page_.has()) {
+        page_.init(new page_t(help.block_id, help.page_cache, batch));
+    } else {
+        page_.get_page_for_read()->read_ahead(help.page_cache, batch);
+    }
+}
+
 page_t *current_page_t::the_page_for_read(current_page_help_t help,
                                           cache_account_t *account) {
     guarantee(!is_deleted_);
@@ -953,7 +1025,10 @@ page_t *current_page_t::the_page_for_write(current_page_help_t help,
                                            cache_account_t *account) {
     guarantee(!is_deleted_);
     convert_from_serializer_if_necessary(help, account);
-    return page_.get_page_for_write(help.page_cache, account);
+    page_t *page = page_.get_page_for_write(help.page_cache, account);
+    // Any load of the block has already taken what it could from the pool.
+    help.page_cache->evicter().forget_compressed_page(help.block_id);
+    return page;
 }
 
 page_txn_t::page_txn_t(page_cache_t *_page_cache,
@@ -1313,6 +1388,20 @@ void page_cache_t::do_flush_changes(page_cache_t *page_cache,
                                                             ancillary_infos[i].page));
         }
 
+        // Aux blocks don't have a recency of their own.  We stamp them in the index
+        // with the newest recency of the regular blocks written along with them, so
+        // that incremental backups can tell which aux blocks changed.  Every write
+        // that modifies an aux block also modifies the regular block that refers to
+        // it, in the same transaction.
+        repli_timestamp_t aux_recency = repli_timestamp_t::invalid;
+        for (auto it = blocks_by_tokens.begin(); it != blocks_by_tokens.end();
+             ++it) {
+            if (!it->is_deleted && it->block_token.has()
+                && !is_aux_block_id(it->block_id)) {
+                aux_recency = superceding_recency(aux_recency, it->tstamp);
+            }
+        }
+
         // KSI: Unnecessary copying between blocks_by_tokens and write_ops, inelegant
         // representation of deletion/touched blocks in blocks_by_tokens.
         std::vector<index_write_op_t> write_ops;
@@ -1327,11 +1416,16 @@ void page_cache_t::do_flush_changes(page_cache_t *page_cache,
             } else if (it->block_token.has()) {
                 write_ops.push_back(index_write_op_t(it->block_id,
                                                      it->block_token,
-                                                     it->tstamp));
+                                                     is_aux_block_id(it->block_id)
+                                                     ? aux_recency
+                                                     : it->tstamp));
             } else {
+                // Touching an aux block leaves its stamp alone.
                 write_ops.push_back(index_write_op_t(it->block_id,
                                                      boost::none,
-                                                     it->tstamp));
+                                                     is_aux_block_id(it->block_id)
+                                                     ? boost::none
+                                                     : boost::make_optional(it->tstamp)));
             }
         }
 
@@ -1427,6 +1521,15 @@ void page_cache_t::do_flush_txn_set(page_cache_t *page_cache,
     // KSI: Can't we remove_txn_set_from_graph before flushing?  It would make some
     // data structures smaller.
     page_cache_t::remove_txn_set_from_graph(page_cache, txns);
+
+    // Start flushing everything that became flushable while we were busy.
+    rassert(page_cache->flushes_in_flight_ > 0);
+    --page_cache->flushes_in_flight_;
+    if (!page_cache->pending_flush_txns_.empty()) {
+        std::vector<page_txn_t *> pending;
+        pending.swap(page_cache->pending_flush_txns_);
+        page_cache->begin_flush(pending);
+    }
 }
 
 std::vector<page_txn_t *> page_cache_t::maximal_flushable_txn_set(page_txn_t *base) {
@@ -1551,21 +1654,41 @@ void page_cache_t::im_waiting_for_flush(page_txn_t *base) {
     if (!flush_set.empty()) {
         for (auto it = flush_set.begin(); it != flush_set.end(); ++it) {
             rassert(!(*it)->spawned_flush_);
+            // Queued transactions count as spawned, so that their subseqers can
+            // join the same queue.
             (*it)->spawned_flush_ = true;
         }
+        begin_or_queue_flush(std::move(flush_set));
+    }
+}
 
-        std::map<block_id_t, block_change_t> changes
-            = page_cache_t::compute_changes(flush_set);
+void page_cache_t::begin_or_queue_flush(std::vector<page_txn_t *> &&txns) {
+    assert_thread();
+    if (flushes_in_flight_ >= MAX_CONCURRENT_FLUSHES
+        || !pending_flush_txns_.empty()) {
+        // Preceders of `txns` may be in the queue, so `txns` must go behind them.
+        pending_flush_txns_.insert(pending_flush_txns_.end(),
+                                   txns.begin(), txns.end());
+    } else {
+        begin_flush(txns);
+    }
+}
 
-        if (!changes.empty()) {
-            coro_t::spawn_now_dangerously(std::bind(&page_cache_t::do_flush_txn_set,
-                                                    this,
-                                                    &changes,
-                                                    flush_set));
-        } else {
-            // Flush complete.  do_flush_txn_set does this in the write case.
-            page_cache_t::remove_txn_set_from_graph(this, flush_set);
-        }
+void page_cache_t::begin_flush(const std::vector<page_txn_t *> &txns) {
+    assert_thread();
+    ASSERT_FINITE_CORO_WAITING;
+    std::map<block_id_t, block_change_t> changes
+        = page_cache_t::compute_changes(txns);
+
+    if (!changes.empty()) {
+        ++flushes_in_flight_;
+        coro_t::spawn_now_dangerously(std::bind(&page_cache_t::do_flush_txn_set,
+                                                this,
+                                                &changes,
+                                                txns));
+    } else {
+        // Flush complete.  do_flush_txn_set does this in the write case.
+        page_cache_t::remove_txn_set_from_graph(this, txns);
     }
 }
 
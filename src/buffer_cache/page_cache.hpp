@@ -9,6 +9,7 @@
 #include <utility>
 #include <vector>
 
+#include "arch/types.hpp"
 #include "buffer_cache/block_version.hpp"
 #include "buffer_cache/cache_account.hpp"
 #include "buffer_cache/evicter.hpp"
@@ -115,6 +116,11 @@ private:
     // Initializes page_ if necessary, deferring loading of the actual block.
     void convert_from_serializer_if_necessary(current_page_help_t help);
 
+    // Starts loading page_ if it isn't in memory, for a read-ahead.
+    void read_ahead(current_page_help_t help, cache_account_t *account);
+    // Like the above, but page_ gets loaded as part of the batch.
+    void read_ahead(current_page_help_t help, page_read_batch_t *batch);
+
     void mark_deleted(current_page_help_t help);
 
     // page_txn_t should not access our fields directly.
@@ -344,6 +350,17 @@ public:
         block_id_t *block_id_out);
     current_page_t *page_for_new_chosen_block_id(block_id_t block_id);
 
+    // Starts loading the current version of the block into memory, if it isn't
+    // there yet, without acquiring it.  Doesn't do anything if the block doesn't
+    // exist.
+    void read_ahead_block(block_id_t block_id, cache_account_t *account);
+
+    // Like read_ahead_block, for several blocks, whose loads get batched so that
+    // blocks that are close to each other on disk get read with one disk read.  Aux
+    // blocks are assumed to exist.
+    void read_ahead_blocks(const std::vector<block_id_t> &block_ids,
+                           cache_account_t *account);
+
     // Returns how much memory is being used by all the pages in the cache at this
     // moment in time.
     size_t total_page_memory() const;
@@ -351,7 +368,7 @@ public:
 
     max_block_size_t max_block_size() const { return max_block_size_; }
 
-    cache_account_t create_cache_account(int priority);
+    cache_account_t create_cache_account(io_class_t io_class, int priority);
 
     cache_account_t *default_reads_account() {
         return &default_reads_account_;
@@ -365,6 +382,10 @@ public:
     // `current_page_t *` to remain valid.)
     void consider_evicting_current_page(block_id_t block_id);
 
+    // Returns true if `page` holds the current version of its block, as opposed to
+    // a version that only snapshots can see.
+    bool is_current_page(page_t *page);
+
     void have_read_ahead_cb_destroyed();
 
     evicter_t &evicter() { return evicter_; }
@@ -372,6 +393,11 @@ public:
     auto_drainer_t::lock_t drainer_lock() { return drainer_->lock(); }
     serializer_t *serializer() { return serializer_; }
 
+    // The number of flushes that are running, and of transactions that are queued
+    // until one of them completes.
+    size_t flushes_in_flight() const { return flushes_in_flight_; }
+    size_t queued_flush_txns() const { return pending_flush_txns_.size(); }
+
 private:
     friend class page_read_ahead_cb_t;
     void add_read_ahead_buf(block_id_t block_id,
@@ -418,6 +444,10 @@ private:
     static std::vector<page_txn_t *> maximal_flushable_txn_set(page_txn_t *base);
 
     void im_waiting_for_flush(page_txn_t *txns);
+    // Starts flushing `txns` if fewer than `MAX_CONCURRENT_FLUSHES` flushes are
+    // running, or adds them to `pending_flush_txns_` otherwise.
+    void begin_or_queue_flush(std::vector<page_txn_t *> &&txns);
+    void begin_flush(const std::vector<page_txn_t *> &txns);
 
     friend class current_page_acq_t;
     repli_timestamp_t recency_for_block_id(block_id_t id) {
@@ -466,6 +496,14 @@ private:
     serializer_t *serializer_;
     segmented_vector_t<repli_timestamp_t> recencies_;
 
+    // Flushes form a pipeline: while one flush waits for its metablock to become
+    // durable, the next one writes its blocks, and transactions that become
+    // flushable in the meantime are collected in `pending_flush_txns_`.  They all
+    // get flushed together (with a single index write) once one of the running
+    // flushes completes.
+    size_t flushes_in_flight_;
+    std::vector<page_txn_t *> pending_flush_txns_;
+
     std::unordered_map<block_id_t, current_page_t *> current_pages_;
 
     free_list_t free_list_;
@@ -3,33 +3,72 @@
 
 #include "perfmon/perfmon.hpp"
 
+static double get_in_use_bytes(const alt::evicter_t &evicter) {
+    return evicter.in_memory_size();
+}
+
+static double get_target_bytes(const alt::evicter_t &evicter) {
+    return evicter.memory_limit();
+}
+
+static double get_compressed_bytes(const alt::evicter_t &evicter) {
+    return evicter.compressed_pages().memory_usage();
+}
+
+static double get_compressed_hit_rate(const alt::evicter_t &evicter) {
+    const uint64_t hits = evicter.total_compressed_hits();
+    const uint64_t lookups = hits + evicter.total_compressed_misses();
+    return lookups == 0 ? 0 : static_cast<double>(hits) / lookups;
+}
+
+static double get_compression_ratio(const alt::evicter_t &evicter) {
+    const alt::compressed_page_pool_t &pool = evicter.compressed_pages();
+    return pool.compressed_size() == 0
+        ? 0
+        : static_cast<double>(pool.uncompressed_size()) / pool.compressed_size();
+}
+
 alt_cache_stats_t::alt_cache_stats_t(alt::page_cache_t *_page_cache,
                                      perfmon_collection_t *parent) :
     page_cache(_page_cache),
     cache_collection(),
     cache_membership(parent, &cache_collection, "cache"),
-    in_use_bytes(this),
+    in_use_bytes(this, &get_in_use_bytes),
     in_use_bytes_membership(&cache_collection,
                             &in_use_bytes, "in_use_bytes"),
+    target_bytes(this, &get_target_bytes),
+    target_bytes_membership(&cache_collection,
+                            &target_bytes, "target_bytes"),
+    compressed_bytes(this, &get_compressed_bytes),
+    compressed_bytes_membership(&cache_collection,
+                                &compressed_bytes, "compressed_bytes"),
+    compressed_hit_rate(this, &get_compressed_hit_rate),
+    compressed_hit_rate_membership(&cache_collection,
+                                   &compressed_hit_rate, "compressed_hit_rate"),
+    compression_ratio(this, &get_compression_ratio),
+    compression_ratio_membership(&cache_collection,
+                                 &compression_ratio, "compression_ratio"),
     cache_collection_membership(&cache_collection) { }
 
-alt_cache_stats_t::perfmon_value_t::perfmon_value_t(alt_cache_stats_t *_parent) :
-    parent(_parent) { }
+alt_cache_stats_t::perfmon_value_t::perfmon_value_t(
+        alt_cache_stats_t *_parent,
+        double (*_getter)(const alt::evicter_t &)) :
+    parent(_parent), getter(_getter) { }
 
 void *alt_cache_stats_t::perfmon_value_t::begin_stats() {
-    return new uint64_t;
+    return new double(0);
 }
 
 void alt_cache_stats_t::perfmon_value_t::visit_stats(void *ptr) {
     if (get_thread_id() == parent->home_thread()) {
-        uint64_t *value = reinterpret_cast<uint64_t *>(ptr);
-        *value = parent->page_cache->evicter().in_memory_size();
+        double *value = reinterpret_cast<double *>(ptr);
+        *value = getter(parent->page_cache->evicter());
     }
 }
 
 ql::datum_t alt_cache_stats_t::perfmon_value_t::end_stats(void *ptr) {
-    uint64_t *value = reinterpret_cast<uint64_t *>(ptr);
-    ql::datum_t res(static_cast<double>(*value));
+    double *value = reinterpret_cast<double *>(ptr);
+    ql::datum_t res(*value);
     delete value;
     return res;
 }
@@ -15,18 +15,29 @@ public:
     perfmon_collection_t cache_collection;
     perfmon_membership_t cache_membership;
 
+    // Reports a value read from the page cache's evicter on its home thread.
     class perfmon_value_t : public perfmon_t {
     public:
-        explicit perfmon_value_t(alt_cache_stats_t *_parent);
+        perfmon_value_t(alt_cache_stats_t *_parent,
+                        double (*_getter)(const alt::evicter_t &));
         void *begin_stats();
         void visit_stats(void *);
         ql::datum_t end_stats(void *);
     private:
         alt_cache_stats_t *parent;
+        double (*getter)(const alt::evicter_t &);
         DISABLE_COPYING(perfmon_value_t);
     };
     perfmon_value_t in_use_bytes;
     perfmon_membership_t in_use_bytes_membership;
+    perfmon_value_t target_bytes;
+    perfmon_membership_t target_bytes_membership;
+    perfmon_value_t compressed_bytes;
+    perfmon_membership_t compressed_bytes_membership;
+    perfmon_value_t compressed_hit_rate;
+    perfmon_membership_t compressed_hit_rate_membership;
+    perfmon_value_t compression_ratio;
+    perfmon_membership_t compression_ratio_membership;
 
 
     perfmon_multi_membership_t cache_collection_membership;
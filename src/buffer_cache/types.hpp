@@ -14,6 +14,31 @@ ARCHIVE_PRIM_MAKE_RANGED_SERIALIZABLE(write_durability_t, int8_t,
                                       write_durability_t::SOFT,
                                       write_durability_t::HARD);
 
+/* How the cache balancer treats a store's cache.  Tables set this in their config. */
+class cache_policy_t {
+public:
+    cache_policy_t() : priority(1), reserved_bytes(0), pinned(false) { }
+
+    bool operator==(const cache_policy_t &other) const {
+        return priority == other.priority
+            && reserved_bytes == other.reserved_bytes
+            && pinned == other.pinned;
+    }
+    bool operator!=(const cache_policy_t &other) const {
+        return !(operator==(other));
+    }
+
+    /* Weighs how much memory the cache gains for the pages it loads, and how much it
+    gives up when other caches load pages. */
+    double priority;
+    /* The balancer never shrinks the cache below this size, unless the reservations
+    and pinned caches together don't fit into the total cache size. */
+    uint64_t reserved_bytes;
+    /* A pinned cache never evicts pages that are on disk, so it grows to hold all of
+    the store's data, as far as that fits into the total cache size.  Only meant for
+    small tables. */
+    bool pinned;
+};
 
 typedef uint32_t block_magic_comparison_t;
 
@@ -107,6 +107,7 @@ bool artificial_reql_cluster_interface_t::table_create(
         const table_generate_config_params_t &config_params,
         const std::string &primary_key,
         write_durability_t durability,
+        uint64_t block_size,
         signal_t *interruptor,
         ql::datum_t *result_out,
         admin_err_t *error_out) {
@@ -124,6 +125,7 @@ bool artificial_reql_cluster_interface_t::table_create(
         config_params,
         primary_key,
         durability,
+        block_size,
         interruptor,
         result_out,
         error_out);
@@ -404,6 +406,26 @@ bool artificial_reql_cluster_interface_t::db_rebalance(
         user_context, db, interruptor, result_out, error_out);
 }
 
+bool artificial_reql_cluster_interface_t::table_backup(
+        auth::user_context_t const &user_context,
+        counted_t<const ql::db_t> db,
+        const name_string_t &name,
+        const std::string &directory,
+        const boost::optional<repli_timestamp_t> &since,
+        signal_t *interruptor,
+        ql::datum_t *result_out,
+        admin_err_t *error_out) {
+    if (db->name == artificial_reql_cluster_interface_t::database_name) {
+        *error_out = admin_err_t{
+            strprintf("Database `%s` is special; you can't back up the "
+                      "tables in it.", artificial_reql_cluster_interface_t::database_name.c_str()),
+            query_state_t::FAILED};
+        return false;
+    }
+    return next_or_error(error_out) && m_next->table_backup(
+        user_context, db, name, directory, since, interruptor, result_out, error_out);
+}
+
 bool artificial_reql_cluster_interface_t::grant_global(
         auth::user_context_t const &user_context,
         auth::username_t username,
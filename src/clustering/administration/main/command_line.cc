@@ -512,6 +512,21 @@ boost::optional<boost::optional<uint64_t> > parse_total_cache_size_option(
     }
 }
 
+/* Returns the largest share of each table's cache that may be used to keep evicted
+pages compressed. */
+double parse_cache_compression_option(
+        const std::map<std::string, options::values_t> &opts) {
+    const std::string percent_opt = get_single_option(opts, "--cache-compression");
+    uint64_t percent;
+    if (!strtou64_strict(percent_opt, 10, &percent)
+        || percent > MAX_CACHE_COMPRESSION_PERCENT) {
+        throw std::runtime_error(strprintf(
+            "ERROR: cache-compression should be a percentage between 0 and %d, "
+            "got '%s'", MAX_CACHE_COMPRESSION_PERCENT, percent_opt.c_str()));
+    }
+    return static_cast<double>(percent) / 100;
+}
+
 // Note that this defaults to the peer port if no port is specified
 //  (at the moment, this is only used for parsing --join directives)
 // Possible formats:
@@ -1417,6 +1432,11 @@ options::help_section_t get_file_options(std::vector<options::option_t> *options
                                              options::OPTIONAL));
     help.add("--cache-size mb", "total cache size (in megabytes) for the process. Can "
         "be 'auto'.");
+    options_out->push_back(options::option_t(options::names_t("--cache-compression"),
+                                             options::OPTIONAL,
+                                             "0"));
+    help.add("--cache-compression percent", "the largest share of the cache that may "
+        "hold evicted pages in compressed form; 0 disables it");
     return help;
 }
 
@@ -2061,6 +2081,7 @@ int main_rethinkdb_serve(int argc, char *argv[]) {
 
         boost::optional<boost::optional<uint64_t> > total_cache_size =
             parse_total_cache_size_option(opts);
+        const double cache_compression = parse_cache_compression_option(opts);
 
         boost::optional<int> join_delay_secs = parse_join_delay_secs_option(opts);
         boost::optional<int> node_reconnect_timeout_secs =
@@ -2109,6 +2130,7 @@ int main_rethinkdb_serve(int argc, char *argv[]) {
                                 node_reconnect_timeout_secs
                                     ? node_reconnect_timeout_secs.get()
                                     : cluster_defaults::reconnect_timeout,
+                                cache_compression,
                                 tls_configs);
 
         const file_direct_io_mode_t direct_io_mode = parse_direct_io_mode_option(opts);
@@ -2214,6 +2236,7 @@ int main_rethinkdb_proxy(int argc, char *argv[]) {
                                 node_reconnect_timeout_secs
                                     ? node_reconnect_timeout_secs.get()
                                     : cluster_defaults::reconnect_timeout,
+                                0,
                                 tls_configs);
 
         bool result;
@@ -2369,6 +2392,7 @@ int main_rethinkdb_porcelain(int argc, char *argv[]) {
 
         boost::optional<boost::optional<uint64_t> > total_cache_size =
             parse_total_cache_size_option(opts);
+        const double cache_compression = parse_cache_compression_option(opts);
 
         if (check_pid_file(opts) != EXIT_SUCCESS) {
             return EXIT_FAILURE;
@@ -2406,6 +2430,7 @@ int main_rethinkdb_porcelain(int argc, char *argv[]) {
                                 node_reconnect_timeout_secs
                                     ? node_reconnect_timeout_secs.get()
                                     : cluster_defaults::reconnect_timeout,
+                                cache_compression,
                                 tls_configs);
 
         const file_direct_io_mode_t direct_io_mode = parse_direct_io_mode_option(opts);
@@ -304,7 +304,8 @@ bool do_serve(io_backender_t *io_backender,
             scoped_ptr_t<multi_table_manager_t> multi_table_manager;
             if (i_am_a_server) {
                 cache_balancer.init(new alt_cache_balancer_t(
-                    server_config_server->get_actual_cache_size_bytes()));
+                    server_config_server->get_actual_cache_size_bytes(),
+                    serve_info.cache_compression));
                 table_persistence_interface.init(
                     new real_table_persistence_interface_t(
                         io_backender,
@@ -362,6 +363,7 @@ bool do_serve(io_backender_t *io_backender,
                 &server_config_client,
                 &table_meta_client,
                 multi_table_manager.get(),
+                table_persistence_interface.get_or_null(),
                 table_query_directory_read_manager.get_root_view(),
                 make_lifetime(name_resolver));
 
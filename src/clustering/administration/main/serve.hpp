@@ -120,6 +120,7 @@ public:
                  std::vector<std::string> &&_argv,
                  const int _join_delay_secs,
                  const int _node_reconnect_timeout_secs,
+                 double _cache_compression,
                  tls_configs_t _tls_configs) :
         joins(std::move(_joins)),
         reql_http_proxy(std::move(_reql_http_proxy)),
@@ -129,7 +130,8 @@ public:
         config_file(_config_file),
         argv(std::move(_argv)),
         join_delay_secs(_join_delay_secs),
-        node_reconnect_timeout_secs(_node_reconnect_timeout_secs)
+        node_reconnect_timeout_secs(_node_reconnect_timeout_secs),
+        cache_compression(_cache_compression)
     {
         tls_configs = _tls_configs;
     }
@@ -150,6 +152,8 @@ public:
     std::vector<std::string> argv;
     int join_delay_secs;
     int node_reconnect_timeout_secs;
+    /* The largest share of each table's cache that may hold compressed pages. */
+    double cache_compression;
     tls_configs_t tls_configs;
 };
 
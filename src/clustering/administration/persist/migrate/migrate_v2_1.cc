@@ -79,7 +79,8 @@ void migrate_metadata_v2_1_to_v2_3(cluster_version_t serialization_version,
         // This only really needs to migrate auth data, but this should be fine
         migrate_metadata_v2_1_to_v2_3<cluster_version_t::v2_3>(txn, interruptor);
         break;
-    case cluster_version_t::v2_4_is_latest:
+    case cluster_version_t::v2_4:
+    case cluster_version_t::v2_5_is_latest:
         break;
     case cluster_version_t::v1_14:
     case cluster_version_t::v1_15:
@@ -1,6 +1,8 @@
 // Copyright 2010-2015 RethinkDB, all rights reserved.
 #include "clustering/administration/persist/table_interface.hpp"
 
+#include <sys/stat.h>
+
 #include <algorithm>
 #include <array>
 
@@ -8,8 +10,11 @@
 #include "clustering/administration/persist/file_keys.hpp"
 #include "clustering/administration/persist/raft_storage_interface.hpp"
 #include "clustering/administration/perfmon_collection_repo.hpp"
+#include "concurrency/cross_thread_signal.hpp"
+#include "concurrency/wait_any.hpp"
 #include "logger.hpp"
 #include "rdb_protocol/store.hpp"
+#include "serializer/backup.hpp"
 #include "serializer/log/log_serializer.hpp"
 #include "serializer/merger.hpp"
 #include "serializer/translator.hpp"
@@ -20,6 +25,7 @@ public:
     real_multistore_ptr_t(
             const namespace_id_t &table_id,
             const serializer_filepath_t &path,
+            uint64_t block_size_if_created,
             scoped_ptr_t<real_branch_history_manager_t> &&bhm,
             const base_path_t &base_path,
             io_backender_t *io_backender,
@@ -56,7 +62,7 @@ public:
         if (create) {
             log_serializer_t::create(
                 &file_opener,
-                log_serializer_t::static_config_t());
+                log_serializer_t::static_config_t(block_size_if_created));
         }
 
         // TODO: Could we handle failure when loading the serializer?  Right
@@ -110,6 +116,8 @@ public:
                     &write_token,
                     write_durability_t::HARD,
                     &non_interruptor);
+            } else {
+                forget_unknown_branches(table_id, ix);
             }
         });
 
@@ -154,6 +162,54 @@ public:
         return stores[i].get();
     }
 
+    /* Must be called on the serializer's thread, while holding a lock on the
+    drainer.  Returns the timestamp that the next incremental backup should be based
+    on. */
+    repli_timestamp_t backup(const namespace_id_t &table_id,
+                             const serializer_filepath_t &path,
+                             const boost::optional<repli_timestamp_t> &since,
+                             io_backender_t *io_backender,
+                             signal_t *interruptor) THROWS_ONLY(interrupted_exc_t) {
+        guarantee(serializer.has());
+        guarantee(multiplexer.has());
+        std::vector<index_snapshot_entry_t> snapshot = serializer->index_snapshot();
+
+        // Each CPU shard flushes its writes independently, so the snapshot can miss
+        // writes to one shard that are older than writes to another shard that it
+        // already contains.  But within a shard, it contains every write up to the
+        // newest one it has, so the oldest of the shards' newest writes is a safe
+        // base for the next increment.
+        const int num_shards = multiplexer->proxies.size();
+        std::vector<repli_timestamp_t> newest(num_shards,
+                                              repli_timestamp_t::distant_past);
+        for (const auto &entry : snapshot) {
+            // Aux blocks get their recency from the regular blocks anyway.
+            if (is_aux_block_id(entry.block_id)
+                || entry.block_id < CONFIG_BLOCK_ID.subsequent_ser_id()
+                || entry.recency == repli_timestamp_t::invalid) {
+                continue;
+            }
+            const int shard = translator_serializer_t::untranslate_block_id_to_mod_id(
+                entry.block_id, num_shards, CONFIG_BLOCK_ID);
+            newest[shard] = superceding_recency(newest[shard], entry.recency);
+        }
+        backup_chain_header_t chain_header;
+        chain_header.source_id = table_id;
+        chain_header.source_creation_timestamp = multiplexer->creation_timestamp;
+        chain_header.since = since;
+        chain_header.next_base = *std::min_element(newest.begin(), newest.end());
+
+        filepath_file_opener_t file_opener(path, io_backender);
+        perfmon_collection_t backup_perfmon_collection;
+        backup_serializer(serializer.get(),
+                          std::move(snapshot),
+                          chain_header,
+                          &file_opener,
+                          &backup_perfmon_collection,
+                          interruptor);
+        return chain_header.next_base;
+    }
+
     bool is_gc_active() {
         rassert(!drainer.is_draining());
         if (serializer.has()) {
@@ -164,6 +220,50 @@ public:
     }
 
 private:
+    /* A file that was restored from a backup of another server, or of a table that
+    was dropped since, has versions on branches that this server's history of the table
+    doesn't know about.  We can't compare those with the other replicas' versions, so
+    the store starts out at the zero version, but keeps its data.  If the table has
+    other replicas with data, the store gets overwritten through a backfill; otherwise
+    the primary starts a new branch on top of it. */
+    void forget_unknown_branches(const namespace_id_t &table_id, int ix) {
+        order_source_t order_source;
+        cond_t non_interruptor;
+        read_token_t read_token;
+        stores[ix]->new_read_token(&read_token);
+        region_map_t<version_t> versions = to_version_map(stores[ix]->get_metainfo(
+            order_source.check_in("real_multistore_ptr_t").with_read_mode(),
+            &read_token, region_t::universe(), &non_interruptor));
+
+        bool all_known = true;
+        {
+            on_thread_t thread_switcher(branch_history_manager->home_thread());
+            versions.visit(versions.get_domain(),
+            [&](const region_t &, const version_t &version) {
+                all_known &= version.branch.is_nil()
+                    || branch_history_manager->is_branch_known(version.branch);
+            });
+        }
+        if (all_known) {
+            return;
+        }
+
+        logWRN("Shard %d of the file of table %s was restored from a backup with a "
+               "history that this server doesn't know. Its data will be kept, but "
+               "treated as if it had no version.\n",
+               ix, uuid_to_str(table_id).c_str());
+        write_token_t write_token;
+        stores[ix]->new_write_token(&write_token);
+        stores[ix]->set_metainfo(
+            region_map_t<binary_blob_t>(
+                region_t::universe(),
+                binary_blob_t(version_t::zero())),
+            order_source.check_in("real_multistore_ptr_t"),
+            &write_token,
+            write_durability_t::HARD,
+            &non_interruptor);
+    }
+
     scoped_ptr_t<real_branch_history_manager_t> branch_history_manager;
     scoped_ptr_t<serializer_t> serializer;
     scoped_ptr_t<serializer_multiplexer_t> multiplexer;
@@ -278,6 +378,31 @@ void real_table_persistence_interface_t::load_multistore(
         scoped_ptr_t<multistore_ptr_t> *multistore_ptr_out,
         signal_t *interruptor,
         perfmon_collection_t *perfmon_collection_serializers) {
+    /* The file should exist already; the block size only matters if it doesn't. */
+    load_or_create_multistore(
+        table_id, DEFAULT_BTREE_BLOCK_SIZE, metadata_read_txn, multistore_ptr_out,
+        interruptor, perfmon_collection_serializers);
+}
+
+void real_table_persistence_interface_t::create_multistore(
+        const namespace_id_t &table_id,
+        uint64_t block_size,
+        scoped_ptr_t<multistore_ptr_t> *multistore_ptr_out,
+        signal_t *interruptor,
+        perfmon_collection_t *perfmon_collection_serializers) {
+    metadata_file_t::read_txn_t read_txn(metadata_file, interruptor);
+    load_or_create_multistore(
+        table_id, block_size, &read_txn, multistore_ptr_out, interruptor,
+        perfmon_collection_serializers);
+}
+
+void real_table_persistence_interface_t::load_or_create_multistore(
+        const namespace_id_t &table_id,
+        uint64_t block_size_if_created,
+        metadata_file_t::read_txn_t *metadata_read_txn,
+        scoped_ptr_t<multistore_ptr_t> *multistore_ptr_out,
+        signal_t *interruptor,
+        perfmon_collection_t *perfmon_collection_serializers) {
     scoped_ptr_t<real_branch_history_manager_t> bhm(
         new real_branch_history_manager_t(
             table_id, metadata_file, metadata_read_txn, interruptor));
@@ -292,6 +417,7 @@ void real_table_persistence_interface_t::load_multistore(
     multistore_ptr_out->init(new real_multistore_ptr_t(
         table_id,
         file_name_for(table_id),
+        block_size_if_created,
         std::move(bhm),
         base_path,
         io_backender,
@@ -303,17 +429,6 @@ void real_table_persistence_interface_t::load_multistore(
         &real_multistores));
 }
 
-void real_table_persistence_interface_t::create_multistore(
-        const namespace_id_t &table_id,
-        scoped_ptr_t<multistore_ptr_t> *multistore_ptr_out,
-        signal_t *interruptor,
-        perfmon_collection_t *perfmon_collection_serializers) {
-    metadata_file_t::read_txn_t read_txn(metadata_file, interruptor);
-    load_multistore(
-        table_id, &read_txn, multistore_ptr_out, interruptor,
-        perfmon_collection_serializers);
-}
-
 void real_table_persistence_interface_t::destroy_multistore(
         const namespace_id_t &table_id,
         scoped_ptr_t<multistore_ptr_t> *multistore_ptr_in) {
@@ -332,6 +447,89 @@ serializer_filepath_t real_table_persistence_interface_t::file_name_for(
     return serializer_filepath_t(base_path, uuid_to_str(table_id));
 }
 
+std::string real_table_persistence_interface_t::backup_file_name(
+        const namespace_id_t &table_id,
+        const boost::optional<repli_timestamp_t> &since) {
+    // Increments are named after the timestamp they're based on, so that they don't
+    // replace the full backup or each other.
+    if (static_cast<bool>(since)) {
+        return strprintf("%s.%" PRIu64, uuid_to_str(table_id).c_str(), since->longtime);
+    }
+    return uuid_to_str(table_id);
+}
+
+bool real_table_persistence_interface_t::backup_multistore(
+        const namespace_id_t &table_id,
+        const std::string &directory,
+        const boost::optional<repli_timestamp_t> &since,
+        signal_t *interruptor,
+        repli_timestamp_t *next_base_out,
+        std::string *error_out)
+        THROWS_ONLY(interrupted_exc_t) {
+    auto it = real_multistores.find(table_id);
+    if (it == real_multistores.end()) {
+        return false;
+    }
+    // Note the copy, we want to hold the `auto_drainer_t::lock_t`.
+    std::pair<real_multistore_ptr_t *, auto_drainer_t::lock_t> multistore = it->second;
+    serializer_t *serializer = multistore.first->get_serializer();
+    if (serializer == nullptr) {
+        return false;
+    }
+
+    // `filepath_file_opener_t` crashes the server if it can't open the file, so we
+    // make sure up front that the file can be created.
+    if (directory.empty() || directory[0] != '/') {
+        *error_out = strprintf("The backup directory must be an absolute path, "
+                               "got `%s`.", directory.c_str());
+        return true;
+    }
+    const base_path_t backup_path(directory);
+    if (!is_rw_directory(backup_path)) {
+        *error_out = strprintf("`%s` is not a directory that the server can write to.",
+                               directory.c_str());
+        return true;
+    }
+    const base_path_t backup_temporary_path(
+        directory + PATH_SEPARATOR + TEMPORARY_DIRECTORY_NAME);
+    int res;
+    do {
+        res = mkdir(backup_temporary_path.path().c_str(), 0755);
+    } while (res == -1 && get_errno() == EINTR);
+    if (res != 0 && get_errno() != EEXIST) {
+        *error_out = strprintf("Could not create the directory `%s`: %s",
+                               backup_temporary_path.path().c_str(),
+                               errno_string(get_errno()).c_str());
+        return true;
+    }
+    if (!is_rw_directory(backup_temporary_path)) {
+        *error_out = strprintf("`%s` is not a directory that the server can write to.",
+                               backup_temporary_path.path().c_str());
+        return true;
+    }
+
+    const serializer_filepath_t path(backup_path, backup_file_name(table_id, since));
+    logNTC("Backing up table %s to %s\n",
+           uuid_to_str(table_id).c_str(), path.permanent_path().c_str());
+
+    wait_any_t combined_interruptor(
+        interruptor, multistore.second.get_drain_signal());
+    try {
+        cross_thread_signal_t ct_interruptor(
+            &combined_interruptor, serializer->home_thread());
+        on_thread_t thread_switcher(serializer->home_thread());
+        *next_base_out = multistore.first->backup(
+            table_id, path, since, io_backender, &ct_interruptor);
+    } catch (const interrupted_exc_t &) {
+        if (interruptor->is_pulsed()) {
+            throw;
+        }
+        *error_out = "The table's data was removed from this server before the "
+                     "backup was complete.";
+    }
+    return true;
+}
+
 bool real_table_persistence_interface_t::is_gc_active() const {
     for (int thread = 0; thread < get_num_db_threads(); ++thread) {
         std::map<serializer_t *, auto_drainer_t::lock_t> serializers_copy;
@@ -63,6 +63,7 @@ public:
         perfmon_collection_t *perfmon_collection_serializers);
     void create_multistore(
         const namespace_id_t &table_id,
+        uint64_t block_size,
         scoped_ptr_t<multistore_ptr_t> *multistore_ptr_out,
         signal_t *interruptor,
         perfmon_collection_t *perfmon_collection_serializers);
@@ -72,7 +73,46 @@ public:
 
     bool is_gc_active() const;
 
+    /* Writes a consistent copy of the table's data file into `directory`, under the
+    same file name that the table has in the data directory, while the table stays
+    available.  If `since` is set, only the blocks that changed at or after that
+    timestamp get copied, into a file whose name ends in the timestamp; see
+    `backup_serializer()`.  `*next_base_out` is set to the `since` timestamp for the
+    next increment.  Returns false if this server doesn't have the table's data, and
+    sets `*error_out` if the file can't be written to `directory`.
+
+    The file only holds the table's data; its name, database, primary key, secondary
+    indexes' definitions and replicas are in the cluster's metadata.  On a fresh
+    server, a backup is restored by creating a table with the same primary key and a
+    single replica on that server, stopping the server, copying the backup over the file
+    named after the new table's ID (see `table.config()`), and starting the server
+    again.  The file's versions refer to the old table's history, so the store starts
+    out at the zero version (see `real_multistore_ptr_t::forget_unknown_branches()`)
+    and the new table's primary continues from its data.  Other replicas can be added
+    afterwards. */
+    bool backup_multistore(
+        const namespace_id_t &table_id,
+        const std::string &directory,
+        const boost::optional<repli_timestamp_t> &since,
+        signal_t *interruptor,
+        repli_timestamp_t *next_base_out,
+        std::string *error_out)
+        THROWS_ONLY(interrupted_exc_t);
+
+    /* The name of the file that `backup_multistore()` writes. */
+    static std::string backup_file_name(
+        const namespace_id_t &table_id,
+        const boost::optional<repli_timestamp_t> &since);
+
 private:
+    void load_or_create_multistore(
+        const namespace_id_t &table_id,
+        uint64_t block_size_if_created,
+        metadata_file_t::read_txn_t *metadata_read_txn,
+        scoped_ptr_t<multistore_ptr_t> *multistore_ptr_out,
+        signal_t *interruptor,
+        perfmon_collection_t *perfmon_collection_serializers);
+
     serializer_filepath_t file_name_for(const namespace_id_t &table_id);
     threadnum_t pick_thread();
 
@@ -5,6 +5,7 @@
 #include "clustering/administration/auth/grant.hpp"
 #include "clustering/administration/datum_adapter.hpp"
 #include "clustering/administration/main/watchable_fields.hpp"
+#include "clustering/administration/persist/table_interface.hpp"
 #include "clustering/administration/servers/config_client.hpp"
 #include "clustering/administration/tables/calculate_status.hpp"
 #include "clustering/administration/tables/generate_config.hpp"
@@ -33,6 +34,7 @@ real_reql_cluster_interface_t::real_reql_cluster_interface_t(
         server_config_client_t *server_config_client,
         table_meta_client_t *table_meta_client,
         multi_table_manager_t *multi_table_manager,
+        real_table_persistence_interface_t *table_persistence_interface,
         watchable_map_t<
             std::pair<peer_id_t, std::pair<namespace_id_t, branch_id_t> >,
             table_query_bcard_t> *table_query_directory,
@@ -55,7 +57,8 @@ real_reql_cluster_interface_t::real_reql_cluster_interface_t(
             return this->m_namespace_repo.get_namespace_interface(id, interruptor);
         },
         name_resolver),
-    m_server_config_client(server_config_client)
+    m_server_config_client(server_config_client),
+    m_table_persistence_interface(table_persistence_interface)
 {
     guarantee(m_auth_semilattice_view->home_thread() == home_thread());
     guarantee(m_cluster_semilattice_view->home_thread() == home_thread());
@@ -292,6 +295,7 @@ bool real_reql_cluster_interface_t::table_create(
         const table_generate_config_params_t &config_params,
         const std::string &primary_key,
         write_durability_t durability,
+        uint64_t block_size,
         signal_t *interruptor_on_caller,
         ql::datum_t *result_out,
         admin_err_t *error_out) {
@@ -334,6 +338,7 @@ bool real_reql_cluster_interface_t::table_create(
 
         config.config.write_ack_config = write_ack_config_t::MAJORITY;
         config.config.durability = durability;
+        config.config.block_size = block_size;
 
         table_id = generate_uuid();
         m_table_meta_client->create(table_id, config, &interruptor_on_home);
@@ -689,6 +694,8 @@ void real_reql_cluster_interface_t::reconfigure_internal(
     new_config.config.sindexes = old_config.config.sindexes;
     new_config.config.write_ack_config = old_config.config.write_ack_config;
     new_config.config.durability = old_config.config.durability;
+    new_config.config.block_size = old_config.config.block_size;
+    new_config.config.cache = old_config.config.cache;
 
     calculate_split_points_intelligently(
         table_id,
@@ -1114,6 +1121,86 @@ bool real_reql_cluster_interface_t::db_rebalance(
     return true;
 }
 
+bool real_reql_cluster_interface_t::table_backup(
+        auth::user_context_t const &user_context,
+        counted_t<const ql::db_t> db,
+        const name_string_t &name,
+        const std::string &directory,
+        const boost::optional<repli_timestamp_t> &since,
+        signal_t *interruptor_on_caller,
+        ql::datum_t *result_out,
+        admin_err_t *error_out) {
+    guarantee(db->name != name_string_t::guarantee_valid("rethinkdb"),
+        "real_reql_cluster_interface_t should never get queries for system tables");
+
+    cross_thread_signal_t interruptor_on_home(interruptor_on_caller, home_thread());
+    try {
+        on_thread_t thread_switcher(home_thread());
+        namespace_id_t table_id;
+        m_table_meta_client->find(db->id, name, &table_id);
+
+        /* The backup gets written to an arbitrary directory on the server, so this
+        requires more than the config permission on the table. */
+        user_context.require_admin_user();
+
+        /* A server only has the data of the shards that it's a replica of, so a backup
+        taken anywhere else would silently miss part of the table. */
+        table_config_and_shards_t config;
+        m_table_meta_client->get_config(table_id, &interruptor_on_home, &config);
+        boost::optional<server_id_t> my_server_id =
+            m_server_config_client->get_peer_to_server_map()->get_key(
+                m_mailbox_manager->get_connectivity_cluster()->get_me());
+        for (const table_config_t::shard_t &shard : config.config.shards) {
+            if (!static_cast<bool>(my_server_id)
+                    || shard.all_replicas.count(*my_server_id) == 0) {
+                *error_out = admin_err_t{
+                    strprintf("Table `%s.%s` can't be backed up by this server "
+                              "because it isn't a replica of every shard of the table. "
+                              "Run the query on a server that is, or reconfigure the "
+                              "table so that one server has a replica of every shard.",
+                              db->name.c_str(), name.c_str()),
+                    query_state_t::FAILED};
+                return false;
+            }
+        }
+
+        repli_timestamp_t next_base;
+        std::string backup_error;
+        if (m_table_persistence_interface == nullptr
+                || !m_table_persistence_interface->backup_multistore(
+                    table_id, directory, since, &interruptor_on_home, &next_base,
+                    &backup_error)) {
+            *error_out = admin_err_t{
+                strprintf("Table `%s.%s` can't be backed up by this server because "
+                          "it doesn't store any of the table's data. Run the query "
+                          "on a server that has a replica of the table.",
+                          db->name.c_str(), name.c_str()),
+                query_state_t::FAILED};
+            return false;
+        }
+        if (!backup_error.empty()) {
+            *error_out = admin_err_t{
+                strprintf("The table was not backed up. %s", backup_error.c_str()),
+                query_state_t::FAILED};
+            return false;
+        }
+
+        ql::datum_object_builder_t builder;
+        builder.overwrite("backed_up", ql::datum_t(1.0));
+        builder.overwrite("path", ql::datum_t(datum_string_t(
+            directory + PATH_SEPARATOR +
+            real_table_persistence_interface_t::backup_file_name(table_id, since))));
+        builder.overwrite("timestamp", ql::datum_t(
+            static_cast<double>(next_base.longtime)));
+        *result_out = std::move(builder).to_datum();
+        return true;
+    } catch (const admin_op_exc_t &admin_op_exc) {
+        *error_out = admin_op_exc.to_admin_err();
+        return false;
+    } CATCH_NAME_ERRORS(db->name, name, error_out)
+      CATCH_OP_ERRORS(db->name, name, error_out, "", "")
+}
+
 bool real_reql_cluster_interface_t::grant_global(
         auth::user_context_t const &user_context,
         auth::username_t username,
@@ -17,6 +17,7 @@
 class artificial_reql_cluster_interface_t;
 class artificial_table_backend_t;
 class name_resolver_t;
+class real_table_persistence_interface_t;
 class server_config_client_t;
 
 /* `real_reql_cluster_interface_t` is a concrete subclass of `reql_cluster_interface_t`
@@ -39,6 +40,8 @@ public:
             server_config_client_t *server_config_client,
             table_meta_client_t *table_meta_client,
             multi_table_manager_t *multi_table_manager,
+            /* `nullptr` on proxies */
+            real_table_persistence_interface_t *table_persistence_interface,
             watchable_map_t<
                 std::pair<peer_id_t, std::pair<namespace_id_t, branch_id_t> >,
                 table_query_bcard_t> *table_query_directory,
@@ -86,6 +89,7 @@ public:
             const table_generate_config_params_t &config_params,
             const std::string &primary_key,
             write_durability_t durability,
+            uint64_t block_size,
             signal_t *interruptor,
             ql::datum_t *result_out,
             admin_err_t *error_out);
@@ -186,6 +190,16 @@ public:
             ql::datum_t *result_out,
             admin_err_t *error_out);
 
+    bool table_backup(
+            auth::user_context_t const &user_context,
+            counted_t<const ql::db_t> db,
+            const name_string_t &name,
+            const std::string &directory,
+            const boost::optional<repli_timestamp_t> &since,
+            signal_t *interruptor,
+            ql::datum_t *result_out,
+            admin_err_t *error_out);
+
     bool grant_global(
             auth::user_context_t const &user_context,
             auth::username_t username,
@@ -286,6 +300,7 @@ private:
     namespace_repo_t m_namespace_repo;
     ql::changefeed::client_t m_changefeed_client;
     server_config_client_t *m_server_config_client;
+    real_table_persistence_interface_t *m_table_persistence_interface;
 
     void wait_for_cluster_metadata_to_propagate(
             const cluster_semilattice_metadata_t &metadata,
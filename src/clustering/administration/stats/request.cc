@@ -39,7 +39,7 @@ parsed_stats_t::server_stats_t::server_stats_t() :
 parsed_stats_t::table_stats_t::table_stats_t() :
     read_docs_per_sec(0), read_docs_total(0),
     written_docs_per_sec(0), written_docs_total(0),
-    in_use_bytes(0), metadata_bytes(0), data_bytes(0),
+    in_use_bytes(0), target_bytes(0), metadata_bytes(0), data_bytes(0),
     garbage_bytes(0), preallocated_bytes(0),
     read_bytes_per_sec(0), read_bytes_total(0),
     written_bytes_per_sec(0), written_bytes_total(0) { }
@@ -125,6 +125,8 @@ void parsed_stats_t::store_shard_values(const ql::datum_t &shard_perf,
                 } else if (key == "cache") {
                     add_perfmon_value(sub_pair.second, "in_use_bytes",
                                       &stats_out->in_use_bytes);
+                    add_perfmon_value(sub_pair.second, "target_bytes",
+                                      &stats_out->target_bytes);
                 }
             }
         }
@@ -552,6 +554,7 @@ bool table_server_stats_request_t::to_datum(const parsed_stats_t &stats,
 
         ql::datum_object_builder_t se_cache_builder;
         ADD_STAT(se_cache_builder, table_stats, in_use_bytes);
+        ADD_STAT(se_cache_builder, table_stats, target_bytes);
 
         ql::datum_object_builder_t se_disk_space_builder;
         ADD_STAT(se_disk_space_builder, table_stats, metadata_bytes);
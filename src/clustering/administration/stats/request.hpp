@@ -28,6 +28,7 @@ public:
         double written_docs_per_sec;
         double written_docs_total;
         double in_use_bytes;
+        double target_bytes;
         double metadata_bytes;
         double data_bytes;
         double garbage_bytes;
@@ -2,6 +2,7 @@
 #include "clustering/administration/tables/table_config.hpp"
 
 #include "clustering/administration/datum_adapter.hpp"
+#include "clustering/administration/main/cache_size.hpp"
 #include "clustering/administration/metadata.hpp"
 #include "clustering/administration/tables/generate_config.hpp"
 #include "clustering/administration/tables/split_points.hpp"
@@ -9,6 +10,7 @@
 #include "concurrency/cross_thread_signal.hpp"
 #include "containers/archive/string_stream.hpp"
 #include "rdb_protocol/terms/write_hook.hpp"
+#include "serializer/log/config.hpp"
 
 table_config_artificial_table_backend_t::table_config_artificial_table_backend_t(
         rdb_context_t *_rdb_context,
@@ -175,6 +177,8 @@ ql::datum_t convert_write_ack_config_to_datum(
             return ql::datum_t("single");
         case write_ack_config_t::MAJORITY:
             return ql::datum_t("majority");
+        case write_ack_config_t::LOCAL_MAJORITY:
+            return ql::datum_t("local_majority");
         default:
             unreachable();
     }
@@ -188,9 +192,12 @@ bool convert_write_ack_config_from_datum(
         *config_out = write_ack_config_t::SINGLE;
     } else if (datum == ql::datum_t("majority")) {
         *config_out = write_ack_config_t::MAJORITY;
+    } else if (datum == ql::datum_t("local_majority")) {
+        *config_out = write_ack_config_t::LOCAL_MAJORITY;
     } else {
         *error_out = admin_err_t{
-            "Expected \"single\" or \"majority\", got: " + datum.print(),
+            "Expected \"single\", \"majority\", or \"local_majority\", got: " +
+                datum.print(),
             query_state_t::FAILED};
         return false;
     }
@@ -227,6 +234,104 @@ bool convert_durability_from_datum(
     return true;
 }
 
+bool convert_block_size_from_datum(
+        const ql::datum_t &datum,
+        uint64_t *block_size_out,
+        admin_err_t *error_out) {
+    if (datum.get_type() == ql::datum_t::R_NUM
+            && datum.as_num() >= MIN_BTREE_BLOCK_SIZE
+            && datum.as_num() <= MAX_BTREE_BLOCK_SIZE
+            && static_cast<double>(static_cast<uint64_t>(datum.as_num()))
+                == datum.as_num()
+            && is_valid_btree_block_size(static_cast<uint64_t>(datum.as_num()))) {
+        *block_size_out = static_cast<uint64_t>(datum.as_num());
+        return true;
+    }
+    *error_out = admin_err_t{
+        strprintf("Expected a power of two between %" PRIu64 " and %" PRIu64
+                  ", got: %s",
+                  static_cast<uint64_t>(MIN_BTREE_BLOCK_SIZE),
+                  static_cast<uint64_t>(MAX_BTREE_BLOCK_SIZE),
+                  datum.print().c_str()),
+        query_state_t::FAILED};
+    return false;
+}
+
+ql::datum_t convert_cache_policy_to_datum(
+        const cache_policy_t &policy) {
+    ql::datum_object_builder_t builder;
+    builder.overwrite("priority", ql::datum_t(policy.priority));
+    builder.overwrite("reserved_bytes",
+        ql::datum_t(static_cast<double>(policy.reserved_bytes)));
+    builder.overwrite("pinned", ql::datum_t::boolean(policy.pinned));
+    return std::move(builder).to_datum();
+}
+
+/* Fields that are missing from `datum` keep their default values. */
+bool convert_cache_policy_from_datum(
+        const ql::datum_t &datum,
+        cache_policy_t *policy_out,
+        admin_err_t *error_out) {
+    converter_from_datum_object_t converter;
+    if (!converter.init(datum, error_out)) {
+        return false;
+    }
+    *policy_out = cache_policy_t();
+
+    if (converter.has("priority")) {
+        ql::datum_t priority_datum;
+        if (!converter.get("priority", &priority_datum, error_out)) {
+            return false;
+        }
+        if (priority_datum.get_type() != ql::datum_t::R_NUM
+                || priority_datum.as_num() <= 0
+                || priority_datum.as_num() > MAX_TABLE_CACHE_PRIORITY) {
+            *error_out = admin_err_t{
+                strprintf("In `priority`: Expected a number greater than 0 and at "
+                          "most %d, got: %s", MAX_TABLE_CACHE_PRIORITY,
+                          priority_datum.print().c_str()),
+                query_state_t::FAILED};
+            return false;
+        }
+        policy_out->priority = priority_datum.as_num();
+    }
+
+    if (converter.has("reserved_bytes")) {
+        ql::datum_t reserved_datum;
+        if (!converter.get("reserved_bytes", &reserved_datum, error_out)) {
+            return false;
+        }
+        if (reserved_datum.get_type() != ql::datum_t::R_NUM
+                || reserved_datum.as_num() < 0
+                || reserved_datum.as_num() > static_cast<double>(get_max_total_cache_size())
+                || static_cast<double>(static_cast<uint64_t>(reserved_datum.as_num()))
+                    != reserved_datum.as_num()) {
+            *error_out = admin_err_t{
+                "In `reserved_bytes`: Expected a non-negative integer no larger than "
+                "the largest legal cache size, got: " + reserved_datum.print(),
+                query_state_t::FAILED};
+            return false;
+        }
+        policy_out->reserved_bytes = static_cast<uint64_t>(reserved_datum.as_num());
+    }
+
+    if (converter.has("pinned")) {
+        ql::datum_t pinned_datum;
+        if (!converter.get("pinned", &pinned_datum, error_out)) {
+            return false;
+        }
+        if (pinned_datum.get_type() != ql::datum_t::R_BOOL) {
+            *error_out = admin_err_t{
+                "In `pinned`: Expected a boolean, got: " + pinned_datum.print(),
+                query_state_t::FAILED};
+            return false;
+        }
+        policy_out->pinned = pinned_datum.as_bool();
+    }
+
+    return converter.check_no_extra_keys(error_out);
+}
+
 ql::datum_t convert_table_config_shard_to_datum(
         const table_config_t::shard_t &shard,
         admin_identifier_format_t identifier_format,
@@ -410,6 +515,9 @@ ql::datum_t convert_table_config_to_datum(
         convert_write_ack_config_to_datum(config.write_ack_config));
     builder.overwrite("durability",
         convert_durability_to_datum(config.durability));
+    builder.overwrite("block_size",
+        ql::datum_t(static_cast<double>(config.block_size)));
+    builder.overwrite("cache", convert_cache_policy_to_datum(config.cache));
     return std::move(builder).to_datum();
 }
 
@@ -480,7 +588,8 @@ bool convert_table_config_and_name_from_datum(
     }
 
     /* As a special case, we allow the user to omit `indexes`, `primary_key`, `shards`,
-    `write_acks`, and/or `durability` for newly-created tables. */
+    `write_acks`, `durability`, `block_size`, and/or `cache` for newly-created tables.
+    */
 
     if (converter.has("indexes")) {
         ql::datum_t indexes_datum;
@@ -589,6 +698,44 @@ bool convert_table_config_and_name_from_datum(
         config_out->write_ack_config = write_ack_config_t::MAJORITY;
     }
 
+    if (config_out->write_ack_config == write_ack_config_t::LOCAL_MAJORITY) {
+        /* Sites are named by server tags, so every voter needs a tag other than
+        `default`. Servers whose config we can't see right now are let through; if
+        the primary turns out not to have a site, the table acks like `majority`. */
+        const name_string_t default_tag = name_string_t::guarantee_valid("default");
+        std::set<server_id_t> voters;
+        for (const table_config_t::shard_t &shard : config_out->shards) {
+            for (const server_id_t &server_id : shard.all_replicas) {
+                if (shard.nonvoting_replicas.count(server_id) == 0) {
+                    voters.insert(server_id);
+                }
+            }
+        }
+        for (const server_id_t &server_id : voters) {
+            bool has_site = true;
+            server_config_client->get_server_config_map()->read_key(server_id,
+                [&](const server_config_versioned_t *config) {
+                    if (config != nullptr) {
+                        std::set<name_string_t> tags = config->config.tags;
+                        tags.erase(default_tag);
+                        if (tags.empty()) {
+                            has_site = false;
+                            *error_out = admin_err_t{
+                                strprintf("In `write_acks`: `local_majority` requires "
+                                          "every voting replica to have a tag other "
+                                          "than `default` naming its site, but server "
+                                          "`%s` doesn't have one.",
+                                          config->config.name.c_str()),
+                                query_state_t::FAILED};
+                        }
+                    }
+                });
+            if (!has_site) {
+                return false;
+            }
+        }
+    }
+
     if (existed_before || converter.has("durability")) {
         ql::datum_t durability_datum;
         if (!converter.get("durability", &durability_datum, error_out)) {
@@ -603,6 +750,66 @@ bool convert_table_config_and_name_from_datum(
         config_out->durability = write_durability_t::HARD;
     }
 
+    if (existed_before || converter.has("block_size")) {
+        ql::datum_t block_size_datum;
+        if (!converter.get("block_size", &block_size_datum, error_out)) {
+            return false;
+        }
+        if (!convert_block_size_from_datum(block_size_datum, &config_out->block_size,
+                                           error_out)) {
+            error_out->msg = "In `block_size`: " + error_out->msg;
+            return false;
+        }
+    } else {
+        config_out->block_size = DEFAULT_BTREE_BLOCK_SIZE;
+    }
+
+    if (existed_before || converter.has("cache")) {
+        ql::datum_t cache_datum;
+        if (!converter.get("cache", &cache_datum, error_out)) {
+            return false;
+        }
+        if (!convert_cache_policy_from_datum(cache_datum, &config_out->cache,
+                                             error_out)) {
+            error_out->msg = "In `cache`: " + error_out->msg;
+            return false;
+        }
+    } else {
+        config_out->cache = cache_policy_t();
+    }
+
+    if (config_out->cache.reserved_bytes > 0) {
+        /* The reservation applies on every server that hosts the table.  Servers
+        that pick their cache size automatically can't be checked here, but the cache
+        balancer never hands out more than the cache size anyway. */
+        std::set<server_id_t> replicas;
+        for (const table_config_t::shard_t &shard : config_out->shards) {
+            replicas.insert(shard.all_replicas.begin(), shard.all_replicas.end());
+        }
+        for (const server_id_t &server_id : replicas) {
+            bool too_large = false;
+            server_config_client->get_server_config_map()->read_key(server_id,
+                [&](const server_config_versioned_t *config) {
+                    if (config != nullptr
+                            && static_cast<bool>(config->config.cache_size_bytes)
+                            && config->config.cache_size_bytes.get()
+                                < config_out->cache.reserved_bytes) {
+                        too_large = true;
+                        *error_out = admin_err_t{
+                            strprintf("In `cache`: `reserved_bytes` is larger than "
+                                      "the cache size of server `%s` (%" PRIu64
+                                      " bytes).",
+                                      config->config.name.c_str(),
+                                      config->config.cache_size_bytes.get()),
+                            query_state_t::FAILED};
+                    }
+                });
+            if (too_large) {
+                return false;
+            }
+        }
+    }
+
     if (converter.has("write_hook")) {
         ql::datum_t write_hook_datum;
         if (!converter.get("write_hook", &write_hook_datum, error_out)) {
@@ -652,6 +859,11 @@ void table_config_artificial_table_backend_t::do_modify(
                              query_state_t::FAILED);
     }
 
+    if (new_config.config.block_size != old_config.config.block_size) {
+        throw admin_op_exc_t("It's illegal to change a table's block size",
+                             query_state_t::FAILED);
+    }
+
     if (new_config.config.basic.database != old_config.config.basic.database ||
             new_config.config.basic.name != old_config.config.basic.name) {
         if (table_meta_client->exists(
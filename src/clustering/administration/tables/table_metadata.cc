@@ -37,6 +37,16 @@ void serialize(write_message_t *wm, const table_config_t &tc) {
 
     write_durability_t durability = tc.durability;
     serialize<W>(wm, durability);
+
+    uint64_t block_size = tc.block_size;
+    serialize<W>(wm, block_size);
+
+    double cache_priority = tc.cache.priority;
+    serialize<W>(wm, cache_priority);
+    uint64_t cache_reserved_bytes = tc.cache.reserved_bytes;
+    serialize<W>(wm, cache_reserved_bytes);
+    bool cache_pinned = tc.cache.pinned;
+    serialize<W>(wm, cache_pinned);
 }
 
 INSTANTIATE_SERIALIZE_FOR_CLUSTER_AND_DISK(table_config_t);
@@ -71,12 +81,14 @@ archive_result_t deserialize_table_config_pre_v2_4(
     tc->sindexes = std::move(sindexes);
     tc->write_ack_config = std::move(write_ack_config);
     tc->durability = std::move(durability);
+    tc->block_size = DEFAULT_BTREE_BLOCK_SIZE;
+    tc->cache = cache_policy_t();
 
     return res;
 }
 
-template <cluster_version_t  W>
-archive_result_t deserialize(
+template <cluster_version_t W>
+archive_result_t deserialize_table_config_pre_v2_5(
     read_stream_t *s, table_config_t *tc) {
     archive_result_t res;
 
@@ -104,12 +116,36 @@ archive_result_t deserialize(
     res = deserialize<W>(s, &durability);
     if (bad(res)) { return res; }
 
-    *tc = table_config_t{std::move(basic),
-                         std::move(shards),
-                         std::move(sindexes),
-                         std::move(write_hook),
-                         std::move(write_ack_config),
-                         std::move(durability)};
+    tc->basic = std::move(basic);
+    tc->shards = std::move(shards);
+    tc->sindexes = std::move(sindexes);
+    tc->write_hook = std::move(write_hook);
+    tc->write_ack_config = std::move(write_ack_config);
+    tc->durability = std::move(durability);
+    tc->block_size = DEFAULT_BTREE_BLOCK_SIZE;
+    tc->cache = cache_policy_t();
+
+    return res;
+}
+
+template <cluster_version_t W>
+archive_result_t deserialize(
+    read_stream_t *s, table_config_t *tc) {
+    archive_result_t res = deserialize_table_config_pre_v2_5<W>(s, tc);
+    if (bad(res)) { return res; }
+
+    uint64_t block_size;
+    res = deserialize<W>(s, &block_size);
+    if (bad(res)) { return res; }
+
+    tc->block_size = block_size;
+
+    res = deserialize<W>(s, &tc->cache.priority);
+    if (bad(res)) { return res; }
+    res = deserialize<W>(s, &tc->cache.reserved_bytes);
+    if (bad(res)) { return res; }
+    res = deserialize<W>(s, &tc->cache.pinned);
+    if (bad(res)) { return res; }
 
     return res;
 }
@@ -132,11 +168,18 @@ archive_result_t deserialize<cluster_version_t::v2_3>(
     return deserialize_table_config_pre_v2_4<cluster_version_t::v2_4>(s, tc);
 }
 
-template archive_result_t deserialize<cluster_version_t::v2_4_is_latest>(
+template <>
+archive_result_t deserialize<cluster_version_t::v2_4>(
+    read_stream_t *s, table_config_t *tc) {
+    return deserialize_table_config_pre_v2_5<cluster_version_t::v2_4>(s, tc);
+}
+
+template archive_result_t deserialize<cluster_version_t::v2_5_is_latest>(
     read_stream_t *, table_config_t *);
 
-RDB_IMPL_EQUALITY_COMPARABLE_6(table_config_t,
-    basic, shards, write_hook, sindexes, write_ack_config, durability);
+RDB_IMPL_EQUALITY_COMPARABLE_8(table_config_t,
+    basic, shards, write_hook, sindexes, write_ack_config, durability, block_size,
+    cache);
 
 RDB_IMPL_SERIALIZABLE_1_SINCE_v1_16(table_shard_scheme_t, split_points);
 RDB_IMPL_EQUALITY_COMPARABLE_1(table_shard_scheme_t, split_points);
@@ -36,15 +36,21 @@ public:
 RDB_DECLARE_SERIALIZABLE(table_basic_config_t);
 RDB_DECLARE_EQUALITY_COMPARABLE(table_basic_config_t);
 
+/* With `LOCAL_MAJORITY`, a write is acked once a majority of the voting replicas in
+the primary's site have it. A server's sites are its tags other than `default`, and
+`table_config` refuses `LOCAL_MAJORITY` if one of the voters doesn't have any. Acks
+from other sites are still collected but never waited on, so a site failure can lose
+writes that were acked but hadn't replicated across yet. */
 enum class write_ack_config_t {
     SINGLE,
-    MAJORITY
+    MAJORITY,
+    LOCAL_MAJORITY
 };
 ARCHIVE_PRIM_MAKE_RANGED_SERIALIZABLE(
     write_ack_config_t,
     int8_t,
     write_ack_config_t::SINGLE,
-    write_ack_config_t::MAJORITY);
+    write_ack_config_t::LOCAL_MAJORITY);
 
 /* `table_config_t` describes the complete contents of the `rethinkdb.table_config`
 artificial table. */
@@ -74,6 +80,14 @@ public:
     boost::optional<write_hook_config_t> write_hook;
     write_ack_config_t write_ack_config;
     write_durability_t durability;
+    /* The size in bytes of the blocks in the table's files, which is fixed when the
+    table is created. Larger blocks hold more keys per btree node and more of a large
+    document per blob block, at the cost of reading and writing more for small
+    documents. */
+    uint64_t block_size;
+    /* How the servers' cache balancers treat the table's caches. `reserved_bytes` is
+    the reservation on each server that has a replica of the table. */
+    cache_policy_t cache;
 };
 
 RDB_DECLARE_EQUALITY_COMPARABLE(table_config_t);
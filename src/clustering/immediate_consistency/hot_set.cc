@@ -0,0 +1,41 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "clustering/immediate_consistency/hot_set.hpp"
+
+#include <algorithm>
+
+#include "rdb_protocol/protocol.hpp"
+
+hot_set_tracker_t::hot_set_tracker_t() : next_slot(0) { }
+
+void hot_set_tracker_t::note_read(const read_t &read) {
+    if (const point_read_t *point_read = boost::get<point_read_t>(&read.read)) {
+        note_key(point_read->key);
+    } else if (const rget_read_t *rget = boost::get<rget_read_t>(&read.read)) {
+        if (static_cast<bool>(rget->primary_keys)) {
+            /* Don't let one big `get_all` flush out everything else. */
+            size_t budget = REPLICA_HOT_SET_MAX_KEYS / 16;
+            for (const auto &pair : *rget->primary_keys) {
+                if (budget-- == 0) {
+                    break;
+                }
+                note_key(pair.first);
+            }
+        }
+    }
+}
+
+std::vector<store_key_t> hot_set_tracker_t::get_keys() const {
+    std::vector<store_key_t> keys = ring;
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
+
+void hot_set_tracker_t::note_key(const store_key_t &key) {
+    if (ring.size() < REPLICA_HOT_SET_MAX_KEYS) {
+        ring.push_back(key);
+    } else {
+        ring[next_slot] = key;
+        next_slot = (next_slot + 1) % REPLICA_HOT_SET_MAX_KEYS;
+    }
+}
@@ -0,0 +1,38 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef CLUSTERING_IMMEDIATE_CONSISTENCY_HOT_SET_HPP_
+#define CLUSTERING_IMMEDIATE_CONSISTENCY_HOT_SET_HPP_
+
+#include <vector>
+
+#include "btree/keys.hpp"
+
+class read_t;
+
+/* `hot_set_tracker_t` remembers the primary keys of the most recent point reads and
+`get_all` reads that went through a `primary_dispatcher_t`. Since reads normally go to
+the primary, the secondaries' caches mostly hold pages that were touched by writes; the
+`remote_replicator_server_t` periodically sends the keys in here to the secondaries, so
+that they can warm their caches with the same pages and a failover doesn't start out
+with a cold cache.
+
+Keys are kept in a fixed-size ring, so recording a read is O(1) and the memory usage is
+bounded. A key that is read often will occupy several slots, which doesn't matter
+because `get_keys()` deduplicates them. */
+
+class hot_set_tracker_t {
+public:
+    hot_set_tracker_t();
+
+    void note_read(const read_t &read);
+
+    /* Returns the distinct keys in the ring, in sorted order. */
+    std::vector<store_key_t> get_keys() const;
+
+private:
+    void note_key(const store_key_t &key);
+
+    std::vector<store_key_t> ring;
+    size_t next_slot;
+};
+
+#endif /* CLUSTERING_IMMEDIATE_CONSISTENCY_HOT_SET_HPP_ */
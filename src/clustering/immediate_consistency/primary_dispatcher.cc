@@ -91,6 +91,8 @@ void primary_dispatcher_t::read(
     rassert(region_is_superset(branch_bc.get_region(), _read.get_region()));
     order_token.assert_read_mode();
 
+    hot_set.note_read(_read);
+
     dispatchee_registration_t *dispatchee = nullptr;
     auto_drainer_t::lock_t dispatchee_lock;
     state_timestamp_t min_timestamp;
@@ -188,12 +190,24 @@ void primary_dispatcher_t::spawn_write(
     cb->write = incomplete_write.get();
 
     for (const auto &pair : dispatchees) {
+        write_durability_t dispatchee_durability =
+            nonvoting_replicas.count(pair.first->server_id) == 1
+                    && !pair.first->dispatchee->is_primary()
+                ? write_durability_t::SOFT
+                : durability;
         pair.first->background_write_queue.push(
             std::bind(&primary_dispatcher_t::background_write, this,
-                pair.first, pair.second, incomplete_write));
+                pair.first, pair.second, incomplete_write, dispatchee_durability));
     }
 }
 
+void primary_dispatcher_t::set_nonvoting_replicas(
+        const std::set<server_id_t> &servers) {
+    assert_thread();
+    DEBUG_VAR mutex_assertion_t::acq_t mutex_acq(&mutex);
+    nonvoting_replicas = servers;
+}
+
 primary_dispatcher_t::incomplete_write_t::incomplete_write_t(
         const write_t &w, state_timestamp_t ts, order_token_t ot,
         write_durability_t dur, write_callback_t *cb) :
@@ -211,7 +225,8 @@ primary_dispatcher_t::incomplete_write_t::~incomplete_write_t() {
 void primary_dispatcher_t::background_write(
         dispatchee_registration_t *dispatchee,
         auto_drainer_t::lock_t dispatchee_lock,
-        counted_t<incomplete_write_t> write) THROWS_NOTHING {
+        counted_t<incomplete_write_t> write,
+        write_durability_t durability) THROWS_NOTHING {
     try {
         /* Use a special path for dummy writes.
         dummy writes are used to check the table status, so we don't want to generate
@@ -234,7 +249,7 @@ void primary_dispatcher_t::background_write(
         if (dispatchee->is_ready) {
             write_response_t response;
             dispatchee->dispatchee->do_write_sync(
-                write->write, write->timestamp, write->order_token, write->durability,
+                write->write, write->timestamp, write->order_token, durability,
                 dispatchee_lock.get_drain_signal(), &response);
 
             /* Update latest acked write on the distpatchee so we can route queries
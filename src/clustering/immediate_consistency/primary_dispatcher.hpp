@@ -3,6 +3,7 @@
 #define CLUSTERING_IMMEDIATE_CONSISTENCY_PRIMARY_DISPATCHER_HPP_
 
 #include "clustering/immediate_consistency/history.hpp"
+#include "clustering/immediate_consistency/hot_set.hpp"
 #include "concurrency/coro_pool.hpp"
 #include "concurrency/queue/unlimited_fifo.hpp"
 #include "concurrency/watchable.hpp"
@@ -173,10 +174,20 @@ public:
         order_token_t tok,
         write_callback_t *cb);
 
+    /* Writes to non-voting replicas are performed with soft durability, since their
+    acks never count towards making a write safe. Call this whenever the set of
+    non-voting replicas changes; it applies to writes spawned afterwards. */
+    void set_nonvoting_replicas(const std::set<server_id_t> &servers);
+
     clone_ptr_t<watchable_t<std::set<server_id_t> > > get_ready_dispatchees() {
         return ready_dispatchees_as_set.get_watchable();
     }
 
+    /* The keys that were recently read through this dispatcher. */
+    const hot_set_tracker_t *get_hot_set() const {
+        return &hot_set;
+    }
+
 private:
     /* `incomplete_write_t` bundles all of the information related to a given write into
     a single struct. When it is destroyed, it calls `on_end()` on the callback. */
@@ -196,7 +207,8 @@ private:
     void background_write(
         dispatchee_registration_t *dispatchee,
         auto_drainer_t::lock_t dispatchee_lock,
-        counted_t<incomplete_write_t> write) THROWS_NOTHING;
+        counted_t<incomplete_write_t> write,
+        write_durability_t durability) THROWS_NOTHING;
 
     void refresh_ready_dispatchees_as_set();
 
@@ -219,11 +231,15 @@ private:
 
     std::map<dispatchee_registration_t *, auto_drainer_t::lock_t> dispatchees;
 
+    std::set<server_id_t> nonvoting_replicas;
+
     /* This is just a set that contains the peer ID of each dispatchee in `dispatchees`
     that's readable. We store it separately so we can expose it to code that needs to
     know which replicas are available. */
     watchable_variable_t<std::set<server_id_t> > ready_dispatchees_as_set;
 
+    hot_set_tracker_t hot_set;
+
     DISABLE_COPYING(primary_dispatcher_t);
 };
 
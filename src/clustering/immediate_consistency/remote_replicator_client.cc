@@ -162,6 +162,8 @@ remote_replicator_client_t::remote_replicator_client_t(
 
     next_write_waiter_(nullptr),
 
+    warming_cache_(false),
+
     write_async_mailbox_(mailbox_manager,
         std::bind(&remote_replicator_client_t::on_write_async, this,
             ph::_1, ph::_2, ph::_3, ph::_4, ph::_5)),
@@ -173,7 +175,10 @@ remote_replicator_client_t::remote_replicator_client_t(
             ph::_1, ph::_2)),
     read_mailbox_(mailbox_manager,
         std::bind(&remote_replicator_client_t::on_read, this,
-            ph::_1, ph::_2, ph::_3, ph::_4))
+            ph::_1, ph::_2, ph::_3, ph::_4)),
+    hot_set_mailbox_(mailbox_manager,
+        std::bind(&remote_replicator_client_t::on_hot_set, this,
+            ph::_1, ph::_2))
 {
     guarantee(remote_replicator_server_bcard.branch == branch_id);
     guarantee(remote_replicator_server_bcard.region == region_);
@@ -211,7 +216,8 @@ remote_replicator_client_t::remote_replicator_client_t(
             write_async_mailbox_.get_address(),
             write_sync_mailbox_.get_address(),
             dummy_write_mailbox_.get_address(),
-            read_mailbox_.get_address() };
+            read_mailbox_.get_address(),
+            hot_set_mailbox_.get_address() };
         registrant_.init(new registrant_t<remote_replicator_client_bcard_t>(
             mailbox_manager, remote_replicator_server_bcard.registrar, our_bcard));
         wait_interruptible(&got_intro, interruptor);
@@ -486,6 +492,19 @@ void remote_replicator_client_t::on_read(
     send(mailbox_manager_, ack_addr, response);
 }
 
+void remote_replicator_client_t::on_hot_set(
+        signal_t *interruptor,
+        const std::vector<store_key_t> &keys)
+        THROWS_ONLY(interrupted_exc_t) {
+    /* Pages loaded during the backfill would just get evicted again by the backfill, so
+    we only warm the cache once we're streaming. */
+    if (mode_ != backfill_mode_t::STREAMING || warming_cache_) {
+        return;
+    }
+    assignment_sentry_t<bool> warming_cache_sentry(&warming_cache_, true);
+    store_->warm_cache(keys, interruptor);
+}
+
 bool remote_replicator_client_t::next_write_can_proceed(
         mutex_assertion_t::acq_t *mutex_assertion_acq) {
     mutex_assertion_acq->assert_is_holding(&mutex_assertion_);
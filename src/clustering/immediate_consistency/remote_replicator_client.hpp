@@ -78,9 +78,10 @@ public:
 private:
     class timestamp_range_tracker_t;
 
-    /* `on_write_async()`, `on_write_sync()`, `on_dummy_write()`, and `on_read()`
-    are mailbox callbacks for `write_async_mailbox_`, `write_sync_mailbox_`,
-    `dummy_write_mailbox_` and `read_mailbox_`. */
+    /* `on_write_async()`, `on_write_sync()`, `on_dummy_write()`, `on_read()`, and
+    `on_hot_set()` are mailbox callbacks for `write_async_mailbox_`,
+    `write_sync_mailbox_`, `dummy_write_mailbox_`, `read_mailbox_`, and
+    `hot_set_mailbox_`. */
     void on_write_async(
             signal_t *interruptor,
             write_t &&write,
@@ -110,6 +111,11 @@ private:
             const mailbox_t<void(read_response_t)>::address_t &ack_addr)
         THROWS_ONLY(interrupted_exc_t);
 
+    void on_hot_set(
+            signal_t *interruptor,
+            const std::vector<store_key_t> &keys)
+        THROWS_ONLY(interrupted_exc_t);
+
     mailbox_manager_t *const mailbox_manager_;
     store_view_t *const store_;
     region_t const region_;   /* same as `store_->get_region()` */
@@ -170,10 +176,15 @@ private:
     acquires it in write mode. */
     rwlock_t cleanup_rwlock_;
 
+    /* `warming_cache_` is `true` while `on_hot_set()` is loading pages into the cache.
+    Hot sets that arrive in the meantime are dropped. */
+    bool warming_cache_;
+
     remote_replicator_client_bcard_t::write_async_mailbox_t write_async_mailbox_;
     remote_replicator_client_bcard_t::write_sync_mailbox_t write_sync_mailbox_;
     remote_replicator_client_bcard_t::dummy_write_mailbox_t dummy_write_mailbox_;
     remote_replicator_client_bcard_t::read_mailbox_t read_mailbox_;
+    remote_replicator_client_bcard_t::hot_set_mailbox_t hot_set_mailbox_;
 
     /* We use `registrant_` to subscribe to a stream of reads and writes from the
     dispatcher via the `remote_replicator_server_t`. */
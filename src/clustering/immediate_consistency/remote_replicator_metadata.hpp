@@ -36,6 +36,9 @@ public:
         read_t, state_timestamp_t,
         mailbox_t<void(read_response_t)>::address_t
         )> read_mailbox_t;
+    typedef mailbox_t<void(
+        std::vector<store_key_t>
+        )> hot_set_mailbox_t;
 
     server_id_t server_id;
     intro_mailbox_t::address_t intro_mailbox;
@@ -43,6 +46,7 @@ public:
     write_sync_mailbox_t::address_t write_sync_mailbox;
     dummy_write_mailbox_t::address_t dummy_write_mailbox;
     read_mailbox_t::address_t read_mailbox;
+    hot_set_mailbox_t::address_t hot_set_mailbox;
 };
 
 RDB_DECLARE_SERIALIZABLE(remote_replicator_client_bcard_t);
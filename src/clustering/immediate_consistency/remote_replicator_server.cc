@@ -101,5 +101,21 @@ void remote_replicator_server_t::proxy_replica_t::on_ready(signal_t *) {
     guarantee(!is_ready);
     is_ready = true;
     registration->mark_ready();
+    hot_set_timer.init(new repeating_timer_t(
+        REPLICA_HOT_SET_HINT_INTERVAL_MS,
+        [this]() {
+            coro_t::spawn_sometime(std::bind(
+                &proxy_replica_t::send_hot_set, this, drainer.lock()));
+        }));
+}
+
+void remote_replicator_server_t::proxy_replica_t::send_hot_set(
+        UNUSED auto_drainer_t::lock_t keepalive) {
+    std::vector<store_key_t> hot_set = parent->primary->get_hot_set()->get_keys();
+    if (hot_set.empty() || hot_set == last_hot_set) {
+        return;
+    }
+    send(parent->mailbox_manager, client_bcard.hot_set_mailbox, hot_set);
+    last_hot_set = std::move(hot_set);
 }
 
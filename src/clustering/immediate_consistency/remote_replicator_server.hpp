@@ -2,6 +2,7 @@
 #ifndef CLUSTERING_IMMEDIATE_CONSISTENCY_REMOTE_REPLICATOR_SERVER_HPP_
 #define CLUSTERING_IMMEDIATE_CONSISTENCY_REMOTE_REPLICATOR_SERVER_HPP_
 
+#include "arch/timing.hpp"
 #include "clustering/generic/registrar.hpp"
 #include "clustering/immediate_consistency/primary_dispatcher.hpp"
 #include "clustering/immediate_consistency/remote_replicator_metadata.hpp"
@@ -66,6 +67,10 @@ private:
     private:
         void on_ready(signal_t *interruptor);
 
+        /* Sends the primary's hot read set to the replica, unless it hasn't changed
+        since the last time. */
+        void send_hot_set(auto_drainer_t::lock_t keepalive);
+
         remote_replicator_client_bcard_t client_bcard;
         remote_replicator_server_t *parent;
         bool is_ready;
@@ -74,6 +79,13 @@ private:
         // that `registration` is still valid.
         scoped_ptr_t<primary_dispatcher_t::dispatchee_registration_t> registration;
         remote_replicator_client_intro_t::ready_mailbox_t ready_mailbox;
+
+        std::vector<store_key_t> last_hot_set;
+
+        /* Once the replica is ready, `hot_set_timer` periodically calls
+        `send_hot_set()`. It's destroyed before `drainer`. */
+        auto_drainer_t drainer;
+        scoped_ptr_t<repeating_timer_t> hot_set_timer;
     };
 
     mailbox_manager_t *mailbox_manager;
@@ -515,6 +515,255 @@ contract_t calculate_contract(
     return new_c;
 }
 
+contract_calculation_cache_t::contract_calculation_cache_t() :
+    contracts_recalculated(0), contracts_reused(0), calculation_ticks(0),
+    valid(false) { }
+
+void contract_calculation_cache_t::invalidate_contract(
+        const contract_id_t &contract_id) {
+    entries.erase(contract_id);
+}
+
+void contract_calculation_cache_t::invalidate_server(const server_id_t &server_id) {
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (it->second.servers.count(server_id) == 1) {
+            entries.erase(it++);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void contract_calculation_cache_t::prepare(const table_raft_state_t &state) {
+    /* Branch birth certificates never change, so it's enough to compare the IDs of the
+    branches in the branch history. */
+    bool same_branches = valid &&
+        known_branches.size() == state.branch_history.branches.size();
+    if (same_branches) {
+        auto it = known_branches.begin();
+        for (const auto &pair : state.branch_history.branches) {
+            if (*it != pair.first) {
+                same_branches = false;
+                break;
+            }
+            ++it;
+        }
+    }
+    if (!same_branches ||
+            !(config == state.config) ||
+            !(current_branches == state.current_branches)) {
+        entries.clear();
+        config = state.config;
+        current_branches = state.current_branches;
+        known_branches.clear();
+        for (const auto &pair : state.branch_history.branches) {
+            known_branches.insert(known_branches.end(), pair.first);
+        }
+        valid = true;
+    }
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (state.contracts.count(it->first) == 0) {
+            entries.erase(it++);
+        } else {
+            ++it;
+        }
+    }
+}
+
+/* `calculate_contracts_for_contract()` does the part of `calculate_all_contracts()` that
+only concerns a single one of the old contracts. It puts its results into `entry_out`
+instead of the final outputs so that `calculate_all_contracts()` can cache them. */
+void calculate_contracts_for_contract(
+        const table_raft_state_t &old_state,
+        const contract_id_t &contract_id,
+        const std::pair<region_t, contract_t> &old_contract_pair,
+        const std::map<contract_id_t, std::map<server_id_t, contract_ack_t> > &acks,
+        watchable_map_t<std::pair<server_id_t, server_id_t>, empty_value_t>
+            *connections_map,
+        contract_calculation_cache_t::entry_t *entry_out) {
+    const contract_t &old_contract = old_contract_pair.second;
+
+    /* Find acks for this contract. If there aren't any acks for this contract, then
+    `acks` might not even have an empty map, so we need to construct an empty map in that
+    case. */
+    const std::map<server_id_t, contract_ack_t> *this_contract_acks;
+    {
+        static const std::map<server_id_t, contract_ack_t> empty_ack_map;
+        auto it = acks.find(contract_id);
+        this_contract_acks = (it == acks.end()) ? &empty_ack_map : &it->second;
+    }
+
+    /* Record which servers' connectivity the new contracts depend on, so the cache entry
+    can be invalidated when it changes. */
+    entry_out->servers = old_contract.replicas;
+    entry_out->servers.insert(old_contract.voters.begin(), old_contract.voters.end());
+    if (static_cast<bool>(old_contract.temp_voters)) {
+        entry_out->servers.insert(
+            old_contract.temp_voters->begin(), old_contract.temp_voters->end());
+    }
+    if (static_cast<bool>(old_contract.primary)) {
+        entry_out->servers.insert(old_contract.primary->server);
+    }
+    for (const auto &pair : *this_contract_acks) {
+        entry_out->servers.insert(pair.first);
+    }
+
+    /* Iterate over all shards of the table config and find the ones that overlap the
+    contract in question: */
+    for (size_t shard_index = 0; shard_index < old_state.config.config.shards.size();
+            ++shard_index) {
+        const table_config_t::shard_t &shard = old_state.config.config.shards[shard_index];
+        region_t region = region_intersection(
+            old_contract_pair.first,
+            region_t(old_state.config.shard_scheme.get_shard_range(shard_index)));
+        if (region_is_empty(region)) {
+            continue;
+        }
+        entry_out->servers.insert(shard.all_replicas.begin(), shard.all_replicas.end());
+
+        /* Now collect the acks for this contract into `ack_frags`. `ack_frags` is
+        homogeneous at first and then it gets fragmented as we iterate over `acks`. */
+        region_map_t<std::map<server_id_t, contract_ack_frag_t> > frags_by_server(
+            region);
+        for (const auto &pair : *this_contract_acks) {
+            /* Sanity-check the ack */
+            DEBUG_ONLY_CODE(pair.second.sanity_check(
+                pair.first, contract_id, old_state));
+
+            /* There are two situations where we don't compute the common ancestor:
+            1. If the server sending the ack is not in `voters` or `temp_voters`
+            2. If the contract has the `after_emergency_repair` flag set
+            In these situations, we don't need the common ancestor, but computing it
+            might be dangerous because the branch history might be incomplete. */
+            bool compute_common_ancestor =
+                (old_contract.voters.count(pair.first) == 1 ||
+                    (static_cast<bool>(old_contract.temp_voters) &&
+                        old_contract.temp_voters->count(pair.first) == 1)) &&
+                !old_contract.after_emergency_repair;
+
+            region_map_t<contract_ack_frag_t> frags = break_ack_into_fragments(
+                region, pair.second, old_state.current_branches,
+                &old_state.branch_history, compute_common_ancestor);
+
+            frags.visit(region,
+            [&](const region_t &reg, const contract_ack_frag_t &frag) {
+                frags_by_server.visit_mutable(reg,
+                [&](const region_t &,
+                        std::map<server_id_t, contract_ack_frag_t> *acks_map) {
+                    auto res = acks_map->insert(
+                        std::make_pair(pair.first, frag));
+                    guarantee(res.second);
+                });
+            });
+        }
+
+        frags_by_server.visit(region,
+        [&](const region_t &reg,
+                const std::map<server_id_t, contract_ack_frag_t> &acks_map) {
+            /* We've finally collected all the inputs to `calculate_contract()` and
+            broken the key space into regions across which the inputs are homogeneous.
+            So now we can actually call it. */
+
+            contract_t new_contract = calculate_contract(
+                old_contract,
+                shard,
+                acks_map,
+                connections_map);
+
+            /* Register a branch if a primary is asking us to */
+            if (static_cast<bool>(old_contract.primary) &&
+                    static_cast<bool>(new_contract.primary) &&
+                    old_contract.primary->server ==
+                        new_contract.primary->server &&
+                    acks_map.count(old_contract.primary->server) == 1 &&
+                    acks_map.at(old_contract.primary->server).state ==
+                        contract_ack_t::state_t::primary_need_branch) {
+                branch_id_t to_register =
+                    *acks_map.at(old_contract.primary->server).branch;
+                bool already_registered = true;
+                old_state.current_branches.visit(reg,
+                [&](const region_t &, const branch_id_t &cur_branch) {
+                    already_registered &= (cur_branch == to_register);
+                });
+                if (!already_registered) {
+                    auto res = entry_out->register_current_branches.insert(
+                        std::make_pair(reg, to_register));
+                    guarantee(res.second);
+                    /* Due to branch garbage collection on the executor,
+                    the branch history in the contract_ack might be incomplete.
+                    Usually this isn't a problem, because the executor is
+                    only going to garbage collect branches when it is sure
+                    that the current branches are already present in the Raft
+                    state. In that case `copy_branch_history_for_branch()` is
+                    not going to traverse to the GCed branches.
+                    However this assumption no longer holds if the Raft state
+                    has just been overwritten by an emergency repair operation.
+                    Hence we ignore missing branches in the copy operation. */
+                    bool ignore_missing_branches
+                        = old_contract.after_emergency_repair;
+                    copy_branch_history_for_branch(
+                        to_register,
+                        this_contract_acks->at(
+                            old_contract.primary->server).branch_history,
+                        old_state,
+                        ignore_missing_branches,
+                        &entry_out->add_branches);
+                }
+            }
+
+            /* Check to what extent we can confirm that the replicas are on
+            `current_branch`. We'll use this to determine when it's safe to GC and
+            whether we can switch off the `after_emergency_repair` flag (if it was
+            on). */
+            bool can_gc_branch_history = true, can_end_after_emergency_repair = true;
+            for (const server_id_t &server : new_contract.replicas) {
+                auto it = this_contract_acks->find(server);
+                if (it == this_contract_acks->end() || (
+                        it->second.state !=
+                            contract_ack_t::state_t::primary_ready &&
+                        it->second.state !=
+                            contract_ack_t::state_t::secondary_streaming)) {
+                    /* At least one replica can't be confirmed to be on
+                    `current_branch`, so we should keep the branch history around in
+                    order to make it easy for that replica to rejoin later. */
+                    can_gc_branch_history = false;
+
+                    if (new_contract.voters.count(server) == 1 ||
+                            (static_cast<bool>(new_contract.temp_voters) &&
+                                new_contract.temp_voters->count(server) == 1)) {
+                        /* If the `after_emergency_repair` flag is set to `true`, we
+                        need to leave it set to `true` until we can confirm that
+                        the branch history is intact. */
+                        can_end_after_emergency_repair = false;
+                    }
+                }
+            }
+
+            /* Branch history GC. The key decision is whether we should only keep
+            `current_branch`, or whether we need to keep all of its ancestors too. The
+            actual marking happens in `calculate_all_contracts()`, since it has to look
+            at all the contracts together. */
+            old_state.current_branches.visit(reg,
+            [&](const region_t &subregion, const branch_id_t &current_branch) {
+                if (!current_branch.is_nil()) {
+                    contract_calculation_cache_t::entry_t::gc_root_t root;
+                    root.branch = current_branch;
+                    root.region = subregion;
+                    root.keep_ancestors = !can_gc_branch_history;
+                    entry_out->gc_roots.push_back(root);
+                }
+            });
+
+            if (can_end_after_emergency_repair) {
+                new_contract.after_emergency_repair = false;
+            }
+
+            entry_out->new_contract_regions.push_back(reg);
+            entry_out->new_contracts.push_back(new_contract);
+        });
+    }
+}
+
 /* `calculate_all_contracts()` is sort of like `calculate_contract()` except that it
 applies to the whole set of contracts instead of to a single contract. It takes the
 inputs that `calculate_contract()` needs, but in sharded form; then breaks the key space
@@ -530,6 +779,7 @@ void calculate_all_contracts(
         const std::map<contract_id_t, std::map<server_id_t, contract_ack_t> > &acks,
         watchable_map_t<std::pair<server_id_t, server_id_t>, empty_value_t>
             *connections_map,
+        contract_calculation_cache_t *cache,
         std::set<contract_id_t> *remove_contracts_out,
         std::map<contract_id_t, std::pair<region_t, contract_t> > *add_contracts_out,
         std::map<region_t, branch_id_t> *register_current_branches_out,
@@ -538,6 +788,11 @@ void calculate_all_contracts(
 
     ASSERT_FINITE_CORO_WAITING;
 
+    ticks_t start_ticks = get_ticks();
+    if (cache != nullptr) {
+        cache->prepare(old_state);
+    }
+
     /* Initially, we put every branch into `remove_branches_out`. Then as we process
     contracts, we "mark branches live" by removing them from `remove_branches_out`. */
     for (const auto &pair : old_state.branch_history.branches) {
@@ -547,176 +802,44 @@ void calculate_all_contracts(
     std::vector<region_t> new_contract_region_vector;
     std::vector<contract_t> new_contract_vector;
 
-    /* We want to break the key-space into sub-regions small enough that the contract,
-    table config, and ack versions are all constant across the sub-region. First we
-    iterate over all contracts: */
-    for (const std::pair<contract_id_t, std::pair<region_t, contract_t> > &cpair :
-            old_state.contracts) {
-        /* Next iterate over all shards of the table config and find the ones that
-        overlap the contract in question: */
-        for (size_t shard_index = 0; shard_index < old_state.config.config.shards.size();
-                ++shard_index) {
-            region_t region = region_intersection(
-                cpair.second.first,
-                region_t(old_state.config.shard_scheme.get_shard_range(shard_index)));
-            if (region_is_empty(region)) {
-                continue;
-            }
-
-            /* Find acks for this contract. If there aren't any acks for this contract,
-            then `acks` might not even have an empty map, so we need to construct an
-            empty map in that case. */
-            const std::map<server_id_t, contract_ack_t> *this_contract_acks;
-            {
-                static const std::map<server_id_t, contract_ack_t> empty_ack_map;
-                auto it = acks.find(cpair.first);
-                this_contract_acks = (it == acks.end()) ? &empty_ack_map : &it->second;
+    for (const auto &cpair : old_state.contracts) {
+        /* Reuse the results from the last call if none of the inputs for this contract
+        have changed since */
+        contract_calculation_cache_t::entry_t uncached_entry;
+        contract_calculation_cache_t::entry_t *entry = &uncached_entry;
+        if (cache != nullptr) {
+            auto res = cache->entries.insert(std::make_pair(
+                cpair.first, contract_calculation_cache_t::entry_t()));
+            entry = &res.first->second;
+            if (res.second) {
+                ++cache->contracts_recalculated;
+                calculate_contracts_for_contract(
+                    old_state, cpair.first, cpair.second, acks, connections_map, entry);
+            } else {
+                ++cache->contracts_reused;
             }
+        } else {
+            calculate_contracts_for_contract(
+                old_state, cpair.first, cpair.second, acks, connections_map, entry);
+        }
 
-            /* Now collect the acks for this contract into `ack_frags`. `ack_frags` is
-            homogeneous at first and then it gets fragmented as we iterate over `acks`.
-            */
-            region_map_t<std::map<server_id_t, contract_ack_frag_t> > frags_by_server(
-                region);
-            for (const auto &pair : *this_contract_acks) {
-                /* Sanity-check the ack */
-                DEBUG_ONLY_CODE(pair.second.sanity_check(
-                    pair.first, cpair.first, old_state));
-
-                /* There are two situations where we don't compute the common ancestor:
-                1. If the server sending the ack is not in `voters` or `temp_voters`
-                2. If the contract has the `after_emergency_repair` flag set
-                In these situations, we don't need the common ancestor, but computing it
-                might be dangerous because the branch history might be incomplete. */
-                bool compute_common_ancestor =
-                    (cpair.second.second.voters.count(pair.first) == 1 ||
-                        (static_cast<bool>(cpair.second.second.temp_voters) &&
-                            cpair.second.second.temp_voters->count(pair.first) == 1)) &&
-                    !cpair.second.second.after_emergency_repair;
-
-                region_map_t<contract_ack_frag_t> frags = break_ack_into_fragments(
-                    region, pair.second, old_state.current_branches,
-                    &old_state.branch_history, compute_common_ancestor);
-
-                frags.visit(region,
-                [&](const region_t &reg, const contract_ack_frag_t &frag) {
-                    frags_by_server.visit_mutable(reg,
-                    [&](const region_t &,
-                            std::map<server_id_t, contract_ack_frag_t> *acks_map) {
-                        auto res = acks_map->insert(
-                            std::make_pair(pair.first, frag));
-                        guarantee(res.second);
-                    });
-                });
+        new_contract_region_vector.insert(new_contract_region_vector.end(),
+            entry->new_contract_regions.begin(), entry->new_contract_regions.end());
+        new_contract_vector.insert(new_contract_vector.end(),
+            entry->new_contracts.begin(), entry->new_contracts.end());
+        for (const auto &pair : entry->register_current_branches) {
+            auto res = register_current_branches_out->insert(pair);
+            guarantee(res.second);
+        }
+        add_branches_out->branches.insert(
+            entry->add_branches.branches.begin(), entry->add_branches.branches.end());
+        for (const auto &root : entry->gc_roots) {
+            if (root.keep_ancestors) {
+                mark_all_ancestors_live(root.branch, root.region,
+                    &old_state.branch_history, remove_branches_out);
+            } else {
+                remove_branches_out->erase(root.branch);
             }
-
-            frags_by_server.visit(region,
-            [&](const region_t &reg,
-                    const std::map<server_id_t, contract_ack_frag_t> &acks_map) {
-                /* We've finally collected all the inputs to `calculate_contract()` and
-                broken the key space into regions across which the inputs are
-                homogeneous. So now we can actually call it. */
-
-                const contract_t &old_contract = cpair.second.second;
-
-                contract_t new_contract = calculate_contract(
-                    old_contract,
-                    old_state.config.config.shards[shard_index],
-                    acks_map,
-                    connections_map);
-
-                /* Register a branch if a primary is asking us to */
-                boost::optional<branch_id_t> registered_new_branch;
-                if (static_cast<bool>(old_contract.primary) &&
-                        static_cast<bool>(new_contract.primary) &&
-                        old_contract.primary->server ==
-                            new_contract.primary->server &&
-                        acks_map.count(old_contract.primary->server) == 1 &&
-                        acks_map.at(old_contract.primary->server).state ==
-                            contract_ack_t::state_t::primary_need_branch) {
-                    branch_id_t to_register =
-                        *acks_map.at(old_contract.primary->server).branch;
-                    bool already_registered = true;
-                    old_state.current_branches.visit(reg,
-                    [&](const region_t &, const branch_id_t &cur_branch) {
-                        already_registered &= (cur_branch == to_register);
-                    });
-                    if (!already_registered) {
-                        auto res = register_current_branches_out->insert(
-                            std::make_pair(reg, to_register));
-                        guarantee(res.second);
-                        /* Due to branch garbage collection on the executor,
-                        the branch history in the contract_ack might be incomplete.
-                        Usually this isn't a problem, because the executor is
-                        only going to garbage collect branches when it is sure
-                        that the current branches are already present in the Raft
-                        state. In that case `copy_branch_history_for_branch()` is
-                        not going to traverse to the GCed branches.
-                        However this assumption no longer holds if the Raft state
-                        has just been overwritten by an emergency repair operation.
-                        Hence we ignore missing branches in the copy operation. */
-                        bool ignore_missing_branches
-                            = old_contract.after_emergency_repair;
-                        copy_branch_history_for_branch(
-                            to_register,
-                            this_contract_acks->at(
-                                old_contract.primary->server).branch_history,
-                            old_state,
-                            ignore_missing_branches,
-                            add_branches_out);
-                        registered_new_branch = boost::make_optional(to_register);
-                    }
-                }
-
-                /* Check to what extent we can confirm that the replicas are on
-                `current_branch`. We'll use this to determine when it's safe to GC and
-                whether we can switch off the `after_emergency_repair` flag (if it was
-                on). */
-                bool can_gc_branch_history = true, can_end_after_emergency_repair = true;
-                for (const server_id_t &server : new_contract.replicas) {
-                    auto it = this_contract_acks->find(server);
-                    if (it == this_contract_acks->end() || (
-                            it->second.state !=
-                                contract_ack_t::state_t::primary_ready &&
-                            it->second.state !=
-                                contract_ack_t::state_t::secondary_streaming)) {
-                        /* At least one replica can't be confirmed to be on
-                        `current_branch`, so we should keep the branch history around in
-                        order to make it easy for that replica to rejoin later. */
-                        can_gc_branch_history = false;
-
-                        if (new_contract.voters.count(server) == 1 ||
-                                (static_cast<bool>(new_contract.temp_voters) &&
-                                    new_contract.temp_voters->count(server) == 1)) {
-                            /* If the `after_emergency_repair` flag is set to `true`, we
-                            need to leave it set to `true` until we can confirm that
-                            the branch history is intact. */
-                            can_end_after_emergency_repair = false;
-                        }
-                    }
-                }
-
-                /* Branch history GC. The key decision is whether we should only keep
-                `current_branch`, or whether we need to keep all of its ancestors too. */
-                old_state.current_branches.visit(reg,
-                [&](const region_t &subregion, const branch_id_t &current_branch) {
-                    if (!current_branch.is_nil()) {
-                        if (can_gc_branch_history) {
-                            remove_branches_out->erase(current_branch);
-                        } else {
-                            mark_all_ancestors_live(current_branch, subregion,
-                                &old_state.branch_history, remove_branches_out);
-                        }
-                    }
-                });
-
-                if (can_end_after_emergency_repair) {
-                    new_contract.after_emergency_repair = false;
-                }
-
-                new_contract_region_vector.push_back(reg);
-                new_contract_vector.push_back(new_contract);
-            });
         }
     }
 
@@ -759,5 +882,9 @@ void calculate_all_contracts(
         IDs and export them. */
         add_contracts_out->insert(std::make_pair(generate_uuid(), pair));
     }
+
+    if (cache != nullptr) {
+        cache->calculation_ticks += get_ticks() - start_ticks;
+    }
 }
 
@@ -4,12 +4,70 @@
 
 #include "clustering/table_contract/contract_metadata.hpp"
 #include "concurrency/watchable_map.hpp"
+#include "time.hpp"
 
+/* `contract_calculation_cache_t` remembers what `calculate_all_contracts()` computed for
+each of the existing contracts, so that the next call only has to recompute the
+contracts whose inputs have changed. The results for a contract only depend on the
+contract itself, the acks for it, the connectivity between the servers involved, the
+table config, the current branches and the branch history. The caller is responsible for
+calling `invalidate_contract()` when the acks for a contract change and
+`invalidate_server()` when a server's connectivity changes; changes to the rest of the
+inputs are detected by `calculate_all_contracts()` itself. */
+class contract_calculation_cache_t {
+public:
+    contract_calculation_cache_t();
+
+    void invalidate_contract(const contract_id_t &contract_id);
+    void invalidate_server(const server_id_t &server_id);
+
+    /* Counts of how many contracts `calculate_all_contracts()` had to recompute and how
+    many it could take from the cache, and the total time it spent */
+    uint64_t contracts_recalculated;
+    uint64_t contracts_reused;
+    ticks_t calculation_ticks;
+
+    class entry_t {
+    public:
+        /* A current branch in the region of one of the new contracts, and whether the
+        branch history GC has to keep all of its ancestors alive as well */
+        class gc_root_t {
+        public:
+            branch_id_t branch;
+            region_t region;
+            bool keep_ancestors;
+        };
+
+        /* The servers whose connectivity the results depend on */
+        std::set<server_id_t> servers;
+
+        std::vector<region_t> new_contract_regions;
+        std::vector<contract_t> new_contracts;
+        std::map<region_t, branch_id_t> register_current_branches;
+        branch_history_t add_branches;
+        std::vector<gc_root_t> gc_roots;
+    };
+
+    /* Drops everything if the inputs shared by all contracts have changed since the
+    last call, and drops the entries for contracts that no longer exist. */
+    void prepare(const table_raft_state_t &state);
+
+    std::map<contract_id_t, entry_t> entries;
+
+private:
+    bool valid;
+    table_config_and_shards_t config;
+    region_map_t<branch_id_t> current_branches;
+    std::set<branch_id_t> known_branches;
+};
+
+/* `cache` may be `nullptr`, in which case every contract is recomputed. */
 void calculate_all_contracts(
         const table_raft_state_t &old_state,
         const std::map<contract_id_t, std::map<server_id_t, contract_ack_t> > &acks,
         watchable_map_t<std::pair<server_id_t, server_id_t>, empty_value_t>
             *connections_map,
+        contract_calculation_cache_t *cache,
         std::set<contract_id_t> *remove_contracts_out,
         std::map<contract_id_t, std::pair<region_t, contract_t> > *add_contracts_out,
         std::map<region_t, branch_id_t> *register_current_branches_out,
@@ -17,4 +75,3 @@ void calculate_all_contracts(
         branch_history_t *add_branches_out);
 
 #endif /* CLUSTERING_TABLE_CONTRACT_COORDINATOR_CALCULATE_CONTRACTS_HPP_ */
-
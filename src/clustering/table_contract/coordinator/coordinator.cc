@@ -3,7 +3,6 @@
 
 #include "clustering/generic/raft_core.tcc"
 #include "clustering/table_contract/branch_history_gc.hpp"
-#include "clustering/table_contract/coordinator/calculate_contracts.hpp"
 #include "clustering/table_contract/coordinator/calculate_misc.hpp"
 #include "clustering/table_contract/coordinator/check_ready.hpp"
 #include "logger.hpp"
@@ -22,7 +21,8 @@ contract_coordinator_t::contract_coordinator_t(
              std::bind(&contract_coordinator_t::on_ack_change, this, ph::_1, ph::_2),
              initial_call_t::YES),
     connections_map_subs(connections_map,
-        std::bind(&pump_coro_t::notify, &contract_pumper), initial_call_t::NO)
+        std::bind(&contract_coordinator_t::on_connection_change, this, ph::_1, ph::_2),
+        initial_call_t::NO)
 {
     raft->assert_thread();
     /* Do an initial round of pumping, in case there are any changes the previous
@@ -124,15 +124,25 @@ void contract_coordinator_t::on_ack_change(
         }
     }
 
+    calculation_cache.invalidate_contract(key.second);
+    contract_pumper.notify();
+}
+
+void contract_coordinator_t::on_connection_change(
+        const std::pair<server_id_t, server_id_t> &key,
+        UNUSED const empty_value_t *value) {
+    calculation_cache.invalidate_server(key.first);
+    calculation_cache.invalidate_server(key.second);
     contract_pumper.notify();
 }
 
 void contract_coordinator_t::pump_contracts(signal_t *interruptor) {
     assert_thread();
 
-    /* Wait a little while to give changes time to accumulate, because
-    `calculate_all_contracts()` needs to examine every shard of the table even if
-    nothing about them has changed, and that might be expensive. */
+    /* Wait a little while to give changes time to accumulate, so that all of them go
+    into a single Raft transaction. `calculate_all_contracts()` only recalculates the
+    contracts that were affected by the changes, but it still has to walk over every
+    contract of the table. */
     nap(200, interruptor);
 
     /* Now we'll apply changes to Raft. We keep trying in a loop in case it
@@ -155,7 +165,7 @@ void contract_coordinator_t::pump_contracts(signal_t *interruptor) {
         raft->get_latest_state()->apply_read(
         [&](const raft_member_t<table_raft_state_t>::state_and_config_t *state) {
             calculate_all_contracts(
-                state->state, acks_by_contract, connections_map,
+                state->state, acks_by_contract, connections_map, &calculation_cache,
                 &change.remove_contracts, &change.add_contracts,
                 &change.register_current_branches,
                 &change.remove_branches, &change.add_branches);
@@ -163,6 +173,11 @@ void contract_coordinator_t::pump_contracts(signal_t *interruptor) {
                 state->state, change.remove_contracts, change.add_contracts,
                 &change.remove_server_names, &change.add_server_names);
         });
+        logDBG("Contract coordinator has recalculated %" PRIu64 " contracts and "
+               "reused %" PRIu64 ", spending %.3f s in total",
+               calculation_cache.contracts_recalculated,
+               calculation_cache.contracts_reused,
+               ticks_to_secs(calculation_cache.calculation_ticks));
 
         /* Apply the change, unless it's a no-op */
         bool change_ok;
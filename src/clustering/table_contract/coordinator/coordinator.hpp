@@ -4,6 +4,7 @@
 
 #include "clustering/generic/raft_core.hpp"
 #include "clustering/table_contract/contract_metadata.hpp"
+#include "clustering/table_contract/coordinator/calculate_contracts.hpp"
 #include "concurrency/pump_coro.hpp"
 
 /* There is one `contract_coordinator_t` per table, located on whichever server is
@@ -51,6 +52,8 @@ public:
 private:
     void on_ack_change(
         const std::pair<server_id_t, contract_id_t> &key, const contract_ack_t *ack);
+    void on_connection_change(
+        const std::pair<server_id_t, server_id_t> &key, const empty_value_t *value);
 
     /* `pump_contracts()` is what actually issues the new contracts. It eventually gets
     run after every change. */
@@ -71,6 +74,10 @@ private:
     /* This is the same as `acks` but indexed by contract. */
     std::map<contract_id_t, std::map<server_id_t, contract_ack_t> > acks_by_contract;
 
+    /* `pump_contracts()` uses this to only recalculate the contracts whose acks or
+    servers have changed since the last round. */
+    contract_calculation_cache_t calculation_cache;
+
     /* These `pump_coro_t`s are responsible for calling `pump_contracts()` and
     `pump_configs()`. Destructor order matters here. We have to destroy `ack_subs` first,
     because it notifies `contract_pumper`. Then we have to destroy `contract_pumper`,
@@ -123,6 +123,8 @@ void calculate_emergency_repair(
         new_state_out->config.config.write_ack_config =
             old_state.config.config.write_ack_config;
         new_state_out->config.config.durability = old_state.config.config.durability;
+        new_state_out->config.config.block_size = old_state.config.config.block_size;
+        new_state_out->config.config.cache = old_state.config.config.cache;
 
         /* We first calculate all the voting and nonvoting replicas for each range in a
         `range_map_t`. */
@@ -11,6 +11,7 @@
 class backfill_progress_tracker_t;
 class backfill_throttler_t;
 class io_backender_t;
+class server_config_versioned_t;
 
 /* `contract_execution_bcard_t`s are passed around between the `contract_executor_t`s for
 the same table on different servers. They allow servers to request backfills from one
@@ -44,6 +45,9 @@ public:
         watchable_map_var_t<std::pair<server_id_t, branch_id_t>,
             contract_execution_bcard_t> *local_contract_execution_bcards;
         watchable_map_var_t<uuid_u, table_query_bcard_t> *local_table_query_bcards;
+        /* Used to look up server tags for `write_acks: local_majority`. May be
+        `nullptr`, in which case every server is treated as being in the same site. */
+        watchable_map_t<server_id_t, server_config_versioned_t> *server_config_map;
     };
 
     /* There is one `params` for each `execution_t`; it holds information that's specific
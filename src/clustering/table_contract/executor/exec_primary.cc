@@ -2,6 +2,7 @@
 #include "clustering/table_contract/executor/exec_primary.hpp"
 
 #include "clustering/administration/admin_op_exc.hpp"
+#include "clustering/administration/servers/server_metadata.hpp"
 #include "clustering/immediate_consistency/local_replicator.hpp"
 #include "clustering/immediate_consistency/primary_dispatcher.hpp"
 #include "clustering/immediate_consistency/remote_replicator_server.hpp"
@@ -10,12 +11,68 @@
 #include "concurrency/promise.hpp"
 #include "store_view.hpp"
 
+/* Returns the servers whose tags say they're in the same site as the primary. The
+`default` tag doesn't name a site. If the primary doesn't have any other tags, or its
+tags aren't known, every voter counts as local, which makes `local_majority` behave
+like `majority`. */
+static std::set<server_id_t> local_voters(
+        const contract_t &contract,
+        watchable_map_t<server_id_t, server_config_versioned_t> *server_config_map) {
+    if (server_config_map == nullptr) {
+        return contract.voters;
+    }
+    const name_string_t default_tag = name_string_t::guarantee_valid("default");
+    auto sites = [&](const server_id_t &server) {
+        std::set<name_string_t> tags;
+        server_config_map->read_key(server,
+        [&](const server_config_versioned_t *config) {
+            if (config != nullptr) {
+                tags = config->config.tags;
+            }
+        });
+        tags.erase(default_tag);
+        return tags;
+    };
+    std::set<name_string_t> primary_sites = sites(contract.primary->server);
+    if (primary_sites.empty()) {
+        return contract.voters;
+    }
+    std::set<server_id_t> local;
+    for (const server_id_t &server : contract.voters) {
+        if (server == contract.primary->server) {
+            local.insert(server);
+            continue;
+        }
+        for (const name_string_t &site : sites(server)) {
+            if (primary_sites.count(site) == 1) {
+                local.insert(server);
+                break;
+            }
+        }
+    }
+    return local;
+}
+
+/* Returns the replicas that don't vote under `contract`. Those are sent their writes
+with soft durability. */
+static std::set<server_id_t> nonvoting_replicas(const contract_t &contract) {
+    std::set<server_id_t> nonvoting;
+    for (const server_id_t &server : contract.replicas) {
+        if (!contract.is_voter(server)) {
+            nonvoting.insert(server);
+        }
+    }
+    return nonvoting;
+}
+
 primary_execution_t::primary_execution_t(
         const execution_t::context_t *_context,
         execution_t::params_t *_params,
         const contract_id_t &contract_id,
         const table_raft_state_t &raft_state) :
-    execution_t(_context, _params), our_dispatcher(nullptr)
+    execution_t(_context, _params), our_dispatcher(nullptr),
+    local_voters_pumper(
+        std::bind(&primary_execution_t::update_local_voters, this, ph::_1))
 {
     const contract_t &contract = raft_state.contracts.at(contract_id).second;
     guarantee(static_cast<bool>(contract.primary));
@@ -23,13 +80,28 @@ primary_execution_t::primary_execution_t(
     guarantee(raft_state.contracts.at(contract_id).first == region);
     latest_contract_home_thread = make_counted<contract_info_t>(
         contract_id, contract, raft_state.config.config.durability,
-        raft_state.config.config.write_ack_config);
+        raft_state.config.config.write_ack_config,
+        local_voters(contract, context->server_config_map));
     latest_contract_store_thread = latest_contract_home_thread;
     begin_write_mutex_assertion.rethread(store->home_thread());
+    if (context->server_config_map != nullptr) {
+        server_config_subs.init(
+            new watchable_map_t<server_id_t, server_config_versioned_t>::all_subs_t(
+                context->server_config_map,
+                [this](const server_id_t &server, const server_config_versioned_t *) {
+                    const contract_t &contract = latest_contract_home_thread->contract;
+                    if (contract.voters.count(server) == 1) {
+                        local_voters_pumper.notify();
+                    }
+                },
+                initial_call_t::NO));
+    }
     coro_t::spawn_sometime(std::bind(&primary_execution_t::run, this, drainer.lock()));
 }
 
 primary_execution_t::~primary_execution_t() {
+    server_config_subs.reset();
+    local_voters_pumper.drain();
     drainer.drain();
     begin_write_mutex_assertion.rethread(home_thread());
 }
@@ -70,7 +142,26 @@ void primary_execution_t::update_contract_or_raft_state(
         contract_id,
         contract,
         raft_state.config.config.durability,
-        raft_state.config.config.write_ack_config);
+        raft_state.config.config.write_ack_config,
+        local_voters(contract, context->server_config_map));
+    replace_contract(new_contract);
+}
+
+void primary_execution_t::update_local_voters(UNUSED signal_t *interruptor) {
+    assert_thread();
+    ASSERT_NO_CORO_WAITING;
+    const contract_info_t &latest = *latest_contract_home_thread;
+    replace_contract(make_counted<contract_info_t>(
+        latest.contract_id,
+        latest.contract,
+        latest.default_write_durability,
+        latest.write_ack_config,
+        local_voters(latest.contract, context->server_config_map)));
+}
+
+void primary_execution_t::replace_contract(counted_t<contract_info_t> new_contract) {
+    assert_thread();
+    ASSERT_NO_CORO_WAITING;
 
     /* Exit early if there aren't actually any changes. This is for performance reasons.
     */
@@ -100,7 +191,7 @@ void primary_execution_t::update_contract_or_raft_state(
 
     /* Send an ack for the new contract */
     if (static_cast<bool>(latest_ack)) {
-        params->send_ack(contract_id, *latest_ack);
+        params->send_ack(new_contract->contract_id, *latest_ack);
     }
 }
 
@@ -189,6 +280,13 @@ void primary_execution_t::run(auto_drainer_t::lock_t keepalive) {
             context->mailbox_manager,
             &primary_dispatcher);
 
+        /* The copy of `update_contract_on_store_thread()` that delivered
+        `pre_replica_contract` ran before `our_dispatcher` was set, so it didn't tell the
+        dispatcher which replicas don't vote. Do it before any write can reach the
+        dispatcher. */
+        primary_dispatcher.set_nonvoting_replicas(
+            nonvoting_replicas(pre_replica_contract->contract));
+
         auto_drainer_t primary_dispatcher_drainer;
         assignment_sentry_t<auto_drainer_t *> our_dispatcher_drainer_assign(
             &our_dispatcher_drainer, &primary_dispatcher_drainer);
@@ -253,8 +351,9 @@ public:
     write_callback_t(write_response_t *_r_out,
                      write_durability_t _default_write_durability,
                      write_ack_config_t _write_ack_config,
-                     contract_t *contract) :
-        ack_counter(*contract),
+                     contract_t *contract,
+                     const std::set<server_id_t> *local_voters) :
+        ack_counter(*contract, local_voters),
         default_write_durability(_default_write_durability),
         write_ack_config(_write_ack_config),
         response_out(_r_out) { }
@@ -269,6 +368,9 @@ private:
         if (!result.is_pulsed()) {
             switch (write_ack_config) {
                 case write_ack_config_t::SINGLE:
+                    if (!ack_counter.is_voting_ack(server)) {
+                        return;
+                    }
                     break;
                 case write_ack_config_t::MAJORITY:
                     ack_counter.note_ack(server);
@@ -277,6 +379,12 @@ private:
                         return;
                     }
                     break;
+                case write_ack_config_t::LOCAL_MAJORITY:
+                    ack_counter.note_ack(server);
+                    if (!ack_counter.is_locally_safe()) {
+                        return;
+                    }
+                    break;
             }
             *response_out = std::move(resp);
             result.pulse(true);
@@ -341,7 +449,8 @@ bool primary_execution_t::on_write(
     write_callback_t write_callback(response_out,
                                     contract_snapshot->default_write_durability,
                                     contract_snapshot->write_ack_config,
-                                    &contract_snapshot->contract);
+                                    &contract_snapshot->contract,
+                                    &contract_snapshot->local_voters);
     our_dispatcher->spawn_write(request, order_token, &write_callback);
 
     /* Now that we've called `spawn_write()`, our write is in the queue. So it's safe to
@@ -392,7 +501,8 @@ bool primary_execution_t::sync_committed_read(const read_t &read_request,
     write_callback_t write_callback(&response,
                                     write_durability_t::HARD,
                                     write_ack_config_t::MAJORITY,
-                                    &contract_snapshot->contract);
+                                    &contract_snapshot->contract,
+                                    &contract_snapshot->local_voters);
     our_dispatcher->spawn_write(request, order_token, &write_callback);
 
     DEBUG_ONLY(finite_coro_waiting.reset());
@@ -505,6 +615,10 @@ void primary_execution_t::update_contract_on_store_thread(
                     &begin_write_mutex_assertion);
                 ASSERT_FINITE_CORO_WAITING;
                 latest_contract_store_thread = contract;
+                if (our_dispatcher != nullptr) {
+                    our_dispatcher->set_nonvoting_replicas(
+                        nonvoting_replicas(contract->contract));
+                }
             }
 
             /* If we have a broadcaster, then try to sync with replicas so we can ack the
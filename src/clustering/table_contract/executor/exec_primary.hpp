@@ -4,6 +4,7 @@
 
 #include "clustering/query_routing/primary_query_server.hpp"
 #include "clustering/table_contract/executor/exec.hpp"
+#include "concurrency/pump_coro.hpp"
 #include "containers/counted.hpp"
 
 class io_backender_t;
@@ -13,27 +14,50 @@ class primary_dispatcher_t;
 even after a failover or other reconfiguration. */
 class ack_counter_t {
 public:
-    explicit ack_counter_t(const contract_t &_contract) :
-        contract(_contract), primary_ack(false), voter_acks(0), temp_voter_acks(0) { }
+    /* `_local_voters` is only needed for `is_locally_safe()`. */
+    explicit ack_counter_t(const contract_t &_contract,
+                           const std::set<server_id_t> *_local_voters = nullptr) :
+        contract(_contract), local_voters(_local_voters), primary_ack(false),
+        voter_acks(0), temp_voter_acks(0), local_voter_acks(0) { }
     void note_ack(const server_id_t &server) {
         if (static_cast<bool>(contract.primary)) {
             primary_ack |= (server == contract.primary->server);
         }
         voter_acks += contract.voters.count(server);
+        if (local_voters != nullptr) {
+            local_voter_acks += local_voters->count(server);
+        }
         if (static_cast<bool>(contract.temp_voters)) {
             temp_voter_acks += contract.temp_voters->count(server);
         }
     }
+    /* Non-voting replicas apply writes with soft durability, so their acks don't
+    count, not even for `write_acks: single`. */
+    bool is_voting_ack(const server_id_t &server) const {
+        return contract.is_voter(server) ||
+            (static_cast<bool>(contract.primary) && server == contract.primary->server);
+    }
     bool is_safe() const {
         return primary_ack &&
             voter_acks * 2 > contract.voters.size() &&
             (!static_cast<bool>(contract.temp_voters) ||
                 temp_voter_acks * 2 > contract.temp_voters->size());
     }
+    /* Like `is_safe()`, but only a majority of the local voters is required. While the
+    voters are being changed we fall back to `is_safe()`, so that a reconfiguration
+    never sees a write that neither voter set has a majority of. */
+    bool is_locally_safe() const {
+        guarantee(local_voters != nullptr);
+        if (static_cast<bool>(contract.temp_voters)) {
+            return is_safe();
+        }
+        return primary_ack && local_voter_acks * 2 > local_voters->size();
+    }
 private:
     const contract_t &contract;
+    const std::set<server_id_t> *local_voters;
     bool primary_ack;
-    size_t voter_acks, temp_voter_acks;
+    size_t voter_acks, temp_voter_acks, local_voter_acks;
 
     DISABLE_COPYING(ack_counter_t);
 };
@@ -64,26 +88,41 @@ private:
         contract_info_t(const contract_id_t &_contract_id,
                         const contract_t &_contract,
                         write_durability_t _default_write_durability,
-                        write_ack_config_t _write_ack_config) :
+                        write_ack_config_t _write_ack_config,
+                        std::set<server_id_t> &&_local_voters) :
                 contract_id(_contract_id),
                 contract(_contract),
                 default_write_durability(_default_write_durability),
-                write_ack_config(_write_ack_config) {
+                write_ack_config(_write_ack_config),
+                local_voters(std::move(_local_voters)) {
         }
         bool equivalent(const contract_info_t &other) const {
             /* This method is called `equivalent` rather than `operator==` to avoid
             confusion, because it doesn't actually compare every member */
             return contract_id == other.contract_id &&
                 default_write_durability == other.default_write_durability &&
-                write_ack_config == other.write_ack_config;
+                write_ack_config == other.write_ack_config &&
+                local_voters == other.local_voters;
         }
         contract_id_t contract_id;
         contract_t contract;
         write_durability_t default_write_durability;
         write_ack_config_t write_ack_config;
+        /* The voters in the primary's site, for `write_acks: local_majority` */
+        std::set<server_id_t> local_voters;
         cond_t obsolete;
     };
 
+    /* `replace_contract()` makes `new_contract` the latest contract, unless it's
+    equivalent to the one we already have. It's used both for new contracts and raft
+    states, and when the server tags that `local_voters` depends on change. */
+    void replace_contract(counted_t<contract_info_t> new_contract);
+
+    /* `update_local_voters()` runs in `local_voters_pumper` whenever the configuration
+    of one of the voters changes, and recomputes `local_voters` for the latest
+    contract. */
+    void update_local_voters(signal_t *interruptor);
+
     /* This is started in a coroutine when the `primary_t` is created. It sets up the
     broadcaster, listener, etc. */
     void run(auto_drainer_t::lock_t keepalive);
@@ -184,6 +223,14 @@ private:
     /* `drainer` ensures that `run()` and `update_contract_on_store_thread()` are
     stopped before the other member variables are destroyed. */
     auto_drainer_t drainer;
+
+    /* `server_config_subs` notifies `local_voters_pumper` when a voter's tags may have
+    changed. We can't recompute `local_voters` in the subscription callback itself,
+    because we'd have to read the map while it's being written to. The destructor
+    stops both of them before draining `drainer`. */
+    pump_coro_t local_voters_pumper;
+    scoped_ptr_t<watchable_map_t<server_id_t, server_config_versioned_t>::all_subs_t>
+        server_config_subs;
 };
 
 #endif /* CLUSTERING_TABLE_CONTRACT_EXECUTOR_EXEC_PRIMARY_HPP_ */
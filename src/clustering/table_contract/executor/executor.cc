@@ -122,6 +122,7 @@ contract_executor_t::contract_executor_t(
         const clone_ptr_t<watchable_t<table_raft_state_t> > &_raft_state,
         watchable_map_t<std::pair<server_id_t, branch_id_t>, contract_execution_bcard_t>
             *_remote_contract_execution_bcards,
+        watchable_map_t<server_id_t, server_config_versioned_t> *_server_config_map,
         multistore_ptr_t *_multistore,
         const base_path_t &_base_path,
         io_backender_t *_io_backender,
@@ -154,6 +155,7 @@ contract_executor_t::contract_executor_t(
     execution_context.local_contract_execution_bcards
         = &local_contract_execution_bcards;
     execution_context.local_table_query_bcards = &local_table_query_bcards;
+    execution_context.server_config_map = _server_config_map;
 
     multistore->assert_thread();
 
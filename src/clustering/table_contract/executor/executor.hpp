@@ -29,6 +29,7 @@ public:
         const clone_ptr_t<watchable_t<table_raft_state_t> > &raft_state,
         watchable_map_t<std::pair<server_id_t, branch_id_t>, contract_execution_bcard_t>
             *remote_contract_execution_bcards,
+        watchable_map_t<server_id_t, server_config_versioned_t> *server_config_map,
         multistore_ptr_t *multistore,
         const base_path_t &base_path,
         io_backender_t *io_backender,
@@ -0,0 +1,36 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved
+#include "clustering/table_manager/cache_policy_manager.hpp"
+
+#include "buffer_cache/alt.hpp"
+#include "clustering/table_contract/cpu_sharding.hpp"
+#include "rdb_protocol/store.hpp"
+
+cache_policy_manager_t::cache_policy_manager_t(
+        multistore_ptr_t *multistore_,
+        const clone_ptr_t<watchable_t<cache_policy_t> > &cache_policy_) :
+    multistore(multistore_), cache_policy(cache_policy_),
+    update_pumper([this](signal_t *interruptor) { update_blocking(interruptor); }),
+    cache_policy_subs([this]() { update_pumper.notify(); })
+{
+    watchable_t<cache_policy_t>::freeze_t freeze(cache_policy);
+    cache_policy_subs.reset(cache_policy, &freeze);
+    update_pumper.notify();
+}
+
+void cache_policy_manager_t::update_blocking(UNUSED signal_t *interruptor) {
+    cache_policy_t goal = cache_policy->get();
+    if (static_cast<bool>(applied_policy) && *applied_policy == goal) {
+        return;
+    }
+
+    /* The table's reservation is for the whole server, and each CPU shard has its own
+    cache. */
+    cache_policy_t store_policy = goal;
+    store_policy.reserved_bytes = goal.reserved_bytes / CPU_SHARDING_FACTOR;
+    for (size_t i = 0; i < CPU_SHARDING_FACTOR; ++i) {
+        store_t *store = multistore->get_underlying_store(i);
+        on_thread_t thread_switcher(store->home_thread());
+        store->cache->set_policy(store_policy);
+    }
+    applied_policy = goal;
+}
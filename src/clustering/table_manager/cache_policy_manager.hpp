@@ -0,0 +1,39 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef CLUSTERING_TABLE_MANAGER_CACHE_POLICY_MANAGER_HPP_
+#define CLUSTERING_TABLE_MANAGER_CACHE_POLICY_MANAGER_HPP_
+
+#include "buffer_cache/types.hpp"
+#include "concurrency/pump_coro.hpp"
+#include "concurrency/watchable.hpp"
+
+class multistore_ptr_t;
+
+/* The `cache_policy_manager_t` is responsible for reading the cache policy from the
+`table_config_t` and passing it to the caches of the `store_t`s, so that the cache
+balancer can honor it. */
+
+class cache_policy_manager_t {
+public:
+    cache_policy_manager_t(
+        multistore_ptr_t *multistore,
+        const clone_ptr_t<watchable_t<cache_policy_t> > &cache_policy);
+
+private:
+    void update_blocking(signal_t *interruptor);
+
+    multistore_ptr_t *const multistore;
+    clone_ptr_t<watchable_t<cache_policy_t> > const cache_policy;
+
+    /* The policy that the stores have, if any. Only accessed by `update_blocking()`. */
+    boost::optional<cache_policy_t> applied_policy;
+
+    /* Destructor order matters: The `cache_policy_subs` must be destroyed before the
+    `update_pumper` because it calls `update_pumper.notify()`. But `update_pumper` must
+    be destroyed before the other variables because it runs `update_blocking()`, which
+    accesses the other variables. */
+    pump_coro_t update_pumper;
+
+    watchable_t<cache_policy_t>::subscription_t cache_policy_subs;
+};
+
+#endif /* CLUSTERING_TABLE_MANAGER_CACHE_POLICY_MANAGER_HPP_ */
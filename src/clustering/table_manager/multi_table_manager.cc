@@ -402,6 +402,7 @@ void multi_table_manager_t::on_action(
             cond_t non_interruptor;
             persistence_interface->create_multistore(
                 table_id,
+                initial_raft_state->snapshot_state.config.config.block_size,
                 &table->multistore_ptr,
                 &non_interruptor,
                 &perfmon_collections->serializers_collection);
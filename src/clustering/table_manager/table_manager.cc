@@ -43,7 +43,8 @@ table_manager_t::table_manager_t(
                     -> table_raft_state_t {
                 return sc.state;
             }),
-        execution_bcard_read_manager.get_values(), multistore_ptr, _base_path,
+        execution_bcard_read_manager.get_values(),
+        server_config_client->get_server_config_map(), multistore_ptr, _base_path,
         _io_backender, _backfill_throttler, &backfill_progress_tracker,
         &perfmon_collection),
     execution_bcard_write_manager(
@@ -61,6 +62,13 @@ table_manager_t::table_manager_t(
                     -> table_config_t {
                 return sc.state.config.config;
             })),
+    cache_policy_manager(
+        multistore_ptr,
+        raft.get_raft()->get_committed_state()->subview(
+            [](const raft_member_t<table_raft_state_t>::state_and_config_t &sc)
+                    -> cache_policy_t {
+                return sc.state.config.config.cache;
+            })),
     table_directory_subs(
         _table_manager_directory,
         std::bind(&table_manager_t::on_table_directory_change, this, ph::_1, ph::_2),
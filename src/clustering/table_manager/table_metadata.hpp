@@ -346,8 +346,11 @@ public:
         scoped_ptr_t<multistore_ptr_t> *multistore_ptr_out,
         signal_t *interruptor,
         perfmon_collection_t *perfmon_collection_serializers) = 0;
+    /* `create_multistore()` creates the table's files with blocks of `block_size`
+    bytes. Existing files keep the block size they were created with. */
     virtual void create_multistore(
         const namespace_id_t &table_id,
+        uint64_t block_size,
         scoped_ptr_t<multistore_ptr_t> *multistore_ptr_out,
         signal_t *interruptor,
         perfmon_collection_t *perfmon_collection_serializers) = 0;
@@ -32,52 +32,97 @@
 #define MAX_IO_EVENT_PROCESSING_BATCH_SIZE        50
 
 // The io batch factor ensures a minimum number of i/o operations
-// which are picked from any specific i/o account consecutively.
+// which are picked from any specific i/o class consecutively.
 // A higher value might be advantageous for throughput if seek times
 // matter on the underlying i/o system. A low value improves latency.
 // The advantage only holds as long as each account has a tendentially
 // sequential set of i/o operations though. If access patterns are random
-// for all accounts, a low io batch factor does just as well (as bad) when it comes
+// for all classes, a low io batch factor does just as well (as bad) when it comes
 // to the number of random seeks, but might still provide a lower latency
 // than a high batch factor. Our serializer now groups data writes into
 // a single large write operation by itself, making a high value here less
 // useful.
 #define DEFAULT_IO_BATCH_FACTOR                   1
 
-// I/O priority of index writes in the log serializer
-#define INDEX_WRITE_IO_PRIORITY                   128
-
-// Each cache uses its own I/O account for reads.
-// Writes use the default I/O account, which in practice is going to be overridden
-// by a common account in the merger_serializer_t.
-//
-// By adjusting the priority of the read account, relative to
-// MERGER_BLOCK_WRITE_IO_PRIORITY below, reads can be prioritized over writes
-// or the other way around.
+// The disk scheduler gives every I/O request a deadline: the time it was submitted
+// plus the latency target of its I/O class (see `io_class_t`).  It always dispatches
+// the request with the earliest deadline first.  The targets are in microseconds.
 //
 // In practice we want to prioritize reads, so reads can pass ahead of
 // flushes.  The rationale behind this is that reads are almost always blocking
 // operations.  Writes, on the other hand, can be non-blocking (from the user's
-// perspective) if they are soft-durability or noreply writes.
-#define CACHE_READS_IO_PRIORITY                   (512 / CPU_SHARDING_FACTOR)
-
-// The cache priority to use for secondary index post construction
-// 100 = same priority as all other read operations in the cache together.
+// perspective) if they are soft-durability or noreply writes.  Background work
+// gets targets long enough that it yields to both, without being starved.
+#define FOREGROUND_READ_IO_LATENCY_TARGET_US      (2 * THOUSAND)
+#define FLUSH_IO_LATENCY_TARGET_US                (20 * THOUSAND)
+#define BACKFILL_IO_LATENCY_TARGET_US             (100 * THOUSAND)
+#define GC_IO_LATENCY_TARGET_US                   (200 * THOUSAND)
+#define SINDEX_BUILD_IO_LATENCY_TARGET_US         (200 * THOUSAND)
+#define PREFETCH_IO_LATENCY_TARGET_US             (500 * THOUSAND)
+
+// Bandwidth caps of the background I/O classes, per disk manager, in bytes per
+// second.  Zero means that the class isn't capped.  A capped class can burst up to
+// IO_BANDWIDTH_BURST_MS worth of its cap.
+#define FOREGROUND_READ_IO_BANDWIDTH_CAP          0
+#define FLUSH_IO_BANDWIDTH_CAP                    0
+#define BACKFILL_IO_BANDWIDTH_CAP                 (128 * MEGABYTE)
+#define GC_IO_BANDWIDTH_CAP                       (64 * MEGABYTE)
+#define SINDEX_BUILD_IO_BANDWIDTH_CAP             (64 * MEGABYTE)
+#define PREFETCH_IO_BANDWIDTH_CAP                 (32 * MEGABYTE)
+#define IO_BANDWIDTH_BURST_MS                     100
+
+// The disk scheduler adapts the number of requests it keeps outstanding on the
+// device, between DISK_MIN_OUTSTANDING_REQUESTS and the configured maximum.  Once
+// the device's latency exceeds DISK_LATENCY_TOLERANCE times the lowest latency
+// it has shown, more outstanding requests only queue up inside the device, where
+// the scheduler can't reorder them, so it lowers the depth instead.
+#define DISK_MIN_OUTSTANDING_REQUESTS             4
+#define DISK_LATENCY_TOLERANCE                    2.0
+
+// The cache priority to use for secondary index post construction.  The priority
+// limits how many reads the cache account can have outstanding at once:
+// 100 = as many as all other read operations in the cache together.
 // 0 = minimal priority
 #define SINDEX_POST_CONSTRUCTION_CACHE_PRIORITY   5
 
+// The cache priority that secondaries use to warm their cache with the primary's hot
+// read set, and how often the primary sends them that set (see `hot_set_tracker_t`).
+#define REPLICA_HOT_SET_CACHE_PRIORITY            5
+#define REPLICA_HOT_SET_HINT_INTERVAL_MS          (10 * THOUSAND)
+#define REPLICA_HOT_SET_MAX_KEYS                  512
+
 // Size of the buffer used to perform IO operations (in bytes).
 #define IO_BUFFER_SIZE                            (4 * KILOBYTE)
 
 // Size of the device block size (in bytes)
 #define DEVICE_BLOCK_SIZE                         512
 
+// When several blocks get read together, blocks in the same extent that are at most
+// this many bytes apart get read with a single disk read.  (The bytes between them
+// are read and thrown away.)
+#define MAX_COALESCED_READ_GAP                    (32 * KILOBYTE)
+
+// Online backups copy a table's blocks in batches of this many blocks, through I/O
+// accounts of the backfill class so that they yield to the table's own reads and
+// writes.
+#define BACKUP_BLOCKS_PER_BATCH                   128
+
+// Index entries without data (as written by incremental backups) are cheap, so a
+// batch may hold this many of them.
+#define BACKUP_INDEX_OPS_PER_BATCH                4096
+
 // Size of the metablock (in bytes)
 #define METABLOCK_SIZE                            (4 * KILOBYTE)
 
 // Size of each btree node (in bytes) on disk
 #define DEFAULT_BTREE_BLOCK_SIZE                  (4 * KILOBYTE)
 
+// Range of btree node sizes (in bytes) that a table can be created with.  The size
+// must also be a power of two.  The LBA stores block sizes in 16 bits, so 64KB
+// doesn't fit.
+#define MIN_BTREE_BLOCK_SIZE                      (4 * KILOBYTE)
+#define MAX_BTREE_BLOCK_SIZE                      (32 * KILOBYTE)
+
 // Size of each extent (in bytes)
 // This should not be too small, or garbage collection will become
 // inefficient (especially on rotational drives).
@@ -86,6 +131,13 @@
 // Ratio of free ram to use for the cache by default
 #define DEFAULT_MAX_CACHE_RATIO                   2
 
+// The largest share (in percent) of a cache that --cache-compression can give to
+// compressed pages
+#define MAX_CACHE_COMPRESSION_PERCENT             50
+
+// The largest cache priority a table can have; the default priority is 1
+#define MAX_TABLE_CACHE_PRIORITY                  100
+
 // The maximum number of concurrently active
 // index writes per merger serializer.
 // The smaller the number, the more effective
@@ -95,9 +147,6 @@
 // small values of this variable.
 #define MERGER_SERIALIZER_MAX_ACTIVE_WRITES       1
 
-// I/O priority of block writes in the merger_serializer_t
-#define MERGER_BLOCK_WRITE_IO_PRIORITY            64
-
 // Maximum number of threads we support
 // TODO: make this dynamic where possible
 #define MAX_THREADS                               128
@@ -126,9 +175,6 @@
 #define LBA_MIN_SIZE_FOR_GC                       (MEGABYTE * 1)
 #define LBA_MIN_UNGARBAGE_FRACTION                0.5
 
-// I/O priority for LBA garbage collection
-#define LBA_GC_IO_PRIORITY                        8
-
 // How many block ids should the LBA garbage collector rewrite before yielding?
 #define LBA_GC_BATCH_SIZE                         (1024 * 8)
 
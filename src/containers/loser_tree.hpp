@@ -0,0 +1,79 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef CONTAINERS_LOSER_TREE_HPP_
+#define CONTAINERS_LOSER_TREE_HPP_
+
+#include <utility>
+#include <vector>
+
+#include "errors.hpp"
+
+/* loser_tree_t picks the best of `k` sorted input streams for a k-way merge. It
+doesn't hold the streams itself: it only knows them by index, and compares their
+current heads with `beats_t`, where `beats(a, b)` is true if the head of stream `a`
+should come before the head of stream `b`. Ties are broken in favor of the stream
+with the lower index, so that the merge is stable.
+
+Each internal node of the tree remembers the loser of the match played there, and
+the overall winner is kept separately. After the winner's head has changed, only the
+matches on the path from its leaf to the root have to be replayed, which costs
+`log2(k)` comparisons. Unlike a binary heap, a replay never has to compare the two
+children of a node against each other. */
+template <class beats_t>
+class loser_tree_t {
+public:
+    loser_tree_t(size_t num_streams, beats_t beats)
+        : beats_(std::move(beats)), num_streams_(num_streams), losers_(num_streams) {
+        guarantee(num_streams > 0);
+        // Play the initial matches bottom-up. Leaf `i` is node `num_streams + i`.
+        std::vector<size_t> winners(2 * num_streams);
+        for (size_t i = 0; i < num_streams; ++i) {
+            winners[num_streams + i] = i;
+        }
+        for (size_t node = num_streams - 1; node >= 1; --node) {
+            size_t a = winners[2 * node];
+            size_t b = winners[2 * node + 1];
+            if (wins(b, a)) {
+                std::swap(a, b);
+            }
+            winners[node] = a;
+            losers_[node] = b;
+        }
+        winner_ = num_streams == 1 ? 0 : winners[1];
+    }
+
+    // The index of the stream whose head comes first.
+    size_t winner() const { return winner_; }
+
+    // Call this after the head of `winner()` has changed.
+    void replay() {
+        size_t current = winner_;
+        for (size_t node = (num_streams_ + current) / 2; node >= 1; node /= 2) {
+            if (wins(losers_[node], current)) {
+                std::swap(losers_[node], current);
+            }
+        }
+        winner_ = current;
+    }
+
+private:
+    bool wins(size_t a, size_t b) {
+        if (beats_(a, b)) {
+            return true;
+        } else if (beats_(b, a)) {
+            return false;
+        } else {
+            return a < b;
+        }
+    }
+
+    beats_t beats_;
+    const size_t num_streams_;
+    // `losers_[node]` is the loser of the match at internal node `node`, for
+    // `1 <= node < num_streams_`.
+    std::vector<size_t> losers_;
+    size_t winner_;
+
+    DISABLE_COPYING(loser_tree_t);
+};
+
+#endif  // CONTAINERS_LOSER_TREE_HPP_
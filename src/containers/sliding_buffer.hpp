@@ -0,0 +1,92 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef CONTAINERS_SLIDING_BUFFER_HPP_
+#define CONTAINERS_SLIDING_BUFFER_HPP_
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "containers/scoped.hpp"
+#include "errors.hpp"
+
+/* sliding_buffer_t is a FIFO of bytes that keeps its contents contiguous, so that
+readers can parse them in place. New bytes are written into the free space behind the
+contents (`prepare()` followed by `commit()`), and consumed bytes are dropped from the
+front in constant time.
+
+The contents only move when `prepare()` needs more free space than is left at the end.
+They then get moved back to the start of the buffer if the consumed space in front of
+them is at least as large as they are, and get copied into a buffer of twice the size
+otherwise. Either way each byte is moved a constant number of times on average, unlike
+with an `std::vector` that gets erased from the front. */
+class sliding_buffer_t {
+public:
+    explicit sliding_buffer_t(size_t initial_capacity)
+        : buffer_(initial_capacity), start_(0), end_(0) {
+        guarantee(initial_capacity > 0);
+    }
+
+    size_t size() const { return end_ - start_; }
+    bool empty() const { return start_ == end_; }
+    size_t capacity() const { return buffer_.size(); }
+
+    const char *data() const { return buffer_.data() + start_; }
+
+    /* Returns a pointer to at least `n` writable bytes behind the current contents.
+    The pointer is valid until the next call to a non-const method. */
+    char *prepare(size_t n) {
+        if (buffer_.size() - end_ < n) {
+            size_t live = size();
+            if (buffer_.size() >= live + n && start_ >= live) {
+                memmove(buffer_.data(), buffer_.data() + start_, live);
+            } else {
+                scoped_array_t<char> new_buffer(
+                    std::max(2 * buffer_.size(), live + n));
+                memcpy(new_buffer.data(), buffer_.data() + start_, live);
+                buffer_.swap(new_buffer);
+            }
+            start_ = 0;
+            end_ = live;
+        }
+        return buffer_.data() + end_;
+    }
+
+    /* Returns how many bytes can be written behind the contents without calling
+    `prepare()` first. */
+    size_t free_space() const { return buffer_.size() - end_; }
+
+    /* Appends the first `n` bytes of the space returned by `prepare()`. */
+    void commit(size_t n) {
+        guarantee(n <= buffer_.size() - end_);
+        end_ += n;
+    }
+
+    /* Drops `n` bytes from the front. */
+    void consume(size_t n) {
+        guarantee(n <= size());
+        start_ += n;
+        if (start_ == end_) {
+            start_ = end_ = 0;
+        }
+    }
+
+    /* Replaces the buffer with one of `new_capacity` bytes if it's empty and larger
+    than that, so that one large message doesn't pin its memory for the rest of the
+    buffer's lifetime. */
+    void shrink_if_empty(size_t new_capacity) {
+        if (empty() && buffer_.size() > new_capacity) {
+            scoped_array_t<char> new_buffer(new_capacity);
+            buffer_.swap(new_buffer);
+        }
+    }
+
+private:
+    scoped_array_t<char> buffer_;
+    // The contents are `buffer_[start_, end_)`.
+    size_t start_;
+    size_t end_;
+
+    DISABLE_COPYING(sliding_buffer_t);
+};
+
+#endif  // CONTAINERS_SLIDING_BUFFER_HPP_
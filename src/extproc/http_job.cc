@@ -9,18 +9,24 @@
 #endif
 #include <curl/curl.h>
 
+#include <array>
 #include <limits>
+#include <list>
 
 #include "containers/archive/boost_types.hpp"
 #include "containers/archive/stl_types.hpp"
+#include "crypto/hash.hpp"
 #include "extproc/extproc_job.hpp"
 #include "http/http_parser.hpp"
 #include "rapidjson/document.h"
 #include "rapidjson/error/en.h"
 #include "rdb_protocol/env.hpp"
+#include "time.hpp"
 
 #define RETHINKDB_USER_AGENT (SOFTWARE_NAME_STRING "/" RETHINKDB_VERSION)
 
+class http_worker_state_t;
+
 void parse_header(const std::string &header,
                   http_result_t *res_out);
 
@@ -40,9 +46,13 @@ void jsonp_to_datum(const std::string &jsonp,
                     attach_json_to_error_t attach_json,
                     http_result_t *res_out);
 
-void perform_http(http_opts_t *opts,
+void perform_http(http_worker_state_t *state,
+                  http_opts_t *opts,
                   http_result_t *res_out);
 
+// The total size of the responses cached by a single worker process
+static const size_t HTTP_RESPONSE_CACHE_MAX_BYTES = 32 * MEGABYTE;
+
 class curl_exc_t : public std::exception {
 public:
     explicit curl_exc_t(std::string err_msg) :
@@ -54,24 +64,6 @@ public:
     const std::string error_string;
 };
 
-class scoped_curl_handle_t {
-public:
-    scoped_curl_handle_t() :
-        curl_handle(curl_easy_init()) {
-    }
-
-    ~scoped_curl_handle_t() {
-        curl_easy_cleanup(curl_handle);
-    }
-
-    CURL *get() {
-        return curl_handle;
-    }
-
-private:
-    CURL *curl_handle;
-};
-
 // Used for adding headers, which cannot be freed until after the request is done
 class scoped_curl_slist_t {
 public:
@@ -179,6 +171,114 @@ size_t curl_data_t::read_internal(char *ptr, size_t size) {
     return bytes_to_copy;
 }
 
+// Successful responses to `r.http(..., {cache: true})` requests, kept in the worker
+// process until the lifetime given by the server's `Cache-Control` header expires.
+// Entries are evicted in LRU order once the cached responses exceed `max_bytes`.
+class http_response_cache_t {
+public:
+    explicit http_response_cache_t(size_t _max_bytes) :
+        max_bytes(_max_bytes), used_bytes(0) { }
+
+    bool lookup(const std::string &key, http_result_t *res_out) {
+        auto it = entries.find(key);
+        if (it == entries.end()) {
+            return false;
+        }
+        if (it->second.expiration <= current_microtime()) {
+            erase(it);
+            return false;
+        }
+        lru.splice(lru.begin(), lru, it->second.lru_it);
+        *res_out = it->second.result;
+        return true;
+    }
+
+    void insert(const std::string &key,
+                const http_result_t &result,
+                size_t size,
+                microtime_t expiration) {
+        // Don't let a single large response flush everything else out of the cache
+        if (size > max_bytes / 4) {
+            return;
+        }
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+            erase(it);
+        }
+        while (used_bytes + size > max_bytes) {
+            erase(entries.find(lru.back()));
+        }
+        lru.push_front(key);
+        entry_t entry;
+        entry.result = result;
+        entry.size = size;
+        entry.expiration = expiration;
+        entry.lru_it = lru.begin();
+        entries.insert(std::make_pair(key, std::move(entry)));
+        used_bytes += size;
+    }
+
+private:
+    struct entry_t {
+        http_result_t result;
+        size_t size;
+        microtime_t expiration;
+        std::list<std::string>::iterator lru_it;
+    };
+
+    void erase(std::map<std::string, entry_t>::iterator it) {
+        guarantee(it != entries.end());
+        used_bytes -= it->second.size;
+        lru.erase(it->second.lru_it);
+        entries.erase(it);
+    }
+
+    const size_t max_bytes;
+    size_t used_bytes;
+    std::map<std::string, entry_t> entries;
+    // Cache keys ordered by access time, most recently used first
+    std::list<std::string> lru;
+
+    DISABLE_COPYING(http_response_cache_t);
+};
+
+// There is one of these per worker process, owned by `http_job_t::worker_fn()` and
+// created the first time the worker handles an `r.http()` job.  It keeps a curl
+// handle alive across jobs, so that consecutive requests handled by the same worker
+// reuse the handle's DNS cache, TLS sessions and keep-alive connections instead of
+// setting up a new connection for every request.
+class http_worker_state_t {
+public:
+    http_worker_state_t() :
+        response_cache(HTTP_RESPONSE_CACHE_MAX_BYTES),
+        curl_handle(nullptr) { }
+
+    ~http_worker_state_t() {
+        if (curl_handle != nullptr) {
+            curl_easy_cleanup(curl_handle);
+        }
+    }
+
+    // Returns the worker's curl handle with all options reset to their defaults, or
+    // `nullptr` if the handle could not be created.  Resetting the handle keeps its
+    // connection, DNS and TLS session caches intact.
+    CURL *reset_handle() {
+        if (curl_handle == nullptr) {
+            curl_handle = curl_easy_init();
+        } else {
+            curl_easy_reset(curl_handle);
+        }
+        return curl_handle;
+    }
+
+    http_response_cache_t response_cache;
+
+private:
+    CURL *curl_handle;
+
+    DISABLE_COPYING(http_worker_state_t);
+};
+
 // The job_t runs in the context of the main rethinkdb process
 http_job_t::http_job_t(extproc_pool_t *pool, signal_t *interruptor) :
     extproc_job(pool, &worker_fn, interruptor) { }
@@ -227,8 +327,11 @@ bool http_job_t::worker_fn(read_stream_t *stream_in, write_stream_t *stream_out)
     }
 
     if (curl_res == CURLE_OK) {
+        // Lives until the worker process exits; the curl handle it owns has to be
+        // created after `curl_global_init()`.
+        static http_worker_state_t state;
         try {
-            perform_http(&opts, &result);
+            perform_http(&state, &opts, &result);
         } catch (const std::exception &ex) {
             result.error.assign(ex.what());
         } catch (...) {
@@ -534,30 +637,165 @@ void set_default_opts(CURL *curl_handle,
     // Enable cookies - needed for multiple requests like redirects or digest auth
     exc_setopt(curl_handle, CURLOPT_COOKIEFILE, "", "COOKIEFILE");
 
+    // The handle is reused across requests, which may come from different queries,
+    // so drop any cookies left over from the previous request
+    exc_setopt(curl_handle, CURLOPT_COOKIELIST, "ALL", "COOKIELIST");
+
     // Use the proxy set when launched
     if (!proxy.empty()) {
         exc_setopt(curl_handle, CURLOPT_PROXY, proxy.c_str(), "PROXY");
     }
 }
 
+// Everything in the request that may influence the result, used as the response
+// cache key.  The credentials are only included as a digest, so that the cache
+// doesn't keep passwords around in the worker's memory.
+std::string response_cache_key(const http_opts_t &opts) {
+    std::string key = strprintf("%s %s\n%s\n%d %zu %d %d %" PRIu32 "\n%s\n",
+                                http_method_to_str(opts.method).c_str(),
+                                opts.url.c_str(),
+                                opts.url_params.print().c_str(),
+                                static_cast<int>(opts.result_format),
+                                opts.limits.array_size_limit(),
+                                static_cast<int>(opts.version),
+                                opts.verify ? 1 : 0,
+                                opts.max_redirects,
+                                opts.proxy.c_str());
+    std::array<unsigned char, SHA256_DIGEST_LENGTH> auth_digest =
+        crypto::sha256(opts.auth.username + ":" + opts.auth.password);
+    key += strprintf("%d ", static_cast<int>(opts.auth.type));
+    key.append(reinterpret_cast<const char *>(auth_digest.data()), auth_digest.size());
+    key += "\n";
+    for (auto const &line : opts.header) {
+        key += line + "\n";
+    }
+    for (auto const &cookie : opts.cookies) {
+        key += cookie + "\n";
+    }
+    return key;
+}
+
+// Determines how long a response may be cached from its `Cache-Control` header.
+// Responses without an explicit `max-age` or `s-maxage` are never cached, nor are
+// responses marked `no-store`, `no-cache` or `private` (the cache is shared by all
+// queries running on the server).
+bool parse_cache_lifetime(const std::string &header_data, uint64_t *max_age_secs_out) {
+    bool cacheable = false;
+    bool has_shared_max_age = false;
+    size_t line_start = 0;
+    while (line_start < header_data.size()) {
+        size_t line_end = header_data.find("\r\n", line_start);
+        if (line_end == std::string::npos) {
+            line_end = header_data.size();
+        }
+        std::string line = header_data.substr(line_start, line_end - line_start);
+        line_start = line_end + 2;
+
+        for (size_t i = 0; i < line.length(); ++i) {
+            line[i] = tolower(line[i]);
+        }
+        const std::string prefix("cache-control:");
+        if (line.compare(0, prefix.size(), prefix) != 0) {
+            continue;
+        }
+
+        size_t directive_start = prefix.size();
+        while (directive_start < line.size()) {
+            size_t directive_end = line.find(',', directive_start);
+            if (directive_end == std::string::npos) {
+                directive_end = line.size();
+            }
+            std::string directive =
+                line.substr(directive_start, directive_end - directive_start);
+            directive_start = directive_end + 1;
+
+            size_t first = directive.find_first_not_of(" \t");
+            size_t last = directive.find_last_not_of(" \t");
+            if (first == std::string::npos) {
+                continue;
+            }
+            directive = directive.substr(first, last - first + 1);
+
+            uint64_t max_age;
+            if (directive == "no-store" ||
+                directive == "no-cache" ||
+                directive == "private") {
+                return false;
+            } else if (sscanf(directive.c_str(), "s-maxage=%" SCNu64, &max_age) == 1) {
+                *max_age_secs_out = max_age;
+                has_shared_max_age = true;
+                cacheable = true;
+            } else if (sscanf(directive.c_str(), "max-age=%" SCNu64, &max_age) == 1) {
+                if (!has_shared_max_age) {
+                    *max_age_secs_out = max_age;
+                    cacheable = true;
+                }
+            }
+        }
+    }
+    return cacheable && *max_age_secs_out > 0;
+}
+
+void perform_http_request(http_opts_t *opts,
+                          CURL *curl_handle,
+                          http_result_t *res_out,
+                          std::string *header_data_out,
+                          size_t *response_size_out);
+
 // TODO: implement streaming API support
-void perform_http(http_opts_t *opts, http_result_t *res_out) {
-    scoped_curl_handle_t curl_handle;
-    curl_data_t curl_data;
+void perform_http(http_worker_state_t *state,
+                  http_opts_t *opts,
+                  http_result_t *res_out) {
+    const bool use_cache = opts->cache &&
+        (opts->method == http_method_t::GET || opts->method == http_method_t::HEAD);
+
+    std::string cache_key;
+    if (use_cache) {
+        cache_key = response_cache_key(*opts);
+        if (state->response_cache.lookup(cache_key, res_out)) {
+            res_out->connection_reused = false;
+            res_out->cache_hit = true;
+            return;
+        }
+    }
 
-    if (curl_handle.get() == nullptr) {
+    CURL *curl_handle = state->reset_handle();
+    if (curl_handle == nullptr) {
         res_out->error.assign("initialization");
         return;
     }
 
-    set_default_opts(curl_handle.get(), opts->proxy, curl_data);
-    transfer_opts(opts, curl_handle.get(), &curl_data);
+    std::string header_data;
+    size_t response_size = 0;
+    perform_http_request(opts, curl_handle, res_out, &header_data, &response_size);
+
+    uint64_t max_age_secs;
+    if (use_cache &&
+        res_out->error.empty() &&
+        parse_cache_lifetime(header_data, &max_age_secs)) {
+        const uint64_t max_age_us =
+            std::min<uint64_t>(max_age_secs, std::numeric_limits<uint32_t>::max())
+            * MILLION;
+        state->response_cache.insert(cache_key, *res_out, response_size,
+                                     current_microtime() + max_age_us);
+    }
+}
+
+void perform_http_request(http_opts_t *opts,
+                          CURL *curl_handle,
+                          http_result_t *res_out,
+                          std::string *header_data_out,
+                          size_t *response_size_out) {
+    curl_data_t curl_data;
+
+    set_default_opts(curl_handle, opts->proxy, curl_data);
+    transfer_opts(opts, curl_handle, &curl_data);
 
     CURLcode curl_res = CURLE_OK;
     long response_code = 0; // NOLINT(runtime/int)
     for (uint64_t attempts = 0; attempts < opts->attempts; ++attempts) {
         // Do the HTTP operation, then check for errors
-        curl_res = curl_easy_perform(curl_handle.get());
+        curl_res = curl_easy_perform(curl_handle);
 
         if (curl_res == CURLE_SEND_ERROR ||
             curl_res == CURLE_RECV_ERROR ||
@@ -569,7 +807,7 @@ void perform_http(http_opts_t *opts, http_result_t *res_out) {
             return;
         }
 
-        curl_res = curl_easy_getinfo(curl_handle.get(),
+        curl_res = curl_easy_getinfo(curl_handle,
                                      CURLINFO_RESPONSE_CODE,
                                      &response_code);
 
@@ -585,9 +823,21 @@ void perform_http(http_opts_t *opts, http_result_t *res_out) {
         }
     }
 
+    if (curl_res == CURLE_OK) {
+        // libcurl reports zero new connections if an existing one was reused
+        long num_connects = 0; // NOLINT(runtime/int)
+        if (curl_easy_getinfo(curl_handle,
+                              CURLINFO_NUM_CONNECTS,
+                              &num_connects) == CURLE_OK) {
+            res_out->connection_reused = (num_connects == 0);
+        }
+    }
+
     std::string body_data(curl_data.steal_body_data());
-    std::string header_data(curl_data.steal_header_data());
+    std::string &header_data = *header_data_out;
+    header_data = curl_data.steal_header_data();
     truncate_header_data(&header_data);
+    *response_size_out = header_data.size() + body_data.size();
 
     if (opts->attempts == 0) {
         res_out->error.assign("could not perform, no attempts allowed");
@@ -610,7 +860,7 @@ void perform_http(http_opts_t *opts, http_result_t *res_out) {
         res_out->error = strprintf("status code %ld", response_code);
     } else {
         parse_header(header_data, res_out);
-        save_cookies(curl_handle.get(), res_out);
+        save_cookies(curl_handle, res_out);
 
         // If this was a HEAD request, we should not be handling data, just return R_NULL
         // so the user knows the request succeeded
@@ -626,7 +876,7 @@ void perform_http(http_opts_t *opts, http_result_t *res_out) {
             {
                 std::string content_type;
                 char *content_type_buffer = nullptr;
-                curl_easy_getinfo(curl_handle.get(),
+                curl_easy_getinfo(curl_handle,
                                   CURLINFO_CONTENT_TYPE,
                                   &content_type_buffer);
 
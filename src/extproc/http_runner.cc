@@ -6,12 +6,14 @@
 #include "arch/timing.hpp"
 #include "protocol_api.hpp"
 
-RDB_IMPL_SERIALIZABLE_4_FOR_CLUSTER(http_result_t, header, body, cookies, error);
+RDB_IMPL_SERIALIZABLE_6_FOR_CLUSTER(http_result_t,
+                                    header, body, cookies, error,
+                                    connection_reused, cache_hit);
 RDB_IMPL_SERIALIZABLE_3_SINCE_v1_13(http_opts_t::http_auth_t, type, username, password);
-RDB_IMPL_SERIALIZABLE_16(http_opts_t,
+RDB_IMPL_SERIALIZABLE_17(http_opts_t,
                          auth, method, result_format, url, proxy, url_params,
                          header, cookies, data, form_data, limits, version, timeout_ms,
-                         attempts, max_redirects, verify);
+                         attempts, max_redirects, verify, cache);
 INSTANTIATE_SERIALIZABLE_FOR_CLUSTER(http_opts_t);
 
 std::string http_method_to_str(http_method_t method) {
@@ -42,7 +44,8 @@ http_opts_t::http_opts_t() :
     timeout_ms(30000),
     attempts(5),
     max_redirects(1),
-    verify(true) { }
+    verify(true),
+    cache(false) { }
 
 http_opts_t::http_auth_t::http_auth_t() :
     type(http_auth_type_t::NONE),
@@ -18,6 +18,8 @@
 
 // http calls result either in a DATUM return value or an error string
 struct http_result_t {
+    http_result_t() : connection_reused(false), cache_hit(false) { }
+
     ql::datum_t header;
     ql::datum_t body;
 
@@ -25,6 +27,12 @@ struct http_result_t {
     // subsequent HTTP requests for the query (e.g. if performing depagination).
     std::vector<std::string> cookies;
     std::string error;
+
+    // Statistics reported back by the worker: whether the request was sent over a
+    // connection kept alive from an earlier request, and whether it was answered
+    // from the worker's response cache without contacting the server at all.
+    bool connection_reused;
+    bool cache_hit;
 };
 
 RDB_DECLARE_SERIALIZABLE(http_result_t);
@@ -117,6 +125,10 @@ struct http_opts_t {
     uint32_t max_redirects;
 
     bool verify;
+
+    // Allow the response to be served from (and stored in) the worker's response
+    // cache, subject to the server's `Cache-Control` header.
+    bool cache;
 };
 
 RDB_DECLARE_SERIALIZABLE(http_opts_t);
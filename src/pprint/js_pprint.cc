@@ -723,6 +723,7 @@ static void pprint_update_reminder() {
     case Term::RECONFIGURE:
     case Term::REBALANCE:
     case Term::SYNC:
+    case Term::BACKUP:
     case Term::GRANT:
     case Term::SET_WRITE_HOOK:
     case Term::GET_WRITE_HOOK:
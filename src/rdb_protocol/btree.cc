@@ -33,7 +33,9 @@
 #include "rdb_protocol/pseudo_geometry.hpp"
 #include "rdb_protocol/serialize_datum_onto_blob.hpp"
 #include "rdb_protocol/shards.hpp"
+#include "rdb_protocol/stored_fields.hpp"
 #include "rdb_protocol/table_common.hpp"
+#include "rdb_protocol/trigrams.hpp"
 
 #include "debug.hpp"
 
@@ -600,13 +602,19 @@ public:
                        key_range_t *_active_region_range_inout,
                        reql_version_t wire_func_reql_version,
                        ql::map_wire_func_t wire_func,
-                       sindex_multi_bool_t _multi)
+                       sindex_multi_bool_t _multi,
+                       sindex_geo_bool_t _geo,
+                       rdb_value_layout_t _layout,
+                       bool _read_stored_fields)
         : pkey_range(std::move(_pkey_range)),
           datumspec(std::move(_datumspec)),
           active_region_range_inout(_active_region_range_inout),
           func_reql_version(wire_func_reql_version),
           func(wire_func.compile_wire_func()),
-          multi(_multi) {
+          multi(_multi),
+          geo(_geo),
+          layout(_layout),
+          read_stored_fields(_read_stored_fields) {
         datumspec.visit<void>(
             [&](const ql::datum_range_t &r) {
                 lbound_trunc_key = r.get_left_bound_trunc_key(func_reql_version);
@@ -622,6 +630,10 @@ private:
     const reql_version_t func_reql_version;
     const counted_t<const ql::func_t> func;
     const sindex_multi_bool_t multi;
+    const sindex_geo_bool_t geo;
+    const rdb_value_layout_t layout;
+    // Whether the stored fields of each entry are all that the read needs.
+    const bool read_stored_fields;
     // The (truncated) boundary keys for the datum range stored in `datumspec`.
     std::string lbound_trunc_key;
     std::string rbound_trunc_key;
@@ -690,7 +702,17 @@ public:
         concurrent_traversal_fifo_enforcer_signal_t waiter)
         THROWS_ONLY(interrupted_exc_t);
     void finish(continue_bool_t last_cb) THROWS_ONLY(interrupted_exc_t);
+
+    // How many values we read from the stored fields of a secondary index, and how
+    // many we had to load as a whole.
+    size_t stored_fields_reads() const { return num_stored_fields_reads; }
+    size_t row_reads() const { return num_row_reads; }
 private:
+    boost::optional<size_t> copies_from_key(
+        const store_key_t &key,
+        size_t default_copies,
+        const boost::optional<std::string> &skey_left) const;
+
     const rget_io_data_t io; // How do get data in/out.
     job_data_t job; // What to do next (stateful).
     const boost::optional<rget_sindex_data_t> sindex; // Optional sindex information.
@@ -702,6 +724,8 @@ private:
     boost::optional<std::string> last_truncated_secondary_for_abort;
     scoped_ptr_t<profile::disabler_t> disabler;
     scoped_ptr_t<profile::sampler_t> sampler;
+    size_t num_stored_fields_reads;
+    size_t num_row_reads;
 };
 
 // This is the interface the btree code expects, but our actual callback needs a
@@ -723,6 +747,10 @@ public:
             skey_left,
             std::move(waiter));
     }
+    // Range reads visit every leaf in their range, unless they stop early.
+    virtual bool should_read_ahead() THROWS_NOTHING {
+        return true;
+    }
 private:
     rget_cb_t *cb;
     size_t copies;
@@ -735,7 +763,9 @@ rget_cb_t::rget_cb_t(rget_io_data_t &&_io,
     : io(std::move(_io)),
       job(std::move(_job)),
       sindex(std::move(_sindex)),
-      bad_init(false) {
+      bad_init(false),
+      num_stored_fields_reads(0),
+      num_row_reads(0) {
 
     if (sindex) {
         // Secondary index functions are deterministic (so no need for an
@@ -758,6 +788,119 @@ void rget_cb_t::finish(continue_bool_t last_cb) THROWS_ONLY(interrupted_exc_t) {
     job.accumulator->finish(last_cb, &io.response->result);
 }
 
+// Returns how many copies of the row at `key` are in the sindex range, or nothing if
+// that can't be told from the key alone because the secondary index value in the key
+// is truncated. In that case, the caller has to compute the secondary index value and
+// check it against the `datumspec`.
+boost::optional<size_t> rget_cb_t::copies_from_key(
+        const store_key_t &key,
+        size_t default_copies,
+        const boost::optional<std::string> &skey_left) const {
+    guarantee(sindex);
+    /* Here's an attempt at explaining the different case distinctions handled in
+       this check (for the left bound; the right bound check is similar):
+       The case distinctions are as follows:
+       1. left_bound_is_truncated
+        If the left bound key had to be truncated, we first compare the prefix of
+        the current secondary key (skey_current), and the left bound key.
+        The comparison cannot be -1, because that would mean that we computed the
+        traversal key range incorrectly in the first place (there's no need to
+        consider keys that are *smaller* than the left bound).
+        If the comparison is 1, the current key's secondary part is larger than
+        the left bound, and we know that the corresponding datum_t value must
+        also be larger than the datum_t corresponding to the left bound.
+        Finally, since the left bound is truncated, the comparison can determine
+        that the prefix is equal for values in the btree with corresponding index
+        values that are either left of the bound (but match in the truncated
+        prefix), at the bound (which we want to include only if the left bound is
+        closed), or right of the bound (which we always want to include, as far
+        as the left bound id concerned). We can't determine which case we have,
+        by looking only at the keys. Hence we must check the number of copies for
+        `cmp == 0`. The only exception is if the current key was actually not
+        truncated, in which case we know that it will actually be smaller than
+        the left bound (that's encoded in line 825).
+       2. !left_bound_is_truncated && left_bound is closed
+        If the bound wasn't truncated, we know that the traversal range will not
+        include any values which are smaller than the left bound. Hence we can
+        skip the check for whether the sindex value is actually in the datum
+        range.
+       3. !left_bound_is_truncated && left_bound is open
+        In contrast, if the left bound is open, we compare the left bound and
+        current key. If they have the same size and their contents compare equal,
+        we know that they are outside the range if the current key isn't truncated
+        (in which case neither is the bound), and there are 0 copies. If the
+        current key is truncated, we check the number of copies as in case 1. */
+    const size_t max_trunc_size = ql::datum_t::max_trunc_size();
+    boost::optional<size_t> copies = default_copies;
+    sindex->datumspec.visit<void>(
+    [&](const ql::datum_range_t &r) {
+        bool must_check_copies = false;
+        std::string skey_current =
+            ql::datum_t::extract_truncated_secondary(key_to_unescaped_str(key));
+        const bool left_bound_is_truncated =
+            sindex->lbound_trunc_key.size() == max_trunc_size;
+        if (left_bound_is_truncated
+            || r.left_bound_type == key_range_t::bound_t::open) {
+            int cmp = memcmp(
+                skey_current.data(),
+                sindex->lbound_trunc_key.data(),
+                std::min<size_t>(skey_current.size(),
+                                 sindex->lbound_trunc_key.size()));
+            if (skey_current.size() < sindex->lbound_trunc_key.size()) {
+                guarantee(cmp != 0);
+            }
+            guarantee(cmp >= 0);
+            if (cmp == 0
+                && skey_current.size() == sindex->lbound_trunc_key.size()) {
+                must_check_copies = true;
+            }
+        }
+        if (!must_check_copies) {
+            const bool right_bound_is_truncated =
+                sindex->rbound_trunc_key.size() == max_trunc_size;
+            if (right_bound_is_truncated
+                || r.right_bound_type == key_range_t::bound_t::open) {
+                int cmp = memcmp(
+                    skey_current.data(),
+                    sindex->rbound_trunc_key.data(),
+                    std::min<size_t>(skey_current.size(),
+                                     sindex->rbound_trunc_key.size()));
+                if (skey_current.size() > sindex->rbound_trunc_key.size()) {
+                    guarantee(cmp != 0);
+                }
+                guarantee(cmp <= 0);
+                if (cmp == 0
+                    && skey_current.size() == sindex->rbound_trunc_key.size()) {
+                    must_check_copies = true;
+                }
+            }
+        }
+        if (!must_check_copies) {
+            copies = 1;
+        } else if (skey_current.size() < max_trunc_size) {
+            copies = 0;
+        } else {
+            copies = boost::none;
+        }
+    },
+    [&](const std::map<ql::datum_t, uint64_t> &) {
+        guarantee(skey_left);
+        std::string skey_current =
+            ql::datum_t::extract_secondary(key_to_unescaped_str(key));
+        const bool skey_current_is_truncated =
+            skey_current.size() >= max_trunc_size;
+        const bool skey_left_is_truncated = skey_left->size() >= max_trunc_size;
+
+        if (skey_current_is_truncated || skey_left_is_truncated) {
+            copies = boost::none;
+        } else if (*skey_left != skey_current) {
+            copies = 0;
+        }
+    });
+
+    return copies;
+}
+
 // Handle a keyvalue pair.  Returns whether or not we're done early.
 continue_bool_t rget_cb_t::handle_pair(
     scoped_key_value_t &&keyvalue,
@@ -779,16 +922,29 @@ continue_bool_t rget_cb_t::handle_pair(
         return continue_bool_t::CONTINUE;
     }
     lazy_btree_val_t row(static_cast<const rdb_value_t *>(keyvalue.value()),
-                         keyvalue.expose_buf());
+                         keyvalue.expose_buf(),
+                         sindex ? sindex->layout : rdb_value_layout_t::ROW);
     ql::datum_t val;
     // Count stats whether or not we deserialize the value
     io.slice->stats.pm_keys_read.record();
     io.slice->stats.pm_total_keys_read += 1;
+    // For a secondary index read, the key usually tells us whether the row is in the
+    // sindex range. We only need the value to check that if the key is truncated.
+    boost::optional<size_t> key_copies;
+    if (sindex) {
+        key_copies = copies_from_key(key, default_copies, skey_left);
+    }
     // We only load the value if we actually use it (`count` does not).
-    if (job.accumulator->uses_val() || job.transformers.size() != 0 || sindex) {
-        val = row.get();
-    } else {
+    if (!job.accumulator->uses_val() && job.transformers.size() == 0
+        && (!sindex || key_copies)) {
+        row.reset();
+    } else if (sindex && sindex->read_stored_fields) {
+        val = row.get_stored_fields();
         row.reset();
+        ++num_stored_fields_reads;
+    } else {
+        val = row.get();
+        ++num_row_reads;
     }
     guarantee(!row.references_parent());
     keyvalue.reset();
@@ -852,7 +1008,15 @@ continue_bool_t rget_cb_t::handle_pair(
             if (sindex && !sindex_val_cache.has()) {
                 sindex_val_cache =
                     sindex->func->call(sindex_env.get(), val)->as_datum();
-                if (sindex->multi == sindex_multi_bool_t::MULTI
+                if (sindex->geo == sindex_geo_bool_t::TRIGRAM) {
+                    // The key's tag is the position of its trigram in the list.
+                    boost::optional<uint64_t> tag = *ql::datum_t::extract_tag(key);
+                    guarantee(tag);
+                    std::vector<ql::datum_t> trigrams =
+                        ql::compute_trigrams(sindex_val_cache);
+                    guarantee(*tag < trigrams.size());
+                    sindex_val_cache = trigrams[*tag];
+                } else if (sindex->multi == sindex_multi_bool_t::MULTI
                     && sindex_val_cache.get_type() == ql::datum_t::R_ARRAY) {
                     boost::optional<uint64_t> tag = *ql::datum_t::extract_tag(key);
                     guarantee(tag);
@@ -864,108 +1028,11 @@ continue_bool_t rget_cb_t::handle_pair(
         };
 
         // Check whether we're outside the sindex range.
-        // We only need to check this if we are on the boundary of the sindex range, and
-        // the involved keys are truncated.
         size_t copies = default_copies;
         if (sindex) {
-            /* Here's an attempt at explaining the different case distinctions handled in
-               this check (for the left bound; the right bound check is similar):
-               The case distinctions are as follows:
-               1. left_bound_is_truncated
-                If the left bound key had to be truncated, we first compare the prefix of
-                the current secondary key (skey_current), and the left bound key.
-                The comparison cannot be -1, because that would mean that we computed the
-                traversal key range incorrectly in the first place (there's no need to
-                consider keys that are *smaller* than the left bound).
-                If the comparison is 1, the current key's secondary part is larger than
-                the left bound, and we know that the corresponding datum_t value must
-                also be larger than the datum_t corresponding to the left bound.
-                Finally, since the left bound is truncated, the comparison can determine
-                that the prefix is equal for values in the btree with corresponding index
-                values that are either left of the bound (but match in the truncated
-                prefix), at the bound (which we want to include only if the left bound is
-                closed), or right of the bound (which we always want to include, as far
-                as the left bound id concerned). We can't determine which case we have,
-                by looking only at the keys. Hence we must check the number of copies for
-                `cmp == 0`. The only exception is if the current key was actually not
-                truncated, in which case we know that it will actually be smaller than
-                the left bound (that's encoded in line 825).
-               2. !left_bound_is_truncated && left_bound is closed
-                If the bound wasn't truncated, we know that the traversal range will not
-                include any values which are smaller than the left bound. Hence we can
-                skip the check for whether the sindex value is actually in the datum
-                range.
-               3. !left_bound_is_truncated && left_bound is open
-                In contrast, if the left bound is open, we compare the left bound and
-                current key. If they have the same size and their contents compare equal,
-                we actually know that they are outside the range and could set the number
-                of copies to 0. We do the slightly less optimal but simpler thing and
-                just check the number of copies in this case, so that we can share the
-                code path with case 1. */
-            const size_t max_trunc_size = ql::datum_t::max_trunc_size();
-            sindex->datumspec.visit<void>(
-            [&](const ql::datum_range_t &r) {
-                bool must_check_copies = false;
-                std::string skey_current =
-                    ql::datum_t::extract_truncated_secondary(key_to_unescaped_str(key));
-                const bool left_bound_is_truncated =
-                    sindex->lbound_trunc_key.size() == max_trunc_size;
-                if (left_bound_is_truncated
-                    || r.left_bound_type == key_range_t::bound_t::open) {
-                    int cmp = memcmp(
-                        skey_current.data(),
-                        sindex->lbound_trunc_key.data(),
-                        std::min<size_t>(skey_current.size(),
-                                         sindex->lbound_trunc_key.size()));
-                    if (skey_current.size() < sindex->lbound_trunc_key.size()) {
-                        guarantee(cmp != 0);
-                    }
-                    guarantee(cmp >= 0);
-                    if (cmp == 0
-                        && skey_current.size() == sindex->lbound_trunc_key.size()) {
-                        must_check_copies = true;
-                    }
-                }
-                if (!must_check_copies) {
-                    const bool right_bound_is_truncated =
-                        sindex->rbound_trunc_key.size() == max_trunc_size;
-                    if (right_bound_is_truncated
-                        || r.right_bound_type == key_range_t::bound_t::open) {
-                        int cmp = memcmp(
-                            skey_current.data(),
-                            sindex->rbound_trunc_key.data(),
-                            std::min<size_t>(skey_current.size(),
-                                             sindex->rbound_trunc_key.size()));
-                        if (skey_current.size() > sindex->rbound_trunc_key.size()) {
-                            guarantee(cmp != 0);
-                        }
-                        guarantee(cmp <= 0);
-                        if (cmp == 0
-                            && skey_current.size() == sindex->rbound_trunc_key.size()) {
-                            must_check_copies = true;
-                        }
-                    }
-                }
-                if (must_check_copies) {
-                    copies = sindex->datumspec.copies(lazy_sindex_val());
-                } else {
-                    copies = 1;
-                }
-            },
-            [&](const std::map<ql::datum_t, uint64_t> &) {
-                guarantee(skey_left);
-                std::string skey_current =
-                    ql::datum_t::extract_secondary(key_to_unescaped_str(key));
-                const bool skey_current_is_truncated =
-                    skey_current.size() >= max_trunc_size;
-                const bool skey_left_is_truncated = skey_left->size() >= max_trunc_size;
-
-                if (skey_current_is_truncated || skey_left_is_truncated) {
-                    copies = sindex->datumspec.copies(lazy_sindex_val());
-                } else if (*skey_left != skey_current) {
-                    copies = 0;
-                }
-            });
+            copies = key_copies
+                ? *key_copies
+                : sindex->datumspec.copies(lazy_sindex_val());
             if (copies == 0) {
                 return continue_bool_t::CONTINUE;
             }
@@ -1091,7 +1158,7 @@ void rdb_rget_secondary_slice(
         rget_read_response_t *response,
         release_superblock_t release_superblock) {
     r_sanity_check(boost::get<ql::exc_t>(&response->result) == nullptr);
-    guarantee(sindex_info.geo == sindex_geo_bool_t::REGULAR);
+    guarantee(sindex_info.geo != sindex_geo_bool_t::GEO);
     PROFILE_STARTER_IF_ENABLED(
         ql_env->profile() == profile_bool_t::PROFILE,
         "Do range scan on secondary index.",
@@ -1099,48 +1166,72 @@ void rdb_rget_secondary_slice(
 
     const reql_version_t sindex_func_reql_version =
         sindex_info.mapping_version_info.latest_compatible_reql_version;
+    const bool read_stored_fields = ql::stored_fields_cover_read(
+        sindex_info.stored_fields, sindex_info.mapping, transforms, terminal);
 
-    key_range_t active_region_range = sindex_region_range;
-    rget_cb_t callback(
-        rget_io_data_t(response, slice),
-        job_data_t(ql_env,
-                   batchspec,
-                   transforms,
-                   terminal,
-                   shard,
-                   !reversed(sorting)
-                       ? sindex_region_range.left
-                       : sindex_region_range.right.key_or_max(),
-                   sorting,
-                   require_sindex_val),
-        rget_sindex_data_t(
-            pk_range,
-            datumspec,
-            &active_region_range,
-            sindex_func_reql_version,
-            sindex_info.mapping,
-            sindex_info.multi));
+    // The callback disables profiling while it exists.
+    size_t stored_fields_reads, row_reads;
+    {
+        key_range_t active_region_range = sindex_region_range;
+        rget_cb_t callback(
+            rget_io_data_t(response, slice),
+            job_data_t(ql_env,
+                       batchspec,
+                       transforms,
+                       terminal,
+                       shard,
+                       !reversed(sorting)
+                           ? sindex_region_range.left
+                           : sindex_region_range.right.key_or_max(),
+                       sorting,
+                       require_sindex_val),
+            rget_sindex_data_t(
+                pk_range,
+                datumspec,
+                &active_region_range,
+                sindex_func_reql_version,
+                sindex_info.mapping,
+                sindex_info.multi,
+                sindex_info.geo,
+                sindex_info.stored_fields.empty()
+                    ? rdb_value_layout_t::ROW
+                    : rdb_value_layout_t::STORED_FIELDS_AND_ROW,
+                read_stored_fields));
+
+        direction_t direction = reversed(sorting) ? BACKWARD : FORWARD;
+        auto cb = [&](const std::pair<ql::datum_range_t, uint64_t> &pair,
+                      bool is_last) {
+            key_range_t sindex_keyrange =
+                pair.first.to_sindex_keyrange(sindex_func_reql_version);
+            rget_cb_wrapper_t wrapper(
+                &callback,
+                pair.second,
+                key_to_unescaped_str(sindex_keyrange.left));
+            key_range_t active_range =
+                active_region_range.intersection(sindex_keyrange);
+            // This can happen sometimes with truncated keys.
+            if (active_range.is_empty()) return continue_bool_t::CONTINUE;
+            return btree_concurrent_traversal(
+                superblock,
+                active_range,
+                &wrapper,
+                direction,
+                is_last ? release_superblock : release_superblock_t::KEEP);
+        };
+        continue_bool_t cont = datumspec.iter(sorting, cb);
+        callback.finish(cont);
+        stored_fields_reads = callback.stored_fields_reads();
+        row_reads = callback.row_reads();
+    }
 
-    direction_t direction = reversed(sorting) ? BACKWARD : FORWARD;
-    auto cb = [&](const std::pair<ql::datum_range_t, uint64_t> &pair, bool is_last) {
-        key_range_t sindex_keyrange =
-            pair.first.to_sindex_keyrange(sindex_func_reql_version);
-        rget_cb_wrapper_t wrapper(
-            &callback,
-            pair.second,
-            key_to_unescaped_str(sindex_keyrange.left));
-        key_range_t active_range = active_region_range.intersection(sindex_keyrange);
-        // This can happen sometimes with truncated keys.
-        if (active_range.is_empty()) return continue_bool_t::CONTINUE;
-        return btree_concurrent_traversal(
-            superblock,
-            active_range,
-            &wrapper,
-            direction,
-            is_last ? release_superblock : release_superblock_t::KEEP);
-    };
-    continue_bool_t cont = datumspec.iter(sorting, cb);
-    callback.finish(cont);
+    if (!sindex_info.stored_fields.empty()
+        && ql_env->profile() == profile_bool_t::PROFILE) {
+        profile::starter_t stored_fields_starter(
+            strprintf("Read %zu rows from the fields stored in the index, "
+                      "and %zu whole rows.",
+                      stored_fields_reads, row_reads),
+            ql_env->trace);
+    }
 }
 
 void rdb_get_intersecting_slice(
@@ -1531,6 +1622,22 @@ void compute_keys(const store_key_t &primary_key,
     ql::datum_t index =
         index_info.mapping.compile_wire_func()->call(&sindex_env, doc)->as_datum();
 
+    if (index_info.geo == sindex_geo_bool_t::TRIGRAM) {
+        // Each trigram is stored like an element of a multi index, tagged with its
+        // position in the sorted trigram list.
+        std::vector<ql::datum_t> trigrams = ql::compute_trigrams(index);
+        for (uint64_t i = 0; i < trigrams.size(); ++i) {
+            std::string store_key =
+                trigrams[i].print_secondary(reql_version, primary_key, i);
+            keys_out->push_back(std::make_pair(store_key_t(store_key), trigrams[i]));
+            if (cfeed_keys_out != nullptr) {
+                cfeed_keys_out->push_back(
+                    std::make_pair(trigrams[i], std::move(store_key)));
+            }
+        }
+        return;
+    }
+
     if (index_info.multi == sindex_multi_bool_t::MULTI
         && index.get_type() == ql::datum_t::R_ARRAY) {
         for (uint64_t i = 0; i < index.arr_size(); ++i) {
@@ -1617,6 +1724,7 @@ void serialize_sindex_info(write_message_t *wm,
     serialize<cluster_version_t::LATEST_DISK>(wm, info.mapping);
     serialize<cluster_version_t::LATEST_DISK>(wm, info.multi);
     serialize<cluster_version_t::LATEST_DISK>(wm, info.geo);
+    serialize<cluster_version_t::LATEST_DISK>(wm, info.stored_fields);
 }
 
 void deserialize_sindex_info(
@@ -1656,7 +1764,8 @@ void deserialize_sindex_info(
     case cluster_version_t::v2_1:
     case cluster_version_t::v2_2:
     case cluster_version_t::v2_3:
-    case cluster_version_t::v2_4_is_latest:
+    case cluster_version_t::v2_4:
+    case cluster_version_t::v2_5_is_latest:
         success = deserialize_reql_version(
                 &read_stream,
                 &info_out->mapping_version_info.original_reql_version,
@@ -1693,12 +1802,31 @@ void deserialize_sindex_info(
     case cluster_version_t::v2_1: // fallthru
     case cluster_version_t::v2_2: // fallthru
     case cluster_version_t::v2_3: // fallthru
-    case cluster_version_t::v2_4_is_latest:
+    case cluster_version_t::v2_4: // fallthru
+    case cluster_version_t::v2_5_is_latest:
         success = deserialize_for_version(cluster_version, &read_stream, &info_out->geo);
         throw_if_bad_deserialization(success, "sindex description");
         break;
     default: unreachable();
     }
+    switch (cluster_version) {
+    case cluster_version_t::v1_14: // fallthru
+    case cluster_version_t::v1_15: // fallthru
+    case cluster_version_t::v1_16: // fallthru
+    case cluster_version_t::v2_0: // fallthru
+    case cluster_version_t::v2_1: // fallthru
+    case cluster_version_t::v2_2: // fallthru
+    case cluster_version_t::v2_3: // fallthru
+    case cluster_version_t::v2_4:
+        info_out->stored_fields.clear();
+        break;
+    case cluster_version_t::v2_5_is_latest:
+        success = deserialize_for_version(
+            cluster_version, &read_stream, &info_out->stored_fields);
+        throw_if_bad_deserialization(success, "sindex description");
+        break;
+    default: unreachable();
+    }
     guarantee(static_cast<size_t>(read_stream.tell()) == data.size(),
               "An sindex description was incompletely deserialized.");
 }
@@ -1727,6 +1855,58 @@ void deserialize_sindex_info_or_crash(
         });
 }
 
+/* The entries of secondary indexes that store fields own a blob with the stored fields
+and a reference to the blob of the row in the primary index. After detaching such an
+entry from the tree, we delete its own blob once the leaf node has been released, just
+like `rdb_update_sindexes` deletes the blob of a row after updating all the indexes. */
+static std::vector<char> rdb_value_ref(keyvalue_location_t *kv_location) {
+    const max_block_size_t block_size = kv_location->buf.cache()->max_block_size();
+    const rdb_value_t *value = kv_location->value_as<rdb_value_t>();
+    return std::vector<char>(value->value_ref(),
+                             value->value_ref() + value->inline_size(block_size));
+}
+
+static void delete_owned_value(sindex_superblock_t *superblock,
+                               std::vector<char> *value_ref) {
+    if (!value_ref->empty()) {
+        rdb_value_deleter_t deleter;
+        deleter.delete_value(buf_parent_t(superblock->get()->txn()), value_ref->data());
+        value_ref->clear();
+    }
+}
+
+/* Sets the entry at `kv_location` to a new blob holding `value`, which the entry owns.
+Returns the reference to the blob of the entry that was there before, if any. */
+static std::vector<char> kv_location_set_owned(
+        keyvalue_location_t *kv_location,
+        const store_key_t &key,
+        const write_message_t &value,
+        const deletion_context_t *deletion_context) {
+    const max_block_size_t block_size = kv_location->buf.cache()->max_block_size();
+    scoped_malloc_t<rdb_value_t> new_value(blob::btree_maxreflen);
+    memset(new_value.get(), 0, blob::btree_maxreflen);
+    {
+        blob_t blob(block_size, new_value->value_ref(), blob::btree_maxreflen);
+        write_onto_blob(buf_parent_t(&kv_location->buf), &blob, value);
+    }
+
+    std::vector<char> old_value_ref;
+    if (kv_location->value.has()) {
+        old_value_ref = rdb_value_ref(kv_location);
+        deletion_context->in_tree_deleter()->delete_value(
+                buf_parent_t(&kv_location->buf), kv_location->value.get());
+    }
+
+    kv_location->value = std::move(new_value);
+    null_key_modification_callback_t null_cb;
+    rdb_value_sizer_t sizer(block_size);
+    apply_keyvalue_change(&sizer, kv_location, key.btree_key(),
+                          repli_timestamp_t::distant_past,
+                          deletion_context->balancing_detacher(), &null_cb,
+                          delete_mode_t::REGULAR_QUERY);
+    return old_value_ref;
+}
+
 /* Used below by rdb_update_sindexes. */
 void rdb_update_single_sindex(
         store_t *store,
@@ -1787,6 +1967,7 @@ void rdb_update_single_sindex(
                         }
                     }, cserver.second);
             }
+            std::vector<char> owned_value_ref;
             for (auto it = keys.begin(); it != keys.end(); ++it) {
                 promise_t<superblock_t *> return_superblock_local;
                 {
@@ -1804,6 +1985,9 @@ void rdb_update_single_sindex(
                         &return_superblock_local);
 
                     if (kv_location.value.has()) {
+                        if (!sindex_info.stored_fields.empty()) {
+                            owned_value_ref = rdb_value_ref(&kv_location);
+                        }
                         kv_location_delete(
                             &kv_location,
                             it->first,
@@ -1816,6 +2000,7 @@ void rdb_update_single_sindex(
                 }
                 superblock =
                     static_cast<sindex_superblock_t *>(return_superblock_local.wait());
+                delete_owned_value(superblock, &owned_value_ref);
             }
         } catch (const ql::base_exc_t &) {
             // Do nothing (it wasn't actually in the index).
@@ -1840,6 +2025,12 @@ void rdb_update_single_sindex(
             compute_keys(
                 modification->primary_key, added, sindex_info,
                 &keys, cfeed_new_keys_out);
+            write_message_t stored_value;
+            if (!sindex_info.stored_fields.empty()) {
+                ql::serialize_stored_fields_value(
+                    &stored_value, sindex_info.stored_fields, added,
+                    modification->info.added.second);
+            }
             if (keys_available_cond != nullptr) {
                 guarantee(*updates_left > 0);
                 decremented_updates_left = true;
@@ -1864,6 +2055,7 @@ void rdb_update_single_sindex(
                         }
                     }, cserver.second);
             }
+            std::vector<char> owned_value_ref;
             for (auto it = keys.begin(); it != keys.end(); ++it) {
                 promise_t<superblock_t *> return_superblock_local;
                 {
@@ -1880,17 +2072,23 @@ void rdb_update_single_sindex(
                         trace,
                         &return_superblock_local);
 
-                    ql::serialization_result_t res =
-                        kv_location_set(&kv_location, it->first,
-                                        modification->info.added.second,
-                                        repli_timestamp_t::distant_past,
-                                        deletion_context);
-                    // this particular context cannot fail AT THE MOMENT.
-                    guarantee(!bad(res));
+                    if (sindex_info.stored_fields.empty()) {
+                        ql::serialization_result_t res =
+                            kv_location_set(&kv_location, it->first,
+                                            modification->info.added.second,
+                                            repli_timestamp_t::distant_past,
+                                            deletion_context);
+                        // this particular context cannot fail AT THE MOMENT.
+                        guarantee(!bad(res));
+                    } else {
+                        owned_value_ref = kv_location_set_owned(
+                            &kv_location, it->first, stored_value, deletion_context);
+                    }
                     // The keyvalue location gets destroyed here.
                 }
                 superblock = static_cast<sindex_superblock_t *>(
                     return_superblock_local.wait());
+                delete_owned_value(superblock, &owned_value_ref);
             }
         } catch (const ql::base_exc_t &) {
             // Do nothing (we just drop the row from the index).
@@ -2251,7 +2449,8 @@ void post_construct_secondary_index_range(
         interruptor);
 
     cache_account
-        = txn->cache()->create_cache_account(SINDEX_POST_CONSTRUCTION_CACHE_PRIORITY);
+        = txn->cache()->create_cache_account(io_class_t::sindex_build,
+                                             SINDEX_POST_CONSTRUCTION_CACHE_PRIORITY);
     txn->set_account(&cache_account);
 
     continue_bool_t cont = btree_concurrent_traversal(
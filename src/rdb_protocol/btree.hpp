@@ -262,13 +262,17 @@ struct sindex_disk_info_t {
     sindex_disk_info_t(const ql::map_wire_func_t &_mapping,
                        const sindex_reql_version_info_t &_mapping_version_info,
                        sindex_multi_bool_t _multi,
-                       sindex_geo_bool_t _geo) :
+                       sindex_geo_bool_t _geo,
+                       const std::vector<std::string> &_stored_fields) :
         mapping(_mapping), mapping_version_info(_mapping_version_info),
-        multi(_multi), geo(_geo) { }
+        multi(_multi), geo(_geo), stored_fields(_stored_fields) { }
     ql::map_wire_func_t mapping;
     sindex_reql_version_info_t mapping_version_info;
     sindex_multi_bool_t multi;
     sindex_geo_bool_t geo;
+    /* Top-level fields that are copied into the index entries; see
+    `rdb_protocol/stored_fields.hpp`. Empty for indexes from before v2.5. */
+    std::vector<std::string> stored_fields;
 };
 
 void serialize_sindex_info(write_message_t *wm,
@@ -21,6 +21,8 @@
 #include "logger.hpp"
 #include "rdb_protocol/btree.hpp"
 #include "rdb_protocol/erase_range.hpp"
+#include "rdb_protocol/error.hpp"
+#include "rdb_protocol/lazy_btree_val.hpp"
 #include "rdb_protocol/protocol.hpp"
 #include "stl_utils.hpp"
 
@@ -89,6 +91,7 @@ store_t::store_t(const region_t &_region,
                  update_sindexes_t _update_sindexes)
     : store_view_t(_region),
       perfmon_collection(),
+      serializer_(serializer),
       io_backender_(io_backender), base_path_(base_path),
       perfmon_collection_membership(parent_perfmon_collection, &perfmon_collection, perfmon_name),
       ctx(_ctx),
@@ -201,6 +204,31 @@ void store_t::read(
     protocol_read(_read, response, superblock.get(), interruptor);
 }
 
+void store_t::warm_cache(
+        const std::vector<store_key_t> &keys,
+        signal_t *interruptor)
+        THROWS_ONLY(interrupted_exc_t) {
+    assert_thread();
+    cache_account_t account =
+        cache->create_cache_account(io_class_t::prefetch,
+                                    REPLICA_HOT_SET_CACHE_PRIORITY);
+    for (const store_key_t &key : keys) {
+        if (interruptor->is_pulsed()) {
+            throw interrupted_exc_t();
+        }
+        if (!get_region().inner.contains_key(key)) {
+            continue;
+        }
+        read_token_t token;
+        new_read_token(&token);
+        scoped_ptr_t<txn_t> txn;
+        scoped_ptr_t<real_superblock_t> superblock;
+        acquire_superblock_for_read(&token, &txn, &superblock, interruptor, false);
+        txn->set_account(&account);
+        warm_keyvalue_location(superblock.get(), key.btree_key());
+    }
+}
+
 void store_t::write(
         DEBUG_ONLY(const metainfo_checker_t& metainfo_checker, )
         const region_map_t<binary_blob_t>& new_metainfo,
@@ -335,6 +363,7 @@ std::map<std::string, std::pair<sindex_config_t, sindex_status_t> > store_t::sin
         res->first.func_version = disk_info.mapping_version_info.original_reql_version;
         res->first.multi = disk_info.multi;
         res->first.geo = disk_info.geo;
+        res->first.stored_fields = disk_info.stored_fields;
 
         res->second.outdated =
             (disk_info.mapping_version_info.latest_compatible_reql_version !=
@@ -381,7 +410,8 @@ void store_t::sindex_create(
     version_info.original_reql_version = config.func_version;
     version_info.latest_compatible_reql_version = config.func_version;
     version_info.latest_checked_reql_version = reql_version_t::LATEST;
-    sindex_disk_info_t info(config.func, version_info, config.multi, config.geo);
+    sindex_disk_info_t info(config.func, version_info, config.multi, config.geo,
+                            config.stored_fields);
 
     write_message_t wm;
     serialize_sindex_info(&wm, info);
@@ -703,6 +733,24 @@ private:
     store_key_t last_traversed_key;
 };
 
+/* Whether the entries of `sindex` own their blobs, because the index stores fields (see
+`rdb_protocol/stored_fields.hpp`). Indexes in formats that we can't read anymore can't
+store fields. */
+static bool sindex_owns_values(const secondary_index_t &sindex) {
+    sindex_disk_info_t sindex_info;
+    try {
+        deserialize_sindex_info(sindex.opaque_definition, &sindex_info,
+            [](obsolete_reql_version_t) {
+                throw archive_exc_t("Obsolete secondary index.");
+            });
+    } catch (const archive_exc_t &) {
+        return false;
+    } catch (const ql::base_exc_t &) {
+        return false;
+    }
+    return !sindex_info.stored_fields.empty();
+}
+
 void store_t::clear_sindex_data(
         uuid_u sindex_id,
         value_sizer_t *sizer,
@@ -744,6 +792,9 @@ void store_t::clear_sindex_data(
             return;
         }
 
+        const bool owns_values = sindex_owns_values(sindex);
+        rdb_value_deleter_t owned_value_deleter;
+
         /* Clear part of the index data */
         buf_lock_t sindex_superblock_lock(buf_parent_t(&sindex_block),
                                           sindex.superblock, access_t::write);
@@ -781,6 +832,7 @@ void store_t::clear_sindex_data(
         const std::vector<store_key_t> &keys = traversal_cb.get_keys();
         for (size_t i = 0; i < keys.size(); ++i) {
             promise_t<superblock_t *> superblock_promise;
+            std::vector<char> owned_value_ref;
             {
                 keyvalue_location_t kv_location;
                 find_keyvalue_location_for_write(sizer, sindex_superblock.release(),
@@ -790,6 +842,12 @@ void store_t::clear_sindex_data(
                         &superblock_promise);
 
                 if (kv_location.there_originally_was_value) {
+                    if (owns_values) {
+                        const rdb_value_t *value = kv_location.value_as<rdb_value_t>();
+                        owned_value_ref.assign(
+                            value->value_ref(),
+                            value->value_ref() + sizer->size(value));
+                    }
                     deletion_context->in_tree_deleter()->delete_value(
                         buf_parent_t(&kv_location.buf), kv_location.value.get());
                     kv_location.value.reset();
@@ -814,6 +872,13 @@ void store_t::clear_sindex_data(
             /* Reclaim the sindex superblock for the next deletion */
             sindex_superblock.init(static_cast<sindex_superblock_t *>(
                 superblock_promise.wait()));
+
+            /* Entries of indexes that store fields have their own blob, which we
+            delete even if the deletion context only detaches values. */
+            if (!owned_value_ref.empty()) {
+                owned_value_deleter.delete_value(buf_parent_t(txn.get()),
+                                                 owned_value_ref.data());
+            }
         }
 
         sindex_superblock.reset();
@@ -927,6 +992,7 @@ bool secondary_indexes_are_equivalent(const std::vector<char> &left,
 
     if (sindex_info_left.multi == sindex_info_right.multi &&
         sindex_info_left.geo == sindex_info_right.geo &&
+        sindex_info_left.stored_fields == sindex_info_right.stored_fields &&
         sindex_info_left.mapping_version_info.original_reql_version ==
             sindex_info_right.mapping_version_info.original_reql_version) {
         // Need to determine if the mapping function is the same, re-serialize them
@@ -847,6 +847,10 @@ bool limit_order_t::operator()(const std::string &a, const std::string &b) const
     unreachable();
 }
 
+// The maximum number of items beyond the top `n` that a `limit_manager_t` keeps in
+// memory to replace items that drop out of the top `n`.
+const size_t MAX_LIMIT_SPARE_ITEMS = 128;
+
 void limit_manager_t::send(msg_t &&msg) {
     if (!parent->drainer.is_draining()) {
         auto_drainer_t::lock_t drain_lock(&parent->drainer);
@@ -879,6 +883,8 @@ limit_manager_t::limit_manager_t(
       spec(std::move(_spec)),
       gt(std::move(_gt)),
       item_queue(gt),
+      spare_limit(std::min<size_t>(spec.limit, MAX_LIMIT_SPARE_ITEMS)),
+      spare_queue(gt),
       aborted(false) {
     guarantee(clients_lock->read_signal()->is_pulsed());
 
@@ -950,14 +956,16 @@ public:
                   const keyspec_t::limit_t *_spec,
                   sorting_t _sorting,
                   boost::optional<item_t> _start,
-                  const item_queue_t *_item_queue)
+                  const item_queue_t *_item_queue,
+                  size_t _extra)
         : env(_env),
           ops(_ops),
           pk_range(_pk_range),
           spec(_spec),
           sorting(_sorting),
           start(std::move(_start)),
-          item_queue(_item_queue) { }
+          item_queue(_item_queue),
+          extra(_extra) { }
 
     std::vector<item_t> operator()(const primary_ref_t &ref) {
         rget_read_response_t resp;
@@ -980,7 +988,7 @@ public:
         case sorting_t::UNORDERED: // fallthru
         default: unreachable();
         }
-        size_t n = spec->limit - item_queue->size();
+        size_t n = spec->limit - item_queue->size() + extra;
         rdb_rget_slice(
             ref.btree,
             region_t(),
@@ -1035,7 +1043,7 @@ public:
                 [](const datum_range_t &) { return true; },
                 [](const std::map<datum_t, uint64_t> &) { return false; }));
         datum_range_t srange = spec->range.datumspec.covering_range();
-        size_t n = spec->limit - item_queue->size();
+        size_t n = spec->limit - item_queue->size() + extra;
         if (start) {
             datum_t dstart = start->second.first;
             switch (sorting) {
@@ -1113,17 +1121,38 @@ private:
     sorting_t sorting;
     boost::optional<item_t> start;
     const item_queue_t *item_queue;
+    // How many items to read beyond those needed to fill the active set
+    size_t extra;
 };
 
 std::vector<item_t> limit_manager_t::read_more(
     const boost::variant<primary_ref_t, sindex_ref_t> &ref,
     const boost::optional<item_t> &start) {
     guarantee(item_queue.size() < spec.limit);
+    // We only go to disk once `spare_queue` has run dry, so we read enough to
+    // refill it as well.
+    guarantee(spare_queue.size() == 0);
     ref_visitor_t visitor(
-        env.get(), &ops, &region.inner, &spec, spec.range.sorting, start, &item_queue);
+        env.get(), &ops, &region.inner, &spec, spec.range.sorting, start, &item_queue,
+        spare_limit);
     return boost::apply_visitor(visitor, ref);
 }
 
+std::vector<std::string> limit_manager_t::truncate_active() {
+    std::vector<std::string> ret;
+    while (item_queue.size() > spec.limit) {
+        auto it = item_queue.begin();
+        item_t item = **it;
+        item_queue.erase(it);
+        ret.push_back(item.first);
+        UNUSED auto res = spare_queue.insert(std::move(item));
+    }
+    // Dropping the worst spare items keeps `spare_queue` contiguous with the
+    // active set.
+    UNUSED std::vector<std::string> dropped = spare_queue.truncate_top(spare_limit);
+    return ret;
+}
+
 void limit_manager_t::commit(
     rwlock_in_line_t *spot,
     const boost::variant<primary_ref_t, sindex_ref_t> &sindex_ref) THROWS_NOTHING {
@@ -1141,6 +1170,13 @@ void limit_manager_t::commit(
     if (item_queue_it != item_queue.end()) {
         active_boundary = **item_queue_it;
     }
+    // Likewise, anything <= the worst spare item (but not in the active set)
+    // is known to be in `spare_queue`.
+    boost::optional<item_t> spare_boundary;
+    auto spare_queue_it = spare_queue.begin();
+    if (spare_queue_it != spare_queue.end()) {
+        spare_boundary = **spare_queue_it;
+    }
 
     item_queue_t real_added(gt);
     std::set<std::string> real_deleted;
@@ -1149,6 +1185,8 @@ void limit_manager_t::commit(
         if (data_deleted) {
             bool inserted = real_deleted.insert(id).second;
             guarantee(inserted);
+        } else {
+            UNUSED bool spare_deleted = spare_queue.del_id(id);
         }
     }
     deleted.clear();
@@ -1165,13 +1203,15 @@ void limit_manager_t::commit(
             guarantee(inserted);
             inserted = real_added.insert(pair).second;
             guarantee(inserted);
+        } else if (spare_boundary && !gt(item_t(pair), *spare_boundary)) {
+            UNUSED auto res = spare_queue.insert(pair);
         } else {
             added_on_disk = true;
         }
     }
     added.clear();
 
-    std::vector<std::string> truncated = item_queue.truncate_top(spec.limit);
+    std::vector<std::string> truncated = truncate_active();
     for (auto &&id : truncated) {
         auto it = real_added.find_id(id);
         if (it != real_added.end()) {
@@ -1182,12 +1222,26 @@ void limit_manager_t::commit(
         }
     }
 
+    // The spare items are the next ones in order, so we use them to refill the
+    // active set before going to disk, and only read past the last of them.
+    boost::optional<item_t> read_start = active_boundary;
+    while (item_queue.size() < spec.limit && spare_queue.size() != 0) {
+        auto it = std::prev(spare_queue.end());
+        item_t item = **it;
+        spare_queue.erase(it);
+        read_start = item;
+        bool inserted = item_queue.insert(item).second;
+        guarantee(inserted);
+        inserted = real_added.insert(std::move(item)).second;
+        guarantee(inserted);
+    }
+
     bool anything_on_disk = real_deleted.size() != 0 || added_on_disk;
     if (item_queue.size() < spec.limit && anything_on_disk) {
         std::vector<item_t> s;
         boost::optional<exc_t> exc;
         try {
-            s = read_more(sindex_ref, active_boundary);
+            s = read_more(sindex_ref, read_start);
         } catch (const exc_t &e) {
             exc = e;
         }
@@ -1205,9 +1259,9 @@ void limit_manager_t::commit(
                 guarantee(added_insert);
             }
         }
-        // We need to truncate again because `read_more` may read too much in
-        // the secondary index case.
-        std::vector<std::string> read_trunc = item_queue.truncate_top(spec.limit);
+        // We need to truncate again because `read_more` reads extra items to
+        // refill `spare_queue`, and may read too much in the secondary index case.
+        std::vector<std::string> read_trunc = truncate_active();
         for (auto &&id : read_trunc) {
             auto it = real_added.find_id(id);
             if (it != real_added.end()) {
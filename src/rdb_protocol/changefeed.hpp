@@ -434,6 +434,9 @@ private:
     std::vector<item_t> read_more(
         const boost::variant<primary_ref_t, sindex_ref_t> &ref,
         const boost::optional<item_t> &start);
+    // Truncates `item_queue` to `spec.limit` items, moving the items that fall out
+    // of the active set into `spare_queue`, and returns their ids.
+    std::vector<std::string> truncate_active();
     void send(msg_t &&msg);
 
     scoped_ptr_t<env_t> env;
@@ -446,6 +449,12 @@ private:
 
     limit_order_t gt;
     item_queue_t item_queue;
+    // The next `spare_limit` items after the active set, so that items dropping out
+    // of the active set can usually be replaced without reading from disk.  If this
+    // isn't empty it always contains every item between the worst item of
+    // `item_queue` and the worst item of `spare_queue`.
+    const size_t spare_limit;
+    item_queue_t spare_queue;
 
     std::map<std::string, std::pair<datum_t, datum_t> > added;
     std::set<std::string> deleted;
@@ -10,7 +10,8 @@
 #include "time.hpp"
 
 bool sindex_config_t::operator==(const sindex_config_t &o) const {
-    if (func_version != o.func_version || multi != o.multi || geo != o.geo) {
+    if (func_version != o.func_version || multi != o.multi || geo != o.geo
+            || stored_fields != o.stored_fields) {
         return false;
     }
     /* This is kind of a hack--we compare the functions by serializing them and comparing
@@ -26,8 +27,35 @@ bool sindex_config_t::operator==(const sindex_config_t &o) const {
     return stream1.vector() == stream2.vector();
 }
 
-RDB_IMPL_SERIALIZABLE_4_SINCE_v2_1(sindex_config_t,
-    func, func_version, multi, geo);
+template <cluster_version_t W>
+void serialize(write_message_t *wm, const sindex_config_t &config) {
+    serialize<W>(wm, config.func);
+    serialize<W>(wm, config.func_version);
+    serialize<W>(wm, config.multi);
+    serialize<W>(wm, config.geo);
+    serialize<W>(wm, config.stored_fields);
+}
+
+template <cluster_version_t W>
+archive_result_t deserialize(read_stream_t *s, sindex_config_t *config) {
+    archive_result_t res = deserialize<W>(s, &config->func);
+    if (bad(res)) { return res; }
+    res = deserialize<W>(s, &config->func_version);
+    if (bad(res)) { return res; }
+    res = deserialize<W>(s, &config->multi);
+    if (bad(res)) { return res; }
+    res = deserialize<W>(s, &config->geo);
+    if (bad(res)) { return res; }
+    /* Stored fields were added in v2_5 */
+    config->stored_fields.clear();
+    if (W >= cluster_version_t::v2_5) {
+        res = deserialize<W>(s, &config->stored_fields);
+        if (bad(res)) { return res; }
+    }
+    return res;
+}
+
+INSTANTIATE_SERIALIZABLE_SINCE_v2_1(sindex_config_t);
 
 bool write_hook_config_t::operator==(const write_hook_config_t &o) const {
     if (func_version != o.func_version) {
@@ -72,7 +100,14 @@ rdb_context_t::stats_t::stats_t(perfmon_collection_t *global_stats)
       queries_per_sec_membership(&qe_stats_collection,
                                  &queries_per_sec, "queries_per_sec"),
       queries_total_membership(&qe_stats_collection,
-                               &queries_total, "queries_total") { }
+                               &queries_total, "queries_total"),
+      http_requests_total_membership(&qe_stats_collection,
+                                     &http_requests_total, "http_requests_total"),
+      http_connections_reused_membership(&qe_stats_collection,
+                                         &http_connections_reused,
+                                         "http_connections_reused"),
+      http_cache_hits_membership(&qe_stats_collection,
+                                 &http_cache_hits, "http_cache_hits") { }
 
 rdb_context_t::rdb_context_t()
     : extproc_pool(nullptr),
@@ -53,12 +53,15 @@ template <class> class cross_thread_watchable_variable_t;
 template <class> class semilattice_read_view_t;
 
 enum class sindex_multi_bool_t { SINGLE = 0, MULTI = 1};
-enum class sindex_geo_bool_t { REGULAR = 0, GEO = 1};
+// Besides geospatial indexes, this also marks trigram indexes (see
+// `rdb_protocol/trigrams.hpp`), the other kind of index whose keys aren't just the
+// index function's value.
+enum class sindex_geo_bool_t { REGULAR = 0, GEO = 1, TRIGRAM = 2};
 
 ARCHIVE_PRIM_MAKE_RANGED_SERIALIZABLE(sindex_multi_bool_t, int8_t,
         sindex_multi_bool_t::SINGLE, sindex_multi_bool_t::MULTI);
 ARCHIVE_PRIM_MAKE_RANGED_SERIALIZABLE(sindex_geo_bool_t, int8_t,
-        sindex_geo_bool_t::REGULAR, sindex_geo_bool_t::GEO);
+        sindex_geo_bool_t::REGULAR, sindex_geo_bool_t::TRIGRAM);
 
 class sindex_config_t {
 public:
@@ -76,6 +79,10 @@ public:
     reql_version_t func_version;
     sindex_multi_bool_t multi;
     sindex_geo_bool_t geo;
+    /* Top-level fields of the row that the index stores in front of every entry, so
+    that queries which only read those fields don't have to load the whole row. See
+    `rdb_protocol/stored_fields.hpp`. */
+    std::vector<std::string> stored_fields;
 };
 RDB_DECLARE_SERIALIZABLE(sindex_config_t);
 
@@ -277,6 +284,7 @@ public:
             const table_generate_config_params_t &config_params,
             const std::string &primary_key,
             write_durability_t durability,
+            uint64_t block_size,
             signal_t *interruptor,
             ql::datum_t *result_out,
             admin_err_t *error_out) = 0;
@@ -373,6 +381,16 @@ public:
             ql::datum_t *result_out,
             admin_err_t *error_out) = 0;
 
+    virtual bool table_backup(
+            auth::user_context_t const &user_context,
+            counted_t<const ql::db_t> db,
+            const name_string_t &name,
+            const std::string &directory,
+            const boost::optional<repli_timestamp_t> &since,
+            signal_t *interruptor,
+            ql::datum_t *result_out,
+            admin_err_t *error_out) = 0;
+
     virtual bool grant_global(
             auth::user_context_t const &user_context,
             auth::username_t username,
@@ -495,6 +513,12 @@ public:
         perfmon_membership_t queries_per_sec_membership;
         perfmon_counter_t queries_total;
         perfmon_membership_t queries_total_membership;
+        perfmon_counter_t http_requests_total;
+        perfmon_membership_t http_requests_total_membership;
+        perfmon_counter_t http_connections_reused;
+        perfmon_membership_t http_connections_reused_membership;
+        perfmon_counter_t http_cache_hits;
+        perfmon_membership_t http_cache_hits_membership;
     private:
         DISABLE_COPYING(stats_t);
     } stats;
@@ -5,6 +5,7 @@
 #include <math.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <algorithm>
 #include <cmath>
@@ -107,13 +108,12 @@ datum_t::data_wrapper_t::data_wrapper_t(const char *cstr) :
     r_str(cstr), internal_type(internal_type_t::R_STR) { }
 
 datum_t::data_wrapper_t::data_wrapper_t(std::vector<datum_t> &&array) :
-    r_array(new countable_wrapper_t<std::vector<datum_t> >(std::move(array))),
+    r_array(new array_storage_t(std::move(array))),
     internal_type(internal_type_t::R_ARRAY) { }
 
 datum_t::data_wrapper_t::data_wrapper_t(
         std::vector<std::pair<datum_string_t, datum_t> > &&object) :
-    r_object(new countable_wrapper_t<std::vector<std::pair<datum_string_t, datum_t> > >(
-        std::move(object))),
+    r_object(new object_storage_t(std::move(object))),
     internal_type(internal_type_t::R_OBJECT) {
 
 #ifndef NDEBUG
@@ -212,10 +212,10 @@ void datum_t::data_wrapper_t::destruct() {
         r_str.~datum_string_t();
     } break;
     case internal_type_t::R_ARRAY: {
-        r_array.~counted_t<countable_wrapper_t<std::vector<datum_t> > >();
+        r_array.~counted_t<array_storage_t>();
     } break;
     case internal_type_t::R_OBJECT: {
-        r_object.~counted_t<countable_wrapper_t<std::vector<std::pair<datum_string_t, datum_t> > > >();
+        r_object.~counted_t<object_storage_t>();
     } break;
     case internal_type_t::BUF_R_ARRAY: // fallthru
     case internal_type_t::BUF_R_OBJECT: {
@@ -244,11 +244,10 @@ void datum_t::data_wrapper_t::assign_copy(const datum_t::data_wrapper_t &copyee)
         new(&r_str) datum_string_t(copyee.r_str);
     } break;
     case internal_type_t::R_ARRAY: {
-        new(&r_array) counted_t<countable_wrapper_t<std::vector<datum_t> > >(copyee.r_array);
+        new(&r_array) counted_t<array_storage_t>(copyee.r_array);
     } break;
     case internal_type_t::R_OBJECT: {
-        new(&r_object) counted_t<countable_wrapper_t<std::vector<std::pair<datum_string_t, datum_t> > > >(
-            copyee.r_object);
+        new(&r_object) counted_t<object_storage_t>(copyee.r_object);
     } break;
     case internal_type_t::BUF_R_ARRAY: // fallthru
     case internal_type_t::BUF_R_OBJECT: {
@@ -276,12 +275,10 @@ void datum_t::data_wrapper_t::assign_move(datum_t::data_wrapper_t &&movee) noexc
         new(&r_str) datum_string_t(std::move(movee.r_str));
     } break;
     case internal_type_t::R_ARRAY: {
-        new(&r_array) counted_t<countable_wrapper_t<std::vector<datum_t> > >(
-            std::move(movee.r_array));
+        new(&r_array) counted_t<array_storage_t>(std::move(movee.r_array));
     } break;
     case internal_type_t::R_OBJECT: {
-        new(&r_object) counted_t<countable_wrapper_t<std::vector<std::pair<datum_string_t, datum_t> > > >(
-            std::move(movee.r_object));
+        new(&r_object) counted_t<object_storage_t>(std::move(movee.r_object));
     } break;
     case internal_type_t::BUF_R_ARRAY: // fallthru
     case internal_type_t::BUF_R_OBJECT: {
@@ -1834,13 +1831,166 @@ int datum_t::cmp(const datum_t &rhs) const {
         });
 }
 
-bool datum_t::operator==(const datum_t &rhs) const { return cmp(rhs) == 0; }
-bool datum_t::operator!=(const datum_t &rhs) const { return cmp(rhs) != 0; }
+bool datum_t::operator==(const datum_t &rhs) const {
+    return !cached_hashes_differ(rhs) && cmp(rhs) == 0;
+}
+bool datum_t::operator!=(const datum_t &rhs) const {
+    return cached_hashes_differ(rhs) || cmp(rhs) != 0;
+}
 bool datum_t::operator<(const datum_t &rhs) const { return cmp(rhs) < 0; }
 bool datum_t::operator<=(const datum_t &rhs) const { return cmp(rhs) <= 0; }
 bool datum_t::operator>(const datum_t &rhs) const { return cmp(rhs) > 0; }
 bool datum_t::operator>=(const datum_t &rhs) const { return cmp(rhs) >= 0; }
 
+namespace {
+
+// The finalizer of MurmurHash3.
+uint64_t hash_mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+uint64_t hash_combine(uint64_t seed, uint64_t value) {
+    return hash_mix(seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2)));
+}
+
+uint64_t hash_bytes(const char *data, size_t size) {
+    uint64_t h = hash_mix(size);
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        h = hash_combine(h, word);
+    }
+    if (i < size) {
+        uint64_t word = 0;
+        memcpy(&word, data + i, size - i);
+        h = hash_combine(h, word);
+    }
+    return h;
+}
+
+uint64_t hash_str(const datum_string_t &str) {
+    return hash_bytes(str.data(), str.size());
+}
+
+uint64_t hash_num(double d) {
+    // `0.0 == -0.0`, so they must hash the same.
+    if (d == 0.0) {
+        d = 0.0;
+    }
+    uint64_t bits;
+    static_assert(sizeof(bits) == sizeof(d), "Unexpected size of double.");
+    memcpy(&bits, &d, sizeof(bits));
+    return hash_mix(bits);
+}
+
+}  // namespace
+
+uint64_t datum_t::hash_unchecked_stack() const {
+    // Mirrors `cmp_unchecked_stack`: whatever that function ignores must not affect
+    // the hash.
+    if (is_ptype() && !pseudo_compares_as_obj()) {
+        if (get_type() == R_BINARY) {
+            return hash_combine(R_BINARY, hash_str(as_binary()));
+        }
+        std::string reql_type = get_reql_type();
+        uint64_t h = hash_combine(R_OBJECT, hash_bytes(reql_type.data(), reql_type.size()));
+        if (reql_type == pseudo::time_string) {
+            // Times compare by their epoch time only, not by their time zone.
+            h = hash_combine(h, hash_num(pseudo::time_to_epoch_time(*this)));
+        }
+        return h;
+    }
+
+    uint64_t h = hash_mix(get_type());
+    switch (get_type()) {
+    case R_NULL: return h;
+    case MINVAL: return h;
+    case MAXVAL: return h;
+    case R_BOOL: return hash_combine(h, as_bool());
+    case R_NUM: return hash_combine(h, hash_num(as_num()));
+    case R_STR: return hash_combine(h, hash_str(as_str()));
+    case R_ARRAY: {
+        const size_t sz = arr_size();
+        for (size_t i = 0; i < sz; ++i) {
+            h = hash_combine(h, unchecked_get(i).hash());
+        }
+        return h;
+    } unreachable();
+    case R_OBJECT: {
+        const size_t sz = obj_size();
+        for (size_t i = 0; i < sz; ++i) {
+            auto pair = unchecked_get_pair(i);
+            h = hash_combine(h, hash_str(pair.first));
+            h = hash_combine(h, pair.second.hash());
+        }
+        return h;
+    } unreachable();
+    case R_BINARY: // This should be handled by the ptype code above
+    case UNINITIALIZED: // fallthru
+    default: unreachable();
+    }
+}
+
+std::atomic<uint64_t> *datum_t::get_hash_cache() const {
+    switch (data.get_internal_type()) {
+    case internal_type_t::R_ARRAY: return &data.r_array->cached_hash;
+    case internal_type_t::R_OBJECT: return &data.r_object->cached_hash;
+    case internal_type_t::UNINITIALIZED: // fallthru
+    case internal_type_t::MINVAL: // fallthru
+    case internal_type_t::R_BINARY: // fallthru
+    case internal_type_t::R_BOOL: // fallthru
+    case internal_type_t::R_NULL: // fallthru
+    case internal_type_t::R_NUM: // fallthru
+    case internal_type_t::R_STR: // fallthru
+    case internal_type_t::BUF_R_ARRAY: // fallthru
+    case internal_type_t::BUF_R_OBJECT: // fallthru
+    case internal_type_t::MAXVAL:
+        return nullptr;
+    default:
+        unreachable();
+    }
+}
+
+uint64_t datum_t::hash() const {
+    // The hash is a pure function of the contents, so it doesn't matter if another
+    // thread computes and stores it at the same time.
+    std::atomic<uint64_t> *cache = get_hash_cache();
+    if (cache != nullptr) {
+        uint64_t cached = cache->load(std::memory_order_relaxed);
+        if (cached != 0) {
+            return cached;
+        }
+    }
+    uint64_t h = call_with_enough_stack_datum<uint64_t>([&] {
+            return this->hash_unchecked_stack();
+        });
+    // Zero marks a hash that hasn't been computed yet.
+    if (h == 0) {
+        h = 1;
+    }
+    if (cache != nullptr) {
+        cache->store(h, std::memory_order_relaxed);
+    }
+    return h;
+}
+
+bool datum_t::cached_hashes_differ(const datum_t &rhs) const {
+    const std::atomic<uint64_t> *cache = get_hash_cache();
+    const std::atomic<uint64_t> *rhs_cache = rhs.get_hash_cache();
+    if (cache == nullptr || rhs_cache == nullptr) {
+        return false;
+    }
+    uint64_t h = cache->load(std::memory_order_relaxed);
+    uint64_t rhs_h = rhs_cache->load(std::memory_order_relaxed);
+    return h != 0 && rhs_h != 0 && h != rhs_h;
+}
+
 void datum_t::runtime_fail(base_exc_t::type_t exc_type,
                            const char *test, const char *file, int line,
                            std::string msg) const {
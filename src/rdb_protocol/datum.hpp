@@ -3,7 +3,9 @@
 #define RDB_PROTOCOL_DATUM_HPP_
 
 #include <float.h>
+#include <stdint.h>
 
+#include <atomic>
 #include <map>
 #include <memory>
 #include <set>
@@ -105,6 +107,21 @@ struct components_t {
     boost::optional<uint64_t> tag_num;
 };
 
+// The storage of in-memory arrays and objects.  Datums are immutable, so the
+// structural hash of the contents only has to be computed once; we keep it next to
+// the refcount.
+template <class T>
+class datum_container_t : public T,
+                          public slow_atomic_countable_t<datum_container_t<T> > {
+public:
+    template <class... Args>
+    explicit datum_container_t(Args &&... args)
+        : T(std::forward<Args>(args)...), cached_hash(0) { }
+
+    // Zero until `datum_t::hash()` has been called on a datum with this storage.
+    mutable std::atomic<uint64_t> cached_hash;
+};
+
 // A `datum_t` is basically a JSON value, with some special handling for
 // ReQL pseudo-types.
 class datum_t {
@@ -330,6 +347,14 @@ public:
     bool operator>(const datum_t &rhs) const;
     bool operator>=(const datum_t &rhs) const;
 
+    // A 64-bit structural hash that is consistent with operator==: data that compare
+    // equal have the same hash.  Buffer-backed data are hashed from their serialized
+    // form without being materialized.  The hashes of in-memory arrays and objects
+    // are cached, and operator== and operator!= use cached hashes to tell unequal
+    // data apart without comparing them.  The hash is not stable across versions, so
+    // it must not be persisted or sent to other servers.
+    uint64_t hash() const;
+
     NORETURN void runtime_fail(base_exc_t::type_t exc_type,
                                const char *test, const char *file, int line,
                                std::string msg) const;
@@ -403,6 +428,11 @@ private:
         std::string *str_out) const;
 
     int cmp_unchecked_stack(const datum_t &rhs) const;
+    uint64_t hash_unchecked_stack() const;
+    // Returns the hash cache of the array or object storage, or null for other types.
+    std::atomic<uint64_t> *get_hash_cache() const;
+    // True if both data have cached hashes and these differ.
+    bool cached_hashes_differ(const datum_t &rhs) const;
 
     int pseudo_cmp(const datum_t &rhs) const;
     bool pseudo_compares_as_obj() const;
@@ -415,6 +445,10 @@ private:
     datum_t drop_literals(bool *encountered_literal_out) const;
     datum_t drop_literals_unchecked_stack(bool *encountered_literal_out) const;
 
+    typedef datum_container_t<std::vector<datum_t> > array_storage_t;
+    typedef datum_container_t<std::vector<std::pair<datum_string_t, datum_t> > >
+        object_storage_t;
+
     // The data_wrapper makes sure we perform proper cleanup when exceptions
     // happen during construction
     class data_wrapper_t {
@@ -447,9 +481,8 @@ private:
             bool r_bool;
             double r_num;
             datum_string_t r_str;
-            counted_t<countable_wrapper_t<std::vector<datum_t> > > r_array;
-            counted_t<countable_wrapper_t<std::vector< //NOLINT(whitespace/operators)
-                std::pair<datum_string_t, datum_t> > > > r_object;
+            counted_t<array_storage_t> r_array;
+            counted_t<object_storage_t> r_object;
             shared_buf_ref_t<char> buf_ref;
         };
     private:
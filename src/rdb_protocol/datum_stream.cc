@@ -1,9 +1,12 @@
 // Copyright 2010-2015 RethinkDB, all rights reserved.
 #include "rdb_protocol/datum_stream.hpp"
 
+#include <algorithm>
+#include <functional>
 #include <map>
 
 #include "boost_utils.hpp"
+#include "containers/loser_tree.hpp"
 #include "rdb_protocol/batching.hpp"
 #include "rdb_protocol/env.hpp"
 #include "rdb_protocol/func.hpp"
@@ -444,24 +447,27 @@ raw_stream_t rget_response_reader_t::unshard(
 
     // Do the unsharding.
     if (sorting != sorting_t::UNORDERED) {
+        // The pseudoshards are already sorted by their (pre-encoded) keys, so we
+        // merge them with a loser tree.  That costs `log2(pseudoshards)` key
+        // comparisons per item rather than one per pseudoshard, which matters when
+        // reading from many shards.  We stop once the best key belongs to a
+        // pseudoshard that has no data left, since we can't know what comes next
+        // in its range.
+        auto beats = [&](size_t a, size_t b) {
+            return is_better(*pseudoshards[a].best_unpopped_key(),
+                             *pseudoshards[b].best_unpopped_key(),
+                             sorting);
+        };
+        loser_tree_t<decltype(beats)> tree(pseudoshards.size(), beats);
         size_t num_iters = 0;
         for (;;) {
             const size_t YIELD_INTERVAL = 2000;
             if (++num_iters % YIELD_INTERVAL == 0) {
                 coro_t::yield();
             }
-            pseudoshard_t *best_shard = &pseudoshards[0];
-            const store_key_t *best_key = best_shard->best_unpopped_key();
-            for (size_t i = 1; i < pseudoshards.size(); ++i) {
-                pseudoshard_t *cur_shard = &pseudoshards[i];
-                const store_key_t *cur_key = cur_shard->best_unpopped_key();
-                if (is_better(*cur_key, *best_key, sorting)) {
-                    best_shard = cur_shard;
-                    best_key = cur_key;
-                }
-            }
-            if (auto maybe_item = best_shard->pop()) {
-                ret.push_back(*maybe_item);
+            if (auto maybe_item = pseudoshards[tree.winner()].pop()) {
+                ret.push_back(std::move(*maybe_item));
+                tree.replay();
             } else {
                 break;
             }
@@ -1135,8 +1141,13 @@ void sindex_readgen_t::sindex_sort(
         return;
     }
     if (sorting(batchspec) != sorting_t::UNORDERED) {
-        std::stable_sort(vec->begin(), vec->end(),
-                         sindex_compare_t(sorting(batchspec)));
+        // The items come out of `unshard` ordered by their encoded sindex keys,
+        // which usually agrees with the datum order (it doesn't when keys were
+        // truncated), so a linear check saves us the sort in the common case.
+        sindex_compare_t compare(sorting(batchspec));
+        if (!std::is_sorted(vec->begin(), vec->end(), std::ref(compare))) {
+            std::stable_sort(vec->begin(), vec->end(), std::ref(compare));
+        }
     }
 }
 
@@ -2560,4 +2571,36 @@ std::vector<changespec_t> vector_datum_stream_t::get_changespecs() {
     }
 }
 
+rewritten_read_datum_stream_t::rewritten_read_datum_stream_t(
+        counted_t<datum_stream_t> &&_rewritten,
+        counted_t<datum_stream_t> &&_original,
+        backtrace_id_t bt)
+    : datum_stream_t(bt),
+      rewritten(std::move(_rewritten)),
+      original(std::move(_original)) { }
+
+bool rewritten_read_datum_stream_t::is_exhausted() const {
+    return rewritten->is_exhausted() && batch_cache_exhausted();
+}
+
+void rewritten_read_datum_stream_t::add_transformation(
+        transform_variant_t &&tv, backtrace_id_t bt) {
+    original->add_transformation(transform_variant_t(tv), bt);
+    rewritten->add_transformation(std::move(tv), bt);
+}
+
+void rewritten_read_datum_stream_t::accumulate(
+        env_t *env, eager_acc_t *acc, const terminal_variant_t &tv) {
+    rewritten->accumulate(env, acc, tv);
+}
+
+void rewritten_read_datum_stream_t::accumulate_all(env_t *env, eager_acc_t *acc) {
+    rewritten->accumulate_all(env, acc);
+}
+
+std::vector<datum_t> rewritten_read_datum_stream_t::next_batch_impl(
+        env_t *env, const batchspec_t &batchspec) {
+    return rewritten->next_batch(env, batchspec);
+}
+
 } // namespace ql
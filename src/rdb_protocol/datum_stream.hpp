@@ -1058,6 +1058,40 @@ private:
     boost::optional<changefeed::keyspec_t> changespec;
 };
 
+/* The result of a `filter` that `filter_index_plan_t` rewrote into an index read.  It
+reads from `rewritten`, but a changefeed on it watches `original`, because the index
+read may only cover the rows that match the predicate right now.  Whether the stream
+ends up being read or watched is only known once something consumes it, so both
+streams get every transformation. */
+class rewritten_read_datum_stream_t : public datum_stream_t {
+public:
+    rewritten_read_datum_stream_t(
+        counted_t<datum_stream_t> &&_rewritten,
+        counted_t<datum_stream_t> &&_original,
+        backtrace_id_t bt);
+
+    virtual void set_notes(response_t *res) const { rewritten->set_notes(res); }
+
+    virtual bool is_array() const { return rewritten->is_array(); }
+    virtual datum_t as_array(env_t *env) { return rewritten->as_array(env); }
+    virtual bool is_exhausted() const;
+    virtual feed_type_t cfeed_type() const { return rewritten->cfeed_type(); }
+    virtual bool is_infinite() const { return rewritten->is_infinite(); }
+
+private:
+    virtual std::vector<changespec_t> get_changespecs() {
+        return original->get_changespecs();
+    }
+    virtual void add_transformation(transform_variant_t &&tv, backtrace_id_t bt);
+    virtual void accumulate(env_t *env, eager_acc_t *acc, const terminal_variant_t &tv);
+    virtual void accumulate_all(env_t *env, eager_acc_t *acc);
+    virtual std::vector<datum_t>
+    next_batch_impl(env_t *env, const batchspec_t &batchspec);
+
+    const counted_t<datum_stream_t> rewritten;
+    const counted_t<datum_stream_t> original;
+};
+
 } // namespace ql
 
 #endif // RDB_PROTOCOL_DATUM_STREAM_HPP_
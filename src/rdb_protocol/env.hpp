@@ -43,6 +43,13 @@ struct regex_cache_t {
     lru_cache_t<std::string, std::shared_ptr<re2::RE2> > regexes;
 };
 
+/* The ready secondary indexes of a table that `plan_filter_index_scan()` can read
+instead of the whole table, by the field they select. */
+struct filter_index_fields_t {
+    std::map<std::string, std::string> regular;
+    std::map<std::string, std::string> trigram;
+};
+
 class env_t : public home_thread_mixin_t {
 public:
     // This is _not_ to be used for secondary index function evaluation -- it doesn't
@@ -131,6 +138,10 @@ public:
 
     regex_cache_t &regex_cache() { return regex_cache_; }
 
+    std::map<namespace_id_t, filter_index_fields_t> &filter_index_cache() {
+        return filter_index_cache_;
+    }
+
     reql_version_t reql_version() const { return reql_version_; }
 
 private:
@@ -147,6 +158,10 @@ private:
     // query specific cache parameters; for example match regexes.
     regex_cache_t regex_cache_;
 
+    // The indexes `filter` can use on each table, so that a filter that's evaluated
+    // many times in a query only looks them up once.
+    std::map<namespace_id_t, filter_index_fields_t> filter_index_cache_;
+
 public:
     const return_empty_normal_batches_t return_empty_normal_batches;
 
@@ -0,0 +1,532 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "rdb_protocol/filter_optimizer.hpp"
+
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "clustering/administration/admin_op_exc.hpp"
+#include "rdb_protocol/context.hpp"
+#include "rdb_protocol/env.hpp"
+#include "rdb_protocol/func.hpp"
+#include "rdb_protocol/op.hpp"
+#include "rdb_protocol/profile.hpp"
+#include "rdb_protocol/term.hpp"
+#include "rdb_protocol/trigrams.hpp"
+#include "rdb_protocol/val.hpp"
+
+namespace ql {
+
+namespace {
+
+enum class field_op_t { EQ, LT, LE, GT, GE, MATCH };
+
+// Counting a trigram's rows walks all of its index keys, so we only count a few of the
+// pattern's trigrams and let the regular expression do the rest.
+const size_t MAX_TRIGRAM_READS = 4;
+
+// Past this many rows, even for the rarest trigram, we give up on the trigram index and
+// scan the table instead.
+const size_t MAX_TRIGRAM_CANDIDATES = 10000;
+
+/* A condition that every row matching the predicate satisfies. */
+struct field_condition_t {
+    std::string field;
+    field_op_t op;
+    datum_t value;
+};
+
+field_op_t flip_op(field_op_t op) {
+    switch (op) {
+    case field_op_t::EQ: return field_op_t::EQ;
+    case field_op_t::LT: return field_op_t::GT;
+    case field_op_t::LE: return field_op_t::GE;
+    case field_op_t::GT: return field_op_t::LT;
+    case field_op_t::GE: return field_op_t::LE;
+    case field_op_t::MATCH: // fallthru
+    default: unreachable();
+    }
+}
+
+/* Only these types compare the same way in a `filter` and in an index read, and can
+be index keys in the first place. */
+bool is_indexable_constant(const datum_t &value) {
+    switch (value.get_type()) {
+    case datum_t::R_BOOL: // fallthru
+    case datum_t::R_NUM: // fallthru
+    case datum_t::R_STR:
+        return true;
+    case datum_t::MINVAL: // fallthru
+    case datum_t::R_ARRAY: // fallthru
+    case datum_t::R_BINARY: // fallthru
+    case datum_t::R_NULL: // fallthru
+    case datum_t::R_OBJECT: // fallthru
+    case datum_t::MAXVAL: // fallthru
+    case datum_t::UNINITIALIZED: // fallthru
+    default:
+        return false;
+    }
+}
+
+/* If `term` is `var(field)` or `var.get_field(field)` for the given variable (or for
+the implicit variable, if `implicit_ok`), returns `field`. */
+boost::optional<std::string> selected_field(
+        const raw_term_t &term, const sym_t &var, bool implicit_ok) {
+    if ((term.type() != Term::BRACKET && term.type() != Term::GET_FIELD)
+            || term.num_args() != 2 || term.num_optargs() != 0) {
+        return boost::none;
+    }
+    raw_term_t object = term.arg(0);
+    if (object.type() == Term::VAR) {
+        if (object.num_args() != 1 || object.arg(0).type() != Term::DATUM) {
+            return boost::none;
+        }
+        datum_t name = object.arg(0).datum();
+        if (name.get_type() != datum_t::R_NUM
+                || name.as_num() != static_cast<double>(var.value)) {
+            return boost::none;
+        }
+    } else if (object.type() != Term::IMPLICIT_VAR || !implicit_ok) {
+        return boost::none;
+    }
+    raw_term_t field = term.arg(1);
+    if (field.type() != Term::DATUM) {
+        return boost::none;
+    }
+    datum_t field_name = field.datum();
+    if (field_name.get_type() != datum_t::R_STR) {
+        return boost::none;
+    }
+    return field_name.as_str().to_std();
+}
+
+bool references_variables(const raw_term_t &term) {
+    if (term.type() == Term::VAR || term.type() == Term::IMPLICIT_VAR) {
+        return true;
+    }
+    for (size_t i = 0; i < term.num_args(); ++i) {
+        if (references_variables(term.arg(i))) {
+            return true;
+        }
+    }
+    bool found = false;
+    term.each_optarg([&](const raw_term_t &optarg, const std::string &) {
+        found = found || references_variables(optarg);
+    });
+    return found;
+}
+
+/* Returns the value of `term` if it's a constant: a datum, or a deterministic
+expression that doesn't refer to any variables (such as `r.expr(1).add(2)`), which
+we evaluate here so that the rest of the planner only has to deal with datums. */
+boost::optional<datum_t> fold_constant(env_t *env, const raw_term_t &term) {
+    if (term.type() == Term::DATUM) {
+        return term.datum();
+    }
+    if (references_variables(term)) {
+        return boost::none;
+    }
+    try {
+        compile_env_t compile_env((var_visibility_t()));
+        counted_t<const term_t> compiled = compile_term(&compile_env, term);
+        if (compiled->is_deterministic() == deterministic_t::no) {
+            return boost::none;
+        }
+        scope_env_t scope_env(env, var_scope_t());
+        scoped_ptr_t<val_t> value = compiled->eval(&scope_env);
+        if (!value->get_type().is_convertible(val_t::type_t::DATUM)) {
+            return boost::none;
+        }
+        return value->as_datum();
+    } catch (const base_exc_t &) {
+        /* The filter will report the error itself when it evaluates the term. */
+        return boost::none;
+    }
+}
+
+void collect_term_conditions(
+        env_t *env,
+        const raw_term_t &term,
+        const sym_t &var,
+        bool implicit_ok,
+        std::vector<field_condition_t> *conditions_out) {
+    field_op_t op;
+    if (term.type() == Term::AND) {
+        for (size_t i = 0; i < term.num_args(); ++i) {
+            collect_term_conditions(env, term.arg(i), var, implicit_ok, conditions_out);
+        }
+        return;
+    } else if (term.type() == Term::EQ) {
+        op = field_op_t::EQ;
+    } else if (term.type() == Term::LT) {
+        op = field_op_t::LT;
+    } else if (term.type() == Term::LE) {
+        op = field_op_t::LE;
+    } else if (term.type() == Term::GT) {
+        op = field_op_t::GT;
+    } else if (term.type() == Term::GE) {
+        op = field_op_t::GE;
+    } else if (term.type() == Term::MATCH) {
+        if (term.num_args() != 2 || term.num_optargs() != 0) {
+            return;
+        }
+        boost::optional<std::string> field =
+            selected_field(term.arg(0), var, implicit_ok);
+        if (!field) {
+            return;
+        }
+        boost::optional<datum_t> regex = fold_constant(env, term.arg(1));
+        if (regex && regex->get_type() == datum_t::R_STR) {
+            conditions_out->push_back(
+                field_condition_t{*field, field_op_t::MATCH, *regex});
+        }
+        return;
+    } else {
+        return;
+    }
+    if (term.num_args() != 2 || term.num_optargs() != 0) {
+        return;
+    }
+    raw_term_t constant = term.arg(1);
+    boost::optional<std::string> field = selected_field(term.arg(0), var, implicit_ok);
+    if (!field) {
+        constant = term.arg(0);
+        field = selected_field(term.arg(1), var, implicit_ok);
+        op = flip_op(op);
+    }
+    if (!field) {
+        return;
+    }
+    boost::optional<datum_t> value = fold_constant(env, constant);
+    if (value && is_indexable_constant(*value)) {
+        conditions_out->push_back(field_condition_t{*field, op, *value});
+    }
+}
+
+class condition_visitor_t : public func_visitor_t {
+public:
+    condition_visitor_t(env_t *_env, std::vector<field_condition_t> *_conditions_out)
+        : env(_env), conditions_out(_conditions_out) { }
+    void on_reql_func(const reql_func_t *reql_func) {
+        const std::vector<sym_t> &arg_names = reql_func->get_arg_names();
+        if (arg_names.size() == 1) {
+            collect_term_conditions(env, reql_func->get_body_src(), arg_names[0],
+                                    function_emits_implicit_variable(arg_names),
+                                    conditions_out);
+        }
+    }
+    void on_js_func(const js_func_t *) { }
+private:
+    env_t *env;
+    std::vector<field_condition_t> *conditions_out;
+};
+
+/* Returns the field `index_func` selects if it's of the form `row(field)`. */
+class selector_visitor_t : public func_visitor_t {
+public:
+    void on_reql_func(const reql_func_t *reql_func) {
+        const std::vector<sym_t> &arg_names = reql_func->get_arg_names();
+        if (arg_names.size() == 1) {
+            field = selected_field(reql_func->get_body_src(), arg_names[0],
+                                   function_emits_implicit_variable(arg_names));
+        }
+    }
+    void on_js_func(const js_func_t *) { }
+    boost::optional<std::string> field;
+};
+
+std::vector<field_condition_t> collect_conditions(env_t *env, val_t *predicate) {
+    std::vector<field_condition_t> conditions;
+    if (predicate->get_type().is_convertible(val_t::type_t::DATUM)) {
+        datum_t object = predicate->as_datum();
+        if (object.get_type() == datum_t::R_OBJECT && !object.is_ptype()) {
+            for (size_t i = 0; i < object.obj_size(); ++i) {
+                auto pair = object.get_pair(i);
+                if (is_indexable_constant(pair.second)) {
+                    conditions.push_back(field_condition_t{
+                        pair.first.to_std(), field_op_t::EQ, pair.second});
+                }
+            }
+        }
+    } else if (predicate->get_type().is_convertible(val_t::type_t::FUNC)) {
+        condition_visitor_t visitor(env, &conditions);
+        predicate->as_func()->visit(&visitor);
+    }
+    return conditions;
+}
+
+/* Lower is better: equality before ranges before trigram lookups, the primary key
+before secondary indexes. */
+int condition_rank(const field_condition_t &condition, const std::string &pkey) {
+    switch (condition.op) {
+    case field_op_t::EQ:
+        return condition.field == pkey ? 0 : 1;
+    case field_op_t::LT: // fallthru
+    case field_op_t::LE: // fallthru
+    case field_op_t::GT: // fallthru
+    case field_op_t::GE:
+        return condition.field == pkey ? 2 : 3;
+    case field_op_t::MATCH:
+        return 4;
+    default:
+        unreachable();
+    }
+}
+
+/* The intersection of all the range conditions on `field`. */
+datum_range_t intersect_ranges(
+        const std::vector<field_condition_t> &conditions, const std::string &field) {
+    datum_t left = datum_t::minval(), right = datum_t::maxval();
+    key_range_t::bound_t left_type = key_range_t::closed;
+    key_range_t::bound_t right_type = key_range_t::open;
+    for (const auto &condition : conditions) {
+        if (condition.field != field) {
+            continue;
+        }
+        switch (condition.op) {
+        case field_op_t::GT: // fallthru
+        case field_op_t::GE:
+            if (left < condition.value || (left == condition.value
+                                           && condition.op == field_op_t::GT)) {
+                left = condition.value;
+                left_type = condition.op == field_op_t::GT
+                    ? key_range_t::open : key_range_t::closed;
+            }
+            break;
+        case field_op_t::LT: // fallthru
+        case field_op_t::LE:
+            if (condition.value < right || (condition.value == right
+                                             && condition.op == field_op_t::LT)) {
+                right = condition.value;
+                right_type = condition.op == field_op_t::LT
+                    ? key_range_t::open : key_range_t::closed;
+            }
+            break;
+        case field_op_t::EQ: // fallthru
+        case field_op_t::MATCH:
+            break;
+        default:
+            unreachable();
+        }
+    }
+    return datum_range_t(left, left_type, right, right_type);
+}
+
+filter_index_fields_t get_filter_index_fields(
+        env_t *env, const counted_t<table_t> &table) {
+    filter_index_fields_t fields;
+    std::map<std::string, std::pair<sindex_config_t, sindex_status_t> >
+        configs_and_statuses;
+    admin_err_t error;
+    if (!env->reql_cluster_interface()->sindex_list(
+            table->db, name_string_t::guarantee_valid(table->name.c_str()),
+            env->interruptor, &error, &configs_and_statuses)) {
+        return fields;
+    }
+    for (const auto &pair : configs_and_statuses) {
+        const sindex_config_t &config = pair.second.first;
+        const sindex_status_t &status = pair.second.second;
+        if (!status.ready || status.outdated) {
+            continue;
+        }
+        selector_visitor_t visitor;
+        config.func.compile_wire_func()->visit(&visitor);
+        if (!visitor.field) {
+            continue;
+        }
+        /* `insert()` keeps the first index we found for each field. */
+        if (config.geo == sindex_geo_bool_t::TRIGRAM) {
+            fields.trigram.insert(std::make_pair(*visitor.field, pair.first));
+        } else if (config.multi == sindex_multi_bool_t::SINGLE
+                   && config.geo == sindex_geo_bool_t::REGULAR) {
+            fields.regular.insert(std::make_pair(*visitor.field, pair.first));
+        }
+    }
+    return fields;
+}
+
+}  // namespace
+
+scoped_ptr_t<val_t> filter_index_plan_t::read(
+        env_t *env,
+        const counted_t<table_t> &table,
+        backtrace_id_t bt) const {
+    if (!trigrams.empty()) {
+        return read_trigrams(env, table, bt);
+    } else if (key) {
+        std::map<datum_t, uint64_t> keys;
+        keys.insert(std::make_pair(*key, 1));
+        return make_scoped<val_t>(
+            make_counted<selection_t>(
+                table,
+                table->get_all(env, datumspec_t(std::move(keys)), index, bt)),
+            bt);
+    } else {
+        return make_scoped<val_t>(
+            make_counted<table_slice_t>(table)->with_bounds(index, range), bt);
+    }
+}
+
+scoped_ptr_t<val_t> filter_index_plan_t::read_trigrams(
+        env_t *env,
+        const counted_t<table_t> &table,
+        backtrace_id_t bt) const {
+    /* Counting the rows under a trigram only reads the index's keys (see
+    `rget_cb_t::copies_from_key()`), so we count each trigram first and then read the
+    rows of the rarest one.  The filter rejects those that lack the other trigrams. */
+    boost::optional<std::pair<uint64_t, datum_t> > rarest;
+    for (const datum_t &trigram : trigrams) {
+        std::map<datum_t, uint64_t> keys;
+        keys.insert(std::make_pair(trigram, 1));
+        uint64_t count = table->get_all(env, datumspec_t(std::move(keys)), index, bt)
+            ->run_terminal(env, count_wire_func_t())->as_int<uint64_t>();
+        if (!rarest || count < rarest->first) {
+            rarest = std::make_pair(count, trigram);
+        }
+        if (count == 0) {
+            break;
+        }
+    }
+    guarantee(rarest);
+    if (rarest->first > MAX_TRIGRAM_CANDIDATES) {
+        profile::starter_t starter(
+            "Optimizer: Too many rows contain each trigram, reading the whole table "
+            "instead.", env->trace);
+        return make_scoped<val_t>(table, bt);
+    }
+
+    /* `match()` fails on rows whose field isn't a string, and a full scan would run
+    into them, so we read them as well.  A row with an array of strings can come up
+    twice, but the filter fails on its first copy. */
+    std::map<datum_t, uint64_t> keys;
+    keys.insert(std::make_pair(rarest->second, 1));
+    keys.insert(std::make_pair(non_string_trigram_key(), 1));
+    return make_scoped<val_t>(
+        make_counted<selection_t>(
+            table,
+            table->get_all(env, datumspec_t(std::move(keys)), index, bt)),
+        bt);
+}
+
+std::string filter_index_plan_t::print() const {
+    if (!trigrams.empty()) {
+        return strprintf("Rewrote `match` on `%s` into reads of %zu trigrams from `%s`.",
+                         field.c_str(), trigrams.size(), index.c_str());
+    } else if (key) {
+        return strprintf("Rewrote `filter` on `%s` into `get_all(%s, {index: \"%s\"})`.",
+                         field.c_str(), key->print().c_str(), index.c_str());
+    } else {
+        return strprintf("Rewrote `filter` on `%s` into a read of `%s` in %s.",
+                         field.c_str(), index.c_str(), range.print().c_str());
+    }
+}
+
+boost::optional<filter_index_plan_t> plan_filter_index_scan(
+        env_t *env,
+        const counted_t<table_t> &table,
+        val_t *predicate) {
+    std::vector<field_condition_t> conditions = collect_conditions(env, predicate);
+    if (conditions.empty()) {
+        return boost::none;
+    }
+
+    const std::string &pkey = table->get_pkey();
+
+    /* Looking up the secondary indexes' status takes a round trip to the servers, so
+    we skip it if the primary key already gives us the best possible plan, and
+    otherwise only do it once per table and query. */
+    bool want_sindexes = true;
+    for (const auto &condition : conditions) {
+        if (condition_rank(condition, pkey) == 0) {
+            want_sindexes = false;
+        }
+    }
+    filter_index_fields_t no_sindexes;
+    const filter_index_fields_t *sindexes = &no_sindexes;
+    if (want_sindexes) {
+        auto &cache = env->filter_index_cache();
+        auto it = cache.find(table->get_id());
+        if (it == cache.end()) {
+            it = cache.insert(std::make_pair(
+                table->get_id(), get_filter_index_fields(env, table))).first;
+        }
+        sindexes = &it->second;
+    }
+    std::map<std::string, std::string> index_for_field = sindexes->regular;
+    index_for_field[pkey] = pkey;
+    const std::map<std::string, std::string> &trigram_index_for_field =
+        sindexes->trigram;
+
+    const field_condition_t *best = nullptr;
+    std::vector<datum_t> best_trigrams;
+    for (const auto &condition : conditions) {
+        if (best != nullptr
+                && condition_rank(*best, pkey) <= condition_rank(condition, pkey)) {
+            continue;
+        }
+        if (condition.op == field_op_t::MATCH) {
+            if (trigram_index_for_field.count(condition.field) == 0) {
+                continue;
+            }
+            std::vector<datum_t> trigrams =
+                required_trigrams(condition.value.as_str().to_std());
+            if (trigrams.empty()) {
+                continue;
+            }
+            best = &condition;
+            best_trigrams = std::move(trigrams);
+            continue;
+        }
+        auto it = index_for_field.find(condition.field);
+        if (it == index_for_field.end()) {
+            continue;
+        }
+        if (condition.op != field_op_t::EQ && it->second != pkey) {
+            /* Rows whose field is `null` or an object are missing from secondary
+            indexes, so the range must not be able to contain them.  Ranges bounded
+            on both sides by constants of the same type can't. */
+            bool left = false, right = false;
+            boost::optional<datum_t::type_t> type;
+            bool same_type = true;
+            for (const auto &other : conditions) {
+                if (other.field != condition.field || other.op == field_op_t::EQ
+                        || other.op == field_op_t::MATCH) {
+                    continue;
+                }
+                left |= other.op == field_op_t::GT || other.op == field_op_t::GE;
+                right |= other.op == field_op_t::LT || other.op == field_op_t::LE;
+                same_type &= !type || *type == other.value.get_type();
+                type = other.value.get_type();
+            }
+            if (!left || !right || !same_type) {
+                continue;
+            }
+        }
+        best = &condition;
+    }
+    if (best == nullptr) {
+        return boost::none;
+    }
+
+    filter_index_plan_t plan;
+    plan.field = best->field;
+    if (best->op == field_op_t::MATCH) {
+        plan.index = trigram_index_for_field.at(best->field);
+        /* Spread the reads over the pattern rather than taking its first few
+        trigrams, which tend to overlap. */
+        size_t step = (best_trigrams.size() + MAX_TRIGRAM_READS - 1) / MAX_TRIGRAM_READS;
+        for (size_t i = 0; i < best_trigrams.size(); i += step) {
+            plan.trigrams.push_back(best_trigrams[i]);
+        }
+        return plan;
+    }
+    plan.index = index_for_field.at(best->field);
+    if (best->op == field_op_t::EQ) {
+        plan.key = best->value;
+    } else {
+        plan.range = intersect_ranges(conditions, best->field);
+    }
+    return plan;
+}
+
+}  // namespace ql
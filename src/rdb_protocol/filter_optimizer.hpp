@@ -0,0 +1,71 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef RDB_PROTOCOL_FILTER_OPTIMIZER_HPP_
+#define RDB_PROTOCOL_FILTER_OPTIMIZER_HPP_
+
+#include <string>
+#include <vector>
+
+#include "errors.hpp"
+#include <boost/optional.hpp>
+
+#include "containers/counted.hpp"
+#include "containers/scoped.hpp"
+#include "rdb_protocol/datum.hpp"
+#include "rdb_protocol/datumspec.hpp"
+
+namespace ql {
+
+class env_t;
+class table_t;
+class val_t;
+
+/* `filter_index_plan_t` describes how `table.filter(predicate)` can read only the part
+of the table that can possibly match the predicate, through the primary key or a ready
+secondary index, instead of scanning the whole table. The predicate still runs on every
+row that the plan reads, so a plan only has to cover a superset of the matching rows. */
+class filter_index_plan_t {
+public:
+    std::string field;
+    std::string index;
+
+    /* If `key` is set, the plan is a `get_all()`; if `trigrams` isn't empty, it reads
+    the rows that contain the rarest of them, and those whose field isn't a string,
+    from a trigram index; otherwise it's a
+    `between()` over `range`. */
+    boost::optional<datum_t> key;
+    std::vector<datum_t> trigrams;
+    datum_range_t range;
+
+    /* Returns the rows of `table` covered by the plan, as a selection or table slice
+    that the filter can be applied to. */
+    scoped_ptr_t<val_t> read(
+        env_t *env,
+        const counted_t<table_t> &table,
+        backtrace_id_t bt) const;
+
+    /* A description of the plan for the query profile. */
+    std::string print() const;
+
+private:
+    scoped_ptr_t<val_t> read_trigrams(
+        env_t *env,
+        const counted_t<table_t> &table,
+        backtrace_id_t bt) const;
+};
+
+/* Returns a plan for `table.filter(predicate)` if `predicate` is an object, or a
+one-argument ReQL function, that compares a top-level field against a constant number,
+string or boolean (for functions, possibly as one conjunct of an `and`, and possibly
+given as a deterministic expression that we fold into a constant), and the field
+is the primary key or is covered by a ready secondary index of the form `row(field)`.
+A `row(field).match(regex)` can use a trigram index on the field instead, as long as we
+can tell some trigrams every match must contain.  Filters with a `default` can't be
+planned because rows that lack the field would match. */
+boost::optional<filter_index_plan_t> plan_filter_index_scan(
+    env_t *env,
+    const counted_t<table_t> &table,
+    val_t *predicate);
+
+}  // namespace ql
+
+#endif  // RDB_PROTOCOL_FILTER_OPTIMIZER_HPP_
@@ -110,6 +110,11 @@ public:
 
     bool is_simple_selector() const final;
 
+    // Used by `plan_filter_index_scan()` to recognize predicates and index functions
+    // it knows how to turn into index reads.
+    const std::vector<sym_t> &get_arg_names() const { return arg_names; }
+    const raw_term_t &get_body_src() const { return body->get_src(); }
+
 private:
     template <cluster_version_t> friend class wire_func_serialization_visitor_t;
     bool filter_helper(env_t *env, datum_t arg) const;
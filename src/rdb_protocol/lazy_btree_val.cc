@@ -24,16 +24,92 @@ ql::datum_t get_data(const rdb_value_t *value, buf_parent_t parent) {
     return data;
 }
 
+static uint32_t get_stored_fields_size(rdb_blob_wrapper_t *blob, buf_parent_t parent) {
+    blob_acq_t acq_group;
+    buffer_group_t buffer_group;
+    blob->expose_region(parent, access_t::read, 0, sizeof(uint32_t),
+                        &buffer_group, &acq_group);
+    buffer_group_read_stream_t read_stream(const_view(&buffer_group));
+    uint32_t size;
+    archive_result_t res
+        = deserialize<cluster_version_t::LATEST_DISK>(&read_stream, &size);
+    guarantee_deserialization(res, "stored fields size");
+    return size;
+}
+
+static ql::datum_t get_region_data(rdb_blob_wrapper_t *blob, buf_parent_t parent,
+                                   int64_t offset, int64_t size) {
+    ql::datum_t data;
+
+    blob_acq_t acq_group;
+    buffer_group_t buffer_group;
+    blob->expose_region(parent, access_t::read, offset, size,
+                        &buffer_group, &acq_group);
+    buffer_group_read_stream_t read_stream(const_view(&buffer_group));
+    archive_result_t res
+        = datum_deserialize(&read_stream, &data);
+    guarantee_deserialization(res, "rdb value");
+
+    return data;
+}
+
+ql::datum_t get_stored_fields(const rdb_value_t *value, buf_parent_t parent) {
+    rdb_blob_wrapper_t blob(parent.cache()->max_block_size(),
+                            const_cast<rdb_value_t *>(value)->value_ref(),
+                            blob::btree_maxreflen);
+    uint32_t size = get_stored_fields_size(&blob, parent);
+    return get_region_data(&blob, parent, sizeof(uint32_t), size);
+}
+
+/* Follows the reference at the end of the value to the row's blob in the primary
+index. */
+static ql::datum_t get_stored_fields_row(const rdb_value_t *value,
+                                         buf_parent_t parent) {
+    rdb_blob_wrapper_t blob(parent.cache()->max_block_size(),
+                            const_cast<rdb_value_t *>(value)->value_ref(),
+                            blob::btree_maxreflen);
+    int64_t offset = sizeof(uint32_t) + get_stored_fields_size(&blob, parent);
+    int64_t ref_size = blob.valuesize() - offset;
+    guarantee(ref_size > 0 && ref_size <= blob::btree_maxreflen);
+
+    scoped_malloc_t<rdb_value_t> row_value(blob::btree_maxreflen);
+    memset(row_value.get(), 0, blob::btree_maxreflen);
+    {
+        blob_acq_t acq_group;
+        buffer_group_t buffer_group;
+        blob.expose_region(parent, access_t::read, offset, ref_size,
+                           &buffer_group, &acq_group);
+        buffer_group_read_stream_t read_stream(const_view(&buffer_group));
+        int64_t res = force_read(&read_stream, row_value->value_ref(), ref_size);
+        guarantee(res == ref_size, "Couldn't read the reference to the row.");
+    }
+    return get_data(row_value.get(), parent);
+}
+
 const ql::datum_t &lazy_btree_val_t::get() const {
     guarantee(pointee.has());
     if (!pointee->ptr.has()) {
-        pointee->ptr = get_data(pointee->rdb_value, pointee->parent);
+        switch (pointee->layout) {
+        case rdb_value_layout_t::ROW:
+            pointee->ptr = get_data(pointee->rdb_value, pointee->parent);
+            break;
+        case rdb_value_layout_t::STORED_FIELDS_AND_ROW:
+            pointee->ptr = get_stored_fields_row(pointee->rdb_value, pointee->parent);
+            break;
+        default: unreachable();
+        }
         pointee->rdb_value = NULL;
         pointee->parent = buf_parent_t();
     }
     return pointee->ptr;
 }
 
+ql::datum_t lazy_btree_val_t::get_stored_fields() const {
+    guarantee(pointee.has() && pointee->rdb_value != NULL);
+    guarantee(pointee->layout == rdb_value_layout_t::STORED_FIELDS_AND_ROW);
+    return ::get_stored_fields(pointee->rdb_value, pointee->parent);
+}
+
 bool lazy_btree_val_t::references_parent() const {
     return pointee.has() && !pointee->parent.empty();
 }
@@ -30,15 +30,24 @@ public:
 ql::datum_t get_data(const rdb_value_t *value,
                      buf_parent_t parent);
 
+/* Values in secondary indexes that store fields start with the stored fields, and only
+then reference the row (see `rdb_protocol/stored_fields.hpp`). */
+enum class rdb_value_layout_t { ROW, STORED_FIELDS_AND_ROW };
+
+/* Only loads the part of the value that holds the stored fields. */
+ql::datum_t get_stored_fields(const rdb_value_t *value,
+                              buf_parent_t parent);
+
 class lazy_btree_val_pointee_t
         : public single_threaded_countable_t<lazy_btree_val_pointee_t> {
-    lazy_btree_val_pointee_t(const rdb_value_t *_rdb_value, buf_parent_t _parent)
-        : rdb_value(_rdb_value), parent(_parent) {
+    lazy_btree_val_pointee_t(const rdb_value_t *_rdb_value, buf_parent_t _parent,
+                             rdb_value_layout_t _layout)
+        : rdb_value(_rdb_value), parent(_parent), layout(_layout) {
         guarantee(rdb_value != NULL);
     }
 
     explicit lazy_btree_val_pointee_t(const ql::datum_t &_ptr)
-        : ptr(_ptr), rdb_value(NULL), parent() {
+        : ptr(_ptr), rdb_value(NULL), parent(), layout(rdb_value_layout_t::ROW) {
         guarantee(ptr.has());
     }
 
@@ -51,6 +60,7 @@ class lazy_btree_val_pointee_t
     // the transaction with which to load it.  Non-NULL only if ptr is empty.
     const rdb_value_t *rdb_value;
     buf_parent_t parent;
+    rdb_value_layout_t layout;
 
     DISABLE_COPYING(lazy_btree_val_pointee_t);
 };
@@ -60,10 +70,14 @@ public:
     explicit lazy_btree_val_t(const ql::datum_t &ptr)
         : pointee(new lazy_btree_val_pointee_t(ptr)) { }
 
-    lazy_btree_val_t(const rdb_value_t *rdb_value, buf_parent_t parent)
-        : pointee(new lazy_btree_val_pointee_t(rdb_value, parent)) { }
+    lazy_btree_val_t(const rdb_value_t *rdb_value, buf_parent_t parent,
+                     rdb_value_layout_t layout = rdb_value_layout_t::ROW)
+        : pointee(new lazy_btree_val_pointee_t(rdb_value, parent, layout)) { }
 
     const ql::datum_t &get() const;
+    // Doesn't cache the result, so call `reset()` afterwards if you don't need the
+    // row.
+    ql::datum_t get_stored_fields() const;
     bool references_parent() const;
     void reset();
 
@@ -55,6 +55,7 @@ static const std::set<std::string> acceptable_optargs({
     "durability",
     "emergency_repair",
     "emit",
+    "explain",
     "fill",
     "final_emit",
     "first_batch_scaledown_factor",
@@ -73,6 +73,10 @@ query_params_t::query_params_t(int64_t _token,
     type = term_storage->query_type();
     noreply = term_storage->static_optarg_as_bool("noreply", noreply);
     profile = term_storage->static_optarg_as_bool("profile", profile);
+    // `explain` reports the optimizer's decisions, which are recorded in the profile.
+    if (term_storage->static_optarg_as_bool("explain", false)) {
+        profile = true;
+    }
 }
 
 } // namespace ql
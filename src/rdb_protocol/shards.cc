@@ -1,6 +1,7 @@
 // Copyright 2010-2014 RethinkDB, all rights reserved.
 #include "rdb_protocol/shards.hpp"
 
+#include <algorithm>
 #include <utility>
 
 #include "errors.hpp"
@@ -109,19 +110,64 @@ private:
 
     virtual void unshard(env_t *env, const std::vector<result_t *> &results) {
         guarantee(acc.size() == 0);
-        std::map<datum_t, std::vector<T *>, optional_datum_less_t> vecs;
         r_sanity_check(results.size() != 0);
-        for (auto res = results.begin(); res != results.end(); ++res) {
-            guarantee(*res);
-            grouped_t<T> *gres = boost::get<grouped_t<T> >(*res);
+
+        // Every shard's groups are already sorted by `optional_datum_less_t`, so
+        // rather than looking each group up in an intermediate map (which costs
+        // `log(groups)` datum comparisons per group per shard), we do a k-way merge
+        // of the shards, which costs `log(shards)` comparisons, and append to `acc`
+        // in order.
+        typedef typename std::map<datum_t, T, optional_datum_less_t>::iterator it_t;
+        struct cursor_t {
+            size_t shard;
+            it_t it, end;
+        };
+        std::vector<cursor_t> cursors;
+        cursors.reserve(results.size());
+        for (size_t i = 0; i < results.size(); ++i) {
+            guarantee(results[i]);
+            grouped_t<T> *gres = boost::get<grouped_t<T> >(results[i]);
             guarantee(gres);
-            for (auto kv = gres->begin(); kv != gres->end(); ++kv) {
-                vecs[kv->first].push_back(&kv->second);
+            if (gres->size() != 0) {
+                cursors.push_back(cursor_t{i, gres->begin(), gres->end()});
             }
         }
-        for (auto kv = vecs.begin(); kv != vecs.end(); ++kv) {
-            auto t_it = acc.insert(std::make_pair(kv->first, default_val)).first;
-            unshard_impl(env, &t_it->second, kv->second);
+
+        optional_datum_less_t less;
+        auto heap_cmp = [&](const cursor_t &a, const cursor_t &b) {
+            return less(b.it->first, a.it->first);
+        };
+        std::make_heap(cursors.begin(), cursors.end(), heap_cmp);
+
+        std::vector<std::pair<size_t, T *> > group_vals;
+        std::vector<T *> ts;
+        while (!cursors.empty()) {
+            datum_t group = cursors.front().it->first;
+            group_vals.clear();
+            while (!cursors.empty() && !less(group, cursors.front().it->first)) {
+                std::pop_heap(cursors.begin(), cursors.end(), heap_cmp);
+                cursor_t *c = &cursors.back();
+                group_vals.push_back(std::make_pair(c->shard, &c->it->second));
+                if (++c->it == c->end) {
+                    cursors.pop_back();
+                } else {
+                    std::push_heap(cursors.begin(), cursors.end(), heap_cmp);
+                }
+            }
+            // Keep the shard order for each group, like we'd get by walking the
+            // results one after another.
+            std::sort(group_vals.begin(), group_vals.end(),
+                      [](const std::pair<size_t, T *> &a,
+                         const std::pair<size_t, T *> &b) {
+                          return a.first < b.first;
+                      });
+            ts.clear();
+            for (const auto &pair : group_vals) {
+                ts.push_back(pair.second);
+            }
+            auto t_it = acc.get_underlying_map()->emplace_hint(
+                acc.end(), std::move(group), default_val);
+            unshard_impl(env, &t_it->second, ts);
         }
     }
     virtual void unshard_impl(env_t *env, T *acc, const std::vector<T *> &ts) = 0;
@@ -147,6 +147,11 @@ public:
             signal_t *interruptor)
         THROWS_ONLY(interrupted_exc_t);
 
+    void warm_cache(
+            const std::vector<store_key_t> &keys,
+            signal_t *interruptor)
+        THROWS_ONLY(interrupted_exc_t);
+
     continue_bool_t send_backfill_pre(
             const region_map_t<state_timestamp_t> &start_point,
             backfill_pre_item_consumer_t *pre_item_consumer,
@@ -375,6 +380,7 @@ public:
     scoped_ptr_t<cache_t> cache;
     scoped_ptr_t<cache_conn_t> general_cache_conn;
     scoped_ptr_t<btree_slice_t> btree;
+    serializer_t *serializer_;
     io_backender_t *io_backender_;
     base_path_t base_path_;
     perfmon_membership_t perfmon_collection_membership;
@@ -3,6 +3,7 @@
 #include "btree/backfill.hpp"
 #include "btree/reql_specific.hpp"
 #include "rdb_protocol/btree.hpp"
+#include "serializer/serializer.hpp"
 
 /* `MAX_CONCURRENT_BACKFILL_ITEMS` is the maximum number of coroutines we'll spawn in
 parallel to apply backfill items to the B-tree. */
@@ -389,6 +390,13 @@ continue_bool_t store_t::receive_backfill(
         THROWS_ONLY(interrupted_exc_t) {
     guarantee(_region.beg == get_region().beg && _region.end == get_region().end);
 
+    /* The items carry the recencies they had on the server they came from, which are
+    older than the ones in our file, so incremental backups need to know about it. */
+    {
+        on_thread_t thread_switcher(serializer_->home_thread());
+        serializer_->note_backfill();
+    }
+
     unsaved_data_limiter_t unsaved_data_limiter(general_cache_conn.get());
     receive_backfill_info_t info(
         general_cache_conn.get(), btree.get(), &unsaved_data_limiter);
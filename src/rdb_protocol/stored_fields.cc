@@ -0,0 +1,172 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "rdb_protocol/stored_fields.hpp"
+
+#include <set>
+
+#include "containers/archive/archive.hpp"
+#include "containers/archive/versioned.hpp"
+#include "rdb_protocol/func.hpp"
+#include "rdb_protocol/serialize_datum.hpp"
+#include "rdb_protocol/wire_func.hpp"
+
+namespace ql {
+
+namespace {
+
+bool is_row(const raw_term_t &term, const sym_t &var, bool implicit_ok) {
+    if (term.type() == Term::IMPLICIT_VAR) {
+        return implicit_ok;
+    }
+    if (term.type() != Term::VAR
+            || term.num_args() != 1 || term.arg(0).type() != Term::DATUM) {
+        return false;
+    }
+    datum_t name = term.arg(0).datum();
+    return name.get_type() == datum_t::R_NUM
+        && name.as_num() == static_cast<double>(var.value);
+}
+
+/* Whether `term` is a string constant that names one of `stored`. */
+bool is_stored_field(const raw_term_t &term, const std::set<std::string> &stored) {
+    if (term.type() != Term::DATUM) {
+        return false;
+    }
+    datum_t field = term.datum();
+    return field.get_type() == datum_t::R_STR
+        && stored.count(field.as_str().to_std()) == 1;
+}
+
+/* Returns true if every use of the row in `term` is a `pluck` of stored fields, or, if
+`allow_get_field` is set, a `row(field)` of a stored field. We don't allow the latter in
+`map` functions: if the field is missing, the error message would print the stored
+fields instead of the row. */
+bool reads_only_stored_fields(
+        const raw_term_t &term,
+        const sym_t &var,
+        bool implicit_ok,
+        const std::set<std::string> &stored,
+        bool allow_get_field) {
+    if (is_row(term, var, implicit_ok)) {
+        // The row is used as a whole.
+        return false;
+    }
+    if (term.num_args() >= 1 && is_row(term.arg(0), var, implicit_ok)) {
+        if (term.type() == Term::BRACKET || term.type() == Term::GET_FIELD) {
+            return allow_get_field
+                && term.num_args() == 2
+                && term.num_optargs() == 0
+                && is_stored_field(term.arg(1), stored);
+        } else if (term.type() == Term::PLUCK) {
+            bool ok = term.num_args() >= 2;
+            for (size_t i = 1; ok && i < term.num_args(); ++i) {
+                ok = is_stored_field(term.arg(i), stored);
+            }
+            term.each_optarg([&](const raw_term_t &, const std::string &name) {
+                ok = ok && name == "_NO_RECURSE_";
+            });
+            return ok;
+        } else {
+            return false;
+        }
+    }
+    bool ok = true;
+    for (size_t i = 0; ok && i < term.num_args(); ++i) {
+        ok = reads_only_stored_fields(
+            term.arg(i), var, implicit_ok, stored, allow_get_field);
+    }
+    term.each_optarg([&](const raw_term_t &optarg, const std::string &) {
+        ok = ok && reads_only_stored_fields(
+            optarg, var, implicit_ok, stored, allow_get_field);
+    });
+    return ok;
+}
+
+class stored_fields_visitor_t : public func_visitor_t {
+public:
+    stored_fields_visitor_t(const std::set<std::string> *_stored, bool _allow_get_field)
+        : stored(_stored), allow_get_field(_allow_get_field), result(false) { }
+    void on_reql_func(const reql_func_t *reql_func) {
+        const std::vector<sym_t> &arg_names = reql_func->get_arg_names();
+        if (arg_names.size() == 1) {
+            result = reads_only_stored_fields(
+                reql_func->get_body_src(), arg_names[0],
+                function_emits_implicit_variable(arg_names), *stored, allow_get_field);
+        }
+    }
+    void on_js_func(const js_func_t *) { }
+    bool reads_only_stored() const { return result; }
+private:
+    const std::set<std::string> *stored;
+    bool allow_get_field;
+    bool result;
+};
+
+bool func_reads_only_stored_fields(
+        const wire_func_t &func,
+        const std::set<std::string> &stored,
+        bool allow_get_field) {
+    stored_fields_visitor_t visitor(&stored, allow_get_field);
+    func.compile_wire_func()->visit(&visitor);
+    return visitor.reads_only_stored();
+}
+
+}  // namespace
+
+datum_t project_stored_fields(const std::vector<std::string> &fields,
+                              const datum_t &row) {
+    datum_object_builder_t projection;
+    for (const std::string &field : fields) {
+        datum_t value = row.get_field(datum_string_t(field), NOTHROW);
+        if (value.has()) {
+            projection.overwrite(datum_string_t(field), value);
+        }
+    }
+    return std::move(projection).to_datum();
+}
+
+void serialize_stored_fields_value(write_message_t *wm,
+                                   const std::vector<std::string> &fields,
+                                   const datum_t &row,
+                                   const std::vector<char> &row_value_ref) {
+    // The row made it into the primary index, so we don't have to check the
+    // projection, which is smaller, for serialization errors again.
+    datum_t projection = project_stored_fields(fields, row);
+    uint32_t projection_size = datum_serialized_size(
+        projection, check_datum_serialization_errors_t::NO);
+    serialize<cluster_version_t::LATEST_DISK>(wm, projection_size);
+    datum_serialize(wm, projection, check_datum_serialization_errors_t::NO);
+    wm->append(row_value_ref.data(), row_value_ref.size());
+}
+
+bool stored_fields_cover_read(
+        const std::vector<std::string> &stored_fields,
+        const map_wire_func_t &sindex_func,
+        const std::vector<transform_variant_t> &transforms,
+        const boost::optional<terminal_variant_t> &terminal) {
+    if (stored_fields.empty()) {
+        return false;
+    }
+    std::set<std::string> stored(stored_fields.begin(), stored_fields.end());
+    // The index function runs on the value we read to check truncated keys.
+    if (!func_reads_only_stored_fields(sindex_func, stored, true)) {
+        return false;
+    }
+    for (const transform_variant_t &transform : transforms) {
+        if (const filter_wire_func_t *filter =
+                boost::get<filter_wire_func_t>(&transform)) {
+            // A `default` could make errors visible, and their messages print the row.
+            if (filter->default_filter_val
+                || !func_reads_only_stored_fields(filter->filter_func, stored, true)) {
+                return false;
+            }
+        } else if (const map_wire_func_t *map = boost::get<map_wire_func_t>(&transform)) {
+            // Whatever comes after the `map` only sees its result.
+            return func_reads_only_stored_fields(*map, stored, false);
+        } else {
+            return false;
+        }
+    }
+    return terminal && boost::get<count_wire_func_t>(&*terminal) != nullptr;
+}
+
+}  // namespace ql
@@ -0,0 +1,56 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef RDB_PROTOCOL_STORED_FIELDS_HPP_
+#define RDB_PROTOCOL_STORED_FIELDS_HPP_
+
+#include <string>
+#include <vector>
+
+#include "errors.hpp"
+#include <boost/optional.hpp>
+
+#include "rdb_protocol/datum.hpp"
+#include "rdb_protocol/shards.hpp"
+
+class write_message_t;
+
+namespace ql {
+
+class map_wire_func_t;
+
+/* A secondary index created with `index_create(..., {store: [fields]})` copies those
+top-level fields of every row into its entries. The entries of other secondary indexes
+are just a reference to the blob of the row in the primary index. Such an entry instead
+owns a small blob that holds
+
+    [uint32_t n][the stored fields, as an object of n bytes][the reference to the row]
+
+so that a read that only needs the stored fields can get them from the leaf node, or
+from the first block of that blob, without loading the row. Other reads follow the
+reference to the row's blob, which the entry still shares with the primary index. */
+
+/* The object with those of `fields` that `row` has, as `row.pluck(fields)` would
+return it. */
+datum_t project_stored_fields(const std::vector<std::string> &fields,
+                              const datum_t &row);
+
+/* Writes the value of an index entry for `row`, whose blob in the primary index is
+referenced by `row_value_ref`, in the format described above. */
+void serialize_stored_fields_value(write_message_t *wm,
+                                   const std::vector<std::string> &fields,
+                                   const datum_t &row,
+                                   const std::vector<char> &row_value_ref);
+
+/* Returns true if a secondary index read with the given transforms and terminal can run
+on the stored fields of each row instead of the whole row, with the same results. That
+is the case if the index function only reads stored fields, and the read only passes
+stored fields on: it may start with filters that only look at stored fields, but then it
+either has to `pluck` stored fields, or end in a `count`. */
+bool stored_fields_cover_read(
+        const std::vector<std::string> &stored_fields,
+        const map_wire_func_t &sindex_func,
+        const std::vector<transform_variant_t> &transforms,
+        const boost::optional<terminal_variant_t> &terminal);
+
+}  // namespace ql
+
+#endif  // RDB_PROTOCOL_STORED_FIELDS_HPP_
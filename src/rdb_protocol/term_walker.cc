@@ -226,6 +226,7 @@ bool term_type_is_valid(Term::TermType type) {
     case Term::RECONFIGURE:
     case Term::REBALANCE:
     case Term::SYNC:
+    case Term::BACKUP:
     case Term::GRANT:
     case Term::SET_WRITE_HOOK:
     case Term::GET_WRITE_HOOK:
@@ -415,6 +416,7 @@ bool term_is_write_or_meta(Term::TermType type) {
     case Term::RECONFIGURE:
     case Term::REBALANCE:
     case Term::SYNC:
+    case Term::BACKUP:
     case Term::GRANT:
     case Term::SET_WRITE_HOOK:
     case Term::GET_WRITE_HOOK:
@@ -685,6 +687,7 @@ bool term_forbids_writes(Term::TermType type) {
     case Term::RECONFIGURE:
     case Term::REBALANCE:
     case Term::SYNC:
+    case Term::BACKUP:
     case Term::GRANT:
     case Term::SET_WRITE_HOOK:
     case Term::GET_WRITE_HOOK:
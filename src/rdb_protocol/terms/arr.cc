@@ -1,8 +1,11 @@
 // Copyright 2010-2015 RethinkDB, all rights reserved.
 #include "rdb_protocol/terms/arr.hpp"
 
+#include <unordered_set>
+
 #include "math.hpp"
 #include "parsing/utf8.hpp"
+#include "rdb_protocol/datum_utils.hpp"
 #include "rdb_protocol/error.hpp"
 #include "rdb_protocol/func.hpp"
 #include "rdb_protocol/op.hpp"
@@ -12,6 +15,11 @@
 
 namespace ql {
 
+// The set terms only need datum equality, so they look up elements by hash.  The
+// hashes of arrays and objects are cached, which also speeds up later comparisons.
+typedef std::unordered_set<datum_t, optional_datum_hash_t, optional_datum_equal_t>
+    datum_hash_set_t;
+
 class pend_term_t : public op_term_t {
 public:
     pend_term_t(compile_env_t *env, const raw_term_t &term)
@@ -369,10 +377,7 @@ private:
         scope_env_t *env, args_t *args, eval_flags_t) const {
         datum_t arr = args->arg(env, 0)->as_datum();
         datum_t new_el = args->arg(env, 1)->as_datum();
-        // We only use el_set for equality purposes, so the reql_version doesn't
-        // really matter (with respect to datum ordering behavior).  But we play it
-        // safe.
-        std::set<datum_t, optional_datum_less_t> el_set;
+        datum_hash_set_t el_set;
         datum_array_builder_t out(env->env->limits());
         for (size_t i = 0; i < arr.arr_size(); ++i) {
             if (el_set.insert(arr.get(i)).second) {
@@ -398,9 +403,7 @@ private:
         scope_env_t *env, args_t *args, eval_flags_t) const {
         datum_t arr1 = args->arg(env, 0)->as_datum();
         datum_t arr2 = args->arg(env, 1)->as_datum();
-        // The reql_version doesn't actually matter here -- we only use the datum
-        // comparisons for equality purposes.
-        std::set<datum_t, optional_datum_less_t> el_set;
+        datum_hash_set_t el_set;
         datum_array_builder_t out(env->env->limits());
         for (size_t i = 0; i < arr1.arr_size(); ++i) {
             if (el_set.insert(arr1.get(i)).second) {
@@ -428,9 +431,7 @@ private:
         scope_env_t *env, args_t *args, eval_flags_t) const {
         datum_t arr1 = args->arg(env, 0)->as_datum();
         datum_t arr2 = args->arg(env, 1)->as_datum();
-        // The reql_version here doesn't really matter.  We only use el_set
-        // comparison for equality purposes.
-        std::set<datum_t, optional_datum_less_t> el_set;
+        datum_hash_set_t el_set;
         datum_array_builder_t out(env->env->limits());
         for (size_t i = 0; i < arr1.arr_size(); ++i) {
             el_set.insert(arr1.get(i));
@@ -457,9 +458,7 @@ private:
         scope_env_t *env, args_t *args, eval_flags_t) const {
         datum_t arr1 = args->arg(env, 0)->as_datum();
         datum_t arr2 = args->arg(env, 1)->as_datum();
-        // The reql_version here doesn't really matter.  We only use el_set
-        // comparison for equality purposes.
-        std::set<datum_t, optional_datum_less_t> el_set;
+        datum_hash_set_t el_set;
         datum_array_builder_t out(env->env->limits());
         for (size_t i = 0; i < arr2.arr_size(); ++i) {
             el_set.insert(arr2.get(i));
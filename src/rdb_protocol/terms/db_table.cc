@@ -12,6 +12,7 @@
 #include "rdb_protocol/op.hpp"
 #include "rdb_protocol/pseudo_geometry.hpp"
 #include "rdb_protocol/terms/writes.hpp"
+#include "serializer/log/config.hpp"
 
 namespace ql {
 
@@ -162,7 +163,7 @@ public:
         : meta_op_term_t(env, term, argspec_t(1, 2),
             optargspec_t({"primary_key", "shards", "replicas",
                           "nonvoting_replica_tags", "primary_replica_tag",
-                          "durability"})) { }
+                          "durability", "block_size"})) { }
 private:
     virtual scoped_ptr_t<val_t> eval_impl(
             scope_env_t *env, args_t *args, eval_flags_t) const {
@@ -194,6 +195,19 @@ private:
                 DURABILITY_REQUIREMENT_SOFT ?
                     write_durability_t::SOFT : write_durability_t::HARD;
 
+        uint64_t block_size = DEFAULT_BTREE_BLOCK_SIZE;
+        if (scoped_ptr_t<val_t> v = args->optarg(env, "block_size")) {
+            int64_t size = v->as_int();
+            rcheck_target(v, size > 0 && is_valid_btree_block_size(size),
+                          base_exc_t::LOGIC,
+                          strprintf("Block size must be a power of two between %"
+                                    PRIu64 " and %" PRIu64 " (got %" PRIi64 ").",
+                                    static_cast<uint64_t>(MIN_BTREE_BLOCK_SIZE),
+                                    static_cast<uint64_t>(MAX_BTREE_BLOCK_SIZE),
+                                    size));
+            block_size = size;
+        }
+
         counted_t<const db_t> db;
         name_string_t tbl_name;
         if (args->num_args() == 1) {
@@ -217,6 +231,7 @@ private:
                     config_params,
                     primary_key,
                     durability,
+                    block_size,
                     env->env->interruptor,
                     &result,
                     &error)) {
@@ -756,6 +771,53 @@ private:
     virtual const char *name() const { return "sync"; }
 };
 
+class backup_term_t : public meta_op_term_t {
+public:
+    backup_term_t(compile_env_t *env, const raw_term_t &term)
+        : meta_op_term_t(env, term, argspec_t(2), optargspec_t({"since"})) { }
+
+private:
+    virtual scoped_ptr_t<val_t> eval_impl(
+            scope_env_t *env, args_t *args, eval_flags_t) const {
+        counted_t<table_t> table = args->arg(env, 0)->as_table();
+        name_string_t table_name = name_string_t::guarantee_valid(table->name.c_str());
+        std::string directory = args->arg(env, 1)->as_str().to_std();
+
+        // `since` is the `timestamp` returned by an earlier backup, and makes this
+        // an incremental backup on top of that one.
+        boost::optional<repli_timestamp_t> since;
+        if (scoped_ptr_t<val_t> v = args->optarg(env, "since")) {
+            int64_t timestamp = v->as_int();
+            rcheck_target(v, timestamp >= 0, base_exc_t::LOGIC,
+                          strprintf("`since` must be the `timestamp` of an earlier "
+                                    "backup (got %" PRIi64 ").", timestamp));
+            since = repli_timestamp_t{static_cast<uint64_t>(timestamp)};
+        }
+
+        ql::datum_t result;
+        bool success;
+        admin_err_t error;
+        try {
+            success = env->env->reql_cluster_interface()->table_backup(
+                env->env->get_user_context(),
+                table->db,
+                table_name,
+                directory,
+                since,
+                env->env->interruptor,
+                &result,
+                &error);
+        } catch (auth::permission_error_t const &permission_error) {
+            rfail(ql::base_exc_t::PERMISSION_ERROR, "%s", permission_error.what());
+        }
+        if (!success) {
+            REQL_RETHROW(error);
+        }
+        return new_val(result);
+    }
+    virtual const char *name() const { return "backup"; }
+};
+
 class grant_term_t : public meta_op_term_t {
 public:
     grant_term_t(compile_env_t *env, const raw_term_t &term)
@@ -1029,6 +1091,11 @@ counted_t<term_t> make_sync_term(
     return make_counted<sync_term_t>(env, term);
 }
 
+counted_t<term_t> make_backup_term(
+        compile_env_t *env, const raw_term_t &term) {
+    return make_counted<backup_term_t>(env, term);
+}
+
 counted_t<term_t> make_grant_term(
         compile_env_t *env, const raw_term_t &term) {
     return make_counted<grant_term_t>(env, term);
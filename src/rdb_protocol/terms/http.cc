@@ -30,7 +30,8 @@ public:
                                   "page",
                                   "page_limit",
                                   "auth",
-                                  "result_format" }))
+                                  "result_format",
+                                  "cache" }))
     { }
 private:
     virtual const char *name() const { return "http"; }
@@ -219,6 +220,17 @@ void dispatch_http(env_t *env,
         res_out->error.assign("encountered an unknown exception");
     }
 
+    rdb_context_t *rdb_ctx = env->get_rdb_ctx();
+    if (rdb_ctx != nullptr) {
+        ++rdb_ctx->stats.http_requests_total;
+        if (res_out->connection_reused) {
+            ++rdb_ctx->stats.http_connections_reused;
+        }
+        if (res_out->cache_hit) {
+            ++rdb_ctx->stats.http_cache_hits;
+        }
+    }
+
     check_error_result(*res_out, opts, parent);
 }
 
@@ -449,6 +461,7 @@ void http_term_t::get_optargs(scope_env_t *env,
     get_attempts(env, args, &opts_out->attempts);
     get_redirects(env, args, &opts_out->max_redirects);
     get_bool_optarg("verify", env, args, &opts_out->verify);
+    get_bool_optarg("cache", env, args, &opts_out->cache);
 }
 
 // The `timeout` optarg specifies the number of seconds to wait before erroring
@@ -7,6 +7,7 @@
 
 #include "parsing/utf8.hpp"
 #include "rdb_protocol/error.hpp"
+#include "rdb_protocol/filter_optimizer.hpp"
 #include "rdb_protocol/func.hpp"
 #include "rdb_protocol/math_utils.hpp"
 #include "rdb_protocol/op.hpp"
@@ -418,6 +419,31 @@ private:
         scope_env_t *env, args_t *args, eval_flags_t) const {
         scoped_ptr_t<val_t> v0 = args->arg(env, 0);
         scoped_ptr_t<val_t> v1 = args->arg(env, 1, LITERAL_OK);
+
+        // If the predicate pins down an indexed field we read only the matching part
+        // of the table.  The filter itself still runs on the result, so the rewrite
+        // only has to be conservative.  A `default` could make rows without the
+        // field match, so we leave those filters alone.  A changefeed on the result
+        // still watches the whole table (see `rewritten_read_datum_stream_t`).
+        if (!default_filter_term.has()
+            && v0->get_type().get_raw_type() == val_t::type_t::TABLE) {
+            counted_t<table_t> table = v0->as_table();
+            boost::optional<filter_index_plan_t> plan =
+                plan_filter_index_scan(env->env, table, v1.get());
+            if (plan) {
+                profile::starter_t starter("Optimizer: " + plan->print(),
+                                           env->env->trace);
+                counted_t<selection_t> rewritten =
+                    plan->read(env->env, table, backtrace())->as_selection(env->env);
+                v0 = new_val(make_counted<selection_t>(
+                    table,
+                    make_counted<rewritten_read_datum_stream_t>(
+                        std::move(rewritten->seq),
+                        v0->as_seq(env->env),
+                        backtrace())));
+            }
+        }
+
         counted_t<const func_t> f = v1->as_func(CONSTANT_SHORTCUT);
         boost::optional<wire_func_t> defval;
         if (default_filter_term.has()) {
@@ -26,7 +26,8 @@ datum_string_t sindex_config_to_string(const sindex_config_t &config) {
     version.original_reql_version = config.func_version;
     version.latest_compatible_reql_version = config.func_version;
     version.latest_checked_reql_version = reql_version_t::LATEST;
-    sindex_disk_info_t disk_info(config.func, version, config.multi, config.geo);
+    sindex_disk_info_t disk_info(config.func, version, config.multi, config.geo,
+                                 config.stored_fields);
 
     write_message_t wm;
     serialize_sindex_info(&wm, disk_info);
@@ -83,11 +84,13 @@ sindex_config_t sindex_config_from_string(
             "reql_index_function (%s).",
             e.what());
     }
-    return sindex_config_t(
+    config = sindex_config_t(
         sindex_info.mapping,
         sindex_info.mapping_version_info.original_reql_version,
         sindex_info.multi,
         sindex_info.geo);
+    config.stored_fields = sindex_info.stored_fields;
+    return config;
 }
 
 // Helper for `sindex_status_to_datum()`
@@ -117,6 +120,31 @@ std::string format_index_create_query(
         }
         ret += "geo: true";
     }
+    if (config.geo == sindex_geo_bool_t::TRIGRAM) {
+        if (first_optarg) {
+            ret += ", {";
+            first_optarg = false;
+        } else {
+            ret += ", ";
+        }
+        ret += "trigram: true";
+    }
+    if (!config.stored_fields.empty()) {
+        if (first_optarg) {
+            ret += ", {";
+            first_optarg = false;
+        } else {
+            ret += ", ";
+        }
+        ret += "store: [";
+        for (size_t i = 0; i < config.stored_fields.size(); ++i) {
+            if (i != 0) {
+                ret += ", ";
+            }
+            ret += "'" + config.stored_fields[i] + "'";
+        }
+        ret += "]";
+    }
     if (!first_optarg) {
         ret += "}";
     }
@@ -144,6 +172,13 @@ ql::datum_t sindex_status_to_datum(
         ql::datum_t::boolean(config.multi == sindex_multi_bool_t::MULTI));
     stat.overwrite("geo",
         ql::datum_t::boolean(config.geo == sindex_geo_bool_t::GEO));
+    stat.overwrite("trigram",
+        ql::datum_t::boolean(config.geo == sindex_geo_bool_t::TRIGRAM));
+    ql::datum_array_builder_t store(ql::configured_limits_t::unlimited);
+    for (const std::string &field : config.stored_fields) {
+        store.add(ql::datum_t(datum_string_t(field)));
+    }
+    stat.overwrite("store", std::move(store).to_datum());
     stat.overwrite("function",
         ql::datum_t::binary(sindex_config_to_string(config)));
     stat.overwrite("query",
@@ -154,7 +189,7 @@ ql::datum_t sindex_status_to_datum(
 class sindex_create_term_t : public op_term_t {
 public:
     sindex_create_term_t(compile_env_t *env, const raw_term_t &term)
-        : op_term_t(env, term, argspec_t(2, 3), optargspec_t({"multi", "geo"})) { }
+        : op_term_t(env, term, argspec_t(2, 3), optargspec_t({"multi", "geo", "trigram", "store"})) { }
 
     virtual scoped_ptr_t<val_t> eval_impl(
         scope_env_t *env, args_t *args, eval_flags_t) const {
@@ -218,6 +253,33 @@ public:
                 ? sindex_geo_bool_t::GEO
                 : sindex_geo_bool_t::REGULAR;
         }
+        /* Or a trigram index?  Those store one key per trigram, just like the elements
+        of a multi index. */
+        if (scoped_ptr_t<val_t> trigram_val = args->optarg(env, "trigram")) {
+            if (trigram_val->as_bool()) {
+                rcheck(config.geo != sindex_geo_bool_t::GEO, base_exc_t::LOGIC,
+                       "An index can't be both a geospatial and a trigram index.");
+                config.geo = sindex_geo_bool_t::TRIGRAM;
+                config.multi = sindex_multi_bool_t::MULTI;
+            }
+        }
+        /* Which fields should be copied into the index, so that queries that only
+        need those fields don't have to load the whole document? */
+        if (scoped_ptr_t<val_t> store_val = args->optarg(env, "store")) {
+            datum_t store = store_val->as_datum();
+            std::set<std::string> seen;
+            config.stored_fields.clear();
+            for (size_t i = 0; i < store.arr_size(); ++i) {
+                std::string field = store.get(i).as_str().to_std();
+                if (seen.insert(field).second) {
+                    config.stored_fields.push_back(field);
+                }
+            }
+            rcheck(config.stored_fields.empty()
+                       || config.geo == sindex_geo_bool_t::REGULAR,
+                   base_exc_t::LOGIC,
+                   "Only regular secondary indexes can store fields.");
+        }
 
         try {
             admin_err_t error;
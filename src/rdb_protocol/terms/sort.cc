@@ -1,13 +1,16 @@
 // Copyright 2010-2015 RethinkDB, all rights reserved.
 #include "rdb_protocol/terms/terms.hpp"
 
+#include <algorithm>
 #include <string>
+#include <unordered_set>
 #include <utility>
 
 #include "errors.hpp"
 #include <boost/bind.hpp>
 
 #include "rdb_protocol/datum_stream.hpp"
+#include "rdb_protocol/datum_utils.hpp"
 #include "rdb_protocol/error.hpp"
 #include "rdb_protocol/func.hpp"
 #include "rdb_protocol/minidriver.hpp"
@@ -167,9 +170,10 @@ private:
         rcheck(!idx, base_exc_t::LOGIC,
                "Can only perform an indexed distinct on a TABLE.");
         counted_t<datum_stream_t> s = v->as_seq(env->env);
-        // The reql_version matters here, because we copy `results` into `toret`
-        // in ascending order.
-        std::set<datum_t, optional_datum_less_t> results;
+        // Finding the distinct elements only takes equality, so we collect them in a
+        // hash set and only sort those that remain.
+        std::unordered_set<datum_t, optional_datum_hash_t, optional_datum_equal_t>
+            results;
         batchspec_t batchspec = batchspec_t::user(batch_type_t::TERMINAL, env->env);
         {
             profile::sampler_t sampler("Evaluating elements in distinct.",
@@ -181,8 +185,8 @@ private:
                 sampler.new_sample();
             }
         }
-        std::vector<datum_t> toret;
-        std::move(results.begin(), results.end(), std::back_inserter(toret));
+        std::vector<datum_t> toret(results.begin(), results.end());
+        std::sort(toret.begin(), toret.end(), optional_datum_less_t());
         return new_val(datum_t(std::move(toret), env->env->limits()));
     }
 
@@ -0,0 +1,284 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "rdb_protocol/trigrams.hpp"
+
+#include <ctype.h>
+#include <string.h>
+
+#include <set>
+
+#include "parsing/utf8.hpp"
+
+namespace ql {
+
+namespace {
+
+char fold_ascii(char c) {
+    return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+}
+
+void add_trigrams(const char *start, const char *end, std::set<std::string> *out) {
+    // `boundaries` holds the offsets of the last three code points we saw.
+    std::vector<const char *> boundaries;
+    for (const char *it = start; it < end;) {
+        boundaries.push_back(it);
+        it = utf8::next_codepoint(it, end);
+        if (boundaries.size() > 3) {
+            boundaries.erase(boundaries.begin());
+        }
+        if (boundaries.size() == 3) {
+            std::string trigram(boundaries[0], it);
+            for (char &c : trigram) {
+                c = fold_ascii(c);
+            }
+            out->insert(std::move(trigram));
+        }
+    }
+}
+
+/* If `it` points at a counted repetition such as `{2}`, `{2,}` or `{2,5}`, returns the
+end of it; otherwise returns `nullptr`. */
+const char *counted_repetition_end(const char *it, const char *end) {
+    guarantee(*it == '{');
+    ++it;
+    const char *digits = it;
+    while (it < end && isdigit(*it)) ++it;
+    if (it == digits) {
+        return nullptr;
+    }
+    if (it < end && *it == ',') {
+        ++it;
+        while (it < end && isdigit(*it)) ++it;
+    }
+    return it < end && *it == '}' ? it + 1 : nullptr;
+}
+
+/* Splits `regex` into the literal strings every match must contain.  This only looks
+at the top level of the pattern; character classes, anchors, escapes other than escaped
+punctuation, and anything quantified just end the current literal, which makes us miss
+trigrams but never invent them.  Returns false if the pattern uses anything we don't
+fully understand, since we then can't be sure where the literals are. */
+bool required_literals(const std::string &regex, std::vector<std::string> *out) {
+    std::string current;
+    // The length of the literal most recently added to `current`, so that a following
+    // quantifier can take it back out.
+    size_t last_len = 0;
+    int depth = 0;
+    auto flush = [&]() {
+        if (!current.empty()) {
+            out->push_back(current);
+            current.clear();
+        }
+        last_len = 0;
+    };
+    auto add_literal = [&](const char *start, const char *end) {
+        if (depth == 0) {
+            current.append(start, end);
+            last_len = end - start;
+        }
+    };
+    // Skips a `{...}` argument of an escape such as `\x{263a}` or `\p{Greek}`.
+    auto skip_braces = [&](const char *it, const char *end) -> const char * {
+        const char *close = static_cast<const char *>(memchr(it, '}', end - it));
+        return close != nullptr ? close + 1 : nullptr;
+    };
+    const char *end = regex.data() + regex.size();
+    for (const char *it = regex.data(); it < end;) {
+        switch (*it) {
+        case '\\': {
+            if (it + 1 == end || (it[1] & 0x80) != 0) {
+                return false;
+            }
+            char escape = it[1];
+            it += 2;
+            if (!isalnum(escape)) {
+                add_literal(it - 1, it);
+            } else if (escape == 'Q') {
+                // `\Q...\E` quotes literals; we skip them rather than parse them.
+                flush();
+                const char *close = strstr(it, "\\E");
+                it = close != nullptr ? close + 2 : end;
+            } else if (escape == 'x' || escape == 'p' || escape == 'P') {
+                // `\x41`, `\x{263a}`, `\pL` and `\p{Greek}`.
+                flush();
+                if (it < end && *it == '{') {
+                    it = skip_braces(it, end);
+                    if (it == nullptr) {
+                        return false;
+                    }
+                } else {
+                    size_t len = escape == 'x' ? 2 : 1;
+                    if (static_cast<size_t>(end - it) < len) {
+                        return false;
+                    }
+                    it += len;
+                }
+            } else if (escape >= '0' && escape <= '7') {
+                // Octal escapes take up to three digits.
+                flush();
+                for (int i = 1; i < 3 && it < end && *it >= '0' && *it <= '7'; ++i) {
+                    ++it;
+                }
+            } else if (strchr("aftnrvdDsSwWbBAzC", escape) != nullptr) {
+                // Control characters, Perl classes, anchors and `\C`.
+                flush();
+            } else {
+                return false;
+            }
+            break;
+        }
+        case '[':
+            flush();
+            ++it;
+            if (it < end && *it == '^') ++it;
+            if (it < end && *it == ']') ++it;
+            while (it < end && *it != ']') {
+                if (*it == '\\' && it + 1 < end) {
+                    if ((it[1] == 'p' || it[1] == 'P' || it[1] == 'x')
+                            && it + 2 < end && it[2] == '{') {
+                        it = skip_braces(it + 2, end);
+                        if (it == nullptr) {
+                            return false;
+                        }
+                    } else {
+                        it += 2;
+                    }
+                } else if (*it == '[' && it + 1 < end && it[1] == ':') {
+                    const char *close = strstr(it + 2, ":]");
+                    if (close == nullptr) {
+                        return false;
+                    }
+                    it = close + 2;
+                } else {
+                    ++it;
+                }
+            }
+            if (it == end) {
+                return false;
+            }
+            ++it;
+            break;
+        case '(':
+            flush();
+            if (it + 1 < end && it[1] == '?' && it + 2 < end && it[2] != 'P') {
+                // A flag group such as `(?i)` or `(?ims:...)`; case-insensitive
+                // matching would need case folding beyond ASCII.
+                for (const char *f = it + 2; f < end && *f != ')' && *f != ':'; ++f) {
+                    if (*f == 'i') {
+                        return false;
+                    }
+                }
+            }
+            ++depth;
+            ++it;
+            break;
+        case ')':
+            if (depth == 0) {
+                return false;
+            }
+            flush();
+            --depth;
+            ++it;
+            break;
+        case '|':
+            if (depth == 0) {
+                // Alternatives at the top level have no literal in common that we
+                // could find without a real parser.
+                return false;
+            }
+            ++it;
+            break;
+        case '{': {
+            // A `{` that doesn't start a counted repetition is a literal in RE2, but
+            // we'd rather not guess which is which.
+            const char *repetition_end = counted_repetition_end(it, end);
+            if (repetition_end == nullptr) {
+                return false;
+            }
+            if (depth == 0) {
+                current.resize(current.size() - last_len);
+            }
+            flush();
+            it = repetition_end;
+            break;
+        }
+        case '?': // fallthru
+        case '*': // fallthru
+        case '+':
+            // The quantified literal may be missing (or repeated), so it can't stay
+            // part of the literal run.
+            if (depth == 0) {
+                current.resize(current.size() - last_len);
+            }
+            flush();
+            ++it;
+            break;
+        case '.': // fallthru
+        case '^': // fallthru
+        case '$': // fallthru
+        case '}':
+            flush();
+            ++it;
+            break;
+        default: {
+            const char *next = utf8::next_codepoint(it, end);
+            add_literal(it, next);
+            it = next;
+            break;
+        }
+        }
+    }
+    if (depth != 0) {
+        return false;
+    }
+    flush();
+    return true;
+}
+
+}  // namespace
+
+std::vector<datum_t> compute_trigrams(const datum_t &value) {
+    std::set<std::string> trigrams;
+    if (value.get_type() == datum_t::R_STR) {
+        const datum_string_t &str = value.as_str();
+        add_trigrams(str.data(), str.data() + str.size(), &trigrams);
+    } else if (value.get_type() == datum_t::R_ARRAY) {
+        for (size_t i = 0; i < value.arr_size(); ++i) {
+            datum_t el = value.get(i);
+            if (el.get_type() == datum_t::R_STR) {
+                const datum_string_t &str = el.as_str();
+                add_trigrams(str.data(), str.data() + str.size(), &trigrams);
+            }
+        }
+    }
+    std::vector<datum_t> res;
+    res.reserve(trigrams.size() + 1);
+    for (const std::string &trigram : trigrams) {
+        res.push_back(datum_t(datum_string_t(trigram)));
+    }
+    if (value.get_type() != datum_t::R_STR) {
+        res.push_back(non_string_trigram_key());
+    }
+    return res;
+}
+
+datum_t non_string_trigram_key() {
+    return datum_t::boolean(false);
+}
+
+std::vector<datum_t> required_trigrams(const std::string &regex) {
+    std::vector<std::string> literals;
+    std::set<std::string> trigrams;
+    if (required_literals(regex, &literals)) {
+        for (const std::string &literal : literals) {
+            add_trigrams(literal.data(), literal.data() + literal.size(), &trigrams);
+        }
+    }
+    std::vector<datum_t> res;
+    res.reserve(trigrams.size());
+    for (const std::string &trigram : trigrams) {
+        res.push_back(datum_t(datum_string_t(trigram)));
+    }
+    return res;
+}
+
+}  // namespace ql
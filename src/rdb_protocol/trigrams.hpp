@@ -0,0 +1,36 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef RDB_PROTOCOL_TRIGRAMS_HPP_
+#define RDB_PROTOCOL_TRIGRAMS_HPP_
+
+#include <string>
+#include <vector>
+
+#include "rdb_protocol/datum.hpp"
+
+namespace ql {
+
+/* A trigram index stores every distinct run of three consecutive code points of the
+strings its function returns (either a string or an array of strings), with ASCII
+letters folded to lower case.  Lookups for a trigram find every row that contains it,
+so a `match()` can be answered by intersecting the rows of the trigrams any matching
+string must contain and running the regular expression on those rows only.
+
+Any other value, including an array, is also stored under `non_string_trigram_key()`,
+since `match()` fails on it and a rewritten `match()` has to fail the same way.
+
+The trigrams are returned sorted, followed by that key if it applies, so that a key's tag
+identifies its trigram. */
+std::vector<datum_t> compute_trigrams(const datum_t &value);
+
+/* `false`, which can't collide with a trigram because those are strings. */
+datum_t non_string_trigram_key();
+
+/* Returns trigrams that every string matching the RE2 pattern `regex` must contain, or
+an empty vector if there are none we can be sure of.  Case-insensitive patterns always
+get an empty vector, since Unicode case folding can map non-ASCII characters onto the
+ASCII letters we fold in the index. */
+std::vector<datum_t> required_trigrams(const std::string &regex);
+
+}  // namespace ql
+
+#endif  // RDB_PROTOCOL_TRIGRAMS_HPP_
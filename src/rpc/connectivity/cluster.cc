@@ -31,12 +31,19 @@
 // Number of messages after which the message handling loop yields
 #define MESSAGE_HANDLER_MAX_BATCH_SIZE           16
 
+// The most TCP streams that a connection to another server is made of
+#define MAX_STREAMS_PER_CONNECTION               4
+
+// How long a new connection waits for its additional streams to be established before
+// it goes ahead with those that are there
+#define STREAM_JOIN_TIMEOUT_MS                   5000
+
 // The cluster communication protocol version.
-static_assert(cluster_version_t::CLUSTER == cluster_version_t::v2_4_is_latest,
+static_assert(cluster_version_t::CLUSTER == cluster_version_t::v2_5_is_latest,
               "We need to update CLUSTER_VERSION_STRING when we add a new cluster "
               "version.");
 
-#define CLUSTER_VERSION_STRING "2.4.0"
+#define CLUSTER_VERSION_STRING "2.5.0"
 
 const std::string connectivity_cluster_t::cluster_proto_header("RethinkDB cluster\n");
 const std::string connectivity_cluster_t::cluster_version_string(CLUSTER_VERSION_STRING);
@@ -119,8 +126,10 @@ const std::string connectivity_cluster_t::cluster_build_mode("debug");
 
 void connectivity_cluster_t::connection_t::kill_connection() {
     /* `heartbeat_manager_t` assumes this doesn't block as long as it's called on the
-    home thread. */
+    home thread. We only shut down the first stream, which is on the home thread;
+    `handle()` shuts down the other streams once the first one is closed. */
     guarantee(!is_loopback(), "Attempted to kill connection to myself.");
+    keepalive_tcp_conn_stream_t *conn = streams[0]->conn;
     on_thread_t thread_switcher(conn->home_thread());
 
     if (conn->is_read_open()) {
@@ -131,16 +140,25 @@ void connectivity_cluster_t::connection_t::kill_connection() {
     }
 }
 
-connectivity_cluster_t::connection_t::connection_t(
-        run_t *_parent,
-        const peer_id_t &_peer_id,
-        const server_id_t &_server_id,
+void connectivity_cluster_t::connection_t::shutdown_streams() {
+    pmap(streams.size(), [this](int64_t i) {
+        keepalive_tcp_conn_stream_t *conn = streams[i]->conn;
+        on_thread_t thread_switcher(conn->home_thread());
+        if (conn->is_read_open()) {
+            conn->shutdown_read();
+        }
+        if (conn->is_write_open()) {
+            conn->shutdown_write();
+        }
+    });
+}
+
+connectivity_cluster_t::connection_t::stream_t::stream_t(
         keepalive_tcp_conn_stream_t *_conn,
-        const peer_address_t &_peer_address) THROWS_NOTHING :
+        perfmon_collection_t *pm_collection,
+        size_t index) :
     conn(_conn),
-    peer_address(_peer_address),
-    flusher([&](signal_t *) {
-        guarantee(this->conn != nullptr);
+    flusher([this](signal_t *) {
         // We need to acquire the send_mutex because flushing the buffer
         // must not interleave with other writes (restriction of linux_tcp_conn_t).
         mutex_t::acq_t acq(&this->send_mutex);
@@ -148,6 +166,58 @@ connectivity_cluster_t::connection_t::connection_t(
         // must be handled elsewhere.
         this->conn->flush_buffer();
     }, 1),
+    pm_bytes_sent(secs_to_ticks(1), true),
+    pm_bytes_sent_membership(
+        pm_collection, &pm_bytes_sent, strprintf("stream_%zu_bytes_sent", index)),
+    pm_reads_per_megabyte(_conn),
+    pm_reads_per_megabyte_membership(
+        pm_collection, &pm_reads_per_megabyte,
+        strprintf("stream_%zu_reads_per_megabyte", index)) {
+    guarantee(conn != nullptr);
+}
+
+connectivity_cluster_t::connection_t::stream_t::pm_reads_per_megabyte_t::
+        pm_reads_per_megabyte_t(keepalive_tcp_conn_stream_t *_conn) :
+    conn(_conn) { }
+
+void connectivity_cluster_t::connection_t::stream_t::pm_reads_per_megabyte_t::
+        get_thread_stat(std::pair<uint64_t, uint64_t> *stat) {
+    /* The read stats may only be accessed on the connection's thread. */
+    tcp_conn_t *tcp_conn = conn->get_underlying_conn();
+    if (get_thread_id() == tcp_conn->home_thread()) {
+        const tcp_conn_t::read_stats_t &read_stats = tcp_conn->get_read_stats();
+        *stat = std::make_pair(read_stats.reads, read_stats.bytes);
+    } else {
+        *stat = std::make_pair(0, 0);
+    }
+}
+
+std::pair<uint64_t, uint64_t>
+connectivity_cluster_t::connection_t::stream_t::pm_reads_per_megabyte_t::
+        combine_stats(const std::pair<uint64_t, uint64_t> *stats) {
+    std::pair<uint64_t, uint64_t> combined(0, 0);
+    for (int i = 0; i < get_num_threads(); ++i) {
+        combined.first += stats[i].first;
+        combined.second += stats[i].second;
+    }
+    return combined;
+}
+
+ql::datum_t connectivity_cluster_t::connection_t::stream_t::pm_reads_per_megabyte_t::
+        output_stat(const std::pair<uint64_t, uint64_t> &stat) {
+    tcp_conn_t::read_stats_t read_stats;
+    read_stats.reads = stat.first;
+    read_stats.bytes = stat.second;
+    return ql::datum_t(read_stats.reads_per_megabyte());
+}
+
+connectivity_cluster_t::connection_t::connection_t(
+        run_t *_parent,
+        const peer_id_t &_peer_id,
+        const server_id_t &_server_id,
+        const std::vector<keepalive_tcp_conn_stream_t *> &conns,
+        const peer_address_t &_peer_address) THROWS_NOTHING :
+    peer_address(_peer_address),
     pm_collection(),
     pm_bytes_sent(secs_to_ticks(1), true),
     pm_collection_membership(
@@ -155,11 +225,18 @@ connectivity_cluster_t::connection_t::connection_t(
         &pm_collection,
         uuid_to_str(_peer_id.get_uuid())),
     pm_bytes_sent_membership(&pm_collection, &pm_bytes_sent, "bytes_sent"),
+    streams(conns.size()),
     parent(_parent),
     peer_id(_peer_id),
     server_id(_server_id),
     drainers()
 {
+    // Each stream is set up on the thread of its TCP connection.
+    pmap(conns.size(), [&](int64_t i) {
+        on_thread_t thread_switcher(conns[i]->home_thread());
+        streams[i].init(new stream_t(conns[i], &pm_collection, i));
+    });
+
     pmap(get_num_threads(), [this](int thread_id) {
         on_thread_t thread_switcher((threadnum_t(thread_id)));
         parent->parent->connections.get()->set_key_no_equals(
@@ -176,8 +253,12 @@ connectivity_cluster_t::connection_t::~connection_t() THROWS_NOTHING {
         drainers.get()->drain();
     });
 
-    /* The drainers have been destroyed, so nothing can be holding the `send_mutex`. */
-    guarantee(!send_mutex.is_locked());
+    /* The drainers have been destroyed, so nothing can be holding a `send_mutex`. */
+    pmap(streams.size(), [this](int64_t i) {
+        on_thread_t thread_switcher(streams[i]->conn->home_thread());
+        guarantee(!streams[i]->send_mutex.is_locked());
+        streams[i].reset();
+    });
 }
 
 // Helper function for the `run_t` constructor's initialization list
@@ -230,6 +311,11 @@ connectivity_cluster_t::run_t::run_t(
     server_id(_server_id),
     tls_ctx(_tls_ctx),
 
+    max_streams_per_connection(
+        client_port != 0
+            ? 1
+            : std::min<uint32_t>(get_num_threads(), MAX_STREAMS_PER_CONNECTION)),
+
     /* Create the socket to use when listening for connections from peers */
     cluster_listener_socket(new tcp_bound_socket_t(local_addresses, port)),
     cluster_listener_port(cluster_listener_socket->get_port()),
@@ -260,7 +346,9 @@ connectivity_cluster_t::run_t::run_t(
     `connection_map` on each thread and notifying any listeners that we're now
     connected to ourself. The destructor will remove us from the
     `connection_map` and again notify any listeners. */
-    connection_to_ourself(this, parent->me, _server_id, nullptr, routing_table[parent->me]),
+    connection_to_ourself(this, parent->me, _server_id,
+                          std::vector<keepalive_tcp_conn_stream_t *>(),
+                          routing_table[parent->me]),
 
     heartbeat_sl_view(_heartbeat_sl_view),
     auth_sl_view(_auth_sl_view),
@@ -324,7 +412,8 @@ void connectivity_cluster_t::run_t::on_new_connection(
 
     keepalive_tcp_conn_stream_t conn_stream(conn);
 
-    handle(&conn_stream, boost::none, boost::none, boost::none, lock, nullptr, join_delay_secs);
+    handle(&conn_stream, boost::none, boost::none, boost::none, lock, nullptr,
+           join_delay_secs, nil_uuid(), 0);
 }
 
 join_result_t connectivity_cluster_t::run_t::connect_to_peer(
@@ -362,7 +451,8 @@ join_result_t connectivity_cluster_t::run_t::connect_to_peer(
 
             join_result = handle(
                 &conn, expected_id, boost::optional<peer_address_t>(*address),
-                expected_server_id, drainer_lock, successful_join_inout, join_delay_secs);
+                expected_server_id, drainer_lock, successful_join_inout, join_delay_secs,
+                generate_uuid(), 0);
         } catch (const tcp_conn_t::connect_failed_exc_t &) {
             /* Ignore */
         } catch (const crypto::openssl_error_t &) {
@@ -377,6 +467,141 @@ join_result_t connectivity_cluster_t::run_t::connect_to_peer(
     return join_result;
 }
 
+/* The first stream of a connection registers a `stream_session_t` under the session id
+of the connection. The `handle()` call of each additional stream hands its TCP connection
+to the session once the handshake is done, and then waits for `released` to be pulsed.
+The first stream picks up the TCP connections in `wait_for_streams()`, and it may use them
+until it destroys the session. All of this happens on the `run_t`'s thread. */
+class connectivity_cluster_t::run_t::stream_session_t {
+public:
+    stream_session_t(run_t *parent,
+                     const uuid_u &session_id,
+                     const peer_id_t &_peer_id,
+                     uint32_t num_streams) :
+        peer_id(_peer_id),
+        slots(num_streams),
+        num_missing(num_streams - 1),
+        collecting(true),
+        sentry(&parent->stream_sessions, session_id, this) {
+        guarantee(num_streams > 1);
+    }
+
+    ~stream_session_t() {
+        for (const slot_t &slot : slots) {
+            if (slot.released != nullptr) {
+                slot.released->pulse();
+            }
+        }
+    }
+
+    /* Returns false if the stream can't join the session, in which case it should be
+    closed. */
+    bool join(uint32_t index,
+              const peer_id_t &other_id,
+              keepalive_tcp_conn_stream_t *conn,
+              cond_t *released) {
+        if (!collecting || other_id != peer_id || index == 0 || index >= slots.size()
+                || slots[index].state != slot_state_t::WAITING) {
+            return false;
+        }
+        slots[index].state = slot_state_t::JOINED;
+        slots[index].conn = conn;
+        slots[index].released = released;
+        on_stream_done();
+        return true;
+    }
+
+    /* Called if we couldn't establish one of the streams that we opened ourselves. */
+    void abandon(uint32_t index) {
+        guarantee(index > 0 && index < slots.size());
+        if (collecting && slots[index].state == slot_state_t::WAITING) {
+            slots[index].state = slot_state_t::ABANDONED;
+            on_stream_done();
+        }
+    }
+
+    /* Waits until every stream has either joined or been abandoned, or until the
+    timeout runs out. Streams can't join anymore afterwards. Returns `first_conn`
+    followed by the TCP connections of the streams that joined. */
+    std::vector<keepalive_tcp_conn_stream_t *> wait_for_streams(
+            keepalive_tcp_conn_stream_t *first_conn,
+            signal_t *interruptor) {
+        signal_timer_t timeout;
+        timeout.start(STREAM_JOIN_TIMEOUT_MS);
+        wait_any_t waiter(&all_done, &timeout, interruptor);
+        waiter.wait_lazily_unordered();
+        collecting = false;
+
+        std::vector<keepalive_tcp_conn_stream_t *> conns(1, first_conn);
+        for (const slot_t &slot : slots) {
+            if (slot.state == slot_state_t::JOINED) {
+                conns.push_back(slot.conn);
+            }
+        }
+        return conns;
+    }
+
+private:
+    enum class slot_state_t { WAITING, JOINED, ABANDONED };
+    struct slot_t {
+        slot_t() : state(slot_state_t::WAITING), conn(nullptr), released(nullptr) { }
+        slot_state_t state;
+        keepalive_tcp_conn_stream_t *conn;
+        cond_t *released;
+    };
+
+    void on_stream_done() {
+        guarantee(num_missing > 0);
+        --num_missing;
+        if (num_missing == 0) {
+            all_done.pulse();
+        }
+    }
+
+    peer_id_t peer_id;
+    std::vector<slot_t> slots;
+    size_t num_missing;
+    cond_t all_done;
+    bool collecting;
+    map_insertion_sentry_t<uuid_u, stream_session_t *> sentry;
+
+    DISABLE_COPYING(stream_session_t);
+};
+
+void connectivity_cluster_t::run_t::connect_stream(
+        ip_and_port_t address,
+        peer_id_t expected_id,
+        server_id_t expected_server_id,
+        uuid_u stream_session,
+        uint32_t stream_index,
+        auto_drainer_t::lock_t drainer_lock) THROWS_NOTHING {
+    join_result_t join_result = join_result_t::TEMPORARY_ERROR;
+    try {
+        keepalive_tcp_conn_stream_t conn(
+            tls_ctx, address.ip(), address.port().value(),
+            drainer_lock.get_drain_signal(), cluster_client_port);
+
+        join_result = handle(
+            &conn, boost::optional<peer_id_t>(expected_id), boost::none,
+            boost::optional<server_id_t>(expected_server_id), drainer_lock, nullptr, 0,
+            stream_session, stream_index);
+    } catch (const tcp_conn_t::connect_failed_exc_t &) {
+        /* Ignore */
+    } catch (const crypto::openssl_error_t &) {
+        /* Ignore */
+    } catch (const interrupted_exc_t &) {
+        /* Ignore */
+    }
+
+    if (join_result != join_result_t::SUCCESS) {
+        // Don't keep the first stream waiting for us.
+        auto it = stream_sessions.find(stream_session);
+        if (it != stream_sessions.end()) {
+            it->second->abandon(stream_index);
+        }
+    }
+}
+
 join_results_t connectivity_cluster_t::run_t::join_blocking(
         const peer_address_t &peer,
         boost::optional<peer_id_t> expected_id,
@@ -483,7 +708,7 @@ public:
         heartbeat_sl_view(std::move(heartbeat_sl_view_)),
         heartbeat_sl_view_sub(std::bind(&heartbeat_manager_t::on_heartbeat_change, this))
     {
-        connection->conn->set_keepalive_callback(this);
+        connection->streams[0]->conn->set_keepalive_callback(this);
 
         // This will trigger the initialization of the timeout, and timer
         watchable_t<heartbeat_semilattice_metadata_t>::freeze_t
@@ -492,7 +717,7 @@ public:
     }
 
     ~heartbeat_manager_t() {
-        connection->conn->set_keepalive_callback(nullptr);
+        connection->streams[0]->conn->set_keepalive_callback(nullptr);
     }
 
     /* These are called by the `keepalive_tcp_conn_stream_t`. */
@@ -869,7 +1094,9 @@ join_result_t connectivity_cluster_t::run_t::handle(
         boost::optional<server_id_t> expected_server_id,
         auto_drainer_t::lock_t drainer_lock,
         bool *successful_join_inout,
-        const int join_delay_secs) THROWS_NOTHING
+        const int join_delay_secs,
+        const uuid_u &stream_session,
+        uint32_t stream_index) THROWS_NOTHING
 {
     parent->assert_thread();
 
@@ -915,6 +1142,9 @@ join_result_t connectivity_cluster_t::run_t::handle(
         // Everything after we send the version string COULD be moved _below_ the
         // point where we resolve the version string.  That would mean adding another
         // back and forth to the handshake?
+        serialize_universal(&wm, stream_session);
+        serialize_universal(&wm, stream_index);
+        serialize_universal(&wm, max_streams_per_connection);
         serialize_universal(&wm, server_id);
         serialize_universal(&wm, static_cast<uint64_t>(cluster_arch_bitsize.length()));
         wm.append(cluster_arch_bitsize.data(), cluster_arch_bitsize.length());
@@ -980,6 +1210,45 @@ join_result_t connectivity_cluster_t::run_t::handle(
         guarantee(resolved_version == cluster_version_t::CLUSTER);
     }
 
+    // Find out which connection this stream belongs to. The session id and stream
+    // index that count are the ones sent by the server that opened the TCP connection.
+    uuid_u session_id;
+    uint32_t session_stream_index;
+    uint32_t num_streams;
+    {
+        uuid_u remote_stream_session;
+        uint32_t remote_stream_index;
+        uint32_t remote_max_streams;
+        if (deserialize_universal_and_check(conn, &remote_stream_session, peername) ||
+            deserialize_universal_and_check(conn, &remote_stream_index, peername) ||
+            deserialize_universal_and_check(conn, &remote_max_streams, peername)) {
+            return join_result_t::TEMPORARY_ERROR;
+        }
+
+        if (stream_session.is_nil()) {
+            session_id = remote_stream_session;
+            session_stream_index = remote_stream_index;
+        } else {
+            session_id = stream_session;
+            session_stream_index = stream_index;
+        }
+        if (!stream_session.is_nil() && !remote_stream_session.is_nil()) {
+            logERR("Received a stream session from %s although we opened the "
+                   "connection, closing connection.", peername);
+            return join_result_t::TEMPORARY_ERROR;
+        }
+        if (session_id.is_nil() && session_stream_index != 0) {
+            logERR("Received a stream index without a stream session from %s, "
+                   "closing connection.", peername);
+            return join_result_t::TEMPORARY_ERROR;
+        }
+        num_streams = session_id.is_nil()
+            ? 1
+            : std::max<uint32_t>(
+                1, std::min(max_streams_per_connection, remote_max_streams));
+    }
+    const bool is_additional_stream = session_stream_index != 0;
+
     server_id_t remote_server_id;
     {
         if (deserialize_universal_and_check(conn, &remote_server_id, peername)) {
@@ -1000,7 +1269,7 @@ join_result_t connectivity_cluster_t::run_t::handle(
             return join_result_t::PERMANENT_ERROR;
         }
 
-        if (servers.count(remote_server_id) != 0) {
+        if (!is_additional_stream && servers.count(remote_server_id) != 0) {
             // There currently is another connection open to the server
             logINF("Rejected a connection from server %s since one is open already.",
                    remote_server_id.print().c_str());
@@ -1008,8 +1277,11 @@ join_result_t connectivity_cluster_t::run_t::handle(
         }
     }
 
-    set_insertion_sentry_t<server_id_t> remote_server_id_sentry(
-        &servers, remote_server_id);
+    // The additional streams of a connection don't count as connections of their own.
+    set_insertion_sentry_t<server_id_t> remote_server_id_sentry;
+    if (!is_additional_stream) {
+        remote_server_id_sentry.reset(&servers, remote_server_id);
+    }
 
     // Check bitsize (e.g. 32bit or 64bit)
     {
@@ -1153,6 +1425,31 @@ join_result_t connectivity_cluster_t::run_t::handle(
     // Just saying that we're still on the rpc listener thread.
     parent->assert_thread();
 
+    if (is_additional_stream) {
+        /* Hand the stream over to the `handle()` call of the first stream of the
+        connection, which takes care of closing it from now on. */
+        auto session = stream_sessions.find(session_id);
+        cond_t released;
+        if (session == stream_sessions.end()
+                || !session->second->join(session_stream_index, other_id, conn, &released)) {
+            return join_result_t::TEMPORARY_ERROR;
+        }
+        conn_closer_1.reset();
+        released.wait_lazily_unordered();
+        return join_result_t::SUCCESS;
+    }
+
+    /* Let the additional streams of the connection find us. */
+    object_buffer_t<stream_session_t> session;
+    if (num_streams > 1) {
+        if (stream_sessions.count(session_id) != 0) {
+            logERR("Received a duplicate stream session from %s, closing connection.",
+                   peername);
+            return join_result_t::TEMPORARY_ERROR;
+        }
+        session.create(this, session_id, other_id, num_streams);
+    }
+
     /* The trickiest case is when there are two or more parallel connections
     that are trying to be established between the same two servers. We can get
     this when e.g. server A and server B try to connect to each other at the
@@ -1276,28 +1573,59 @@ join_result_t connectivity_cluster_t::run_t::handle(
         }
     }
 
+    /* If we opened the connection, we also open its additional streams. Either way,
+    we wait for them before we go on. If the cluster is shutting down, there's no point
+    in doing so. */
+    std::vector<keepalive_tcp_conn_stream_t *> conns(1, conn);
+    if (session.has() && !drainer_lock.get_drain_signal()->is_pulsed()) {
+        if (!stream_session.is_nil()) {
+            for (uint32_t i = 1; i < num_streams; ++i) {
+                coro_t::spawn_now_dangerously(std::bind(
+                    &connectivity_cluster_t::run_t::connect_stream, this,
+                    peer_addr, other_id, remote_server_id, session_id, i,
+                    drainer_lock));
+            }
+        }
+        conns = session.get()->wait_for_streams(conn, drainer_lock.get_drain_signal());
+    }
+
     /* Now that we're about to switch threads, it's not safe to try to close
     the connection from this thread anymore. This is safe because we won't do
     anything that permanently blocks before setting up `conn_closer_2`. */
     conn_closer_1.reset();
 
-    thread_allocation_t chosen_thread(&parent->thread_allocator);
+    /* Every stream gets a thread of its own. The thread of the first stream is the
+    home thread of the connection. */
+    std::vector<scoped_ptr_t<thread_allocation_t> > stream_threads;
+    std::vector<scoped_ptr_t<rethread_tcp_conn_stream_t> > unregister_conns;
+    for (keepalive_tcp_conn_stream_t *c : conns) {
+        stream_threads.push_back(
+            make_scoped<thread_allocation_t>(&parent->thread_allocator));
+        unregister_conns.push_back(
+            make_scoped<rethread_tcp_conn_stream_t>(c, INVALID_THREAD));
+    }
+    const threadnum_t chosen_thread = stream_threads[0]->get_thread();
 
     cross_thread_signal_t connection_thread_drain_signal(
         drainer_lock.get_drain_signal(),
-        chosen_thread.get_thread());
+        chosen_thread);
     cross_thread_watchable_variable_t<heartbeat_semilattice_metadata_t>
         cross_thread_heartbeat_sl_view(
             clone_ptr_t<semilattice_watchable_t<heartbeat_semilattice_metadata_t> >(
                 new semilattice_watchable_t<heartbeat_semilattice_metadata_t>(
-                    heartbeat_sl_view)), chosen_thread.get_thread());
-
-    rethread_tcp_conn_stream_t unregister_conn(conn, INVALID_THREAD);
-    on_thread_t conn_threader(chosen_thread.get_thread());
-    rethread_tcp_conn_stream_t reregister_conn(conn, get_thread_id());
+                    heartbeat_sl_view)), chosen_thread);
+
+    on_thread_t conn_threader(chosen_thread);
+    std::vector<scoped_ptr_t<rethread_tcp_conn_stream_t> > reregister_conns(
+        conns.size());
+    pmap(conns.size(), [&](int64_t i) {
+        on_thread_t thread_switcher(stream_threads[i]->get_thread());
+        reregister_conns[i].init(
+            new rethread_tcp_conn_stream_t(conns[i], get_thread_id()));
+    });
 
     // Make sure that if we're ordered to shut down, any pending read
-    // or write gets interrupted.
+    // or write gets interrupted. Closing the first stream closes the others.
     cluster_conn_closing_subscription_t conn_closer_2(conn);
     conn_closer_2.reset(&connection_thread_drain_signal);
 
@@ -1320,7 +1648,7 @@ join_result_t connectivity_cluster_t::run_t::handle(
         constructor registers it in the `connectivity_cluster_t`'s connection
         map. */
         connection_t conn_structure(
-            this, other_id, remote_server_id, conn, *other_peer_addr.get());
+            this, other_id, remote_server_id, conns, *other_peer_addr.get());
 
         /* `heartbeat_manager` will periodically send a heartbeat message to
         other servers, and it will also close the connection if we don't
@@ -1331,57 +1659,61 @@ join_result_t connectivity_cluster_t::run_t::handle(
             peerstr,
             cross_thread_heartbeat_sl_view.get_watchable());
 
-        /* Main message-handling loop: read messages off the connection until
-        it's closed, which may be due to network events, or the other end
-        shutting down, or us shutting down. */
-        try {
-            int messages_handled_since_yield = 0;
-            while (true) {
-                message_tag_t tag;
-                archive_result_t res = deserialize_universal(conn, &tag);
-                if (bad(res)) { throw fake_archive_exc_t(); }
-
-                /* Ignore messages tagged with the heartbeat tag. The
-                `keepalive_tcp_conn_stream_t` will have already notified the
-                `heartbeat_manager_t` as soon as the heartbeat arrived. */
-                if (tag != heartbeat_tag) {
-                    cluster_message_handler_t *handler = parent->message_handlers[tag];
-                    guarantee(handler != nullptr, "Got a message for an unfamiliar tag. "
-                        "Apparently we aren't compatible with the cluster on the other "
-                        "end.");
-
-                    /* If you really want to support old cluster versions, the
-                    resolved_version should be passed into the on_message() handler. */
-                    guarantee(resolved_version == cluster_version_t::CLUSTER);
-                    handler->on_message(
-                        &conn_structure,
-                        auto_drainer_t::lock_t(conn_structure.drainers.get()),
-                        conn); // might raise fake_archive_exc_t
-                }
+        /* Main message-handling loops: read messages off each stream until it's
+        closed, which may be due to network events, or the other end shutting down,
+        or us shutting down. Once one of the streams is closed, we close the others
+        too, so that every loop ends. */
+        pmap(conns.size(), [&](int64_t i) {
+            keepalive_tcp_conn_stream_t *stream_conn = conns[i];
+            on_thread_t thread_switcher(stream_conn->home_thread());
+            try {
+                int messages_handled_since_yield = 0;
+                while (true) {
+                    message_tag_t tag;
+                    archive_result_t res = deserialize_universal(stream_conn, &tag);
+                    if (bad(res)) { throw fake_archive_exc_t(); }
+
+                    /* Ignore messages tagged with the heartbeat tag. The
+                    `keepalive_tcp_conn_stream_t` will have already notified the
+                    `heartbeat_manager_t` as soon as the heartbeat arrived. */
+                    if (tag != heartbeat_tag) {
+                        cluster_message_handler_t *handler =
+                            parent->message_handlers[tag];
+                        guarantee(handler != nullptr, "Got a message for an unfamiliar "
+                            "tag. Apparently we aren't compatible with the cluster on "
+                            "the other end.");
+
+                        /* If you really want to support old cluster versions, the
+                        resolved_version should be passed into the on_message()
+                        handler. */
+                        guarantee(resolved_version == cluster_version_t::CLUSTER);
+                        handler->on_message(
+                            &conn_structure,
+                            auto_drainer_t::lock_t(conn_structure.drainers.get()),
+                            stream_conn); // might raise fake_archive_exc_t
+                    }
 
-                ++messages_handled_since_yield;
-                if (messages_handled_since_yield >= MESSAGE_HANDLER_MAX_BATCH_SIZE) {
-                    coro_t::yield();
-                    messages_handled_since_yield = 0;
+                    ++messages_handled_since_yield;
+                    if (messages_handled_since_yield >= MESSAGE_HANDLER_MAX_BATCH_SIZE) {
+                        coro_t::yield();
+                        messages_handled_since_yield = 0;
+                    }
                 }
+            } catch (const fake_archive_exc_t &) {
+                /* The exception broke us out of the loop, and that's what we
+                wanted. This could either be because we lost contact with the peer
+                or because the cluster is shutting down and `close_conn()` got
+                called. */
             }
-        } catch (const fake_archive_exc_t &) {
-            /* The exception broke us out of the loop, and that's what we
-            wanted. This could either be because we lost contact with the peer
-            or because the cluster is shutting down and `close_conn()` got
-            called. */
-        }
 
-        if (conn->is_read_open()) {
-            logWRN("Received invalid data on a cluster connection. Disconnecting.");
-            conn->shutdown_read();
-        }
-        if (conn->is_write_open()) {
+            if (stream_conn->is_read_open()) {
+                logWRN("Received invalid data on a cluster connection. Disconnecting.");
+            }
             /* Shutdown the write direction as well, to make sure that any active
             `send_message` calls get interrupted and don't stop us from destructing
             the `conn_structure`. */
-            conn->shutdown_write();
-        }
+            conn_structure.shutdown_streams();
+        });
 
         /* The `conn_structure` destructor removes us from the connection map. It also
         blocks until all references to `conn_structure` have been released (using its
@@ -1392,7 +1724,11 @@ join_result_t connectivity_cluster_t::run_t::handle(
     any pending network writes have either been transmitted or aborted.
     `shutdown_write()` which we call above initiates aborting pending writes, but it
     doesn't wait until the process is done. */
-    conn->flush_buffer();
+    pmap(conns.size(), [&](int64_t i) {
+        on_thread_t thread_switcher(stream_threads[i]->get_thread());
+        conns[i]->flush_buffer();
+        reregister_conns[i].reset();
+    });
     return join_result_t::SUCCESS;
 }
 
@@ -1469,7 +1805,8 @@ connectivity_cluster_t::connection_t *connectivity_cluster_t::get_connection(
 void connectivity_cluster_t::send_message(connection_t *connection,
                                      auto_drainer_t::lock_t connection_keepalive,
                                      message_tag_t tag,
-                                     cluster_send_message_write_callback_t *callback) {
+                                     cluster_send_message_write_callback_t *callback,
+                                     uint64_t stream_key) {
     // We could be on _any_ thread.
 
     /* If the connection is being closed, just drop the message now. It's not going
@@ -1521,6 +1858,7 @@ void connectivity_cluster_t::send_message(connection_t *connection,
     stats->second += bytes_sent;
 #endif
 
+    connection_t::stream_t *stream = nullptr;
     if (connection->is_loopback()) {
         // We could be on any thread here! Oh no!
         std::vector<char> buffer_data;
@@ -1529,14 +1867,17 @@ void connectivity_cluster_t::send_message(connection_t *connection,
         message_handlers[tag]->on_local_message(connection, connection_keepalive,
             std::move(buffer_data));
     } else {
-        on_thread_t threader(connection->conn->home_thread());
+        /* Messages with the same `stream_key` go over the same stream, so they arrive
+        in the order in which they were sent. */
+        stream = connection->streams[stream_key % connection->streams.size()].get();
+        on_thread_t threader(stream->conn->home_thread());
 
         /* Acquire the send-mutex so we don't collide with other things trying
         to send on the same connection. */
         {
             /* The `true` is for eager waiting, which is a significant performance
             optimization in this case. */
-            mutex_t::acq_t acq(&connection->send_mutex, true);
+            mutex_t::acq_t acq(&stream->send_mutex, true);
 
             /* Write the tag to the network */
             {
@@ -1548,14 +1889,14 @@ void connectivity_cluster_t::send_message(connection_t *connection,
                               "you need to ask yourself whether live cluster upgrades work."
                               );
                 serialize_universal(&wm, tag);
-                make_buffered_tcp_conn_stream_wrapper_t buffered_conn(connection->conn);
+                make_buffered_tcp_conn_stream_wrapper_t buffered_conn(stream->conn);
                 int res = send_write_message(&buffered_conn, &wm);
                 if (res == -1) {
                     /* Close the other half of the connection to make sure that
                        `connectivity_cluster_t::run_t::handle()` notices that something is
                        up */
-                    if (connection->conn->is_read_open()) {
-                        connection->conn->shutdown_read();
+                    if (stream->conn->is_read_open()) {
+                        stream->conn->shutdown_read();
                     }
                     return;
                 }
@@ -1563,11 +1904,11 @@ void connectivity_cluster_t::send_message(connection_t *connection,
 
             /* Write the message itself to the network */
             {
-                int64_t res = connection->conn->write_buffered(buffer.vector().data(),
-                                                               buffer.vector().size());
+                int64_t res = stream->conn->write_buffered(buffer.vector().data(),
+                                                           buffer.vector().size());
                 if (res == -1) {
-                    if (connection->conn->is_read_open()) {
-                        connection->conn->shutdown_read();
+                    if (stream->conn->is_read_open()) {
+                        stream->conn->shutdown_read();
                     }
                     return;
                 } else {
@@ -1576,18 +1917,21 @@ void connectivity_cluster_t::send_message(connection_t *connection,
             }
         } /* Releases the send_mutex */
 
-        connection->flusher.notify();
+        stream->flusher.notify();
         cond_t dummy_interruptor;
-        connection->flusher.flush(&dummy_interruptor);
-        if (!connection->conn->is_write_open()) {
-            if (connection->conn->is_read_open()) {
-                connection->conn->shutdown_read();
+        stream->flusher.flush(&dummy_interruptor);
+        if (!stream->conn->is_write_open()) {
+            if (stream->conn->is_read_open()) {
+                stream->conn->shutdown_read();
             }
             return;
         }
     }
 
     connection->pm_bytes_sent.record(bytes_sent);
+    if (stream != nullptr) {
+        stream->pm_bytes_sent.record(bytes_sent);
+    }
 }
 
 cluster_message_handler_t::cluster_message_handler_t(
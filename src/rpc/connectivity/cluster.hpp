@@ -81,9 +81,15 @@ connection. Once a connection is established, messages can be sent across it in
 directions. Every message is guaranteed to eventually arrive unless the connection goes
 down. Messages cannot be duplicated.
 
-Can messages be reordered? I think the current implementation doesn't ever reorder
-messages, but don't rely on this guarantee. However, some old code may rely on this
-guarantee (I'm not sure) so don't break this property without checking first. */
+A connection to another server is made up of one or more TCP streams, each homed on a
+different thread, so that the traffic to a single peer isn't limited by what one thread
+and one socket can handle. The server that opens the connection also opens the additional
+streams; the number of streams is negotiated in the handshake. If any of the streams
+fails, the whole connection goes down.
+
+Can messages be reordered? Messages that are sent with the same `stream_key` (see
+`send_message()`) from the same thread travel over the same stream, and arrive in the
+order they were sent. Messages with different stream keys can be reordered. */
 
 class connectivity_cluster_t :
     public home_thread_mixin_debug_only_t
@@ -138,7 +144,7 @@ public:
 
         /* Returns `true` if this is the loopback connection */
         bool is_loopback() const {
-            return conn == nullptr;
+            return streams.empty();
         }
 
         /* Drops the connection. */
@@ -147,35 +153,69 @@ public:
     private:
         friend class connectivity_cluster_t;
 
+        /* `stream_t` is one of the TCP streams of a connection. It lives on the home
+        thread of its `conn`. */
+        class stream_t : public home_thread_mixin_debug_only_t {
+        public:
+            stream_t(keepalive_tcp_conn_stream_t *conn,
+                     perfmon_collection_t *pm_collection,
+                     size_t index);
+
+            keepalive_tcp_conn_stream_t *const conn;
+
+            mutex_t send_mutex;
+
+            /* Calls `conn->flush_buffer()`. Can be used for making sure that a
+            buffered write makes it to the TCP stack. */
+            pump_coro_t flusher;
+
+            perfmon_sampler_t pm_bytes_sent;
+            perfmon_membership_t pm_bytes_sent_membership;
+
+            /* Reports how many reads the stream's TCP connection has made per
+            megabyte it has received, which tells how well its reads are batched. */
+            class pm_reads_per_megabyte_t : public perfmon_perthread_t<
+                    std::pair<uint64_t, uint64_t> > {
+            public:
+                explicit pm_reads_per_megabyte_t(keepalive_tcp_conn_stream_t *conn);
+            private:
+                void get_thread_stat(std::pair<uint64_t, uint64_t> *);
+                std::pair<uint64_t, uint64_t> combine_stats(
+                    const std::pair<uint64_t, uint64_t> *);
+                ql::datum_t output_stat(const std::pair<uint64_t, uint64_t> &);
+                keepalive_tcp_conn_stream_t *const conn;
+            } pm_reads_per_megabyte;
+            perfmon_membership_t pm_reads_per_megabyte_membership;
+        };
+
         /* The constructor registers us in every thread's `connections` map, thereby
-        notifying event subscribers. */
+        notifying event subscribers. The `conns` must already be on the threads they
+        should be homed on; the first one is the stream that the handshake happened
+        on. */
         connection_t(
             run_t *,
             const peer_id_t &peer_id,
             const server_id_t &server_id,
-            keepalive_tcp_conn_stream_t *,
+            const std::vector<keepalive_tcp_conn_stream_t *> &conns,
             const peer_address_t &peer_address) THROWS_NOTHING;
         ~connection_t() THROWS_NOTHING;
 
-        /* NULL for the loopback connection (i.e. our "connection" to ourself) */
-        keepalive_tcp_conn_stream_t *conn;
+        /* Shuts down every stream of the connection. This blocks, so unlike
+        `kill_connection()` it's not safe to call from the heartbeat timer. */
+        void shutdown_streams();
 
         /* `connection_t` contains the addresses so that we can call
         `get_peers_list()` on any thread. Otherwise, we would have to go
         cross-thread to access the routing table. */
         peer_address_t peer_address;
 
-        /* Unused for our connection to ourself */
-        mutex_t send_mutex;
-
-        /* Calls `conn->flush_buffer()`. Can be used for making sure that a
-        buffered write makes it to the TCP stack. */
-        pump_coro_t flusher;
-
         perfmon_collection_t pm_collection;
         perfmon_sampler_t pm_bytes_sent;
         perfmon_membership_t pm_collection_membership, pm_bytes_sent_membership;
 
+        /* Empty for the loopback connection (i.e. our "connection" to ourself) */
+        std::vector<scoped_ptr_t<stream_t> > streams;
+
         /* We only hold this information so we can deregister ourself */
         run_t *parent;
 
@@ -241,6 +281,10 @@ public:
             DISABLE_COPYING(variable_setter_t);
         };
 
+        /* A `stream_session_t` collects the additional streams of a connection while
+        the connection is being established. */
+        class stream_session_t;
+
         void on_new_connection(const scoped_ptr_t<tcp_conn_descriptor_t> &nconn,
                 const int join_delay_secs,
                 auto_drainer_t::lock_t lock) THROWS_NOTHING;
@@ -257,6 +301,15 @@ public:
                              const int join_delay_secs,
                              co_semaphore_t *rate_control) THROWS_NOTHING;
 
+        /* `connect_stream` is spawned by `handle()` for each additional stream of a
+        connection that we opened. */
+        void connect_stream(ip_and_port_t address,
+                            peer_id_t expected_id,
+                            server_id_t expected_server_id,
+                            uuid_u stream_session,
+                            uint32_t stream_index,
+                            auto_drainer_t::lock_t drainer_lock) THROWS_NOTHING;
+
         /* `join_blocking()` is spawned in a new coroutine by `join()`. It's also run by
         `handle()` when we hear about a new peer from a peer we are connected to, and
         directly by the auto_reconnector_t. For cases where it is used directly, it
@@ -280,14 +333,20 @@ public:
         connect-notification, receiving messages from the peer until it
         disconnects or we are shut down, and sending out the
         disconnect-notification. It returns a join_result_t indicating the outcome
-        of the attempted join. */
+        of the attempted join. `stream_session` is nil if the peer opened the TCP
+        connection; otherwise it identifies the connection that the stream belongs
+        to, and `stream_index` is the index of the stream in it. For any stream other
+        than the first one, `handle()` hands the stream over to the `handle()` call
+        of the first stream and waits for it to be done with it. */
         join_result_t handle(keepalive_tcp_conn_stream_t *c,
             boost::optional<peer_id_t> expected_id,
             boost::optional<peer_address_t> expected_address,
             boost::optional<server_id_t> expected_server_id,
             auto_drainer_t::lock_t,
             bool *successful_join_inout,
-            const int join_delay_secs) THROWS_NOTHING;
+            const int join_delay_secs,
+            const uuid_u &stream_session,
+            uint32_t stream_index) THROWS_NOTHING;
 
         connectivity_cluster_t *parent;
 
@@ -317,6 +376,15 @@ public:
         redundant connections to the same peer. */
         mutex_t new_connection_mutex;
 
+        /* The most streams we open or accept per connection. This is 1 if
+        `cluster_client_port` is set, because all of our connections then come from
+        the same port. */
+        uint32_t max_streams_per_connection;
+
+        /* The connections that are currently collecting their additional streams,
+        by session id. */
+        std::map<uuid_u, stream_session_t *> stream_sessions;
+
         scoped_ptr_t<tcp_bound_socket_t> cluster_listener_socket;
         int cluster_listener_port;
         int cluster_client_port;
@@ -359,11 +427,13 @@ public:
 
     /* Sends a message to the other server. The message is associated with a "tag",
     which determines which message handler on the other server will receive the message.
-    */
+    The `stream_key` picks the stream of the connection that carries the message;
+    messages sent with the same key from the same thread are delivered in order. */
     void send_message(connection_t *connection,
                       auto_drainer_t::lock_t connection_keepalive,
                       message_tag_t tag,
-                      cluster_send_message_write_callback_t *callback);
+                      cluster_send_message_write_callback_t *callback,
+                      uint64_t stream_key = 0);
 
 private:
     friend class cluster_message_handler_t;
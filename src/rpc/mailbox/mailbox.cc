@@ -125,8 +125,10 @@ void send_write(mailbox_manager_t *src, raw_mailbox_t::address_t dest,
         return;
     }
     raw_mailbox_writer_t writer(dest.thread, dest.mailbox_id, callback);
+    /* Messages to the same mailbox must not be reordered, but messages to different
+    mailboxes may travel over different streams. */
     src->get_connectivity_cluster()->send_message(connection, connection_keepalive,
-        src->get_message_tag(), &writer);
+        src->get_message_tag(), &writer, dest.mailbox_id);
 }
 
 static const int MAX_OUTSTANDING_MAILBOX_WRITES_PER_THREAD = 4;
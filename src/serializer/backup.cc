@@ -0,0 +1,305 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "serializer/backup.hpp"
+
+#include <vector>
+
+#include "arch/runtime/coroutines.hpp"
+#include "buffer_cache/types.hpp"
+#include "concurrency/cond_var.hpp"
+#include "concurrency/new_mutex.hpp"
+#include "config/args.hpp"
+#include "containers/archive/boost_types.hpp"
+#include "containers/archive/buffer_stream.hpp"
+#include "containers/archive/vector_stream.hpp"
+#include "containers/archive/versioned.hpp"
+#include "logger.hpp"
+#include "serializer/buf_ptr.hpp"
+#include "serializer/log/log_serializer.hpp"
+
+/* The chain header is stored as the magic, followed by the serialized fields.  Table
+files have zeros there instead. */
+const block_magic_t backup_chain_header_magic = { { 'b', 'k', 'u', 'p' } };
+const size_t backup_chain_header_max_size = 128;
+
+std::vector<char> serialize_backup_chain_header(const backup_chain_header_t &header) {
+    write_message_t wm;
+    wm.append(backup_chain_header_magic.bytes, sizeof(backup_chain_header_magic.bytes));
+    serialize<cluster_version_t::LATEST_DISK>(&wm, header.source_id);
+    serialize<cluster_version_t::LATEST_DISK>(&wm, header.source_creation_timestamp);
+    serialize<cluster_version_t::LATEST_DISK>(&wm, header.since);
+    serialize<cluster_version_t::LATEST_DISK>(&wm, header.next_base);
+    vector_stream_t stream;
+    int res = send_write_message(&stream, &wm);
+    guarantee(res == 0);
+    guarantee(stream.vector().size() <= backup_chain_header_max_size);
+    return stream.vector();
+}
+
+boost::optional<backup_chain_header_t> read_backup_chain_header(log_serializer_t *ser) {
+    std::vector<char> data = ser->read_extra_static_data(backup_chain_header_max_size);
+    buffer_read_stream_t stream(data.data(), data.size());
+    block_magic_t magic;
+    if (force_read(&stream, magic.bytes, sizeof(magic.bytes))
+            != static_cast<int64_t>(sizeof(magic.bytes))
+        || magic != backup_chain_header_magic) {
+        return boost::none;
+    }
+    backup_chain_header_t header;
+    archive_result_t res;
+    res = deserialize<cluster_version_t::LATEST_DISK>(&stream, &header.source_id);
+    guarantee_deserialization(res, "backup chain header");
+    res = deserialize<cluster_version_t::LATEST_DISK>(
+        &stream, &header.source_creation_timestamp);
+    guarantee_deserialization(res, "backup chain header");
+    res = deserialize<cluster_version_t::LATEST_DISK>(&stream, &header.since);
+    guarantee_deserialization(res, "backup chain header");
+    res = deserialize<cluster_version_t::LATEST_DISK>(&stream, &header.next_base);
+    guarantee_deserialization(res, "backup chain header");
+    return boost::make_optional(header);
+}
+
+/* Copies the data of the blocks in `to_copy` from `source` to `target`, then applies
+`write_ops` together with the index entries of the copied blocks to `target`.  Clears
+both vectors. */
+void copy_backup_batch(
+        serializer_t *source,
+        file_account_t *source_account,
+        serializer_t *target,
+        file_account_t *target_account,
+        std::vector<index_snapshot_entry_t> *to_copy,
+        std::vector<index_write_op_t> *write_ops) {
+    if (!to_copy->empty()) {
+        std::vector<counted_t<standard_block_token_t> > source_tokens;
+        source_tokens.reserve(to_copy->size());
+        for (auto &entry : *to_copy) {
+            // Once this batch is copied, the source serializer is free to garbage
+            // collect the old version of the block.
+            source_tokens.push_back(std::move(entry.token));
+        }
+        std::vector<buf_ptr_t> bufs = source->block_reads(source_tokens, source_account);
+        source_tokens.clear();
+
+        std::vector<buf_write_info_t> write_infos;
+        write_infos.reserve(bufs.size());
+        for (size_t i = 0; i < bufs.size(); ++i) {
+            write_infos.push_back(buf_write_info_t(bufs[i].ser_buffer(),
+                                                   bufs[i].block_size(),
+                                                   (*to_copy)[i].block_id));
+        }
+
+        struct : public cond_t, public iocallback_t {
+            void on_io_complete() { pulse(); }
+        } cb;
+        std::vector<counted_t<standard_block_token_t> > target_tokens
+            = target->block_writes(write_infos, target_account, &cb);
+        guarantee(target_tokens.size() == bufs.size());
+        cb.wait();
+
+        for (size_t i = 0; i < target_tokens.size(); ++i) {
+            write_ops->push_back(index_write_op_t((*to_copy)[i].block_id,
+                                                  target_tokens[i],
+                                                  (*to_copy)[i].recency));
+        }
+    }
+
+    if (!write_ops->empty()) {
+        // There are no other index_write operations to maintain ordering with.
+        new_mutex_in_line_t dummy_acq;
+        target->index_write(&dummy_acq, []{ }, *write_ops);
+    }
+    to_copy->clear();
+    write_ops->clear();
+}
+
+bool backup_batch_is_full(const std::vector<index_snapshot_entry_t> &to_copy,
+                          const std::vector<index_write_op_t> &write_ops) {
+    return to_copy.size() >= BACKUP_BLOCKS_PER_BATCH
+        || write_ops.size() >= BACKUP_INDEX_OPS_PER_BATCH;
+}
+
+bool backup_needs_data(const index_snapshot_entry_t &entry,
+                       const boost::optional<repli_timestamp_t> &since) {
+    if (!entry.token.has()) {
+        return false;
+    }
+    // Blocks that are written without a timestamp could have changed at any time.
+    return !static_cast<bool>(since)
+        || entry.recency == repli_timestamp_t::distant_past
+        || entry.recency == repli_timestamp_t::invalid
+        || entry.recency >= *since;
+}
+
+void backup_serializer(
+        serializer_t *source,
+        std::vector<index_snapshot_entry_t> &&snapshot,
+        const backup_chain_header_t &chain_header,
+        serializer_file_opener_t *target_opener,
+        perfmon_collection_t *target_perfmon_collection,
+        signal_t *interruptor)
+    THROWS_ONLY(interrupted_exc_t) {
+    source->assert_thread();
+    boost::optional<repli_timestamp_t> since = chain_header.since;
+    // Backfilled blocks keep the recencies they had on the server they came from, so
+    // after a backfill we can't tell from the recencies which blocks changed since
+    // `since`.  An increment that has the data of every block is still a valid
+    // increment.  The watermark is read after the snapshot was taken, so it covers
+    // every backfill that the snapshot contains.
+    boost::optional<repli_timestamp_t> watermark = source->backfill_watermark();
+    if (static_cast<bool>(since)
+        && static_cast<bool>(watermark)
+        && *watermark >= *since) {
+        logNTC("The table received a backfill since the last backup, so the "
+               "incremental backup will contain all of its data.\n");
+        since = boost::none;
+    }
+
+    log_serializer_t::create(
+        target_opener,
+        log_serializer_t::static_config_t(source->max_block_size().ser_value()),
+        serialize_backup_chain_header(chain_header));
+
+    bool interrupted = false;
+    {
+        log_serializer_t target(log_serializer_t::dynamic_config_t(),
+                                target_opener,
+                                target_perfmon_collection);
+        scoped_ptr_t<file_account_t> source_account(
+            source->make_io_account(io_class_t::backfill));
+        scoped_ptr_t<file_account_t> target_account(
+            target.make_io_account(io_class_t::backfill));
+
+        std::vector<index_snapshot_entry_t> to_copy;
+        std::vector<index_write_op_t> write_ops;
+        for (auto &entry : snapshot) {
+            if (backup_needs_data(entry, since)) {
+                to_copy.push_back(std::move(entry));
+            } else {
+                write_ops.push_back(index_write_op_t(entry.block_id,
+                                                     counted_t<standard_block_token_t>(),
+                                                     entry.recency));
+                entry.token.reset();
+            }
+            if (backup_batch_is_full(to_copy, write_ops)) {
+                if (interruptor->is_pulsed()) {
+                    interrupted = true;
+                    break;
+                }
+                copy_backup_batch(source, source_account.get(),
+                                  &target, target_account.get(),
+                                  &to_copy, &write_ops);
+            }
+        }
+        if (!interrupted) {
+            copy_backup_batch(source, source_account.get(),
+                              &target, target_account.get(),
+                              &to_copy, &write_ops);
+        }
+    }
+
+    if (interrupted) {
+        target_opener->unlink_serializer_file();
+        throw interrupted_exc_t();
+    }
+    target_opener->move_serializer_file_to_permanent_location();
+}
+
+bool apply_serializer_backup_increment(
+        log_serializer_t *base,
+        log_serializer_t *increment,
+        signal_t *interruptor)
+    THROWS_ONLY(interrupted_exc_t) {
+    base->assert_thread();
+    increment->assert_thread();
+
+    boost::optional<backup_chain_header_t> base_header
+        = read_backup_chain_header(base);
+    boost::optional<backup_chain_header_t> increment_header
+        = read_backup_chain_header(increment);
+    if (!static_cast<bool>(base_header)
+        || !static_cast<bool>(increment_header)
+        || static_cast<bool>(base_header->since)
+        || !static_cast<bool>(increment_header->since)
+        || base_header->source_id != increment_header->source_id
+        || base_header->source_creation_timestamp
+           != increment_header->source_creation_timestamp
+        || *increment_header->since != base_header->next_base) {
+        return false;
+    }
+
+    std::vector<block_id_t> base_ids;
+    {
+        std::vector<index_snapshot_entry_t> base_entries = base->index_snapshot();
+        base_ids.reserve(base_entries.size());
+        for (const auto &entry : base_entries) {
+            if (entry.token.has()) {
+                base_ids.push_back(entry.block_id);
+            }
+        }
+    }
+    std::vector<index_snapshot_entry_t> increment_entries = increment->index_snapshot();
+
+    // Check that `base` has the data for every block the increment doesn't carry,
+    // before we change anything.
+    {
+        auto base_id = base_ids.begin();
+        for (const auto &entry : increment_entries) {
+            while (base_id != base_ids.end() && *base_id < entry.block_id) {
+                ++base_id;
+            }
+            if (!entry.token.has()
+                && (base_id == base_ids.end() || *base_id != entry.block_id)) {
+                return false;
+            }
+        }
+    }
+
+    scoped_ptr_t<file_account_t> increment_account(
+        increment->make_io_account(io_class_t::backfill));
+    scoped_ptr_t<file_account_t> base_account(
+        base->make_io_account(io_class_t::backfill));
+
+    std::vector<index_snapshot_entry_t> to_copy;
+    std::vector<index_write_op_t> write_ops;
+    auto base_id = base_ids.begin();
+    auto entry = increment_entries.begin();
+    while (base_id != base_ids.end() || entry != increment_entries.end()) {
+        if (entry == increment_entries.end()
+            || (base_id != base_ids.end() && *base_id < entry->block_id)) {
+            // The block was deleted after the base was taken.
+            write_ops.push_back(index_write_op_t(*base_id,
+                                                 counted_t<standard_block_token_t>(),
+                                                 repli_timestamp_t::invalid));
+            ++base_id;
+        } else {
+            if (base_id != base_ids.end() && *base_id == entry->block_id) {
+                ++base_id;
+            }
+            if (entry->token.has()) {
+                to_copy.push_back(std::move(*entry));
+            } else {
+                // Keep the base's data, but take over the recency.
+                write_ops.push_back(index_write_op_t(entry->block_id,
+                                                     boost::none,
+                                                     entry->recency));
+            }
+            ++entry;
+        }
+        if (backup_batch_is_full(to_copy, write_ops)) {
+            if (interruptor->is_pulsed()) {
+                throw interrupted_exc_t();
+            }
+            copy_backup_batch(increment, increment_account.get(),
+                              base, base_account.get(),
+                              &to_copy, &write_ops);
+        }
+    }
+    copy_backup_batch(increment, increment_account.get(),
+                      base, base_account.get(),
+                      &to_copy, &write_ops);
+
+    // Only now that `base` holds the increment's blocks can the next increment be
+    // applied to it.
+    base_header->next_base = increment_header->next_base;
+    base->write_extra_static_data(serialize_backup_chain_header(*base_header));
+    return true;
+}
@@ -0,0 +1,85 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#ifndef SERIALIZER_BACKUP_HPP_
+#define SERIALIZER_BACKUP_HPP_
+
+#include <vector>
+
+#include "errors.hpp"
+#include <boost/optional.hpp>
+
+#include "concurrency/interruptor.hpp"
+#include "containers/uuid.hpp"
+#include "repli_timestamp.hpp"
+#include "serializer/serializer.hpp"
+
+class log_serializer_t;
+class perfmon_collection_t;
+class serializer_file_opener_t;
+class signal_t;
+
+/* Every backup file records which file it was taken of, and where it belongs in its
+chain of increments.  It's stored as extra static data of the backup file (see
+`log_serializer_t::create()`), so that a backup is still a valid table file. */
+struct backup_chain_header_t {
+    /* The file that was backed up is identified by the table's ID and the time at which
+    the file was created.  If the file is deleted and created again, the block IDs and
+    recencies of earlier backups don't mean anything anymore. */
+    uuid_u source_id;
+    creation_timestamp_t source_creation_timestamp;
+
+    /* Unset for a full backup. */
+    boost::optional<repli_timestamp_t> since;
+
+    /* The timestamp that was returned for the next increment to be based on. */
+    repli_timestamp_t next_base;
+};
+
+/* Copies the blocks in `snapshot`, which must have been returned by
+`source->index_snapshot()`, into a newly created serializer file, while `source` keeps
+serving reads and writes.  The snapshot's block tokens keep the old versions of the
+blocks on disk until they have been copied.  Since only live blocks get copied, the
+new file doesn't contain any garbage.  `chain_header` is stored in the new file.
+
+If `chain_header.since` is set, the new file is an incremental backup: it only contains
+the data of blocks whose recency is at or after `since`, plus the data of blocks
+without a meaningful recency (secondary index trees and the like are written at
+`distant_past`).  Every other block gets an index entry that carries its recency but
+no data, so the increment still records which blocks exist.  If `source` received a
+backfill since then (see `serializer_t::note_backfill()`), the increment carries the
+data of every block instead.
+
+Must be called on `source`'s home thread.  The new file only gets moved to its
+permanent location once the copy is complete; if `interruptor` is pulsed, the
+temporary file is removed again. */
+void backup_serializer(
+        serializer_t *source,
+        std::vector<index_snapshot_entry_t> &&snapshot,
+        const backup_chain_header_t &chain_header,
+        serializer_file_opener_t *target_opener,
+        perfmon_collection_t *target_perfmon_collection,
+        signal_t *interruptor)
+    THROWS_ONLY(interrupted_exc_t);
+
+/* Returns the chain header of a file written by `backup_serializer()`, or nothing if
+the file isn't a backup. */
+boost::optional<backup_chain_header_t> read_backup_chain_header(log_serializer_t *ser);
+
+/* Applies an incremental backup made by `backup_serializer()` to `base`, which must
+hold the full backup that the increment was based on, possibly with earlier increments
+already applied.  Afterwards `base` holds the same blocks as the table did when the
+increment was taken, and its chain header says so.  Blocks that the increment has no
+data for are kept as they are in `base`, blocks that don't exist in the increment are
+deleted.
+
+Returns false without changing `base` if the increment doesn't continue `base`'s
+chain: if it was taken of a different file, if its `since` isn't the timestamp that
+`base` was taken (or last incremented) for, or if it refers to a block that `base`
+doesn't have.  If `interruptor` is pulsed, `base` is left partially updated, but its
+chain header is unchanged, so the increment can be applied again. */
+bool apply_serializer_backup_increment(
+        log_serializer_t *base,
+        log_serializer_t *increment,
+        signal_t *interruptor)
+    THROWS_ONLY(interrupted_exc_t);
+
+#endif  // SERIALIZER_BACKUP_HPP_
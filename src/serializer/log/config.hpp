@@ -2,6 +2,8 @@
 #ifndef SERIALIZER_LOG_CONFIG_HPP_
 #define SERIALIZER_LOG_CONFIG_HPP_
 
+#include <stdint.h>
+
 #include <string>
 
 #include "config/args.hpp"
@@ -17,9 +19,7 @@ struct log_serializer_dynamic_config_t {
         io_batch_factor = DEFAULT_IO_BATCH_FACTOR;
     }
 
-    /* The (minimal) batch size of i/o requests being taken from a single i/o account.
-    It is a factor because the actual batch size is this factor multiplied by the
-    i/o priority of the account. */
+    /* The (minimal) batch size of i/o requests being taken from a single i/o class. */
     int32_t io_batch_factor;
 
     /* Enable reading more data than requested to let the cache warmup more quickly esp. on rotational drives */
@@ -47,8 +47,24 @@ struct log_serializer_static_config_t : public log_serializer_on_disk_static_con
         extent_size_ = DEFAULT_EXTENT_SIZE;
         block_size_ = DEFAULT_BTREE_BLOCK_SIZE;
     }
+
+    explicit log_serializer_static_config_t(uint64_t block_size) {
+        extent_size_ = DEFAULT_EXTENT_SIZE;
+        block_size_ = block_size;
+    }
 };
 
+/* Whether a table's files can use blocks of `block_size` bytes.  Every such size
+divides `DEFAULT_EXTENT_SIZE`. */
+inline bool is_valid_btree_block_size(uint64_t block_size) {
+    return block_size >= MIN_BTREE_BLOCK_SIZE
+        && block_size <= MAX_BTREE_BLOCK_SIZE
+        && (block_size & (block_size - 1)) == 0;
+}
+
+static_assert(MAX_BTREE_BLOCK_SIZE <= UINT16_MAX,
+              "The LBA can't store the size of the largest btree blocks.");
+
 RDB_MAKE_SERIALIZABLE_2(log_serializer_static_config_t,
                         block_size_, extent_size_);
 
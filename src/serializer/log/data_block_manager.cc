@@ -4,6 +4,7 @@
 #include <inttypes.h>
 #include <sys/uio.h>
 
+#include <algorithm>
 #include <functional>
 
 #include "arch/arch.hpp"
@@ -27,16 +28,16 @@ const int64_t APPROXIMATE_READ_AHEAD_SIZE = 32 * DEFAULT_BTREE_BLOCK_SIZE;
 const size_t MAX_CONCURRENT_GCS = 64;
 
 // Garbage Collection uses its own two IO accounts.
-// There is one low-priority account that is meant to guarantee
-// (performance-wise) unintrusive garbage collection.
+// There is one account in the GC class, with its long latency target and its
+// bandwidth cap, that is meant to guarantee (performance-wise) unintrusive
+// garbage collection.
 // If the garbage ratio keeps growing,
-// GC starts using the high priority account instead, which
-// might have a negative influence on database performance
+// GC starts using the high priority account instead, which competes with
+// flushes.  That might have a negative influence on database performance
 // under i/o heavy workloads but guarantees that the database
 // doesn't grow indefinitely.
-const int GC_IO_PRIORITY_NICE = 8;
-// 4 times the priority of all caches combined
-const int GC_IO_PRIORITY_HIGH = 4 * MERGER_BLOCK_WRITE_IO_PRIORITY;
+const io_class_t GC_IO_CLASS_NICE = io_class_t::gc;
+const io_class_t GC_IO_CLASS_HIGH = io_class_t::flush;
 
 // The ratio at which we start GCing.
 constexpr double GC_START_RATIO = 0.1;
@@ -441,8 +442,8 @@ void data_block_manager_t::start_existing(file_t *file,
                                           data_block_manager::metablock_mixin_t *last_metablock) {
     guarantee(state == state_unstarted);
     dbfile = file;
-    gc_io_account_nice.init(new file_account_t(file, GC_IO_PRIORITY_NICE));
-    gc_io_account_high.init(new file_account_t(file, GC_IO_PRIORITY_HIGH));
+    gc_io_account_nice.init(new file_account_t(file, GC_IO_CLASS_NICE));
+    gc_io_account_high.init(new file_account_t(file, GC_IO_CLASS_HIGH));
 
     /* Reconstruct the active data block extents from the metablock. */
     const int64_t offset = last_metablock->active_extent;
@@ -725,6 +726,75 @@ buf_ptr_t data_block_manager_t::read(int64_t off_in, block_size_t block_size,
     }
 }
 
+std::vector<buf_ptr_t>
+data_block_manager_t::many_reads(
+        const std::vector<std::pair<int64_t, block_size_t> > &blocks,
+        file_account_t *io_account) {
+    guarantee(state == state_ready);
+
+    // We visit the blocks in the order of their offsets, so that blocks that are
+    // close to each other on disk are next to each other in `order`.
+    std::vector<size_t> order(blocks.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&blocks](size_t x, size_t y) {
+        return blocks[x].first < blocks[y].first;
+    });
+
+    std::vector<buf_ptr_t> ret(blocks.size());
+    size_t run_begin = 0;
+    while (run_begin < order.size()) {
+        const int64_t front_offset = blocks[order[run_begin]].first;
+        const uint64_t extent_id = static_config->extent_index(front_offset);
+        // Like read-ahead, we don't read bytes that aren't ours in an extent that was
+        // written, because that could conflict with active writes on the io queue.
+        const int64_t max_gap
+            = entries.get(extent_id)->was_written ? 0 : MAX_COALESCED_READ_GAP;
+
+        // Find the run of blocks that we can read with a single disk read.
+        int64_t back_offset = front_offset
+            + gc_entry_t::aligned_value(blocks[order[run_begin]].second);
+        size_t run_end = run_begin + 1;
+        if (divides(DEVICE_BLOCK_SIZE, front_offset)) {
+            while (run_end < order.size()) {
+                const std::pair<int64_t, block_size_t> &block = blocks[order[run_end]];
+                if (block.first < back_offset
+                    || block.first - back_offset > max_gap
+                    || !divides(DEVICE_BLOCK_SIZE, block.first)
+                    || static_config->extent_index(block.first) != extent_id) {
+                    break;
+                }
+                back_offset = block.first + gc_entry_t::aligned_value(block.second);
+                ++run_end;
+            }
+        }
+
+        if (run_end - run_begin == 1) {
+            ret[order[run_begin]] = read(front_offset, blocks[order[run_begin]].second,
+                                         io_account);
+        } else {
+            scoped_device_block_aligned_ptr_t<char> buf(back_offset - front_offset);
+            co_read(dbfile, front_offset, back_offset - front_offset,
+                    buf.get(), io_account);
+            stats->bytes_read(back_offset - front_offset);
+
+            for (size_t j = run_begin; j < run_end; ++j) {
+                const std::pair<int64_t, block_size_t> &block = blocks[order[j]];
+                buf_ptr_t block_buf = buf_ptr_t::alloc_uninitialized(block.second);
+                memcpy(block_buf.ser_buffer(), buf.get() + (block.first - front_offset),
+                       block.second.ser_value());
+                block_buf.fill_padding_zero();
+                ret[order[j]] = std::move(block_buf);
+            }
+        }
+
+        run_begin = run_end;
+    }
+
+    return ret;
+}
+
 std::vector<counted_t<ls_block_token_pointee_t> >
 data_block_manager_t::many_writes(const std::vector<buf_write_info_t> &writes,
                                   file_account_t *io_account,
@@ -2,6 +2,7 @@
 #ifndef SERIALIZER_LOG_DATA_BLOCK_MANAGER_HPP_
 #define SERIALIZER_LOG_DATA_BLOCK_MANAGER_HPP_
 
+#include <utility>
 #include <vector>
 
 #include "arch/types.hpp"
@@ -50,6 +51,13 @@ public:
     buf_ptr_t read(int64_t off_in, block_size_t block_size,
                  file_account_t *io_account);
 
+    // Reads the blocks at the given offsets, returning them in the same order.
+    // Blocks in the same extent that are close to each other get read with a single
+    // disk read.
+    std::vector<buf_ptr_t>
+    many_reads(const std::vector<std::pair<int64_t, block_size_t> > &blocks,
+               file_account_t *io_account);
+
     /* exposed gc api */
     /* mark a buffer as garbage */
     void mark_garbage(int64_t offset, extent_transaction_t *txn);  // Takes a real int64_t.
@@ -1,6 +1,8 @@
 // Copyright 2010-2014 RethinkDB, all rights reserved.
 #include "serializer/log/lba/disk_extent.hpp"
 
+#include <limits>
+
 #include "arch/arch.hpp"
 #include "math.hpp"
 
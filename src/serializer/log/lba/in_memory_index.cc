@@ -3,10 +3,323 @@
 
 #include <inttypes.h>
 
+#include <algorithm>
+#include <limits>
+
 #include "serializer/log/lba/disk_format.hpp"
 
+/* Each entry's offset and serializer block size are packed into one word: the low
+48 bits hold the offset plus one (so that zero means "unused"), the high 16 bits
+hold the block size. 48 bits are enough to address a 256 TB file. A word of zero
+together with an invalid recency is an empty entry. */
+static const int OFFSET_BITS = 48;
+static const uint64_t OFFSET_MASK = (uint64_t(1) << OFFSET_BITS) - 1;
+
+static const size_t IN_MEMORY_INDEX_CHUNK_SIZE = 1 << 12;
+
+/* A chunk switches from the sparse to the dense form once it has more than
+`MAX_SPARSE_ENTRIES` live entries, and back once it drops below half of that. The
+gap keeps a chunk that hovers around the threshold from converting on every
+update. */
+static const size_t MAX_SPARSE_ENTRIES = IN_MEMORY_INDEX_CHUNK_SIZE / 16;
+
+/* When the recency encoding of a dense chunk is rebuilt, we leave at least this
+much room on either side of the range of recencies currently in the chunk. */
+static const uint64_t MIN_RECENCY_HEADROOM = 1 << 12;
+
+static uint64_t pack_word(flagged_off64_t offset, uint16_t ser_block_size) {
+    uint64_t packed_offset;
+    if (offset.has_value()) {
+        guarantee(static_cast<uint64_t>(offset.get_value()) < OFFSET_MASK,
+                  "Offset %" PRIi64 " is too large for the in-memory LBA index.",
+                  offset.get_value());
+        packed_offset = static_cast<uint64_t>(offset.get_value()) + 1;
+    } else {
+        guarantee(offset == flagged_off64_t::unused());
+        packed_offset = 0;
+    }
+    return packed_offset | (static_cast<uint64_t>(ser_block_size) << OFFSET_BITS);
+}
+
+static flagged_off64_t unpack_offset(uint64_t word) {
+    const uint64_t packed_offset = word & OFFSET_MASK;
+    return packed_offset == 0
+        ? flagged_off64_t::unused()
+        : flagged_off64_t::make(packed_offset - 1);
+}
+
+static uint16_t unpack_ser_block_size(uint64_t word) {
+    return static_cast<uint16_t>(word >> OFFSET_BITS);
+}
+
+static int bits_needed(uint64_t x) {
+    return x == 0 ? 0 : 64 - __builtin_clzll(x);
+}
+
+static uint64_t saturating_add(uint64_t x, uint64_t y) {
+    return x + y < x ? std::numeric_limits<uint64_t>::max() : x + y;
+}
+
+/* A chunk is either sparse -- a sorted array of its live entries -- or dense -- an
+array of `IN_MEMORY_INDEX_CHUNK_SIZE` words plus a bit-packed array of recency
+codes. A code of zero stands for
+`repli_timestamp_t::invalid`, any other code `c` for `recency_base_ + c - 1`.
+When a recency doesn't fit into the current encoding, the codes are rebuilt
+with room for the chunk's range of recencies to grow by at least its current
+span in both directions. The span at least doubles with every rebuild, so the
+number of bits per code grows logarithmically and rebuilds get rarer as the
+range widens. */
+class in_memory_index_chunk_t {
+public:
+    in_memory_index_chunk_t()
+        : dense_(false), count_(0), recency_base_(0), recency_width_(0) { }
+
+    bool empty() const { return count_ == 0; }
+
+    size_t memory_usage() const {
+        return sizeof(*this)
+            + sparse_.capacity() * sizeof(sparse_entry_t)
+            + words_.capacity() * sizeof(uint64_t)
+            + recency_bits_.capacity() * sizeof(uint64_t);
+    }
+
+    void get(size_t index, uint64_t *word_out, repli_timestamp_t *recency_out) const {
+        rassert(index < IN_MEMORY_INDEX_CHUNK_SIZE);
+        if (dense_) {
+            *word_out = words_[index];
+            *recency_out = decode_recency(get_code(index));
+        } else {
+            auto it = find_sparse(index);
+            if (it != sparse_.end() && it->index == index) {
+                *word_out = it->word;
+                *recency_out = it->recency;
+            } else {
+                *word_out = 0;
+                *recency_out = repli_timestamp_t::invalid;
+            }
+        }
+    }
+
+    void set(size_t index, uint64_t word, repli_timestamp_t recency) {
+        rassert(index < IN_MEMORY_INDEX_CHUNK_SIZE);
+        const bool live = word != 0 || recency != repli_timestamp_t::invalid;
+        if (dense_) {
+            const bool was_live = words_[index] != 0 || get_code(index) != 0;
+            ensure_recency_fits(recency);
+            set_code(index, encode_recency(recency));
+            words_[index] = word;
+            if (live && !was_live) {
+                ++count_;
+            } else if (!live && was_live) {
+                --count_;
+                if (count_ < MAX_SPARSE_ENTRIES / 2) {
+                    make_sparse();
+                }
+            }
+        } else {
+            auto it = find_sparse(index);
+            const bool found = it != sparse_.end() && it->index == index;
+            if (live && found) {
+                it->word = word;
+                it->recency = recency;
+            } else if (live) {
+                sparse_entry_t entry;
+                entry.index = index;
+                entry.word = word;
+                entry.recency = recency;
+                sparse_.insert(it, entry);
+            } else if (found) {
+                sparse_.erase(it);
+            }
+            count_ = sparse_.size();
+            if (count_ > MAX_SPARSE_ENTRIES) {
+                make_dense();
+            } else if (count_ == 0) {
+                std::vector<sparse_entry_t>().swap(sparse_);
+            }
+        }
+    }
+
+private:
+    struct sparse_entry_t {
+        uint64_t word;
+        repli_timestamp_t recency;
+        uint32_t index;
+    };
+
+    std::vector<sparse_entry_t>::iterator find_sparse(size_t index) {
+        return std::lower_bound(sparse_.begin(), sparse_.end(), index,
+            [](const sparse_entry_t &e, size_t i) { return e.index < i; });
+    }
+    std::vector<sparse_entry_t>::const_iterator find_sparse(size_t index) const {
+        return std::lower_bound(sparse_.begin(), sparse_.end(), index,
+            [](const sparse_entry_t &e, size_t i) { return e.index < i; });
+    }
+
+    uint64_t get_code(size_t index) const {
+        if (recency_width_ == 0) {
+            return 0;
+        }
+        const size_t pos = index * recency_width_;
+        const size_t word_ix = pos / 64;
+        const size_t shift = pos % 64;
+        uint64_t value = recency_bits_[word_ix] >> shift;
+        if (shift + recency_width_ > 64) {
+            value |= recency_bits_[word_ix + 1] << (64 - shift);
+        }
+        return value & code_mask();
+    }
+
+    void set_code(size_t index, uint64_t code) {
+        rassert(code <= code_mask());
+        if (recency_width_ == 0) {
+            return;
+        }
+        const size_t pos = index * recency_width_;
+        const size_t word_ix = pos / 64;
+        const size_t shift = pos % 64;
+        recency_bits_[word_ix] =
+            (recency_bits_[word_ix] & ~(code_mask() << shift)) | (code << shift);
+        if (shift + recency_width_ > 64) {
+            recency_bits_[word_ix + 1] =
+                (recency_bits_[word_ix + 1] & ~(code_mask() >> (64 - shift)))
+                | (code >> (64 - shift));
+        }
+    }
+
+    uint64_t code_mask() const {
+        return recency_width_ == 64
+            ? std::numeric_limits<uint64_t>::max()
+            : (uint64_t(1) << recency_width_) - 1;
+    }
+
+    repli_timestamp_t decode_recency(uint64_t code) const {
+        if (code == 0) {
+            return repli_timestamp_t::invalid;
+        }
+        repli_timestamp_t ret;
+        ret.longtime = recency_base_ + (code - 1);
+        return ret;
+    }
+
+    uint64_t encode_recency(repli_timestamp_t recency) const {
+        if (recency == repli_timestamp_t::invalid) {
+            return 0;
+        }
+        return recency.longtime - recency_base_ + 1;
+    }
+
+    bool recency_fits(repli_timestamp_t recency) const {
+        return recency == repli_timestamp_t::invalid
+            || (recency_width_ != 0
+                && recency.longtime >= recency_base_
+                && recency.longtime - recency_base_ < code_mask());
+    }
+
+    void ensure_recency_fits(repli_timestamp_t recency) {
+        if (recency_fits(recency)) {
+            return;
+        }
+
+        // Collect the current recencies, then rebuild the codes around the range
+        // spanned by them and the new recency.
+        std::vector<repli_timestamp_t> recencies(IN_MEMORY_INDEX_CHUNK_SIZE);
+        uint64_t lo = recency.longtime;
+        uint64_t hi = recency.longtime;
+        for (size_t i = 0; i < IN_MEMORY_INDEX_CHUNK_SIZE; ++i) {
+            recencies[i] = decode_recency(get_code(i));
+            if (recencies[i] != repli_timestamp_t::invalid) {
+                lo = std::min(lo, recencies[i].longtime);
+                hi = std::max(hi, recencies[i].longtime);
+            }
+        }
+        rebuild_recency_encoding(lo, hi);
+        for (size_t i = 0; i < IN_MEMORY_INDEX_CHUNK_SIZE; ++i) {
+            set_code(i, encode_recency(recencies[i]));
+        }
+    }
+
+    // Picks a new base and width that cover [lo, hi] with headroom and clears
+    // all codes.
+    void rebuild_recency_encoding(uint64_t lo, uint64_t hi) {
+        const uint64_t headroom = std::max(saturating_add(hi - lo, 1),
+                                           MIN_RECENCY_HEADROOM);
+        recency_base_ = lo - std::min(lo, headroom);
+        // `repli_timestamp_t::invalid` is the largest value, and it has its own
+        // code, so the largest code we need is at most `invalid - base`.
+        const uint64_t top = std::min(saturating_add(hi, headroom),
+                                      repli_timestamp_t::invalid.longtime - 1);
+        recency_width_ = bits_needed(top - recency_base_ + 1);
+        const size_t bit_words =
+            (IN_MEMORY_INDEX_CHUNK_SIZE * recency_width_ + 63) / 64 + 1;
+        std::vector<uint64_t>(bit_words, 0).swap(recency_bits_);
+    }
+
+    void make_dense() {
+        rassert(!dense_);
+        std::vector<uint64_t>(IN_MEMORY_INDEX_CHUNK_SIZE, 0).swap(words_);
+        bool any_recency = false;
+        uint64_t lo = 0;
+        uint64_t hi = 0;
+        for (const sparse_entry_t &e : sparse_) {
+            if (e.recency != repli_timestamp_t::invalid) {
+                lo = any_recency ? std::min(lo, e.recency.longtime) : e.recency.longtime;
+                hi = any_recency ? std::max(hi, e.recency.longtime) : e.recency.longtime;
+                any_recency = true;
+            }
+        }
+        if (any_recency) {
+            rebuild_recency_encoding(lo, hi);
+        }
+        for (const sparse_entry_t &e : sparse_) {
+            words_[e.index] = e.word;
+            set_code(e.index, encode_recency(e.recency));
+        }
+        std::vector<sparse_entry_t>().swap(sparse_);
+        dense_ = true;
+    }
+
+    void make_sparse() {
+        rassert(dense_);
+        std::vector<sparse_entry_t> sparse;
+        sparse.reserve(count_);
+        for (size_t i = 0; i < IN_MEMORY_INDEX_CHUNK_SIZE; ++i) {
+            sparse_entry_t e;
+            e.index = i;
+            e.word = words_[i];
+            e.recency = decode_recency(get_code(i));
+            if (e.word != 0 || e.recency != repli_timestamp_t::invalid) {
+                sparse.push_back(e);
+            }
+        }
+        rassert(sparse.size() == count_);
+        sparse_.swap(sparse);
+        std::vector<uint64_t>().swap(words_);
+        std::vector<uint64_t>().swap(recency_bits_);
+        recency_base_ = 0;
+        recency_width_ = 0;
+        dense_ = false;
+    }
+
+    bool dense_;
+    size_t count_;
+
+    // Used in the sparse form.
+    std::vector<sparse_entry_t> sparse_;
+
+    // Used in the dense form.
+    std::vector<uint64_t> words_;
+    uint64_t recency_base_;
+    size_t recency_width_;
+    std::vector<uint64_t> recency_bits_;
+
+    DISABLE_COPYING(in_memory_index_chunk_t);
+};
+
 in_memory_index_t::in_memory_index_t()
-    : end_block_id_(0), end_aux_block_id_(FIRST_AUX_BLOCK_ID) { }
+    : end_block_id_(0), end_aux_block_id_(FIRST_AUX_BLOCK_ID), memory_usage_(0) { }
+
+in_memory_index_t::~in_memory_index_t() { }
 
 block_id_t in_memory_index_t::end_block_id() {
     return end_block_id_;
@@ -17,34 +330,68 @@ block_id_t in_memory_index_t::end_aux_block_id() {
 }
 
 index_block_info_t in_memory_index_t::get_block_info(block_id_t id) {
-    if (is_aux_block_id(id)) {
-        index_aux_block_info_t aux_info = aux_infos_.get(make_aux_block_id_relative(id));
-        return index_block_info_t(aux_info.offset,
-                                  repli_timestamp_t::invalid,
-                                  aux_info.ser_block_size);
-    } else {
-        return infos_.get(id);
+    const bool aux = is_aux_block_id(id);
+    const block_id_t relative_id = aux ? make_aux_block_id_relative(id) : id;
+    const std::vector<scoped_ptr_t<in_memory_index_chunk_t> > &chunks
+        = aux ? aux_chunks_ : chunks_;
+    const size_t chunk_id = relative_id / IN_MEMORY_INDEX_CHUNK_SIZE;
+    if (chunk_id >= chunks.size() || !chunks[chunk_id].has()) {
+        return index_block_info_t();
     }
+    uint64_t word;
+    repli_timestamp_t recency;
+    chunks[chunk_id]->get(relative_id % IN_MEMORY_INDEX_CHUNK_SIZE, &word, &recency);
+    return index_block_info_t(unpack_offset(word), recency, unpack_ser_block_size(word));
 }
 
 void in_memory_index_t::set_block_info(block_id_t id, repli_timestamp_t recency,
                                        flagged_off64_t offset, uint16_t ser_block_size) {
+    const uint64_t word = pack_word(offset, ser_block_size);
     if (is_aux_block_id(id)) {
         if (id >= end_aux_block_id_) {
             end_aux_block_id_ = id + 1;
         }
-        // If you're trying to set the timestamp of  an aux block to anything
-        // other than `invalid`, you might be doing something wrong. It will be
-        // discarded anyway.
-        rassert(recency == repli_timestamp_t::invalid);
-        index_aux_block_info_t info(offset, ser_block_size);
-        aux_infos_.set(make_aux_block_id_relative(id), info);
+        set_in_chunks(&aux_chunks_, make_aux_block_id_relative(id), word, recency);
     } else {
         if (id >= end_block_id_) {
             end_block_id_ = id + 1;
         }
-        index_block_info_t info(offset, recency, ser_block_size);
-        infos_.set(id, info);
+        set_in_chunks(&chunks_, id, word, recency);
     }
 }
 
+void in_memory_index_t::set_in_chunks(
+        std::vector<scoped_ptr_t<in_memory_index_chunk_t> > *chunks,
+        block_id_t relative_id, uint64_t word, repli_timestamp_t recency) {
+    const size_t chunk_id = relative_id / IN_MEMORY_INDEX_CHUNK_SIZE;
+    if (chunk_id >= chunks->size() || !(*chunks)[chunk_id].has()) {
+        if (word == 0 && recency == repli_timestamp_t::invalid) {
+            return;
+        }
+        if (chunk_id >= chunks->size()) {
+            memory_usage_ -= chunks->capacity() * sizeof(chunks->front());
+            chunks->resize(chunk_id + 1);
+            memory_usage_ += chunks->capacity() * sizeof(chunks->front());
+        }
+        (*chunks)[chunk_id].init(new in_memory_index_chunk_t());
+        memory_usage_ += (*chunks)[chunk_id]->memory_usage();
+    }
+
+    in_memory_index_chunk_t *chunk = (*chunks)[chunk_id].get();
+    memory_usage_ -= chunk->memory_usage();
+    chunk->set(relative_id % IN_MEMORY_INDEX_CHUNK_SIZE, word, recency);
+    memory_usage_ += chunk->memory_usage();
+
+    if (chunk->empty()) {
+        memory_usage_ -= chunk->memory_usage();
+        (*chunks)[chunk_id].reset();
+        memory_usage_ -= chunks->capacity() * sizeof(chunks->front());
+        while (!chunks->empty() && !chunks->back().has()) {
+            chunks->pop_back();
+        }
+        if (chunks->empty()) {
+            std::vector<scoped_ptr_t<in_memory_index_chunk_t> >().swap(*chunks);
+        }
+        memory_usage_ += chunks->capacity() * sizeof(chunks->front());
+    }
+}
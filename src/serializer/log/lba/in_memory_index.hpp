@@ -2,8 +2,10 @@
 #ifndef SERIALIZER_LOG_LBA_IN_MEMORY_INDEX_HPP_
 #define SERIALIZER_LOG_LBA_IN_MEMORY_INDEX_HPP_
 
+#include <vector>
+
 #include "arch/compiler.hpp"
-#include "containers/two_level_array.hpp"
+#include "containers/scoped.hpp"
 #include "config/args.hpp"
 #include "serializer/serializer.hpp"
 #include "serializer/log/lba/disk_format.hpp"
@@ -21,7 +23,6 @@ ATTR_PACKED(struct index_block_info_t {
           recency(_recency),
           ser_block_size(_ser_block_size) { }
 
-    // For two_level_array_t.
     bool operator==(const index_block_info_t &other) const {
         return offset == other.offset &&
             recency == other.recency &&
@@ -33,39 +34,31 @@ ATTR_PACKED(struct index_block_info_t {
     uint16_t ser_block_size;
 });
 
-/* This is a reduced-size block info for auxiliary blocks (currently
-blob blocks used for large values). It doesn't store a replication
-timestamp, because we don't need it for those blocks. */
-ATTR_PACKED(struct index_aux_block_info_t {
-    index_aux_block_info_t()
-        : offset(flagged_off64_t::unused()),
-          ser_block_size(0) { }
-
-    index_aux_block_info_t(flagged_off64_t _offset,
-                           uint16_t _ser_block_size)
-        : offset(_offset),
-          ser_block_size(_ser_block_size) { }
-
-    // For two_level_array_t.
-    bool operator==(const index_aux_block_info_t &other) const {
-        return offset == other.offset &&
-            ser_block_size == other.ser_block_size;
-    }
-
-    flagged_off64_t offset;
-    uint16_t ser_block_size;
-});
-
-
+class in_memory_index_chunk_t;
 
+/* The in-memory index keeps one entry per block id. Entries are grouped into
+chunks of `IN_MEMORY_INDEX_CHUNK_SIZE` consecutive ids. Offsets and block sizes
+are packed into a single 64 bit word per entry, and each chunk bit-packs its
+recency timestamps relative to a per-chunk base, so a dense chunk costs about 10
+bytes per block instead of the 18 bytes of `index_block_info_t`. Chunks with
+few live entries are kept in a small sorted array instead, and chunks without
+any live entries are freed. See in_memory_index.cc for the details. */
 class in_memory_index_t {
-    two_level_array_t<index_block_info_t> infos_;
+    std::vector<scoped_ptr_t<in_memory_index_chunk_t> > chunks_;
     block_id_t end_block_id_;
-    two_level_array_t<index_aux_block_info_t> aux_infos_;
+    std::vector<scoped_ptr_t<in_memory_index_chunk_t> > aux_chunks_;
     block_id_t end_aux_block_id_;
 
+    // The number of heap bytes used by the chunks and the chunk tables.
+    size_t memory_usage_;
+
+    void set_in_chunks(std::vector<scoped_ptr_t<in_memory_index_chunk_t> > *chunks,
+                       block_id_t relative_id, uint64_t word,
+                       repli_timestamp_t recency);
+
 public:
     in_memory_index_t();
+    ~in_memory_index_t();
 
     // end_block_id is one greater than the maximum used block id.
     block_id_t end_block_id();
@@ -75,6 +68,11 @@ public:
     void set_block_info(block_id_t id, repli_timestamp_t recency,
                         flagged_off64_t offset, uint16_t ser_block_size);
 
+    // Returns the number of bytes the index currently occupies in memory.
+    size_t memory_usage() const { return memory_usage_; }
+
+private:
+    DISABLE_COPYING(in_memory_index_t);
 };
 
 #endif  // SERIALIZER_LOG_LBA_IN_MEMORY_INDEX_HPP_
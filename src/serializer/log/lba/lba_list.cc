@@ -13,7 +13,8 @@
 lba_list_t::lba_list_t(extent_manager_t *em,
         const lba_list_t::write_metablock_fun_t &_write_metablock_fun)
     : gc_drainer(new auto_drainer_t), write_metablock_fun(_write_metablock_fun),
-      extent_manager(em), state(state_unstarted), inline_lba_entries_count(0)
+      extent_manager(em), state(state_unstarted), reported_index_memory_usage(0),
+      inline_lba_entries_count(0)
 {
     for (int i = 0; i < LBA_SHARD_FACTOR; i++) {
         gc_active[i] = false;
@@ -111,6 +112,7 @@ public:
                         e->offset,
                         static_cast<uint16_t>(e->ser_block_size));
             }
+            owner->update_index_memory_usage_stat();
 
             owner->state = lba_list_t::state_ready;
             if (callback) callback->on_lba_ready();
@@ -124,7 +126,7 @@ bool lba_list_t::start_existing(file_t *file, metablock_mixin_t *last_metablock,
     rassert(state == state_unstarted);
 
     dbfile = file;
-    gc_io_account.init(new file_account_t(dbfile, LBA_GC_IO_PRIORITY));
+    gc_io_account.init(new file_account_t(dbfile, io_class_t::gc));
 
     lba_start_fsm_t *starter = new lba_start_fsm_t(this, last_metablock);
     if (state == state_ready) {
@@ -190,6 +192,15 @@ segmented_vector_t<repli_timestamp_t> lba_list_t::get_block_recencies(block_id_t
     return ret;
 }
 
+void lba_list_t::update_index_memory_usage_stat() {
+    const int64_t usage = in_memory_index.memory_usage();
+    if (usage != reported_index_memory_usage) {
+        extent_manager->stats->pm_serializer_lba_index_bytes
+            += usage - reported_index_memory_usage;
+        reported_index_memory_usage = usage;
+    }
+}
+
 void lba_list_t::set_block_info(block_id_t block, repli_timestamp_t recency,
                                 flagged_off64_t offset, uint32_t ser_block_size,
                                 file_account_t *io_account, extent_transaction_t *txn) {
@@ -199,6 +210,7 @@ void lba_list_t::set_block_info(block_id_t block, repli_timestamp_t recency,
     uint16_t ser_block_size_16 = static_cast<uint16_t>(ser_block_size);
 
     in_memory_index.set_block_info(block, recency, offset, ser_block_size_16);
+    update_index_memory_usage_stat();
 
     // If the inline LBA is full, free it up first by moving its entries to
     // the LBA extents
@@ -487,6 +499,9 @@ void lba_list_t::shutdown() {
 
     gc_io_account.reset();
 
+    extent_manager->stats->pm_serializer_lba_index_bytes -= reported_index_memory_usage;
+    reported_index_memory_usage = 0;
+
     state = state_shut_down;
 }
 
@@ -108,6 +108,11 @@ private:
 
     in_memory_index_t in_memory_index;
 
+    // The part of `pm_serializer_lba_index_bytes` that is due to this
+    // `in_memory_index`.
+    int64_t reported_index_memory_usage;
+    void update_index_memory_usage_stat();
+
     // This is a set of inlined LBA entries which are written directly into the
     // metablock. When the array gets full, all inlined LBA entries are moved
     // to the active LBA extent of their respective LBA shards, as computed from
@@ -6,6 +6,7 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <functional>
 
 #include "arch/io/disk.hpp"
@@ -130,6 +131,7 @@ log_serializer_stats_t::log_serializer_stats_t(perfmon_collection_t *parent)
       pm_serializer_old_garbage_block_bytes(),
       pm_serializer_old_total_block_bytes(),
       pm_serializer_lba_gcs(),
+      pm_serializer_lba_index_bytes(),
       parent_collection_membership(parent, &serializer_collection, "serializer"),
       stats_membership(&serializer_collection,
           &pm_serializer_block_reads, "serializer_block_reads",
@@ -149,7 +151,8 @@ log_serializer_stats_t::log_serializer_stats_t(perfmon_collection_t *parent)
           &pm_serializer_data_extents_gced, "serializer_data_extents_gced",
           &pm_serializer_old_garbage_block_bytes, "serializer_old_garbage_block_bytes",
           &pm_serializer_old_total_block_bytes, "serializer_old_total_block_bytes",
-          &pm_serializer_lba_gcs, "serializer_lba_gcs")
+          &pm_serializer_lba_gcs, "serializer_lba_gcs",
+          &pm_serializer_lba_index_bytes, "serializer_lba_index_bytes")
 { }
 
 void log_serializer_stats_t::bytes_read(size_t count) {
@@ -162,13 +165,39 @@ void log_serializer_stats_t::bytes_written(size_t count) {
     pm_serializer_written_bytes_total += count;
 }
 
-void log_serializer_t::create(serializer_file_opener_t *file_opener, static_config_t static_config) {
+/* A table file's extra static data holds its backfill watermark (see
+`serializer_t::note_backfill()`) as the magic followed by the timestamp.  It's zeros if
+there is no watermark. */
+ATTR_PACKED(struct log_serializer_backfill_watermark_t {
+    block_magic_t magic;
+    repli_timestamp_t watermark;
+});
+
+static const block_magic_t backfill_watermark_magic = { { 'b', 'k', 'f', 'l' } };
+
+/* The static header holds the static configuration, followed by the extra static data.
+*/
+static std::vector<char> static_header_data(
+        const log_serializer_on_disk_static_config_t &on_disk_config,
+        const std::vector<char> &extra_static_data) {
+    std::vector<char> data(sizeof(on_disk_config) + extra_static_data.size());
+    memcpy(data.data(), &on_disk_config, sizeof(on_disk_config));
+    std::copy(extra_static_data.begin(), extra_static_data.end(),
+              data.begin() + sizeof(on_disk_config));
+    return data;
+}
+
+void log_serializer_t::create(serializer_file_opener_t *file_opener,
+                              static_config_t static_config,
+                              const std::vector<char> &extra_static_data) {
     log_serializer_on_disk_static_config_t *on_disk_config = &static_config;
 
     scoped_ptr_t<file_t> file;
     file_opener->open_serializer_file_create_temporary(&file);
 
-    co_static_header_write(file.get(), on_disk_config, sizeof(*on_disk_config));
+    std::vector<char> header_data
+        = static_header_data(*on_disk_config, extra_static_data);
+    co_static_header_write(file.get(), header_data.data(), header_data.size());
 
     metablock_t metablock;
     memset(&metablock, 0, sizeof(metablock));
@@ -209,7 +238,7 @@ struct ls_start_existing_fsm_t :
         file_opener->open_serializer_file_existing(&dbfile);
         ser->dbfile = dbfile.release();
         ser->index_writes_io_account.init(
-            new file_account_t(ser->dbfile, INDEX_WRITE_IO_PRIORITY));
+            new file_account_t(ser->dbfile, io_class_t::flush));
 
         start_existing_state = state_read_static_header;
         // STATE A above implies STATE B here
@@ -407,6 +436,7 @@ log_serializer_t::log_serializer_t(dynamic_config_t _dynamic_config, serializer_
       shutdown_state(shutdown_not_started),
       state(state_unstarted),
       static_header_needs_migration(false),
+      index_snapshot_since_backfill_note(true),
       dbfile(nullptr),
       extent_manager(nullptr),
       metablock_manager(nullptr),
@@ -418,6 +448,15 @@ log_serializer_t::log_serializer_t(dynamic_config_t _dynamic_config, serializer_
     ls_start_existing_fsm_t *s = new ls_start_existing_fsm_t(this);
     cond_t cond;
     if (!s->run(&cond, file_opener)) cond.wait();
+
+    log_serializer_backfill_watermark_t watermark_data;
+    std::vector<char> data = read_extra_static_data(sizeof(watermark_data));
+    memcpy(&watermark_data, data.data(), sizeof(watermark_data));
+    if (watermark_data.magic == backfill_watermark_magic) {
+        // `watermark_data` is packed, so we can't bind a reference to its field.
+        const repli_timestamp_t watermark = watermark_data.watermark;
+        stored_backfill_watermark = watermark;
+    }
 }
 
 log_serializer_t::~log_serializer_t() {
@@ -432,10 +471,10 @@ log_serializer_t::~log_serializer_t() {
     rassert(active_write_count == 0);
 }
 
-file_account_t *log_serializer_t::make_io_account(int priority, int outstanding_requests_limit) {
+file_account_t *log_serializer_t::make_io_account(io_class_t io_class, int outstanding_requests_limit) {
     assert_thread();
     rassert(dbfile);
-    return new file_account_t(dbfile, priority, outstanding_requests_limit);
+    return new file_account_t(dbfile, io_class, outstanding_requests_limit);
 }
 
 buf_ptr_t log_serializer_t::block_read(const counted_t<ls_block_token_pointee_t> &token,
@@ -454,6 +493,28 @@ buf_ptr_t log_serializer_t::block_read(const counted_t<ls_block_token_pointee_t>
     return ret;
 }
 
+std::vector<buf_ptr_t> log_serializer_t::block_reads(
+        const std::vector<counted_t<ls_block_token_pointee_t> > &tokens,
+        file_account_t *io_account) {
+    assert_thread();
+    guarantee(state == state_ready);
+
+    std::vector<std::pair<int64_t, block_size_t> > blocks;
+    blocks.reserve(tokens.size());
+    for (const auto &token : tokens) {
+        guarantee(token.has());
+        blocks.push_back(std::make_pair(token->offset_, token->block_size()));
+    }
+
+    ticks_t pm_time;
+    stats->pm_serializer_block_reads.begin(&pm_time);
+
+    std::vector<buf_ptr_t> ret = data_block_manager->many_reads(blocks, io_account);
+
+    stats->pm_serializer_block_reads.end(&pm_time);
+    return ret;
+}
+
 // God this is such a hack.
 #ifndef SEMANTIC_SERIALIZER_CHECK
 counted_t<ls_block_token_pointee_t>
@@ -525,6 +586,9 @@ void log_serializer_t::index_write(new_mutex_in_line_t *mutex_acq,
             lba_index->set_block_info(op.block_id, recency,
                                       offset, ser_block_size,
                                       index_writes_io_account.get(), &txn);
+            if (static_cast<bool>(newest_recency)) {
+                newest_recency = superceding_recency(*newest_recency, recency);
+            }
         }
     }
 
@@ -803,6 +867,102 @@ counted_t<ls_block_token_pointee_t> log_serializer_t::index_read(block_id_t bloc
     }
 }
 
+std::vector<char> log_serializer_t::read_extra_static_data(size_t size) {
+    assert_thread();
+    rassert(state == state_ready);
+    std::vector<char> data(sizeof(log_serializer_on_disk_static_config_t) + size);
+    co_static_header_read_data(dbfile, data.data(), data.size());
+    return std::vector<char>(
+        data.begin() + sizeof(log_serializer_on_disk_static_config_t), data.end());
+}
+
+void log_serializer_t::write_extra_static_data(
+        const std::vector<char> &extra_static_data) {
+    assert_thread();
+    rassert(state == state_ready);
+    new_mutex_acq_t acq(&static_header_migration_mutex);
+    // Rewriting the header migrates it, and migrating it later would drop the data.
+    static_header_needs_migration = false;
+    std::vector<char> header_data
+        = static_header_data(static_config, extra_static_data);
+    co_static_header_write(dbfile, header_data.data(), header_data.size());
+}
+
+void log_serializer_t::note_backfill() {
+    assert_thread();
+    rassert(state == state_ready);
+    new_mutex_acq_t acq(&static_header_migration_mutex);
+    if (!index_snapshot_since_backfill_note) {
+        return;
+    }
+    if (!static_cast<bool>(newest_recency)) {
+        repli_timestamp_t newest = repli_timestamp_t::invalid;
+        for (block_id_t id = 0; id < lba_index->end_block_id(); ++id) {
+            newest = superceding_recency(newest, lba_index->get_block_recency(id));
+        }
+        for (block_id_t id = FIRST_AUX_BLOCK_ID;
+             id < lba_index->end_aux_block_id();
+             ++id) {
+            newest = superceding_recency(newest, lba_index->get_block_recency(id));
+        }
+        newest_recency = newest;
+    }
+    index_snapshot_since_backfill_note = false;
+    if (*newest_recency == repli_timestamp_t::invalid
+        || (static_cast<bool>(stored_backfill_watermark)
+            && *stored_backfill_watermark >= *newest_recency)) {
+        return;
+    }
+
+    log_serializer_backfill_watermark_t watermark_data;
+    memset(&watermark_data, 0, sizeof(watermark_data));
+    watermark_data.magic = backfill_watermark_magic;
+    watermark_data.watermark = *newest_recency;
+    std::vector<char> extra_static_data(sizeof(watermark_data));
+    memcpy(extra_static_data.data(), &watermark_data, sizeof(watermark_data));
+    static_header_needs_migration = false;
+    std::vector<char> header_data
+        = static_header_data(static_config, extra_static_data);
+    co_static_header_write(dbfile, header_data.data(), header_data.size());
+    stored_backfill_watermark = *newest_recency;
+}
+
+boost::optional<repli_timestamp_t> log_serializer_t::backfill_watermark() {
+    assert_thread();
+    return stored_backfill_watermark;
+}
+
+std::vector<index_snapshot_entry_t> log_serializer_t::index_snapshot() {
+    assert_thread();
+    rassert(state == state_ready);
+    ASSERT_NO_CORO_WAITING;
+    index_snapshot_since_backfill_note = true;
+
+    std::vector<index_snapshot_entry_t> ret;
+    auto add_range = [&](block_id_t first, block_id_t end) {
+        for (block_id_t id = first; id < end; ++id) {
+            index_block_info_t info = lba_index->get_block_info(id);
+            if (info.offset.has_value()) {
+                index_snapshot_entry_t entry;
+                entry.block_id = id;
+                entry.token = generate_block_token(
+                    info.offset.get_value(),
+                    block_size_t::unsafe_make(info.ser_block_size));
+                entry.recency = info.recency;
+                ret.push_back(std::move(entry));
+            } else if (info.recency != repli_timestamp_t::invalid) {
+                index_snapshot_entry_t entry;
+                entry.block_id = id;
+                entry.recency = info.recency;
+                ret.push_back(std::move(entry));
+            }
+        }
+    };
+    add_range(0, lba_index->end_block_id());
+    add_range(FIRST_AUX_BLOCK_ID, lba_index->end_aux_block_id());
+    return ret;
+}
+
 bool log_serializer_t::get_delete_bit(block_id_t id) {
     assert_thread();
     rassert(state == state_ready);
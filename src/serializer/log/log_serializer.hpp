@@ -124,8 +124,19 @@ public:
     typedef log_serializer_static_config_t static_config_t;
 
 
-    /* Blocks. Does not check for an existing database--use check_existing for that. */
-    static void create(serializer_file_opener_t *file_opener, static_config_t static_config);
+    /* Blocks. Does not check for an existing database--use check_existing for that.
+    `extra_static_data` is stored in the static header after the static configuration,
+    where the serializer itself never looks at it. */
+    static void create(serializer_file_opener_t *file_opener,
+                       static_config_t static_config,
+                       const std::vector<char> &extra_static_data = std::vector<char>());
+
+    /* Blocks. Returns the first `size` bytes of the extra static data (see `create()`),
+    which are zeros where none was stored. */
+    std::vector<char> read_extra_static_data(size_t size);
+
+    /* Blocks. Replaces the extra static data, and returns once it is on disk. */
+    void write_extra_static_data(const std::vector<char> &extra_static_data);
 
     /* Blocks. */
     log_serializer_t(dynamic_config_t dynamic_config, serializer_file_opener_t *file_opener, perfmon_collection_t *perfmon_collection);
@@ -136,7 +147,7 @@ public:
 #ifndef SEMANTIC_SERIALIZER_CHECK
     using serializer_t::make_io_account;
 #endif
-    file_account_t *make_io_account(int priority, int outstanding_requests_limit);
+    file_account_t *make_io_account(io_class_t io_class, int outstanding_requests_limit);
 
     void register_read_ahead_cb(serializer_read_ahead_callback_t *cb);
     void unregister_read_ahead_cb(serializer_read_ahead_callback_t *cb);
@@ -147,9 +158,13 @@ public:
 
     bool get_delete_bit(block_id_t id);
     counted_t<ls_block_token_pointee_t> index_read(block_id_t block_id);
+    std::vector<index_snapshot_entry_t> index_snapshot();
 
     buf_ptr_t block_read(const counted_t<ls_block_token_pointee_t> &token,
                        file_account_t *io_account);
+    std::vector<buf_ptr_t> block_reads(
+            const std::vector<counted_t<ls_block_token_pointee_t> > &tokens,
+            file_account_t *io_account);
 
     void index_write(new_mutex_in_line_t *mutex_acq,
                      const std::function<void()> &on_writes_reflected,
@@ -164,6 +179,11 @@ public:
 
     virtual bool is_gc_active() const;
 
+    /* Blocks.  The watermark is stored in the extra static data, so a backup file
+    (which stores its chain header there) never has one. */
+    void note_backfill();
+    boost::optional<repli_timestamp_t> backfill_watermark();
+
 private:
     void register_block_token(ls_block_token_pointee_t *token, int64_t offset);
     bool tokens_exist_for_offset(int64_t off);
@@ -257,6 +277,15 @@ private:
     bool static_header_needs_migration;
     new_mutex_t static_header_migration_mutex;
 
+    /* The newest recency in the index.  It's only computed once `note_backfill()`
+    needs it, and `index_write()` keeps it up to date from then on. */
+    boost::optional<repli_timestamp_t> newest_recency;
+    boost::optional<repli_timestamp_t> stored_backfill_watermark;
+    /* A backup can only be based on a recency that was in the index when it took its
+    snapshot, so as long as there was no snapshot since the last watermark, that
+    watermark still covers every backup. */
+    bool index_snapshot_since_backfill_note;
+
     file_t *dbfile;
     scoped_ptr_t<file_account_t> index_writes_io_account;
 
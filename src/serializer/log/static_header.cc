@@ -110,6 +110,13 @@ void static_header_read(
         needs_migration_out));
 }
 
+void co_static_header_read_data(file_t *file, void *data_out, size_t data_size) {
+    rassert(sizeof(static_header_t) + data_size < DEVICE_BLOCK_SIZE);
+    scoped_device_block_aligned_ptr_t<static_header_t> buffer(DEVICE_BLOCK_SIZE);
+    co_read(file, 0, DEVICE_BLOCK_SIZE, buffer.get(), DEFAULT_DISK_ACCOUNT);
+    memcpy(data_out, buffer->data, data_size);
+}
+
 void migrate_static_header(file_t *file, size_t data_size) {
     // Migrate the static header by rewriting it
     logNTC("Migrating file to serializer version %s.",
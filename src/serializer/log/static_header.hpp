@@ -38,6 +38,10 @@ void static_header_read(
     bool *needs_migration_out,
     static_header_read_callback_t *cb);
 
+// Blocks, must be run in a coroutine.  Reads `data_size` bytes of the data after the
+// static header, without checking the version.
+void co_static_header_read_data(file_t *file, void *data_out, size_t data_size);
+
 // Blocks, must be run in a coroutine
 void migrate_static_header(file_t *file, size_t data_size);
 
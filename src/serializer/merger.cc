@@ -14,7 +14,7 @@
 merger_serializer_t::merger_serializer_t(scoped_ptr_t<serializer_t> _inner,
                                          int _max_active_writes) :
     inner(std::move(_inner)),
-    block_writes_io_account(make_io_account(MERGER_BLOCK_WRITE_IO_PRIORITY)),
+    block_writes_io_account(make_io_account(io_class_t::flush)),
     write_committer(std::bind(&merger_serializer_t::do_index_write, this),
                     _max_active_writes) { }
 
@@ -36,6 +36,49 @@ counted_t<standard_block_token_t> merger_serializer_t::index_read(block_id_t blo
     return inner->index_read(block_id);
 }
 
+std::vector<index_snapshot_entry_t> merger_serializer_t::index_snapshot() {
+    assert_thread();
+    ASSERT_NO_CORO_WAITING;
+    std::vector<index_snapshot_entry_t> inner_entries = inner->index_snapshot();
+    if (outstanding_index_write_ops.empty()) {
+        return inner_entries;
+    }
+
+    // Both `inner_entries` and `outstanding_index_write_ops` are ordered by block
+    // id, so we can apply the outstanding writes in a single pass.
+    std::vector<index_snapshot_entry_t> ret;
+    ret.reserve(inner_entries.size() + outstanding_index_write_ops.size());
+    auto entry = inner_entries.begin();
+    for (const auto &pair : outstanding_index_write_ops) {
+        while (entry != inner_entries.end() && entry->block_id < pair.first) {
+            ret.push_back(std::move(*entry));
+            ++entry;
+        }
+        index_snapshot_entry_t merged;
+        merged.block_id = pair.first;
+        merged.recency = repli_timestamp_t::invalid;
+        if (entry != inner_entries.end() && entry->block_id == pair.first) {
+            merged = std::move(*entry);
+            ++entry;
+        }
+        const index_write_op_t &op = pair.second;
+        if (static_cast<bool>(op.token)) {
+            merged.token = *op.token;
+        }
+        if (static_cast<bool>(op.recency)) {
+            merged.recency = *op.recency;
+        }
+        // A deleted block has an empty token and no recency.
+        if (merged.token.has() || merged.recency != repli_timestamp_t::invalid) {
+            ret.push_back(std::move(merged));
+        }
+    }
+    for (; entry != inner_entries.end(); ++entry) {
+        ret.push_back(std::move(*entry));
+    }
+    return ret;
+}
+
 void merger_serializer_t::index_write(new_mutex_in_line_t *mutex_acq,
                                       const std::function<void()> &on_writes_reflected,
                                       const std::vector<index_write_op_t> &write_ops) {
@@ -64,6 +107,16 @@ void merger_serializer_t::index_write(new_mutex_in_line_t *mutex_acq,
     write_committer.flush(&non_interruptor);
 }
 
+void merger_serializer_t::note_backfill() {
+    assert_thread();
+    if (!outstanding_index_write_ops.empty()) {
+        write_committer.notify();
+        cond_t non_interruptor;
+        write_committer.flush(&non_interruptor);
+    }
+    inner->note_backfill();
+}
+
 void merger_serializer_t::do_index_write() {
     assert_thread();
 
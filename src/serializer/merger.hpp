@@ -37,8 +37,8 @@ public:
     /* Allocates a new io account for the underlying file.
     Use delete to free it. */
     using serializer_t::make_io_account;
-    file_account_t *make_io_account(int priority, int outstanding_requests_limit) {
-        return inner->make_io_account(priority, outstanding_requests_limit);
+    file_account_t *make_io_account(io_class_t io_class, int outstanding_requests_limit) {
+        return inner->make_io_account(io_class, outstanding_requests_limit);
     }
 
     /* Some serializer implementations support read-ahead to speed up cache warmup.
@@ -59,6 +59,12 @@ public:
         return inner->block_read(token, io_account);
     }
 
+    std::vector<buf_ptr_t> block_reads(
+            const std::vector<counted_t<standard_block_token_t> > &tokens,
+            file_account_t *io_account) {
+        return inner->block_reads(tokens, io_account);
+    }
+
     /* The index stores three pieces of information for each ID:
      * 1. A pointer to a data block on disk (which may be NULL)
      * 2. A repli_timestamp_t, called the "recency"
@@ -85,6 +91,16 @@ public:
     /* Reads the block's actual data */
     counted_t<standard_block_token_t> index_read(block_id_t block_id);
 
+    /* Includes the outstanding index writes, just like index_read() */
+    std::vector<index_snapshot_entry_t> index_snapshot();
+
+    /* Waits for the outstanding index writes to reach `inner`, so that its watermark
+    covers them. */
+    void note_backfill();
+    boost::optional<repli_timestamp_t> backfill_watermark() {
+        return inner->backfill_watermark();
+    }
+
     /* index_write() applies all given index operations in an atomic way */
     /* This is where merger_serializer_t merges operations */
     void index_write(new_mutex_in_line_t *mutex_acq,
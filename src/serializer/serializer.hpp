@@ -33,6 +33,13 @@ struct index_write_op_t {
 
 void debug_print(printf_buffer_t *buf, const index_write_op_t &write_op);
 
+// One existing block, as returned by `serializer_t::index_snapshot()`.
+struct index_snapshot_entry_t {
+    block_id_t block_id;
+    counted_t<standard_block_token_t> token;
+    repli_timestamp_t recency;
+};
+
 /* serializer_t is an abstract interface that describes how each serializer should
 behave. It is implemented by merger_serializer_t, log_serializer_t, and
 translator_serializer_t. */
@@ -50,8 +57,9 @@ public:
 
     /* Allocates a new io account for the underlying file.
     Use delete to free it. */
-    file_account_t *make_io_account(int priority);
-    virtual file_account_t *make_io_account(int priority, int outstanding_requests_limit) = 0;
+    file_account_t *make_io_account(io_class_t io_class);
+    virtual file_account_t *make_io_account(io_class_t io_class,
+                                            int outstanding_requests_limit) = 0;
 
     /* Some serializer implementations support read-ahead to speed up cache warmup.
     This is supported through a serializer_read_ahead_callback_t which gets called whenever the serializer has read-ahead some buf.
@@ -64,6 +72,12 @@ public:
     virtual buf_ptr_t block_read(const counted_t<standard_block_token_t> &token,
                                file_account_t *io_account) = 0;
 
+    // Reads several blocks, returning them in the same order as the tokens.  Blocks
+    // that lie close to each other on disk get read with a single disk read.
+    virtual std::vector<buf_ptr_t> block_reads(
+            const std::vector<counted_t<standard_block_token_t> > &tokens,
+            file_account_t *io_account) = 0;
+
     /* The index stores three pieces of information for each ID:
      * 1. A pointer to a data block on disk (which may be NULL)
      * 2. A repli_timestamp_t, called the "recency"
@@ -100,6 +114,25 @@ public:
     /* Reads the block's actual data */
     virtual counted_t<standard_block_token_t> index_read(block_id_t block_id) = 0;
 
+    /* Returns every existing regular and aux block, in order by block id, as the
+    index stands at a single point in time (this doesn't block).  The returned tokens
+    keep the blocks' data readable for as long as they are held, no matter what gets
+    written or garbage collected in the meantime.  Index entries that have a recency
+    but no data (as written by incremental backups) are returned with an empty
+    token. */
+    virtual std::vector<index_snapshot_entry_t> index_snapshot() = 0;
+
+    /* Called before blocks get written with recencies that are older than the ones
+    the file already has, as a backfill does.  Records the newest recency in the file
+    (including index writes that haven't reached the disk yet) as the backfill
+    watermark, and returns once the watermark is on disk. */
+    virtual void note_backfill() = 0;
+
+    /* Returns the watermark that `note_backfill()` last recorded, or nothing if the
+    file never received a backfill.  Blocks whose recency is older than the watermark
+    may still have been written after any timestamp up to the watermark. */
+    virtual boost::optional<repli_timestamp_t> backfill_watermark() = 0;
+
     // Applies all given index operations in an atomic way.  The mutex_acq is for a
     // mutex belonging to the _caller_, used by the caller for pipelining, for
     // ensuring that different index write operations do not cross each other.
@@ -232,8 +232,8 @@ translator_serializer_t::translator_serializer_t(serializer_t *_inner, int _mod_
     rassert(mod_id < mod_count);
 }
 
-file_account_t *translator_serializer_t::make_io_account(int priority, int outstanding_requests_limit) {
-    return inner->make_io_account(priority, outstanding_requests_limit);
+file_account_t *translator_serializer_t::make_io_account(io_class_t io_class, int outstanding_requests_limit) {
+    return inner->make_io_account(io_class, outstanding_requests_limit);
 }
 
 void translator_serializer_t::index_write(
@@ -267,6 +267,12 @@ buf_ptr_t translator_serializer_t::block_read(const counted_t<standard_block_tok
     return inner->block_read(token, io_account);
 }
 
+std::vector<buf_ptr_t> translator_serializer_t::block_reads(
+        const std::vector<counted_t<standard_block_token_t> > &tokens,
+        file_account_t *io_account) {
+    return inner->block_reads(tokens, io_account);
+}
+
 counted_t<standard_block_token_t> translator_serializer_t::index_read(block_id_t block_id) {
     return inner->index_read(translate_block_id(block_id));
 }
@@ -283,6 +289,14 @@ bool translator_serializer_t::is_gc_active() const {
     return inner->is_gc_active();
 }
 
+void translator_serializer_t::note_backfill() {
+    inner->note_backfill();
+}
+
+boost::optional<repli_timestamp_t> translator_serializer_t::backfill_watermark() {
+    return inner->backfill_watermark();
+}
+
 // A helper function for `end_block_id` and `end_aux_block_id`
 // `first_block_id` is the lowest block ID in the range, either 0 for regular block
 // IDs or FIRST_AUX_BLOCK_ID for aux blocks.
@@ -330,6 +344,25 @@ bool translator_serializer_t::get_delete_bit(block_id_t id) {
     return inner->get_delete_bit(translate_block_id(id));
 }
 
+std::vector<index_snapshot_entry_t> translator_serializer_t::index_snapshot() {
+    std::vector<index_snapshot_entry_t> ret;
+    for (index_snapshot_entry_t &entry : inner->index_snapshot()) {
+        const block_id_t relative_id = is_aux_block_id(entry.block_id)
+            ? make_aux_block_id_relative(entry.block_id)
+            : entry.block_id;
+        // Skip the configuration block and the blocks of the other slices.
+        if (relative_id < cfgid.subsequent_ser_id()
+            || untranslate_block_id_to_mod_id(entry.block_id, mod_count, cfgid)
+               != mod_id) {
+            continue;
+        }
+        entry.block_id = untranslate_block_id_to_id(entry.block_id, mod_count, mod_id,
+                                                    cfgid);
+        ret.push_back(std::move(entry));
+    }
+    return ret;
+}
+
 void translator_serializer_t::offer_read_ahead_buf(
         block_id_t block_id,
         buf_ptr_t *buf,
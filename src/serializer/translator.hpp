@@ -111,7 +111,7 @@ public:
     translator_serializer_t(serializer_t *inner, int mod_count, int mod_id, config_block_id_t cfgid);
 
     /* Allocates a new io account for the underlying file */
-    file_account_t *make_io_account(int priority, int outstanding_requests_limit);
+    file_account_t *make_io_account(io_class_t io_class, int outstanding_requests_limit);
 
     void index_write(new_mutex_in_line_t *mutex_acq,
                      const std::function<void()> &on_writes_reflected,
@@ -126,15 +126,22 @@ public:
 
     bool is_gc_active() const;
 
+    void note_backfill();
+    boost::optional<repli_timestamp_t> backfill_watermark();
+
     block_id_t end_block_id();
     block_id_t end_aux_block_id();
 
     segmented_vector_t<repli_timestamp_t> get_all_recencies(block_id_t first,
                                                             block_id_t step);
     bool get_delete_bit(block_id_t id);
+    std::vector<index_snapshot_entry_t> index_snapshot();
 
     buf_ptr_t block_read(const counted_t<standard_block_token_t> &token,
                        file_account_t *io_account);
+    std::vector<buf_ptr_t> block_reads(
+            const std::vector<counted_t<standard_block_token_t> > &tokens,
+            file_account_t *io_account);
     counted_t<standard_block_token_t> index_read(block_id_t block_id);
 
 public:
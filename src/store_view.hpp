@@ -94,6 +94,13 @@ public:
             signal_t *interruptor)
             THROWS_ONLY(interrupted_exc_t) = 0;
 
+    /* Loads the parts of the store that are needed to read `keys` into the cache, at a
+    low priority. This is only a hint; stores without a cache can ignore it. */
+    virtual void warm_cache(
+            UNUSED const std::vector<store_key_t> &keys,
+            UNUSED signal_t *interruptor)
+            THROWS_ONLY(interrupted_exc_t) { }
+
     /* `send_backfill_pre()` expresses the keys that have changed since `start_point` as
     a series of `backfill_pre_item_t` objects, ignoring the values of the changed keys.
     It passes the items to `callback`. The pre-items will not overlap, and the calls to
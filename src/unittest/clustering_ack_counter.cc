@@ -0,0 +1,76 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include "unittest/gtest.hpp"
+
+#include "clustering/table_contract/executor/exec_primary.hpp"
+
+namespace unittest {
+
+TEST(ClusteringAckCounter, LocalMajority) {
+    /* Five voters: the primary and one other server in the local site, three servers
+    in a remote site. */
+    std::vector<server_id_t> s;
+    for (size_t i = 0; i < 5; ++i) {
+        s.push_back(server_id_t::generate_server_id());
+    }
+    contract_t contract;
+    contract.replicas = contract.voters = std::set<server_id_t>(s.begin(), s.end());
+    contract.primary = boost::make_optional(contract_t::primary_t{s[0], boost::none});
+    std::set<server_id_t> local_voters = {s[0], s[1]};
+
+    ack_counter_t counter(contract, &local_voters);
+    counter.note_ack(s[2]);
+    counter.note_ack(s[3]);
+    EXPECT_FALSE(counter.is_locally_safe());
+    counter.note_ack(s[0]);
+    EXPECT_FALSE(counter.is_locally_safe());
+    EXPECT_TRUE(counter.is_safe());
+
+    ack_counter_t local_counter(contract, &local_voters);
+    local_counter.note_ack(s[0]);
+    local_counter.note_ack(s[1]);
+    EXPECT_TRUE(local_counter.is_locally_safe());
+    EXPECT_FALSE(local_counter.is_safe());
+
+    /* While the voters are changing, a local majority isn't enough. */
+    contract.temp_voters = boost::make_optional(std::set<server_id_t>{s[0], s[1], s[2]});
+    ack_counter_t transition_counter(contract, &local_voters);
+    transition_counter.note_ack(s[0]);
+    transition_counter.note_ack(s[1]);
+    EXPECT_FALSE(transition_counter.is_locally_safe());
+    transition_counter.note_ack(s[2]);
+    EXPECT_TRUE(transition_counter.is_locally_safe());
+}
+
+TEST(ClusteringAckCounter, VotingAck) {
+    /* The primary and two voters, one non-voting replica, and one server that will only
+    vote once the voters have changed. */
+    std::vector<server_id_t> s;
+    for (size_t i = 0; i < 5; ++i) {
+        s.push_back(server_id_t::generate_server_id());
+    }
+    contract_t contract;
+    contract.replicas = std::set<server_id_t>(s.begin(), s.end());
+    contract.voters = std::set<server_id_t>{s[0], s[1], s[2]};
+    contract.primary = boost::make_optional(contract_t::primary_t{s[0], boost::none});
+
+    ack_counter_t counter(contract);
+    EXPECT_TRUE(counter.is_voting_ack(s[0]));
+    EXPECT_TRUE(counter.is_voting_ack(s[1]));
+    EXPECT_FALSE(counter.is_voting_ack(s[3]));
+    EXPECT_FALSE(counter.is_voting_ack(s[4]));
+
+    /* Non-voting acks never make a write safe. */
+    counter.note_ack(s[0]);
+    counter.note_ack(s[3]);
+    counter.note_ack(s[4]);
+    EXPECT_FALSE(counter.is_safe());
+    counter.note_ack(s[1]);
+    EXPECT_TRUE(counter.is_safe());
+
+    contract.temp_voters = boost::make_optional(std::set<server_id_t>{s[0], s[1], s[4]});
+    ack_counter_t transition_counter(contract);
+    EXPECT_TRUE(transition_counter.is_voting_ack(s[4]));
+    EXPECT_FALSE(transition_counter.is_voting_ack(s[3]));
+}
+
+}  // namespace unittest
@@ -52,6 +52,7 @@ public:
         cs.config.basic.primary_key = "id";
         cs.config.write_ack_config = write_ack_config_t::MAJORITY;
         cs.config.durability = write_durability_t::HARD;
+        cs.config.block_size = DEFAULT_BTREE_BLOCK_SIZE;
 
         key_range_t::right_bound_t prev_right(store_key_t::min());
         for (const quick_shard_args_t &qs : qss) {
@@ -109,6 +110,7 @@ public:
             st != contract_ack_t::state_t::primary_need_branch);
         for (size_t i = 0; i < CPU_SHARDING_FACTOR; ++i) {
             acks[contracts.contract_ids[i]][server] = contract_ack_t(st);
+            cache.invalidate_contract(contracts.contract_ids[i]);
         }
     }
     void add_ack(
@@ -123,6 +125,7 @@ public:
             ack.version = boost::make_optional(quick_cpu_version_map(i, version));
             ack.branch_history = branch_history;
             acks[contracts.contract_ids[i]][server] = ack;
+            cache.invalidate_contract(contracts.contract_ids[i]);
         }
     }
     void add_ack(
@@ -137,6 +140,7 @@ public:
             ack.branch = boost::make_optional(branch->branch_ids[i]);
             ack.branch_history = branch_history;
             acks[contracts.contract_ids[i]][server] = ack;
+            cache.invalidate_contract(contracts.contract_ids[i]);
         }
     }
 
@@ -148,6 +152,7 @@ public:
             if (acks[contracts.contract_ids[i]].empty()) {
                 acks.erase(contracts.contract_ids[i]);
             }
+            cache.invalidate_contract(contracts.contract_ids[i]);
         }
     }
 
@@ -156,6 +161,7 @@ public:
     form sets unidirectional visibility from one specific server to one specific other
     server.  */
     void set_visibility(const server_id_t &s, bool visible) {
+        cache.invalidate_server(s);
         for (const server_id_t &s2 : all_servers) {
             if (visible) {
                 connections.set_key(std::make_pair(s, s2), empty_value_t());
@@ -167,6 +173,8 @@ public:
         }
     }
     void set_visibility(const server_id_t &s1, const server_id_t &s2, bool visible) {
+        cache.invalidate_server(s1);
+        cache.invalidate_server(s2);
         if (visible) {
             connections.set_key(std::make_pair(s1, s2), empty_value_t());
         } else {
@@ -175,16 +183,40 @@ public:
     }
 
     /* Call `coordinate()` to run the contract coordinator logic on the inputs you've
-    created. */
+    created. It also checks that using `cache` gives the same results as recalculating
+    every contract from scratch. */
     void coordinate() {
         std::set<contract_id_t> remove_contracts;
         std::map<contract_id_t, std::pair<region_t, contract_t> > add_contracts;
         std::map<region_t, branch_id_t> register_current_branches;
         std::set<branch_id_t> remove_branches;
         branch_history_t add_branches;
-        calculate_all_contracts(state, acks, &connections,
+        calculate_all_contracts(state, acks, &connections, &cache,
             &remove_contracts, &add_contracts, &register_current_branches,
             &remove_branches, &add_branches);
+
+        std::set<contract_id_t> uncached_remove_contracts;
+        std::map<contract_id_t, std::pair<region_t, contract_t> > uncached_add_contracts;
+        std::map<region_t, branch_id_t> uncached_register_current_branches;
+        std::set<branch_id_t> uncached_remove_branches;
+        branch_history_t uncached_add_branches;
+        calculate_all_contracts(state, acks, &connections, nullptr,
+            &uncached_remove_contracts, &uncached_add_contracts,
+            &uncached_register_current_branches, &uncached_remove_branches,
+            &uncached_add_branches);
+        EXPECT_EQ(uncached_remove_contracts, remove_contracts);
+        std::map<region_t, contract_t> added, uncached_added;
+        for (const auto &pair : add_contracts) {
+            added.insert(pair.second);
+        }
+        for (const auto &pair : uncached_add_contracts) {
+            uncached_added.insert(pair.second);
+        }
+        EXPECT_TRUE(uncached_added == added);
+        EXPECT_TRUE(uncached_register_current_branches == register_current_branches);
+        EXPECT_EQ(uncached_remove_branches, remove_branches);
+        EXPECT_EQ(uncached_add_branches.branches.size(), add_branches.branches.size());
+
         for (const contract_id_t &id : remove_contracts) {
             state.contracts.erase(id);
             acks.erase(id);
@@ -290,6 +322,7 @@ public:
     std::set<server_id_t> all_servers;
     std::map<contract_id_t, std::map<server_id_t, contract_ack_t> > acks;
     watchable_map_var_t<std::pair<server_id_t, server_id_t>, empty_value_t> connections;
+    contract_calculation_cache_t cache;
 };
 
 /* In the `AddReplica` test, we add a single replica to a table. */
@@ -623,5 +656,49 @@ TPTEST(ClusteringContractCoordinator, FailoverSplit) {
     test.check_current_branches(branch1);
 }
 
+/* In the `IncrementalRecalculation` test, we check that the coordinator only
+recalculates the contracts whose inputs have changed. */
+TPTEST(ClusteringContractCoordinator, IncrementalRecalculation) {
+    server_id_t alice = server_id_t::generate_server_id();
+    server_id_t billy = server_id_t::generate_server_id();
+    coordinator_tester_t test({ alice, billy });
+    test.set_config({ {"*-M", {alice}, alice}, {"N-*", {billy}, billy} });
+    cpu_branch_ids_t branch = quick_cpu_branch(
+        &test.state.branch_history,
+        { {"*-*", nullptr, 0} });
+    test.set_current_branches(branch);
+    cpu_contract_ids_t cid_l = test.add_contract("*-M",
+        quick_contract_simple({alice}, alice));
+    cpu_contract_ids_t cid_r = test.add_contract("N-*",
+        quick_contract_simple({billy}, billy));
+    test.add_ack(alice, cid_l, contract_ack_t::state_t::primary_ready);
+    test.add_ack(billy, cid_r, contract_ack_t::state_t::primary_ready);
+
+    test.coordinate();
+    test.check_same_contract(cid_l);
+    test.check_same_contract(cid_r);
+    EXPECT_EQ(2 * CPU_SHARDING_FACTOR, test.cache.contracts_recalculated);
+    EXPECT_EQ(0u, test.cache.contracts_reused);
+
+    /* Nothing changed, so nothing should be recalculated */
+    test.coordinate();
+    EXPECT_EQ(2 * CPU_SHARDING_FACTOR, test.cache.contracts_recalculated);
+    EXPECT_EQ(2 * CPU_SHARDING_FACTOR, test.cache.contracts_reused);
+
+    /* A new ack only affects the contracts it refers to */
+    test.add_ack(alice, cid_l, contract_ack_t::state_t::primary_ready);
+    test.coordinate();
+    EXPECT_EQ(3 * CPU_SHARDING_FACTOR, test.cache.contracts_recalculated);
+    EXPECT_EQ(3 * CPU_SHARDING_FACTOR, test.cache.contracts_reused);
+
+    /* Changing the config affects every contract */
+    test.set_config({ {"*-M", {alice, billy}, alice}, {"N-*", {billy}, billy} });
+    test.coordinate();
+    EXPECT_EQ(5 * CPU_SHARDING_FACTOR, test.cache.contracts_recalculated);
+    test.check_contract("L: Billy in replicas", "*-M",
+        quick_contract_extra_replicas({alice}, {billy}, alice));
+    test.check_same_contract(cid_r);
+}
+
 } /* namespace unittest */
 
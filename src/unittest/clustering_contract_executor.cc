@@ -133,6 +133,7 @@ public:
             context->cluster.get_mailbox_manager(),
             context->published_state.get_watchable(),
             &context->contract_execution_bcards,
+            nullptr,
             files,
             base_path_t("."),
             &context->io_backender,
@@ -0,0 +1,41 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include <algorithm>
+
+#include "unittest/gtest.hpp"
+
+#include "clustering/immediate_consistency/hot_set.hpp"
+#include "rdb_protocol/protocol.hpp"
+
+namespace unittest {
+
+namespace {
+
+read_t make_point_read(const std::string &key) {
+    return read_t(point_read_t(store_key_t(key)),
+                  profile_bool_t::DONT_PROFILE, read_mode_t::SINGLE);
+}
+
+}  // anonymous namespace
+
+TEST(ClusteringHotSet, DeduplicatesAndSorts) {
+    hot_set_tracker_t tracker;
+    EXPECT_TRUE(tracker.get_keys().empty());
+    tracker.note_read(make_point_read("b"));
+    tracker.note_read(make_point_read("a"));
+    tracker.note_read(make_point_read("b"));
+    std::vector<store_key_t> expected { store_key_t("a"), store_key_t("b") };
+    EXPECT_EQ(expected, tracker.get_keys());
+}
+
+TEST(ClusteringHotSet, ForgetsOldKeys) {
+    hot_set_tracker_t tracker;
+    tracker.note_read(make_point_read("old"));
+    for (int i = 0; i < REPLICA_HOT_SET_MAX_KEYS; ++i) {
+        tracker.note_read(make_point_read(strprintf("new%d", i)));
+    }
+    std::vector<store_key_t> keys = tracker.get_keys();
+    EXPECT_EQ(static_cast<size_t>(REPLICA_HOT_SET_MAX_KEYS), keys.size());
+    EXPECT_TRUE(std::find(keys.begin(), keys.end(), store_key_t("old")) == keys.end());
+}
+
+}  // namespace unittest
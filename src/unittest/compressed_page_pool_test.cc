@@ -0,0 +1,86 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include <string.h>
+
+#include "unittest/gtest.hpp"
+
+#include "buffer_cache/compressed_page_pool.hpp"
+
+namespace unittest {
+
+static const uint32_t TEST_BLOCK_SIZE = 4096;
+
+static buf_ptr_t make_compressible_buf(char fill) {
+    buf_ptr_t buf = buf_ptr_t::alloc_zeroed(block_size_t::unsafe_make(TEST_BLOCK_SIZE));
+    memset(buf.ser_buffer(), fill, TEST_BLOCK_SIZE / 2);
+    return buf;
+}
+
+static buf_ptr_t make_incompressible_buf() {
+    buf_ptr_t buf = buf_ptr_t::alloc_zeroed(block_size_t::unsafe_make(TEST_BLOCK_SIZE));
+    char *data = reinterpret_cast<char *>(buf.ser_buffer());
+    uint32_t x = 12345;
+    for (uint32_t i = 0; i < TEST_BLOCK_SIZE; ++i) {
+        x = x * 1103515245 + 12345;
+        data[i] = static_cast<char>(x >> 16);
+    }
+    return buf;
+}
+
+static bool pool_has_block(alt::compressed_page_pool_t *pool, block_id_t block_id,
+                           char fill) {
+    counted_t<standard_block_token_t> token;
+    buf_ptr_t buf;
+    if (!pool->take(block_id, counted_t<standard_block_token_t>(), &token, &buf)) {
+        return false;
+    }
+    buf_ptr_t expected = make_compressible_buf(fill);
+    EXPECT_EQ(TEST_BLOCK_SIZE, buf.block_size().ser_value());
+    EXPECT_EQ(0, memcmp(expected.ser_buffer(), buf.ser_buffer(), TEST_BLOCK_SIZE));
+    return true;
+}
+
+TEST(CompressedPagePoolTest, InsertAndTake) {
+    alt::compressed_page_pool_t pool;
+    pool.set_memory_limit(MEGABYTE);
+    pool.insert(1, counted_t<standard_block_token_t>(), make_compressible_buf('a'));
+    pool.insert(2, counted_t<standard_block_token_t>(), make_compressible_buf('b'));
+    EXPECT_GT(pool.uncompressed_size(), pool.compressed_size());
+
+    ASSERT_TRUE(pool_has_block(&pool, 2, 'b'));
+    // Taking a block removes it from the pool.
+    EXPECT_FALSE(pool_has_block(&pool, 2, 'b'));
+
+    pool.remove(1);
+    EXPECT_FALSE(pool_has_block(&pool, 1, 'a'));
+    EXPECT_EQ(0u, pool.memory_usage());
+}
+
+TEST(CompressedPagePoolTest, MemoryLimit) {
+    alt::compressed_page_pool_t pool;
+    pool.insert(1, counted_t<standard_block_token_t>(), make_compressible_buf('a'));
+    EXPECT_EQ(0u, pool.memory_usage());
+
+    pool.set_memory_limit(MEGABYTE);
+    for (block_id_t i = 0; i < 10; ++i) {
+        pool.insert(i, counted_t<standard_block_token_t>(), make_compressible_buf('a'));
+    }
+    const uint64_t per_block = pool.memory_usage() / 10;
+    // Shrinking the pool drops the blocks that were inserted first.
+    pool.set_memory_limit(per_block * 4);
+    EXPECT_LE(pool.memory_usage(), per_block * 4);
+    EXPECT_FALSE(pool_has_block(&pool, 5, 'a'));
+    EXPECT_TRUE(pool_has_block(&pool, 6, 'a'));
+    EXPECT_TRUE(pool_has_block(&pool, 9, 'a'));
+}
+
+TEST(CompressedPagePoolTest, Incompressible) {
+    alt::compressed_page_pool_t pool;
+    pool.set_memory_limit(MEGABYTE);
+    pool.insert(1, counted_t<standard_block_token_t>(), make_compressible_buf('a'));
+    // An incompressible version replaces the old one, without being stored itself.
+    pool.insert(1, counted_t<standard_block_token_t>(), make_incompressible_buf());
+    EXPECT_EQ(0u, pool.memory_usage());
+    EXPECT_FALSE(pool_has_block(&pool, 1, 'a'));
+}
+
+}  // namespace unittest
@@ -4,6 +4,7 @@
 #include "rdb_protocol/datum.hpp"
 #include "rdb_protocol/datum_string.hpp"
 #include "rdb_protocol/env.hpp"
+#include "rdb_protocol/pseudo_time.hpp"
 #include "unittest/gtest.hpp"
 
 
@@ -205,4 +206,54 @@ TEST(DatumTest, OffsetScaling) {
     }
 }
 
+TEST(DatumTest, Hash) {
+    ql::configured_limits_t limits;
+    ql::datum_t nested(std::map<datum_string_t, ql::datum_t>
+        {std::make_pair(datum_string_t("a"), ql::datum_t(0.0)),
+         std::make_pair(datum_string_t("b"), ql::datum_t(datum_string_t("foo"))),
+         std::make_pair(datum_string_t("c"), ql::datum_t(
+             std::vector<ql::datum_t>{ql::datum_t::null(), ql::datum_t::boolean(true)},
+             limits))});
+    ql::datum_t test_array(
+        std::vector<ql::datum_t>{nested, ql::datum_t(1.5), nested}, limits);
+
+    // A buffer-backed datum hashes the same as the datum it was serialized from.
+    ql::datum_t deserialized;
+    {
+        string_stream_t write_stream;
+        write_message_t wm;
+        serialize<cluster_version_t::LATEST_OVERALL>(&wm, test_array);
+        ASSERT_EQ(0, send_write_message(&write_stream, &wm));
+        string_read_stream_t read_stream(std::move(write_stream.str()), 0);
+        ASSERT_EQ(archive_result_t::SUCCESS,
+                  deserialize<cluster_version_t::LATEST_OVERALL>(
+                      &read_stream, &deserialized));
+    }
+    ASSERT_TRUE(deserialized.get_buf_ref() != nullptr);
+    EXPECT_EQ(test_array.hash(), deserialized.hash());
+    // The cached hash doesn't change.
+    EXPECT_EQ(test_array.hash(), test_array.hash());
+
+    // Data that compare equal have the same hash.
+    EXPECT_EQ(ql::datum_t(0.0), ql::datum_t(-0.0));
+    EXPECT_EQ(ql::datum_t(0.0).hash(), ql::datum_t(-0.0).hash());
+    ql::datum_t utc = ql::pseudo::make_time(1000.0, "+00:00");
+    ql::datum_t pst = ql::pseudo::make_time(1000.0, "-08:00");
+    EXPECT_EQ(utc, pst);
+    EXPECT_EQ(utc.hash(), pst.hash());
+
+    // Unequal data with cached hashes compare unequal.
+    ql::datum_t other_array(
+        std::vector<ql::datum_t>{nested, ql::datum_t(2.5), nested}, limits);
+    EXPECT_NE(test_array.hash(), other_array.hash());
+    EXPECT_NE(test_array, other_array);
+    EXPECT_FALSE(test_array == other_array);
+    ql::datum_t same_array(
+        std::vector<ql::datum_t>{nested, ql::datum_t(1.5), nested}, limits);
+    EXPECT_EQ(test_array.hash(), same_array.hash());
+    EXPECT_EQ(test_array, same_array);
+    EXPECT_NE(ql::datum_t(datum_string_t("foo")).hash(),
+              ql::datum_t::binary(datum_string_t("foo")).hash());
+}
+
 }  // namespace unittest
@@ -0,0 +1,151 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include <vector>
+
+#include "arch/io/disk/accounting.hpp"
+#include "arch/timing.hpp"
+#include "config/args.hpp"
+#include "containers/scoped.hpp"
+#include "unittest/gtest.hpp"
+#include "unittest/unittest_utils.hpp"
+
+namespace unittest {
+
+#ifdef _WIN32
+static const fd_t IRRELEVANT_DEFAULT_FD = GetStdHandle(STD_INPUT_HANDLE);
+#else
+static const fd_t IRRELEVANT_DEFAULT_FD = 0;
+#endif
+
+/* Plays the part of the device: takes every request that the `accounting_diskmgr_t`
+makes available, and completes them when the test says so. */
+struct scheduling_driver_t : private availability_callback_t {
+    typedef accounting_diskmgr_t::action_t action_t;
+
+    explicit scheduling_driver_t(int max_outstanding_requests, int batch_factor = 1)
+        : accounter(batch_factor, max_outstanding_requests,
+                    &get_global_perfmon_collection()) {
+        accounter.done_fun = [](action_t *) { };
+        accounter.producer->available->set_callback(this);
+    }
+    ~scheduling_driver_t() {
+        accounter.producer->available->unset_callback();
+    }
+
+    accounting_diskmgr_t::account_t *make_account(io_class_t io_class) {
+        accounts.push_back(make_scoped<accounting_diskmgr_t::account_t>(
+            &accounter, io_class, UNLIMITED_OUTSTANDING_REQUESTS));
+        return accounts.back().get();
+    }
+
+    action_t *submit_read(accounting_diskmgr_t::account_t *account, size_t count) {
+        actions.push_back(make_scoped<action_t>());
+        action_t *a = actions.back().get();
+        // The driver never performs the read, so the buffer doesn't matter.
+        a->make_read(IRRELEVANT_DEFAULT_FD, &dummy_buf, count, 0);
+        a->account = account;
+        accounter.submit(a);
+        return a;
+    }
+
+    bool has_started(action_t *a) const {
+        for (accounting_payload_t *p : started) {
+            if (p == a) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void complete(action_t *a) {
+        ASSERT_TRUE(has_started(a));
+        accounter.done(a);
+    }
+
+    void on_source_availability_changed() {
+        while (accounter.producer->available->get()) {
+            started.push_back(accounter.producer->pop());
+        }
+    }
+
+    accounting_diskmgr_t accounter;
+    // Declared after `accounter`, because they have to be destroyed first.
+    std::vector<scoped_ptr_t<accounting_diskmgr_t::account_t> > accounts;
+    std::vector<scoped_ptr_t<action_t> > actions;
+    std::vector<accounting_payload_t *> started;
+    char dummy_buf;
+};
+
+TPTEST(DiskScheduling, EarliestDeadlineFirst) {
+    scheduling_driver_t driver(1);
+    accounting_diskmgr_t::account_t *gc = driver.make_account(io_class_t::gc);
+    accounting_diskmgr_t::account_t *reads
+        = driver.make_account(io_class_t::foreground_read);
+
+    scheduling_driver_t::action_t *gc1 = driver.submit_read(gc, 4096);
+    scheduling_driver_t::action_t *gc2 = driver.submit_read(gc, 4096);
+    scheduling_driver_t::action_t *read = driver.submit_read(reads, 4096);
+    ASSERT_EQ(1u, driver.started.size());
+    ASSERT_TRUE(driver.has_started(gc1));
+
+    // The read was submitted last, but its deadline is much earlier.
+    driver.complete(gc1);
+    ASSERT_EQ(2u, driver.started.size());
+    ASSERT_TRUE(driver.has_started(read));
+
+    driver.complete(read);
+    ASSERT_EQ(3u, driver.started.size());
+    ASSERT_TRUE(driver.has_started(gc2));
+    driver.complete(gc2);
+}
+
+TPTEST(DiskScheduling, BatchingRespectsDeadlines) {
+    scheduling_driver_t driver(1, 4);
+    accounting_diskmgr_t::account_t *gc = driver.make_account(io_class_t::gc);
+    accounting_diskmgr_t::account_t *reads
+        = driver.make_account(io_class_t::foreground_read);
+
+    scheduling_driver_t::action_t *gc1 = driver.submit_read(gc, 4096);
+    scheduling_driver_t::action_t *gc2 = driver.submit_read(gc, 4096);
+    scheduling_driver_t::action_t *read = driver.submit_read(reads, 4096);
+    ASSERT_TRUE(driver.has_started(gc1));
+
+    // The GC batch could go on, but the read is due earlier.
+    driver.complete(gc1);
+    ASSERT_EQ(2u, driver.started.size());
+    ASSERT_TRUE(driver.has_started(read));
+
+    driver.complete(read);
+    ASSERT_TRUE(driver.has_started(gc2));
+    driver.complete(gc2);
+}
+
+TPTEST(DiskScheduling, BandwidthCap) {
+    scheduling_driver_t driver(DEFAULT_MAX_CONCURRENT_IO_REQUESTS);
+    accounting_diskmgr_t::account_t *prefetch
+        = driver.make_account(io_class_t::prefetch);
+    accounting_diskmgr_t::account_t *reads
+        = driver.make_account(io_class_t::foreground_read);
+
+    // The first request uses up more than the whole burst.
+    const size_t burst = PREFETCH_IO_BANDWIDTH_CAP * IO_BANDWIDTH_BURST_MS / THOUSAND;
+    scheduling_driver_t::action_t *large = driver.submit_read(prefetch, burst * 5 / 4);
+    ASSERT_TRUE(driver.has_started(large));
+    scheduling_driver_t::action_t *small = driver.submit_read(prefetch, 4096);
+    ASSERT_FALSE(driver.has_started(small));
+    driver.complete(large);
+    ASSERT_FALSE(driver.has_started(small));
+
+    // Other classes aren't held up by the cap.
+    scheduling_driver_t::action_t *read = driver.submit_read(reads, 4096);
+    ASSERT_TRUE(driver.has_started(read));
+    driver.complete(read);
+
+    // Once the prefetch class has tokens again, the small request goes through.
+    for (int i = 0; i < 100 && !driver.has_started(small); ++i) {
+        nap(10);
+    }
+    ASSERT_TRUE(driver.has_started(small));
+    driver.complete(small);
+}
+
+}  // namespace unittest
@@ -0,0 +1,131 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include <map>
+
+#include "unittest/gtest.hpp"
+
+#include "serializer/log/lba/in_memory_index.hpp"
+
+namespace unittest {
+
+namespace {
+
+repli_timestamp_t make_recency(uint64_t t) {
+    repli_timestamp_t ret;
+    ret.longtime = t;
+    return ret;
+}
+
+void expect_info(in_memory_index_t *index, block_id_t id,
+                 const index_block_info_t &expected) {
+    index_block_info_t info = index->get_block_info(id);
+    EXPECT_EQ(expected.offset, info.offset) << "block " << id;
+    EXPECT_EQ(expected.recency, info.recency) << "block " << id;
+    EXPECT_EQ(expected.ser_block_size, info.ser_block_size) << "block " << id;
+}
+
+}  // namespace
+
+TEST(LbaInMemoryIndex, EmptyEntries) {
+    in_memory_index_t index;
+    EXPECT_EQ(0u, index.end_block_id());
+    EXPECT_EQ(FIRST_AUX_BLOCK_ID, index.end_aux_block_id());
+    expect_info(&index, 12345, index_block_info_t());
+    expect_info(&index, FIRST_AUX_BLOCK_ID + 7, index_block_info_t());
+    EXPECT_EQ(0u, index.memory_usage());
+}
+
+TEST(LbaInMemoryIndex, RoundTrip) {
+    in_memory_index_t index;
+    std::map<block_id_t, index_block_info_t> expected;
+    for (block_id_t id = 0; id < 20000; id += 3) {
+        index_block_info_t info(flagged_off64_t::make(id * 4096 + 17),
+                                make_recency(1000000 + (id * 7) % 5000),
+                                static_cast<uint16_t>(id % 4096 + 1));
+        index.set_block_info(id, info.recency, info.offset, info.ser_block_size);
+        expected[id] = info;
+    }
+    // A deleted block keeps its recency.
+    index.set_block_info(3, make_recency(5), flagged_off64_t::unused(), 0);
+    expected[3] = index_block_info_t(flagged_off64_t::unused(), make_recency(5), 0);
+
+    EXPECT_EQ(19999u, index.end_block_id());
+    for (block_id_t id = 0; id < 20010; ++id) {
+        auto it = expected.find(id);
+        expect_info(&index, id, it == expected.end() ? index_block_info_t() : it->second);
+    }
+}
+
+TEST(LbaInMemoryIndex, RecencyRanges) {
+    // Writes recencies that keep widening the range of a single dense chunk, and
+    // makes sure that nothing gets lost when its encoding is rebuilt.
+    in_memory_index_t index;
+    const block_id_t n = 4096;
+    for (block_id_t id = 0; id < n; ++id) {
+        index.set_block_info(id, make_recency(1ull << 40), flagged_off64_t::make(id), 1);
+    }
+    for (int shift = 0; shift < 64; ++shift) {
+        const block_id_t id = shift;
+        const uint64_t t = shift == 63 ? UINT64_MAX - 1 : (uint64_t(1) << shift);
+        index.set_block_info(id, make_recency(t), flagged_off64_t::make(id), 1);
+    }
+    index.set_block_info(100, repli_timestamp_t::invalid, flagged_off64_t::make(100), 1);
+    index.set_block_info(101, repli_timestamp_t::distant_past,
+                         flagged_off64_t::make(101), 1);
+
+    for (block_id_t id = 0; id < n; ++id) {
+        repli_timestamp_t recency = make_recency(1ull << 40);
+        if (id < 64) {
+            recency = make_recency(id == 63 ? UINT64_MAX - 1 : (uint64_t(1) << id));
+        } else if (id == 100) {
+            recency = repli_timestamp_t::invalid;
+        } else if (id == 101) {
+            recency = repli_timestamp_t::distant_past;
+        }
+        expect_info(&index, id,
+                    index_block_info_t(flagged_off64_t::make(id), recency, 1));
+    }
+}
+
+TEST(LbaInMemoryIndex, AuxBlocks) {
+    in_memory_index_t index;
+    // Aux blocks keep the recency they get stamped with when they are written (see
+    // `page_cache_t::do_flush_changes`), or have none at all.
+    auto aux_recency = [](block_id_t i) {
+        return i % 2 == 0 ? repli_timestamp_t::invalid : make_recency(1000 + i);
+    };
+    for (block_id_t i = 0; i < 5000; ++i) {
+        index.set_block_info(FIRST_AUX_BLOCK_ID + i, aux_recency(i),
+                             flagged_off64_t::make(i * 512), 512);
+    }
+    EXPECT_EQ(FIRST_AUX_BLOCK_ID + 5000, index.end_aux_block_id());
+    EXPECT_EQ(0u, index.end_block_id());
+    for (block_id_t i = 0; i < 5000; ++i) {
+        expect_info(&index, FIRST_AUX_BLOCK_ID + i,
+                    index_block_info_t(flagged_off64_t::make(i * 512),
+                                       aux_recency(i), 512));
+    }
+    expect_info(&index, 0, index_block_info_t());
+}
+
+TEST(LbaInMemoryIndex, MemoryUsage) {
+    in_memory_index_t index;
+    const block_id_t n = 100000;
+    for (block_id_t id = 0; id < n; ++id) {
+        index.set_block_info(id, make_recency(500000 + id / 10),
+                             flagged_off64_t::make(id * 4096), 4096);
+    }
+    // The dense form stores an eight byte word plus a small recency code per
+    // block, well below the 18 bytes of an `index_block_info_t`.
+    EXPECT_LT(index.memory_usage(), n * 12);
+    EXPECT_GT(index.memory_usage(), n * 8);
+
+    // Deleting everything frees all chunks again.
+    for (block_id_t id = 0; id < n; ++id) {
+        index.set_block_info(id, repli_timestamp_t::invalid,
+                             flagged_off64_t::unused(), 0);
+    }
+    EXPECT_EQ(0u, index.memory_usage());
+    expect_info(&index, 42, index_block_info_t());
+}
+
+}  // namespace unittest
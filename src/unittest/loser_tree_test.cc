@@ -0,0 +1,78 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "unittest/gtest.hpp"
+
+#include "containers/loser_tree.hpp"
+#include "random.hpp"
+
+namespace unittest {
+
+namespace {
+
+// Merges `streams` with a `loser_tree_t` and returns (value, stream) pairs in the
+// order they were picked.
+std::vector<std::pair<int, size_t> > merge(const std::vector<std::vector<int> > &streams) {
+    std::vector<size_t> positions(streams.size(), 0);
+    // Exhausted streams sort last.
+    auto beats = [&](size_t a, size_t b) {
+        bool a_done = positions[a] == streams[a].size();
+        bool b_done = positions[b] == streams[b].size();
+        if (a_done || b_done) {
+            return !a_done && b_done;
+        }
+        return streams[a][positions[a]] < streams[b][positions[b]];
+    };
+    loser_tree_t<decltype(beats)> tree(streams.size(), beats);
+    std::vector<std::pair<int, size_t> > ret;
+    for (;;) {
+        size_t winner = tree.winner();
+        if (positions[winner] == streams[winner].size()) {
+            break;
+        }
+        ret.push_back(std::make_pair(streams[winner][positions[winner]], winner));
+        ++positions[winner];
+        tree.replay();
+    }
+    return ret;
+}
+
+}  // namespace
+
+TEST(LoserTree, SingleStream) {
+    std::vector<std::pair<int, size_t> > res = merge({{1, 2, 3}});
+    ASSERT_EQ(3u, res.size());
+    EXPECT_EQ(1, res[0].first);
+    EXPECT_EQ(3, res[2].first);
+}
+
+TEST(LoserTree, TiesGoToLowerStream) {
+    std::vector<std::pair<int, size_t> > res = merge({{5, 7}, {5}, {1, 5}});
+    std::vector<std::pair<int, size_t> > expected =
+        {{1, 2}, {5, 0}, {5, 1}, {5, 2}, {7, 0}};
+    EXPECT_EQ(expected, res);
+}
+
+TEST(LoserTree, RandomStreams) {
+    rng_t rng;
+    for (size_t k = 1; k < 40; ++k) {
+        std::vector<std::vector<int> > streams(k);
+        std::vector<std::pair<int, size_t> > expected;
+        for (size_t i = 0; i < k; ++i) {
+            size_t n = rng.randint(20);
+            for (size_t j = 0; j < n; ++j) {
+                streams[i].push_back(rng.randint(50));
+            }
+            std::sort(streams[i].begin(), streams[i].end());
+            for (int v : streams[i]) {
+                expected.push_back(std::make_pair(v, i));
+            }
+        }
+        std::stable_sort(expected.begin(), expected.end());
+        EXPECT_EQ(expected, merge(streams)) << "k = " << k;
+    }
+}
+
+}  // namespace unittest
@@ -32,7 +32,7 @@ public:
     void writev_async(int64_t offset, size_t length, scoped_array_t<iovec> &&bufs,
                       file_account_t *account, linux_iocallback_t *cb);
 
-    void *create_account(UNUSED int priority, UNUSED int outstanding_requests_limit) {
+    void *create_account(UNUSED io_class_t io_class, UNUSED int outstanding_requests_limit) {
         // We don't care about accounts.  Return an arbitrary non-null pointer.
         return this;
     }
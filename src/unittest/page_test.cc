@@ -1,4 +1,6 @@
 // Copyright 2010-2014 RethinkDB, all rights reserved.
+#include <algorithm>
+
 #include "arch/runtime/coroutines.hpp"
 #include "arch/timing.hpp"
 #include "buffer_cache/page_cache.hpp"
@@ -60,6 +62,15 @@ public:
         flush_and_destroy_txn(std::move(txn), &reset_throttler_acq);
     }
 
+    void flush(scoped_ptr_t<test_txn_t> txn, std::function<void()> on_complete) {
+        flush_and_destroy_txn(
+            std::move(txn),
+            [on_complete](alt::throttler_acq_t *acq) {
+                on_complete();
+                reset_throttler_acq(acq);
+            });
+    }
+
     alt::throttler_acq_t make_throttler_acq() {
         // KSI: We could make these tests better by varying the expected change
         // count.
@@ -218,6 +229,74 @@ TPTEST(PageTest, OneWriteAcqWait, 4) {
     page_cache.flush(std::move(txn));
 }
 
+TPTEST(PageTest, ReadAhead, 4) {
+    mock_ser_t mock;
+    dummy_cache_balancer_t balancer(GIGABYTE);
+    block_id_t block_id;
+    {
+        test_cache_t page_cache(mock.ser.get(), &balancer, mock.throttler.get());
+        auto txn = make_scoped<test_txn_t>(&page_cache);
+        {
+            current_test_acq_t acq(txn.get(), alt_create_t::create);
+            block_id = acq.block_id();
+            test_acq_t page_acq;
+            page_acq.init(acq.current_page_for_write(), &page_cache);
+            static_cast<char *>(page_acq.get_buf_write())[0] = 'r';
+        }
+        page_cache.flush(std::move(txn));
+    }
+
+    // A fresh cache has to load the block, which the read ahead starts before anybody
+    // acquires it.  Reading ahead twice must be harmless.
+    test_cache_t page_cache(mock.ser.get(), &balancer, mock.throttler.get());
+    page_cache.read_ahead_block(block_id, page_cache.default_reads_account());
+    page_cache.read_ahead_block(block_id, page_cache.default_reads_account());
+    auto txn = make_scoped<test_txn_t>(&page_cache);
+    {
+        current_test_acq_t acq(txn.get(), block_id, access_t::read);
+        test_acq_t page_acq;
+        page_acq.init(acq.current_page_for_read(), &page_cache);
+        const char *buf = static_cast<const char *>(page_acq.get_buf_read());
+        ASSERT_EQ('r', buf[0]);
+    }
+    page_cache.flush(std::move(txn));
+}
+
+TPTEST(PageTest, ReadAheadBatch, 4) {
+    mock_ser_t mock;
+    dummy_cache_balancer_t balancer(GIGABYTE);
+    std::vector<block_id_t> block_ids;
+    {
+        test_cache_t page_cache(mock.ser.get(), &balancer, mock.throttler.get());
+        auto txn = make_scoped<test_txn_t>(&page_cache);
+        for (char c = 'a'; c < 'i'; ++c) {
+            current_test_acq_t acq(txn.get(), alt_create_t::create);
+            block_ids.push_back(acq.block_id());
+            test_acq_t page_acq;
+            page_acq.init(acq.current_page_for_write(), &page_cache);
+            static_cast<char *>(page_acq.get_buf_write())[0] = c;
+        }
+        page_cache.flush(std::move(txn));
+    }
+
+    // The blocks were written by one flush, so most of them get read together.  One
+    // of them is already loading when the batch starts, and reading ahead twice must be
+    // harmless.
+    test_cache_t page_cache(mock.ser.get(), &balancer, mock.throttler.get());
+    page_cache.read_ahead_block(block_ids[3], page_cache.default_reads_account());
+    page_cache.read_ahead_blocks(block_ids, page_cache.default_reads_account());
+    page_cache.read_ahead_blocks(block_ids, page_cache.default_reads_account());
+    auto txn = make_scoped<test_txn_t>(&page_cache);
+    for (size_t i = 0; i < block_ids.size(); ++i) {
+        current_test_acq_t acq(txn.get(), block_ids[i], access_t::read);
+        test_acq_t page_acq;
+        page_acq.init(acq.current_page_for_read(), &page_cache);
+        const char *buf = static_cast<const char *>(page_acq.get_buf_read());
+        ASSERT_EQ(static_cast<char>('a' + i), buf[0]);
+    }
+    page_cache.flush(std::move(txn));
+}
+
 struct ReadAfterWrite_state_t {
     block_id_t block_id;
     cond_t write_acquired;
@@ -314,6 +393,133 @@ TPTEST(PageTest, WriteWaitForFlush, 4) {
     pmap(2, std::bind(&WriteWaitForFlush_cases, &s, &page_cache, ph::_1));
 }
 
+TPTEST(PageTest, PipelinedFlushes, 4) {
+    mock_ser_t mock;
+    dummy_cache_balancer_t balancer(GIGABYTE);
+    test_cache_t page_cache(mock.ser.get(), &balancer, mock.throttler.get());
+
+    // Six independent transactions that each write a block of their own, so that each
+    // of them is flushable as soon as it's done.
+    const size_t num_txns = 6;
+    std::vector<scoped_ptr_t<test_txn_t> > txns;
+    for (size_t i = 0; i < num_txns; ++i) {
+        txns.push_back(make_scoped<test_txn_t>(&page_cache));
+        current_test_acq_t acq(txns.back().get(), alt_create_t::create);
+        test_acq_t page_acq;
+        page_acq.init(acq.current_page_for_write(), &page_cache);
+        memset(page_acq.get_buf_write(), static_cast<int>(i), 1);
+    }
+
+    std::vector<size_t> completed;
+    size_t max_flushes_in_flight = 0;
+    cond_t all_completed;
+    for (size_t i = 0; i < num_txns; ++i) {
+        page_cache.flush(std::move(txns[i]), [&, i]() {
+            completed.push_back(i);
+            max_flushes_in_flight =
+                std::max(max_flushes_in_flight, page_cache.flushes_in_flight());
+            if (i == 1) {
+                // The transactions queued behind the first two flushes were all
+                // handed to one flush as soon as the first of them completed.
+                EXPECT_EQ(0u, page_cache.queued_flush_txns());
+                EXPECT_EQ(2u, page_cache.flushes_in_flight());
+            } else if (i >= 2) {
+                EXPECT_EQ(1u, page_cache.flushes_in_flight());
+            }
+            if (completed.size() == num_txns) {
+                all_completed.pulse();
+            }
+        });
+        max_flushes_in_flight =
+            std::max(max_flushes_in_flight, page_cache.flushes_in_flight());
+    }
+    // Flushing doesn't block, so the first two transactions are being flushed and the
+    // others wait for a flush to complete.
+    EXPECT_EQ(2u, page_cache.flushes_in_flight());
+    EXPECT_EQ(num_txns - 2, page_cache.queued_flush_txns());
+
+    all_completed.wait();
+    EXPECT_EQ(2u, max_flushes_in_flight);
+    EXPECT_EQ((std::vector<size_t>{0, 1, 2, 3, 4, 5}), completed);
+}
+
+void CompressedReload_write(test_cache_t *cache,
+                            const std::vector<block_id_t> &block_ids,
+                            char first_fill) {
+    auto txn = make_scoped<test_txn_t>(cache);
+    for (size_t i = 0; i < block_ids.size(); ++i) {
+        current_test_acq_t acq(txn.get(), block_ids[i], access_t::write);
+        test_acq_t page_acq;
+        page_acq.init(acq.current_page_for_write(), cache);
+        memset(page_acq.get_buf_write(), first_fill + static_cast<char>(i % 26),
+               cache->max_block_size().value());
+    }
+    // A block's compressed copy is forgotten as soon as it's acquired for write, and
+    // the dirty pages can't be evicted into the pool again.
+    EXPECT_EQ(0u, cache->evicter().compressed_pages().uncompressed_size());
+    cond_t flushed;
+    cache->flush(std::move(txn), [&]() { flushed.pulse(); });
+    flushed.wait();
+}
+
+void CompressedReload_check(test_cache_t *cache,
+                            const std::vector<block_id_t> &block_ids,
+                            char first_fill) {
+    const uint32_t block_size = cache->max_block_size().value();
+    auto txn = make_scoped<test_txn_t>(cache);
+    for (size_t i = 0; i < block_ids.size(); ++i) {
+        current_test_acq_t acq(txn.get(), block_ids[i], access_t::read);
+        test_acq_t page_acq;
+        page_acq.init(acq.current_page_for_read(), cache);
+        const char *buf = static_cast<const char *>(page_acq.get_buf_read());
+        const char fill = first_fill + static_cast<char>(i % 26);
+        ASSERT_EQ(block_size, static_cast<uint32_t>(
+            std::count(buf, buf + block_size, fill)));
+    }
+    cache->flush(std::move(txn));
+}
+
+TPTEST(PageTest, CompressedReload, 4) {
+    mock_ser_t mock;
+    // Room for eight uncompressed pages, and as much again for compressed ones.
+    dummy_cache_balancer_t balancer(16 * DEFAULT_BTREE_BLOCK_SIZE, 0.5);
+    test_cache_t page_cache(mock.ser.get(), &balancer, mock.throttler.get());
+    const alt::evicter_t &evicter = page_cache.evicter();
+
+    std::vector<block_id_t> block_ids;
+    {
+        auto txn = make_scoped<test_txn_t>(&page_cache);
+        for (size_t i = 0; i < 64; ++i) {
+            current_test_acq_t acq(txn.get(), alt_create_t::create);
+            block_ids.push_back(acq.block_id());
+            test_acq_t page_acq;
+            page_acq.init(acq.current_page_for_write(), &page_cache);
+            memset(page_acq.get_buf_write(), 'a' + static_cast<char>(i % 26),
+                   page_cache.max_block_size().value());
+        }
+        cond_t flushed;
+        page_cache.flush(std::move(txn), [&]() { flushed.pulse(); });
+        flushed.wait();
+    }
+
+    // Most of the clean pages had to be evicted, and they compress well enough to be
+    // kept.
+    ASSERT_LT(0u, evicter.compressed_pages().uncompressed_size());
+    EXPECT_EQ(0u, evicter.total_compressed_hits());
+
+    // Reloading them takes the compressed copies, whose block tokens match those of
+    // the evicted pages.
+    CompressedReload_check(&page_cache, block_ids, 'a');
+    EXPECT_LT(0u, evicter.total_compressed_hits());
+
+    // Once the blocks have been written, reloads see the new contents rather than the
+    // copies that were compressed before the write.
+    CompressedReload_write(&page_cache, block_ids, 'A');
+    const uint64_t hits = evicter.total_compressed_hits();
+    CompressedReload_check(&page_cache, block_ids, 'A');
+    EXPECT_LT(hits, evicter.total_compressed_hits());
+}
+
 class bigger_test_t {
 public:
     explicit bigger_test_t(uint64_t _memory_limit)
@@ -419,6 +419,7 @@ bool test_rdb_env_t::instance_t::table_create(
         UNUSED const table_generate_config_params_t &config_params,
         UNUSED const std::string &primary_key,
         UNUSED write_durability_t durability,
+        UNUSED uint64_t block_size,
         UNUSED signal_t *local_interruptor,
         UNUSED ql::datum_t *result_out,
         admin_err_t *error_out) {
@@ -624,6 +625,21 @@ bool test_rdb_env_t::instance_t::db_rebalance(
     return false;
 }
 
+bool test_rdb_env_t::instance_t::table_backup(
+        UNUSED auth::user_context_t const &user_context,
+        UNUSED counted_t<const ql::db_t> db,
+        UNUSED const name_string_t &name,
+        UNUSED const std::string &directory,
+        UNUSED const boost::optional<repli_timestamp_t> &since,
+        UNUSED signal_t *local_interruptor,
+        UNUSED ql::datum_t *result_out,
+        admin_err_t *error_out) {
+    *error_out = admin_err_t{
+        "test_rdb_env_t::instance_t doesn't support backup()",
+        query_state_t::FAILED};
+    return false;
+}
+
 bool test_rdb_env_t::instance_t::grant_global(
         UNUSED auth::user_context_t const &user_context,
         UNUSED auth::username_t username,
@@ -191,6 +191,7 @@ public:
                 const table_generate_config_params_t &config_params,
                 const std::string &primary_key,
                 write_durability_t durability,
+                uint64_t block_size,
                 signal_t *interruptor,
                 ql::datum_t *result_out,
                 admin_err_t *error_out);
@@ -287,6 +288,16 @@ public:
                 ql::datum_t *result_out,
                 admin_err_t *error_out);
 
+        bool table_backup(
+                auth::user_context_t const &user_context,
+                counted_t<const ql::db_t> db,
+                const name_string_t &name,
+                const std::string &directory,
+                const boost::optional<repli_timestamp_t> &since,
+                signal_t *interruptor,
+                ql::datum_t *result_out,
+                admin_err_t *error_out);
+
         bool grant_global(
                 auth::user_context_t const &user_context,
                 auth::username_t username,
@@ -0,0 +1,81 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include <string>
+#include <vector>
+
+#include "rdb_protocol/trigrams.hpp"
+#include "unittest/gtest.hpp"
+
+namespace unittest {
+
+namespace {
+
+std::vector<std::string> to_strings(const std::vector<ql::datum_t> &trigrams) {
+    std::vector<std::string> res;
+    for (const ql::datum_t &trigram : trigrams) {
+        res.push_back(trigram.as_str().to_std());
+    }
+    return res;
+}
+
+std::vector<std::string> trigrams_of(const std::string &str) {
+    return to_strings(ql::compute_trigrams(ql::datum_t(datum_string_t(str))));
+}
+
+std::vector<std::string> required(const std::string &regex) {
+    return to_strings(ql::required_trigrams(regex));
+}
+
+}  // namespace
+
+TEST(RDBTrigrams, ComputeTrigrams) {
+    ASSERT_EQ((std::vector<std::string>{"ell", "hel", "llo"}), trigrams_of("Hello"));
+    ASSERT_EQ((std::vector<std::string>{"aaa"}), trigrams_of("aAaA"));
+    ASSERT_EQ(std::vector<std::string>(), trigrams_of("ab"));
+    // Trigrams are made of code points, not bytes.
+    ASSERT_EQ((std::vector<std::string>{"a\xc3\xa9" "b"}), trigrams_of("a\xc3\xa9" "b"));
+
+    std::vector<ql::datum_t> strings{
+        ql::datum_t(datum_string_t("abc")),
+        ql::datum_t(1.0),
+        ql::datum_t(datum_string_t("abcd"))};
+    ASSERT_EQ((std::vector<std::string>{"abc", "bcd"}),
+              to_strings(ql::compute_trigrams(
+                  ql::datum_t(std::move(strings), ql::configured_limits_t()))));
+}
+
+TEST(RDBTrigrams, RequiredTrigrams) {
+    ASSERT_EQ((std::vector<std::string>{"bar", "foo", "oba", "oob"}),
+              required("fooBar"));
+    ASSERT_EQ((std::vector<std::string>{"bar", "foo"}), required("^foo.*bar$"));
+    ASSERT_EQ((std::vector<std::string>{"bar", "foo"}), required("fooo?bar"));
+    ASSERT_EQ((std::vector<std::string>{"bar", "foo"}), required("foo(x|y)+bar"));
+    ASSERT_EQ((std::vector<std::string>{".ba", "foo", "o.b", "oo."}),
+              required("foo\\.ba"));
+    ASSERT_EQ(std::vector<std::string>(), required("x[abc]yz"));
+    ASSERT_EQ(std::vector<std::string>(), required("foo|bar"));
+    ASSERT_EQ(std::vector<std::string>(), required("(?i)foobar"));
+    ASSERT_EQ((std::vector<std::string>{"foo"}), required("(?s:.)foo"));
+}
+
+TEST(RDBTrigrams, RequiredTrigramsSkipsQuantifiersAndEscapes) {
+    // Neither the body of a counted repetition nor the payload of an escape is
+    // literal text.
+    ASSERT_EQ(std::vector<std::string>(), required("ab{10,20}cd"));
+    ASSERT_EQ((std::vector<std::string>{"abc"}), required("\\d{2}abc"));
+    ASSERT_EQ(std::vector<std::string>(), required("\\x41bc"));
+    ASSERT_EQ((std::vector<std::string>{"bcd"}), required("\\x{41}bcd"));
+    ASSERT_EQ((std::vector<std::string>{"xyz"}), required("\\p{Greek}xyz"));
+    ASSERT_EQ((std::vector<std::string>{"xyz"}), required("\\pLxyz"));
+    ASSERT_EQ((std::vector<std::string>{"abc"}), required("[\\p{Greek}]abc"));
+    ASSERT_EQ((std::vector<std::string>{"bcd"}), required("\\101bcd"));
+    ASSERT_EQ((std::vector<std::string>{"abc"}), required("x\\nabc"));
+
+    // We give up on anything we don't fully understand.
+    ASSERT_EQ(std::vector<std::string>(), required("a{,2}bcd"));
+    ASSERT_EQ(std::vector<std::string>(), required("\\kabcd"));
+    ASSERT_EQ(std::vector<std::string>(), required("(abcd"));
+    ASSERT_EQ(std::vector<std::string>(), required("abcd)"));
+    ASSERT_EQ(std::vector<std::string>(), required("[abcd"));
+}
+
+}  // namespace unittest
@@ -32,16 +32,16 @@ public:
         cluster_message_handler_t(cm, _tag),
         sequence_number(0)
         { }
-    void send(int message, peer_id_t peer) {
+    void send(int message, peer_id_t peer, uint64_t stream_key = 0) {
         auto_drainer_t::lock_t connection_keepalive;
         connectivity_cluster_t::connection_t *connection =
             get_connectivity_cluster()->get_connection(peer, &connection_keepalive);
         if (connection) {
-            send(message, connection, connection_keepalive);
+            send(message, connection, connection_keepalive, stream_key);
         }
     }
     void send(int message, connectivity_cluster_t::connection_t *connection,
-            auto_drainer_t::lock_t connection_keepalive) {
+            auto_drainer_t::lock_t connection_keepalive, uint64_t stream_key = 0) {
         class writer_t : public cluster_send_message_write_callback_t {
         public:
             explicit writer_t(int _data) : data(_data) { }
@@ -60,7 +60,7 @@ public:
             int32_t data;
         } writer(message);
         get_connectivity_cluster()->send_message(connection, connection_keepalive,
-            get_message_tag(), &writer);
+            get_message_tag(), &writer, stream_key);
     }
     void expect(int message, peer_id_t peer) {
         expect_delivered(message);
@@ -241,6 +241,32 @@ TPTEST_MULTITHREAD(RPCConnectivityTest, Ordering, 3) {
     }
 }
 
+/* `StreamOrdering` tests that messages with the same stream key arrive in the order
+they were sent in, even though the connection may have several streams. */
+
+TPTEST_MULTITHREAD(RPCConnectivityTest, StreamOrdering, 3) {
+    connectivity_cluster_t c1, c2;
+    recording_test_application_t a1(&c1, 'T'), a2(&c2, 'T');
+    test_cluster_run_t cr1(&c1);
+    test_cluster_run_t cr2(&c2);
+
+    cr1.join(get_cluster_local_address(&c2), 0);
+
+    let_stuff_happen();
+
+    const int num_keys = 5;
+    for (int i = 0; i < 100; i++) {
+        a1.send(i, c2.get_me(), i % num_keys);
+    }
+
+    let_stuff_happen();
+
+    for (int i = 0; i + num_keys < 100; i++) {
+        a2.expect(i, c1.get_me());
+        a2.expect_order(i, i + num_keys);
+    }
+}
+
 /* `GetConnections` confirms that the behavior of `cluster_t::get_connections()` is
 correct. */
 
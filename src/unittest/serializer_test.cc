@@ -2,6 +2,7 @@
 
 #include "arch/runtime/starter.hpp"
 #include "concurrency/new_mutex.hpp"
+#include "serializer/backup.hpp"
 #include "serializer/buf_ptr.hpp"
 #include "serializer/log/log_serializer.hpp"
 #include "unittest/mock_file.hpp"
@@ -30,7 +31,7 @@ void run_AddDeleteRepeatedly(bool perform_index_write) {
 
     buf_ptr_t buf = buf_ptr_t::alloc_zeroed(ser.max_block_size());
 
-    scoped_ptr_t<file_account_t> account(ser.make_io_account(1));
+    scoped_ptr_t<file_account_t> account(ser.make_io_account(io_class_t::foreground_read));
 
     // We run enough create/delete operations to run ourselves through the young
     // extent queue and (with perform_index_write true) kick off a GC that reproduces
@@ -90,5 +91,355 @@ TEST(SerializerTest, AddDeleteRepeatedlyWithIndex) {
     run_in_thread_pool(std::bind(run_AddDeleteRepeatedly, true), 4);
 }
 
+void write_test_block(log_serializer_t *ser, file_account_t *account,
+                      block_id_t block_id, char fill, repli_timestamp_t recency) {
+    buf_ptr_t buf = buf_ptr_t::alloc_zeroed(ser->max_block_size());
+    memset(buf.cache_data(), fill, ser->max_block_size().value());
+
+    struct : public iocallback_t, public cond_t {
+        void on_io_complete() {
+            pulse();
+        }
+    } cb;
+    std::vector<counted_t<standard_block_token_t> > tokens
+        = ser->block_writes({ buf_write_info_t(buf.ser_buffer(), buf.block_size(),
+                                               block_id) },
+                            account, &cb);
+    cb.wait();
+
+    new_mutex_in_line_t dummy_acq;
+    ser->index_write(&dummy_acq, []{ },
+                     { index_write_op_t(block_id, tokens[0], recency) });
+}
+
+backup_chain_header_t test_chain_header(
+        const boost::optional<repli_timestamp_t> &since,
+        repli_timestamp_t next_base) {
+    static const uuid_u source_id = generate_uuid();
+    backup_chain_header_t header;
+    header.source_id = source_id;
+    header.source_creation_timestamp = 1;
+    header.since = since;
+    header.next_base = next_base;
+    return header;
+}
+
+TPTEST(SerializerTest, Backup, 4) {
+    mock_file_opener_t source_opener;
+    log_serializer_t::create(&source_opener, log_serializer_t::static_config_t());
+    log_serializer_t source(log_serializer_t::dynamic_config_t(),
+                            &source_opener,
+                            &get_global_perfmon_collection());
+    scoped_ptr_t<file_account_t> account(source.make_io_account(io_class_t::foreground_read));
+
+    // Enough blocks for several batches, some of which get overwritten or deleted.
+    const block_id_t num_blocks = BACKUP_BLOCKS_PER_BATCH * 2 + 10;
+    for (block_id_t id = 0; id < num_blocks; ++id) {
+        write_test_block(&source, account.get(), id, 'a',
+                         repli_timestamp_t::distant_past);
+    }
+    for (block_id_t id = 0; id < num_blocks; id += 3) {
+        write_test_block(&source, account.get(), id, 'b',
+                         repli_timestamp_t{static_cast<uint64_t>(id) + 1});
+    }
+    {
+        std::vector<index_write_op_t> ops;
+        for (block_id_t id = 1; id < num_blocks; id += 7) {
+            ops.push_back(index_write_op_t(id, counted_t<standard_block_token_t>(),
+                                           repli_timestamp_t::invalid));
+        }
+        new_mutex_in_line_t dummy_acq;
+        source.index_write(&dummy_acq, []{ }, ops);
+    }
+    write_test_block(&source, account.get(), FIRST_AUX_BLOCK_ID, 'x',
+                     repli_timestamp_t::invalid);
+
+    {
+        // An interrupted backup leaves no file behind.
+        mock_file_opener_t target_opener;
+        cond_t interruptor;
+        interruptor.pulse();
+        perfmon_collection_t perfmon_collection;
+        EXPECT_THROW(backup_serializer(&source, source.index_snapshot(),
+                                       test_chain_header(boost::none,
+                                                         repli_timestamp_t::distant_past),
+                                       &target_opener, &perfmon_collection,
+                                       &interruptor),
+                     interrupted_exc_t);
+    }
+
+    mock_file_opener_t target_opener;
+    {
+        cond_t non_interruptor;
+        perfmon_collection_t perfmon_collection;
+        backup_serializer(&source, source.index_snapshot(),
+                          test_chain_header(boost::none, repli_timestamp_t{7}),
+                          &target_opener, &perfmon_collection, &non_interruptor);
+    }
+
+    // Writes to the source after the backup don't affect it.
+    write_test_block(&source, account.get(), 2, 'c', repli_timestamp_t{1000});
+
+    log_serializer_t target(log_serializer_t::dynamic_config_t(),
+                            &target_opener,
+                            &get_global_perfmon_collection());
+    scoped_ptr_t<file_account_t> target_account(target.make_io_account(io_class_t::foreground_read));
+    ASSERT_EQ(source.max_block_size().value(), target.max_block_size().value());
+    ASSERT_EQ(num_blocks, target.end_block_id());
+
+    // Only the backup has a chain header.
+    EXPECT_FALSE(static_cast<bool>(read_backup_chain_header(&source)));
+    boost::optional<backup_chain_header_t> header = read_backup_chain_header(&target);
+    ASSERT_TRUE(static_cast<bool>(header));
+    EXPECT_EQ(test_chain_header(boost::none, repli_timestamp_t()).source_id,
+              header->source_id);
+    EXPECT_FALSE(static_cast<bool>(header->since));
+    EXPECT_EQ(repli_timestamp_t{7}, header->next_base);
+
+    segmented_vector_t<repli_timestamp_t> recencies = target.get_all_recencies(0, 1);
+    for (block_id_t id = 0; id < num_blocks; ++id) {
+        counted_t<standard_block_token_t> token = target.index_read(id);
+        if (id % 7 == 1) {
+            EXPECT_FALSE(token.has());
+            continue;
+        }
+        ASSERT_TRUE(token.has());
+        buf_ptr_t buf = target.block_read(token, target_account.get());
+        const char expected = id % 3 == 0 ? 'b' : 'a';
+        const char *data = static_cast<const char *>(buf.cache_data());
+        EXPECT_EQ(expected, data[0]);
+        EXPECT_EQ(expected, data[target.max_block_size().value() - 1]);
+        EXPECT_EQ(id % 3 == 0 ? repli_timestamp_t{static_cast<uint64_t>(id) + 1}
+                              : repli_timestamp_t::distant_past,
+                  recencies[id]);
+    }
+
+    counted_t<standard_block_token_t> aux_token = target.index_read(FIRST_AUX_BLOCK_ID);
+    ASSERT_TRUE(aux_token.has());
+    buf_ptr_t aux_buf = target.block_read(aux_token, target_account.get());
+    EXPECT_EQ('x', static_cast<const char *>(aux_buf.cache_data())[0]);
+}
+
+// Returns the first byte of the block, or 0 if it has no data.
+char read_test_block(log_serializer_t *ser, file_account_t *account,
+                     block_id_t block_id) {
+    counted_t<standard_block_token_t> token = ser->index_read(block_id);
+    if (!token.has()) {
+        return 0;
+    }
+    buf_ptr_t buf = ser->block_read(token, account);
+    return static_cast<const char *>(buf.cache_data())[0];
+}
+
+TPTEST(SerializerTest, BackupIncrement, 4) {
+    mock_file_opener_t source_opener;
+    log_serializer_t::create(&source_opener, log_serializer_t::static_config_t());
+    log_serializer_t source(log_serializer_t::dynamic_config_t(),
+                            &source_opener,
+                            &get_global_perfmon_collection());
+    scoped_ptr_t<file_account_t> account(source.make_io_account(io_class_t::foreground_read));
+
+    const block_id_t num_blocks = BACKUP_BLOCKS_PER_BATCH * 2 + 10;
+    for (block_id_t id = 0; id < num_blocks; ++id) {
+        write_test_block(&source, account.get(), id, 'a',
+                         repli_timestamp_t{static_cast<uint64_t>(id) + 1});
+    }
+    // A block without a timestamp, like the blocks of a secondary index.
+    write_test_block(&source, account.get(), num_blocks, 'a',
+                     repli_timestamp_t::distant_past);
+
+    cond_t non_interruptor;
+    const repli_timestamp_t since{1000};
+    mock_file_opener_t base_opener;
+    {
+        perfmon_collection_t perfmon_collection;
+        backup_serializer(&source, source.index_snapshot(),
+                          test_chain_header(boost::none, since),
+                          &base_opener, &perfmon_collection, &non_interruptor);
+    }
+
+    write_test_block(&source, account.get(), 2, 'b', since);
+    write_test_block(&source, account.get(), num_blocks, 'b',
+                     repli_timestamp_t::distant_past);
+    write_test_block(&source, account.get(), num_blocks + 1, 'b',
+                     since.next());
+    {
+        new_mutex_in_line_t dummy_acq;
+        source.index_write(&dummy_acq, []{ },
+                           { index_write_op_t(5, counted_t<standard_block_token_t>(),
+                                              repli_timestamp_t::invalid) });
+    }
+
+    const repli_timestamp_t next_base{2000};
+    mock_file_opener_t increment_opener;
+    {
+        perfmon_collection_t perfmon_collection;
+        backup_serializer(&source, source.index_snapshot(),
+                          test_chain_header(since, next_base),
+                          &increment_opener, &perfmon_collection, &non_interruptor);
+    }
+
+    log_serializer_t increment(log_serializer_t::dynamic_config_t(),
+                               &increment_opener,
+                               &get_global_perfmon_collection());
+    scoped_ptr_t<file_account_t> increment_account(increment.make_io_account(io_class_t::foreground_read));
+    {
+        // The increment only has the data of the changed blocks, but knows about
+        // all of them.
+        std::vector<index_snapshot_entry_t> entries = increment.index_snapshot();
+        ASSERT_EQ(static_cast<size_t>(num_blocks + 1), entries.size());
+        size_t with_data = 0;
+        for (const auto &entry : entries) {
+            with_data += entry.token.has() ? 1 : 0;
+        }
+        EXPECT_EQ(3u, with_data);
+        EXPECT_EQ('b', read_test_block(&increment, increment_account.get(), 2));
+        EXPECT_EQ(0, read_test_block(&increment, increment_account.get(), 3));
+        EXPECT_EQ(repli_timestamp_t{4}, increment.get_all_recencies(0, 1)[3]);
+    }
+
+    {
+        // An increment can't be applied to a file that isn't a backup.
+        mock_file_opener_t empty_opener;
+        log_serializer_t::create(&empty_opener, log_serializer_t::static_config_t());
+        log_serializer_t empty(log_serializer_t::dynamic_config_t(),
+                               &empty_opener,
+                               &get_global_perfmon_collection());
+        EXPECT_FALSE(apply_serializer_backup_increment(&empty, &increment,
+                                                       &non_interruptor));
+        EXPECT_EQ(0, empty.end_block_id());
+    }
+
+    log_serializer_t base(log_serializer_t::dynamic_config_t(),
+                          &base_opener,
+                          &get_global_perfmon_collection());
+    scoped_ptr_t<file_account_t> base_account(base.make_io_account(io_class_t::foreground_read));
+
+    {
+        // Nor to a backup it wasn't based on, even if it has all the blocks.
+        backup_chain_header_t other_source = test_chain_header(since, next_base);
+        other_source.source_id = generate_uuid();
+        backup_chain_header_t other_since = test_chain_header(since.next(), next_base);
+        for (const backup_chain_header_t &header : { other_source, other_since }) {
+            mock_file_opener_t other_opener;
+            {
+                perfmon_collection_t perfmon_collection;
+                backup_serializer(&source, source.index_snapshot(), header,
+                                  &other_opener, &perfmon_collection,
+                                  &non_interruptor);
+            }
+            log_serializer_t other(log_serializer_t::dynamic_config_t(),
+                                   &other_opener,
+                                   &get_global_perfmon_collection());
+            EXPECT_FALSE(apply_serializer_backup_increment(&base, &other,
+                                                           &non_interruptor));
+            EXPECT_EQ('a', read_test_block(&base, base_account.get(), 2));
+        }
+    }
+
+    ASSERT_TRUE(apply_serializer_backup_increment(&base, &increment,
+                                                  &non_interruptor));
+    boost::optional<backup_chain_header_t> base_header = read_backup_chain_header(&base);
+    ASSERT_TRUE(static_cast<bool>(base_header));
+    EXPECT_FALSE(static_cast<bool>(base_header->since));
+    EXPECT_EQ(next_base, base_header->next_base);
+    // The increment has been applied, so it doesn't continue the chain anymore.
+    EXPECT_FALSE(apply_serializer_backup_increment(&base, &increment,
+                                                   &non_interruptor));
+
+    segmented_vector_t<repli_timestamp_t> recencies = base.get_all_recencies(0, 1);
+    segmented_vector_t<repli_timestamp_t> source_recencies
+        = source.get_all_recencies(0, 1);
+    for (block_id_t id = 0; id < num_blocks + 2; ++id) {
+        char expected;
+        if (id == 5) {
+            expected = 0;
+        } else if (id == 2 || id >= num_blocks) {
+            expected = 'b';
+        } else {
+            expected = 'a';
+        }
+        EXPECT_EQ(expected, read_test_block(&base, base_account.get(), id));
+        if (id != 5) {
+            EXPECT_EQ(source_recencies[id], recencies[id]);
+        }
+    }
+}
+
+TPTEST(SerializerTest, BackupIncrementAfterBackfill, 4) {
+    mock_file_opener_t source_opener;
+    log_serializer_t::create(&source_opener, log_serializer_t::static_config_t());
+    cond_t non_interruptor;
+    const block_id_t num_blocks = 10;
+    const repli_timestamp_t since{num_blocks};
+    mock_file_opener_t base_opener;
+    mock_file_opener_t plain_increment_opener;
+    {
+        log_serializer_t source(log_serializer_t::dynamic_config_t(),
+                                &source_opener,
+                                &get_global_perfmon_collection());
+        scoped_ptr_t<file_account_t> account(source.make_io_account(io_class_t::foreground_read));
+        for (block_id_t id = 0; id < num_blocks; ++id) {
+            write_test_block(&source, account.get(), id, 'a',
+                             repli_timestamp_t{static_cast<uint64_t>(id) + 1});
+        }
+        EXPECT_FALSE(static_cast<bool>(source.backfill_watermark()));
+
+        perfmon_collection_t perfmon_collection;
+        backup_serializer(&source, source.index_snapshot(),
+                          test_chain_header(boost::none, since),
+                          &base_opener, &perfmon_collection, &non_interruptor);
+        backup_serializer(&source, source.index_snapshot(),
+                          test_chain_header(since, since),
+                          &plain_increment_opener, &perfmon_collection,
+                          &non_interruptor);
+
+        // A backfilled block keeps the recency it had on the other server.
+        source.note_backfill();
+        write_test_block(&source, account.get(), 3, 'b', repli_timestamp_t{2});
+    }
+
+    // The watermark is on disk.
+    log_serializer_t source(log_serializer_t::dynamic_config_t(),
+                            &source_opener,
+                            &get_global_perfmon_collection());
+    ASSERT_TRUE(static_cast<bool>(source.backfill_watermark()));
+    EXPECT_EQ(since, *source.backfill_watermark());
+
+    mock_file_opener_t increment_opener;
+    {
+        perfmon_collection_t perfmon_collection;
+        backup_serializer(&source, source.index_snapshot(),
+                          test_chain_header(since, since),
+                          &increment_opener, &perfmon_collection, &non_interruptor);
+    }
+
+    // Without the backfill, only the newest block would have been copied.  After
+    // it, every block is.
+    for (mock_file_opener_t *opener : { &plain_increment_opener, &increment_opener }) {
+        log_serializer_t increment(log_serializer_t::dynamic_config_t(),
+                                   opener,
+                                   &get_global_perfmon_collection());
+        EXPECT_FALSE(static_cast<bool>(increment.backfill_watermark()));
+        size_t with_data = 0;
+        for (const auto &entry : increment.index_snapshot()) {
+            with_data += entry.token.has() ? 1 : 0;
+        }
+        EXPECT_EQ(opener == &increment_opener ? static_cast<size_t>(num_blocks) : 1u,
+                  with_data);
+    }
+
+    log_serializer_t base(log_serializer_t::dynamic_config_t(),
+                          &base_opener,
+                          &get_global_perfmon_collection());
+    log_serializer_t increment(log_serializer_t::dynamic_config_t(),
+                               &increment_opener,
+                               &get_global_perfmon_collection());
+    ASSERT_TRUE(apply_serializer_backup_increment(&base, &increment,
+                                                  &non_interruptor));
+    scoped_ptr_t<file_account_t> base_account(base.make_io_account(io_class_t::foreground_read));
+    EXPECT_EQ('b', read_test_block(&base, base_account.get(), 3));
+    EXPECT_EQ('a', read_test_block(&base, base_account.get(), 4));
+}
 
 }  // namespace unittest
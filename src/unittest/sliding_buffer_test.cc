@@ -0,0 +1,62 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include <string>
+
+#include "unittest/gtest.hpp"
+
+#include "containers/sliding_buffer.hpp"
+
+namespace unittest {
+
+namespace {
+
+void append(sliding_buffer_t *buffer, const std::string &str) {
+    memcpy(buffer->prepare(str.size()), str.data(), str.size());
+    buffer->commit(str.size());
+}
+
+std::string contents(const sliding_buffer_t &buffer) {
+    return std::string(buffer.data(), buffer.size());
+}
+
+}  // namespace
+
+TEST(SlidingBufferTest, FifoOrder) {
+    sliding_buffer_t buffer(4);
+    append(&buffer, "abc");
+    append(&buffer, "defgh");
+    EXPECT_EQ("abcdefgh", contents(buffer));
+    buffer.consume(2);
+    EXPECT_EQ("cdefgh", contents(buffer));
+    append(&buffer, "ij");
+    EXPECT_EQ("cdefghij", contents(buffer));
+    buffer.consume(8);
+    EXPECT_TRUE(buffer.empty());
+}
+
+TEST(SlidingBufferTest, ReusesConsumedSpace) {
+    sliding_buffer_t buffer(8);
+    append(&buffer, "abcdefg");
+    buffer.consume(5);
+    // Two live bytes and five consumed ones: moving the live bytes back to the front
+    // makes room without growing the buffer.
+    append(&buffer, "hijkl");
+    EXPECT_EQ("fghijkl", contents(buffer));
+    EXPECT_EQ(8u, buffer.capacity());
+
+    // Now there's no room, and growing is the only option.
+    append(&buffer, "mn");
+    EXPECT_EQ("fghijklmn", contents(buffer));
+    EXPECT_EQ(16u, buffer.capacity());
+}
+
+TEST(SlidingBufferTest, ShrinksOnlyWhenEmpty) {
+    sliding_buffer_t buffer(4);
+    append(&buffer, std::string(100, 'x'));
+    buffer.shrink_if_empty(4);
+    EXPECT_EQ(100u, buffer.capacity());
+    buffer.consume(100);
+    buffer.shrink_if_empty(4);
+    EXPECT_EQ(4u, buffer.capacity());
+}
+
+}  // namespace unittest
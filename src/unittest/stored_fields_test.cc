@@ -0,0 +1,64 @@
+// Copyright 2010-2016 RethinkDB, all rights reserved.
+#include <string>
+#include <vector>
+
+#include "unittest/gtest.hpp"
+
+#include "containers/archive/buffer_stream.hpp"
+#include "containers/archive/vector_stream.hpp"
+#include "containers/archive/versioned.hpp"
+#include "rdb_protocol/serialize_datum.hpp"
+#include "rdb_protocol/stored_fields.hpp"
+
+namespace unittest {
+
+namespace {
+
+ql::datum_t make_row() {
+    ql::datum_object_builder_t row;
+    row.overwrite("id", ql::datum_t(1.0));
+    row.overwrite("a", ql::datum_t(datum_string_t("foo")));
+    row.overwrite("b", ql::datum_t::boolean(true));
+    row.overwrite("c", ql::datum_t(datum_string_t(std::string(10000, 'x'))));
+    return std::move(row).to_datum();
+}
+
+}  // namespace
+
+TEST(StoredFields, Projection) {
+    ql::datum_t row = make_row();
+    ql::datum_t projection = ql::project_stored_fields({"b", "a", "missing"}, row);
+    ASSERT_EQ(ql::datum_t::R_OBJECT, projection.get_type());
+    EXPECT_EQ(2u, projection.obj_size());
+    EXPECT_EQ(row.get_field("a"), projection.get_field("a"));
+    EXPECT_EQ(row.get_field("b"), projection.get_field("b"));
+    EXPECT_FALSE(projection.get_field("missing", ql::NOTHROW).has());
+}
+
+TEST(StoredFields, ValueLayout) {
+    ql::datum_t row = make_row();
+    const std::vector<char> row_value_ref = {'\x12', '\x34', '\x56'};
+    write_message_t wm;
+    ql::serialize_stored_fields_value(&wm, {"a"}, row, row_value_ref);
+    vector_stream_t stream;
+    ASSERT_EQ(0, send_write_message(&stream, &wm));
+    const std::vector<char> &data = stream.vector();
+
+    // The stored fields come first, so they can be read without the rest of the value.
+    buffer_read_stream_t read_stream(data.data(), data.size());
+    uint32_t projection_size;
+    ASSERT_EQ(archive_result_t::SUCCESS,
+              deserialize<cluster_version_t::LATEST_DISK>(
+                  &read_stream, &projection_size));
+    ql::datum_t projection;
+    ASSERT_EQ(archive_result_t::SUCCESS, datum_deserialize(&read_stream, &projection));
+    EXPECT_EQ(sizeof(uint32_t) + projection_size,
+              static_cast<size_t>(read_stream.tell()));
+    EXPECT_EQ(ql::project_stored_fields({"a"}, row), projection);
+
+    // The row itself isn't copied, only the reference to its blob.
+    std::vector<char> rest(data.begin() + read_stream.tell(), data.end());
+    EXPECT_EQ(row_value_ref, rest);
+}
+
+}  // namespace unittest
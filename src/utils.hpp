@@ -227,6 +227,9 @@ private:
 
 void recreate_temporary_directory(const base_path_t& base_path);
 
+// Returns true if `path` is a directory that we can read and write.
+bool is_rw_directory(const base_path_t& path);
+
 void remove_directory_recursive(const char *path);
 
 #define MSTR(x) stringify(x) // Stringify a macro
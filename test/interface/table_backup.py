@@ -0,0 +1,98 @@
+#!/usr/bin/env python
+# Copyright 2016 RethinkDB, all rights reserved.
+
+'''Backs up a table, restores the backup into a table on a fresh server and reads the data back. Also checks that a server that doesn't replicate every shard refuses to take a backup.'''
+
+import os, shutil, sys, tempfile
+
+sys.path.append(os.path.abspath(os.path.join(os.path.dirname(__file__), os.path.pardir, 'common')))
+import driver, scenario_common, utils, vcoptparse
+
+op = vcoptparse.OptParser()
+op["num_rows"] = vcoptparse.IntFlag("--num-rows", 1000)
+scenario_common.prepare_option_parser_mode_flags(op)
+opts = op.parse(sys.argv)
+_, command_prefix, serve_options = scenario_common.parse_mode_flags(opts)
+
+r = utils.import_python_driver()
+dbName, tableName = utils.get_test_db_table()
+
+backupDir = tempfile.mkdtemp()
+try:
+    utils.print_with_time("Starting a cluster of two servers")
+    with driver.Cluster(initial_servers=['source', 'other'], output_folder='.', command_prefix=command_prefix, extra_options=serve_options) as cluster:
+        source = cluster['source']
+        conn = r.connect(host=source.host, port=source.driver_port)
+
+        if dbName not in r.db_list().run(conn):
+            r.db_create(dbName).run(conn)
+
+        utils.print_with_time("Checking that a table sharded over both servers can't be backed up")
+        r.db("rethinkdb").table("table_config").insert({
+            "name": "split", "db": dbName,
+            "shards": [{"primary_replica": "source", "replicas": ["source"]},
+                       {"primary_replica": "other", "replicas": ["other"]}]
+            }).run(conn)
+        split = r.db(dbName).table("split")
+        split.wait(wait_for="all_replicas_ready").run(conn)
+        try:
+            split.backup(backupDir).run(conn)
+            assert False, 'The backup of a table that the server only has half of succeeded'
+        except r.ReqlOpFailedError as e:
+            assert "isn't a replica of every shard" in str(e), str(e)
+
+        utils.print_with_time("Creating a table with %d documents" % opts["num_rows"])
+        r.db("rethinkdb").table("table_config").insert({
+            "name": tableName, "db": dbName, "primary_key": "key",
+            "shards": [{"primary_replica": "source", "replicas": ["source"]}]
+            }).run(conn)
+        tbl = r.db(dbName).table(tableName)
+        tbl.wait(wait_for="all_replicas_ready").run(conn)
+        res = tbl.insert(r.range(opts["num_rows"]).map({"key": r.row, "value": r.row.mul(2)})).run(conn)
+        assert res["inserted"] == opts["num_rows"], res
+
+        utils.print_with_time("Backing up the table")
+        res = tbl.backup(backupDir).run(conn)
+        assert res["backed_up"] == 1, res
+        backupFile = res["path"]
+        assert os.path.isfile(backupFile), 'The backup was not written to %s' % backupFile
+
+        cluster.check()
+
+    utils.print_with_time("Starting a fresh server")
+    with driver.Process(name='./fresh', command_prefix=command_prefix, extra_options=serve_options) as fresh:
+        conn = r.connect(host=fresh.host, port=fresh.driver_port)
+
+        # The backup only contains the table's data, so we create the table again
+        # with the same primary key and a single replica, and then replace its file.
+        r.db_create(dbName).run(conn)
+        r.db(dbName).table_create(tableName, primary_key="key").run(conn)
+        tbl = r.db(dbName).table(tableName)
+        tbl.wait(wait_for="all_replicas_ready").run(conn)
+        tableId = tbl.config()["id"].run(conn)
+
+        utils.print_with_time("Restoring the backup into table %s" % tableId)
+        fresh.check_and_stop()
+        shutil.copyfile(backupFile, os.path.join(fresh.data_path, tableId))
+        fresh.start()
+
+        conn = r.connect(host=fresh.host, port=fresh.driver_port)
+        tbl.wait(wait_for="all_replicas_ready").run(conn)
+
+        utils.print_with_time("Reading the data back")
+        count = tbl.count().run(conn)
+        assert count == opts["num_rows"], 'Expected %d documents, found %d' % (opts["num_rows"], count)
+        for key in [0, opts["num_rows"] // 2, opts["num_rows"] - 1]:
+            row = tbl.get(key).run(conn)
+            assert row == {"key": key, "value": key * 2}, 'Unexpected document for key %d: %r' % (key, row)
+
+        utils.print_with_time("Writing to the restored table")
+        res = tbl.insert({"key": opts["num_rows"], "value": 0}).run(conn)
+        assert res["inserted"] == 1, res
+        assert tbl.count().run(conn) == opts["num_rows"] + 1
+
+        fresh.check()
+finally:
+    shutil.rmtree(backupDir)
+
+utils.print_with_time("Done.")
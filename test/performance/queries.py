@@ -152,6 +152,11 @@ table_queries = [
         "tag": "count-sindex-between",
         "imax": 100
     },
+    {
+        # Every value of `field0` is shared by 1000 documents
+        "query": "r.db('test').table(table['name']).get_all(str(i), index='field0').count()",
+        "tag": "count-sindex-get_all"
+    },
     {
         "query": "r.db('test').table(table['name']).filter(r.expr(True)).count()",
         "tag": "filter-true-count"